@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -16,10 +17,14 @@ struct lock_t
     int table_id;
     int64_t key;
     std::atomic<bool> locked;
+    std::mutex wait_latch;
+    std::condition_variable granted;
 
     lock_t(int table_id, int64_t key);
 
-    bool wait() const;
+    // lock을 얻을 때까지 잠깐 spin 한 뒤, signal이 올 때까지 잠든다.
+    void wait();
+    // 이 lock을 기다리는 thread 하나만 깨운다.
     void signal();
 };
 
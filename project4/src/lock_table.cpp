@@ -1,7 +1,6 @@
 #include <lock_table.h>
 
 #include <iostream>
-#include <thread>
 
 std::unique_ptr<LockManager> lockManager;
 
@@ -36,10 +35,7 @@ lock_t* LockManager::lock_acquire(int table_id, int64_t key)
         lock_table[table_id][key].emplace_back(lock);
     }
 
-    while (lock->wait())
-    {
-        std::this_thread::yield();
-    }
+    lock->wait();
 
     return lock.get();
 }
@@ -76,12 +72,34 @@ lock_t::lock_t(int table_id, int64_t key)
     // Do nothing
 }
 
-bool lock_t::wait() const
+// 잠들기 전에 spin 할 최대 횟수. 최근 spin으로 lock을 얻었으면 늘리고,
+// 결국 잠들었으면 줄인다.
+constexpr int MIN_LOCK_SPIN = 16;
+constexpr int MAX_LOCK_SPIN = 4096;
+static std::atomic<int> spin_limit { MIN_LOCK_SPIN };
+
+void lock_t::wait()
 {
-    return locked;
+    int limit = spin_limit;
+    for (int i = 0; i < limit; ++i)
+    {
+        if (!locked)
+        {
+            spin_limit = std::min(limit * 2, MAX_LOCK_SPIN);
+            return;
+        }
+    }
+    spin_limit = std::max(limit / 2, MIN_LOCK_SPIN);
+
+    std::unique_lock<std::mutex> crit { wait_latch };
+    granted.wait(crit, [this]() { return !locked; });
 }
 
 void lock_t::signal()
 {
+    // wait_latch를 잡고 바꿔야, 검사와 잠들기 사이에 온 signal을 놓치지
+    // 않는다.
+    std::unique_lock<std::mutex> crit { wait_latch };
     locked = false;
+    granted.notify_one();
 } 
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "bench.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+void BENCH_SEARCH();
+void BENCH_BUFFER();
+void BENCH_DEADLOCK();
+void BENCH_SCAN();
+void BENCH_BULK_LOAD();
+void BENCH_INSERT();
+void BENCH_BLINK();
+void BENCH_PAGE_SIZE();
+void BENCH_SLOTTED();
+void BENCH_OVERFLOW();
+void BENCH_INTERNAL();
+void BENCH_COLUMNAR();
+void BENCH_COMPRESSED();
+void BENCH_FIXED();
+void BENCH_RECORD_CACHE();
+
+int main(int argc, char* argv[])
+{
+    void (*benches[])() = { BENCH_SEARCH,   BENCH_BUFFER,    BENCH_DEADLOCK,
+                            BENCH_SCAN,     BENCH_BULK_LOAD, BENCH_INSERT,
+                            BENCH_BLINK,    BENCH_PAGE_SIZE, BENCH_SLOTTED,
+                            BENCH_OVERFLOW, BENCH_INTERNAL, BENCH_COLUMNAR,
+                            BENCH_COMPRESSED, BENCH_FIXED,
+                            BENCH_RECORD_CACHE };
+
+    std::string benchNames[] = { "search",    "buffer", "deadlock",  "scan",
+                                 "bulk_load", "insert", "blink",     "page_size",
+                                 "slotted",   "overflow", "internal",
+                                 "columnar",  "compressed", "fixed",
+                                 "record_cache" };
+
+    constexpr int num_benches = sizeof(benches) / sizeof(void (*)());
+
+    if (argc != 2)
+    {
+        std::cout << "Choose a benchmark (or all)\n";
+        for (int i = 0; i < num_benches; ++i)
+        {
+            std::cout << "./bench " << benchNames[i] << "\n";
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < num_benches; ++i)
+    {
+        if (std::strcmp(argv[1], "all") && benchNames[i] != argv[1])
+        {
+            continue;
+        }
+        std::cout << "[" << benchNames[i] << " START]\n";
+        benches[i]();
+        std::cout << "[" << benchNames[i] << " END]\n\n";
+    }
+
+    return 0;
+}
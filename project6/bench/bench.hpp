@@ -0,0 +1,48 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// 벤치마크 공용 helper.
+// 각 벤치마크는 BENCH_XXX() 함수로 작성하고 bench.cc의 목록에 등록한다.
+
+class bench_timer
+{
+ public:
+    bench_timer() : begin(std::chrono::steady_clock::now())
+    {
+        // Do nothing
+    }
+
+    double elapsed_sec() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             begin)
+            .count();
+    }
+
+    void reset()
+    {
+        begin = std::chrono::steady_clock::now();
+    }
+
+ private:
+    std::chrono::steady_clock::time_point begin;
+};
+
+// 최적화로 결과가 지워지지 않도록 값을 사용한 것으로 표시한다.
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void print_result(const std::string& name, long long ops, double sec)
+{
+    std::printf("  %-36s %12lld ops %10.3f s %14.1f ops/s %10.2f ns/op\n",
+                name.c_str(), ops, sec, ops / sec, sec * 1e9 / ops);
+}
+
+#endif /* __BENCH_H__*/
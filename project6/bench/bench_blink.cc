@@ -0,0 +1,97 @@
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+
+// split이 계속 일어나는 동안의 find 처리량
+// 짝수 key를 넣어 두고 reader thread들이 임의의 짝수 key를 찾는다.
+// writer가 있으면 reader가 찾는 범위에 홀수 key를 넣어서 leaf와 internal
+// node가 계속 split 된다.
+constexpr auto BLINK_BENCH_RECORDS = 200000;
+constexpr auto BLINK_BENCH_FINDS = 200000;
+constexpr auto BLINK_BENCH_FILE = "DATA22";
+constexpr auto BLINK_BENCH_LOG = "blink_bench.log";
+constexpr auto BLINK_BENCH_MSG = "blink_bench.txt";
+
+static void run(int num_readers, bool with_writer)
+{
+    std::remove(BLINK_BENCH_FILE);
+    std::remove(BLINK_BENCH_LOG);
+    init_db(4096, 0, 0, const_cast<char*>(BLINK_BENCH_LOG),
+            const_cast<char*>(BLINK_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(BLINK_BENCH_FILE));
+    for (int64_t key = 0; key < BLINK_BENCH_RECORDS; key += 2)
+    {
+        db_insert(table_id, key, const_cast<char*>(std::to_string(key).c_str()));
+    }
+
+    std::atomic<bool> reading { true };
+    std::thread writer;
+    if (with_writer)
+    {
+        writer = std::thread([&]() {
+            char value[120];
+            std::mt19937 gen(2038);
+            while (reading)
+            {
+                int64_t key = gen() % (BLINK_BENCH_RECORDS / 2) * 2 + 1;
+                std::sprintf(value, "%ld", key);
+                db_insert(table_id, key, value);
+            }
+        });
+    }
+
+    bench_timer timer;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < num_readers; ++t)
+    {
+        readers.emplace_back([=]() {
+            char value[120];
+            std::mt19937 gen(t);
+            for (int i = 0; i < BLINK_BENCH_FINDS / num_readers; ++i)
+            {
+                int64_t key = gen() % (BLINK_BENCH_RECORDS / 2) * 2;
+                db_find(table_id, key, value, 0);
+                do_not_optimize(value[0]);
+            }
+        });
+    }
+    for (auto& thread : readers)
+    {
+        thread.join();
+    }
+    double sec = timer.elapsed_sec();
+    reading = false;
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+
+    close_table(table_id);
+    shutdown_db();
+
+    print_result("find (readers=" + std::to_string(num_readers) +
+                     (with_writer ? ", splitting)" : ")"),
+                 BLINK_BENCH_FINDS / num_readers * num_readers, sec);
+}
+
+void BENCH_BLINK()
+{
+    // ops는 reader들이 find 한 횟수
+    for (bool with_writer : { false, true })
+    {
+        for (int num_readers : { 1, 2, 4, 8 })
+        {
+            run(num_readers, with_writer);
+        }
+    }
+
+    std::remove(BLINK_BENCH_FILE);
+    std::remove(BLINK_BENCH_LOG);
+    std::remove(BLINK_BENCH_MSG);
+}
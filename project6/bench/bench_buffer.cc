@@ -0,0 +1,141 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "buffer_manager.hpp"
+
+// buffer eviction policy 비교
+// - zipf: zipfian(s = 0.99) 분포로 page를 읽는다.
+// - zipf+scan: 읽기의 1/5은 file 전체를 순서대로 훑는 scan이다.
+// buffer는 file page 수의 1/16 이다.
+constexpr auto BUFFER_BENCH_PAGES = 16384;
+constexpr auto BUFFER_BENCH_FRAMES = 1024;
+constexpr auto BUFFER_BENCH_OPS = 1 << 21;
+constexpr auto BUFFER_BENCH_FILE = "DATA9";
+
+static bool make_bench_file()
+{
+    int fd = ::open(BUFFER_BENCH_FILE, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd == -1)
+    {
+        return false;
+    }
+    page_t header {};
+    header.headerPageHeader().numberOfPages = BUFFER_BENCH_PAGES;
+    bool result = pwrite(fd, &header, sizeof(page_t), 0) == sizeof(page_t) &&
+                  ftruncate(fd, sizeof(page_t) * BUFFER_BENCH_PAGES) == 0;
+    close(fd);
+    return result;
+}
+
+// thread별 접근 순서를 미리 만들어 둔다.
+static std::vector<std::vector<pagenum_t>> make_workload(int num_threads,
+                                                         bool with_scan)
+{
+    std::vector<double> cdf(BUFFER_BENCH_PAGES - 1);
+    double sum = 0;
+    for (std::size_t i = 0; i < cdf.size(); ++i)
+    {
+        sum += 1.0 / std::pow(i + 1, 0.99);
+        cdf[i] = sum;
+    }
+
+    std::vector<std::vector<pagenum_t>> workload(num_threads);
+    for (int t = 0; t < num_threads; ++t)
+    {
+        std::mt19937_64 gen(2038 + t);
+        std::uniform_real_distribution<double> dist(0, sum);
+        pagenum_t cursor = 1 + t * BUFFER_BENCH_PAGES / num_threads;
+        for (int i = 0; i < BUFFER_BENCH_OPS / num_threads; ++i)
+        {
+            if (with_scan && gen() % 5 == 0)
+            {
+                workload[t].push_back(cursor);
+                cursor = cursor + 1 < BUFFER_BENCH_PAGES ? cursor + 1 : 1;
+                continue;
+            }
+            auto rank =
+                std::lower_bound(cdf.begin(), cdf.end(), dist(gen)) -
+                cdf.begin();
+            // 자주 읽히는 page끼리 붙어있지 않도록 섞는다.
+            pagenum_t pagenum =
+                1 + (rank * 7919) % (BUFFER_BENCH_PAGES - 1);
+            workload[t].push_back(pagenum);
+        }
+    }
+    return workload;
+}
+
+static void run(const std::string& name, BufferPolicy policy,
+                const std::vector<std::vector<pagenum_t>>& workload)
+{
+    auto& bc = BufferController::instance();
+    bc.clear_buffer();
+    bc.init_buffer(BUFFER_BENCH_FRAMES, policy);
+    int file_id = bc.openFileManager(BUFFER_BENCH_FILE);
+
+    std::vector<std::thread> threads;
+    bench_timer timer;
+    for (auto& accesses : workload)
+    {
+        threads.emplace_back([&accesses, file_id]() {
+            long long checksum = 0;
+            for (auto pagenum : accesses)
+            {
+                page_guard guard(file_id, pagenum);
+                checksum += guard.page().nodePageHeader().numberOfKeys;
+            }
+            do_not_optimize(checksum);
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double sec = timer.elapsed_sec();
+
+    double hit_ratio =
+        static_cast<double>(bc.hits()) / (bc.hits() + bc.misses());
+    print_result(name + " (hit " + std::to_string(hit_ratio * 100).substr(0, 5) +
+                     "%)",
+                 BUFFER_BENCH_OPS, sec);
+    bc.clear_buffer();
+}
+
+void BENCH_BUFFER()
+{
+    if (!make_bench_file())
+    {
+        std::printf("create bench file failure\n");
+        return;
+    }
+
+    const std::pair<std::string, BufferPolicy> policies[] = {
+        { "lru", BufferPolicy::LRU },
+        { "clock", BufferPolicy::CLOCK },
+        { "lru-k", BufferPolicy::LRU_K },
+        { "2q", BufferPolicy::TWO_Q }
+    };
+
+    for (bool with_scan : { false, true })
+    {
+        for (int num_threads : { 1, 8 })
+        {
+            std::printf(" %s, threads = %d\n", with_scan ? "zipf+scan" : "zipf",
+                        num_threads);
+            auto workload = make_workload(num_threads, with_scan);
+            for (auto& [name, policy] : policies)
+            {
+                run(name, policy, workload);
+            }
+        }
+    }
+
+    unlink(BUFFER_BENCH_FILE);
+}
@@ -0,0 +1,67 @@
+#include <cstdio>
+#include <string>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+
+// 빈 table을 정렬된 key로 채우는 시간 비교
+// - insert: key마다 db_insert
+// - bulk load: db_bulk_load (fill factor별)
+constexpr auto BULK_LOAD_BENCH_RECORDS = 1000000;
+constexpr auto BULK_LOAD_BENCH_FILE = "DATA16";
+constexpr auto BULK_LOAD_BENCH_LOG = "bulk_load_bench.log";
+constexpr auto BULK_LOAD_BENCH_MSG = "bulk_load_bench.txt";
+
+static int next_record(int64_t* key, char* value, void* arg)
+{
+    auto& i = *static_cast<int64_t*>(arg);
+    *key = i++;
+    std::sprintf(value, "%ld", *key);
+    return 0;
+}
+
+template<typename Load>
+static void run(const std::string& name, Load load)
+{
+    std::remove(BULK_LOAD_BENCH_FILE);
+    std::remove(BULK_LOAD_BENCH_LOG);
+    init_db(4096, 0, 0, const_cast<char*>(BULK_LOAD_BENCH_LOG),
+            const_cast<char*>(BULK_LOAD_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(BULK_LOAD_BENCH_FILE));
+
+    // close_table의 flush / fsync까지 포함한다.
+    bench_timer timer;
+    load(table_id);
+    close_table(table_id);
+    double sec = timer.elapsed_sec();
+    shutdown_db();
+
+    // ops는 넣은 record 수
+    print_result(name, BULK_LOAD_BENCH_RECORDS, sec);
+}
+
+void BENCH_BULK_LOAD()
+{
+    run("insert", [](int table_id) {
+        char value[120];
+        for (int64_t key = 0; key < BULK_LOAD_BENCH_RECORDS; ++key)
+        {
+            std::sprintf(value, "%ld", key);
+            db_insert(table_id, key, value);
+        }
+    });
+
+    for (int fill_percent : { 70, 90, 100 })
+    {
+        run("bulk load (fill " + std::to_string(fill_percent) + "%)",
+            [fill_percent](int table_id) {
+                int64_t i = 0;
+                db_bulk_load(table_id, BULK_LOAD_BENCH_RECORDS, next_record,
+                             &i, fill_percent);
+            });
+    }
+
+    std::remove(BULK_LOAD_BENCH_FILE);
+    std::remove(BULK_LOAD_BENCH_LOG);
+    std::remove(BULK_LOAD_BENCH_MSG);
+}
@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+#include "page.hpp"
+
+// slotted / columnar leaf의 key 탐색과 find 처리량, 형식을 바꾸는 시간
+// leaf search는 짧은 value로 가득 채운 leaf page에서 leaf_lower_bound만
+// 잰다. cold는 page가 cache에 들어가지 않는 경우, hot은 L1에 들어가는
+// 경우이다. find는 같은 table을 형식만 바꿔 가며 잰다.
+constexpr auto COLUMNAR_BENCH_COLD_PAGES = 4096;
+constexpr auto COLUMNAR_BENCH_HOT_PAGES = 4;
+constexpr auto COLUMNAR_BENCH_LOOKUPS = 1 << 22;
+constexpr auto COLUMNAR_BENCH_RECORDS = 500000;
+constexpr auto COLUMNAR_BENCH_FINDS = 500000;
+constexpr auto COLUMNAR_BENCH_FILE = "DATA32";
+constexpr auto COLUMNAR_BENCH_LOG = "columnar_bench.log";
+constexpr auto COLUMNAR_BENCH_MSG = "columnar_bench.txt";
+
+static const char* format_name(LeafFormat format)
+{
+    return format == LeafFormat::COLUMNAR ? "columnar" : "slotted";
+}
+
+static void search(LeafFormat format, int num_pages)
+{
+    std::mt19937_64 gen(2038);
+    std::vector<page_t> pages(num_pages);
+    KeyValue rec;
+    valType value {};
+    int n = 0;
+    for (auto& page : pages)
+    {
+        page = page_t {};
+        page.leaf_init(format);
+        keyType key = 0;
+        for (rec.init(key, value, 7); page.leaf_fits(rec);
+             rec.init(key, value, 7))
+        {
+            page.leaf_insert(page.number_of_keys(), rec);
+            key += 1 + gen() % 16;
+        }
+        n = page.number_of_keys();
+    }
+
+    std::vector<keyType> queries(COLUMNAR_BENCH_LOOKUPS);
+    for (auto& q : queries)
+    {
+        q = gen() % (8 * n);
+    }
+
+    long long checksum = 0;
+    bench_timer timer;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        checksum += pages[i % pages.size()].leaf_lower_bound(queries[i]);
+    }
+    double sec = timer.elapsed_sec();
+    do_not_optimize(checksum);
+    print_result(std::string(format_name(format)) + " leaf search (n = " +
+                     std::to_string(n) + ", pages = " +
+                     std::to_string(num_pages) + ")",
+                 queries.size(), sec);
+}
+
+static void find(int table_id, LeafFormat format)
+{
+    bench_timer timer;
+    int skipped = db_set_leaf_format(table_id, static_cast<int>(format));
+    print_result(std::string("set ") + format_name(format) + " (skipped " +
+                     std::to_string(skipped) + ")",
+                 COLUMNAR_BENCH_RECORDS, timer.elapsed_sec());
+
+    std::mt19937_64 gen(2038);
+    char value[120];
+    timer.reset();
+    for (int i = 0; i < COLUMNAR_BENCH_FINDS; ++i)
+    {
+        db_find(table_id, gen() % (COLUMNAR_BENCH_RECORDS * 4), value, 0);
+        do_not_optimize(value[0]);
+    }
+    print_result(std::string(format_name(format)) + " find",
+                 COLUMNAR_BENCH_FINDS, timer.elapsed_sec());
+}
+
+void BENCH_COLUMNAR()
+{
+    // ops는 탐색 / find 호출 수, set은 record 수
+    for (int num_pages : { COLUMNAR_BENCH_COLD_PAGES, COLUMNAR_BENCH_HOT_PAGES })
+    {
+        for (auto format : { LeafFormat::SLOTTED, LeafFormat::COLUMNAR })
+        {
+            search(format, num_pages);
+        }
+    }
+
+    std::remove(COLUMNAR_BENCH_FILE);
+    std::remove(COLUMNAR_BENCH_LOG);
+    init_db(16384, 0, 0, const_cast<char*>(COLUMNAR_BENCH_LOG),
+            const_cast<char*>(COLUMNAR_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(COLUMNAR_BENCH_FILE));
+    std::mt19937_64 gen(2038);
+    for (int i = 0; i < COLUMNAR_BENCH_RECORDS; ++i)
+    {
+        db_insert(table_id, gen() % (COLUMNAR_BENCH_RECORDS * 4),
+                  const_cast<char*>("value"));
+    }
+    for (auto format : { LeafFormat::SLOTTED, LeafFormat::COLUMNAR,
+                         LeafFormat::SLOTTED })
+    {
+        find(table_id, format);
+    }
+    close_table(table_id);
+    shutdown_db();
+
+    std::remove(COLUMNAR_BENCH_FILE);
+    std::remove(COLUMNAR_BENCH_LOG);
+    std::remove(COLUMNAR_BENCH_MSG);
+}
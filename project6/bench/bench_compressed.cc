@@ -0,0 +1,79 @@
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+
+// 압축 파일 형식의 크기와 find 처리량
+// 같은 record를 그대로 쓰는 파일과 압축하는 파일에 넣고, 파일 크기, disk에서
+// 실제로 차지하는 크기, 작은 buffer로 find 할 때의 처리량을 비교한다.
+constexpr auto COMPRESSED_BENCH_RECORDS = 500000;
+constexpr auto COMPRESSED_BENCH_FINDS = 200000;
+constexpr auto COMPRESSED_BENCH_BUFFER = 256;
+constexpr auto COMPRESSED_BENCH_FILE = "DATA34";
+constexpr auto COMPRESSED_BENCH_LOG = "compressed_bench.log";
+constexpr auto COMPRESSED_BENCH_MSG = "compressed_bench.txt";
+
+static int next_record(int64_t* key, char* value, void* arg)
+{
+    auto& i = *static_cast<int64_t*>(arg);
+    *key = i++;
+    std::sprintf(value, "value %ld", *key);
+    return 0;
+}
+
+static void run(bool compressed)
+{
+    std::string name = compressed ? "compressed" : "raw";
+    std::remove(COMPRESSED_BENCH_FILE);
+    std::remove(COMPRESSED_BENCH_LOG);
+    init_db(COMPRESSED_BENCH_BUFFER, 0, 0,
+            const_cast<char*>(COMPRESSED_BENCH_LOG),
+            const_cast<char*>(COMPRESSED_BENCH_MSG));
+    char* file = const_cast<char*>(COMPRESSED_BENCH_FILE);
+    int table_id = compressed ? open_compressed_table(file) : open_table(file);
+    int64_t i = 0;
+    bench_timer load_timer;
+    db_bulk_load(table_id, COMPRESSED_BENCH_RECORDS, next_record, &i, 90);
+    close_table(table_id);
+    shutdown_db();
+    print_result(name + " bulk load", COMPRESSED_BENCH_RECORDS,
+                 load_timer.elapsed_sec());
+
+    struct stat st;
+    stat(COMPRESSED_BENCH_FILE, &st);
+    std::printf("%s: file %lld KB, allocated %lld KB\n", name.c_str(),
+                static_cast<long long>(st.st_size) >> 10,
+                static_cast<long long>(st.st_blocks) * 512 >> 10);
+
+    // ops는 find 한 횟수
+    init_db(COMPRESSED_BENCH_BUFFER, 0, 0,
+            const_cast<char*>(COMPRESSED_BENCH_LOG),
+            const_cast<char*>(COMPRESSED_BENCH_MSG));
+    table_id = open_table(file);
+    std::mt19937_64 gen(2038);
+    char value[120];
+    bench_timer timer;
+    for (int q = 0; q < COMPRESSED_BENCH_FINDS; ++q)
+    {
+        db_find(table_id, gen() % COMPRESSED_BENCH_RECORDS, value, 0);
+        do_not_optimize(value[0]);
+    }
+    double sec = timer.elapsed_sec();
+    close_table(table_id);
+    shutdown_db();
+    print_result(name + " find", COMPRESSED_BENCH_FINDS, sec);
+}
+
+void BENCH_COMPRESSED()
+{
+    run(false);
+    run(true);
+
+    std::remove(COMPRESSED_BENCH_FILE);
+    std::remove(COMPRESSED_BENCH_LOG);
+    std::remove(COMPRESSED_BENCH_MSG);
+}
@@ -0,0 +1,139 @@
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+#include "lock_manager.hpp"
+
+// deadlock policy 비교
+// main의 deadlock test(DLT)와 같은 workload: 작은 table(100 record)에서
+// transaction마다 record 5개를 임의의 순서로 find / update 한다.
+// thread 수가 많을수록 기다리는 transaction과 deadlock이 많아진다.
+constexpr auto DEADLOCK_BENCH_TABLE_SIZE = 100;
+constexpr auto DEADLOCK_BENCH_OPS_PER_TRX = 5;
+constexpr auto DEADLOCK_BENCH_TRXS = 20000;
+constexpr auto DEADLOCK_BENCH_FILE = "DATA13";
+constexpr auto DEADLOCK_BENCH_LOG = "deadlock_bench.log";
+constexpr auto DEADLOCK_BENCH_MSG = "deadlock_bench.txt";
+
+static void run(DeadlockPolicy policy, int num_threads)
+{
+    std::remove(DEADLOCK_BENCH_FILE);
+    std::remove(DEADLOCK_BENCH_LOG);
+
+    // 이 workload는 deadlock이 잦아서, detector 주기가 길면 cycle에 걸린
+    // transaction들이 주기만큼 멈춰 있는 시간이 대부분을 차지한다.
+    DeadlockConfig config;
+    config.policy = policy;
+    config.detect_interval_ms = 1;
+    LockManager::instance().set_deadlock_config(config);
+    init_db(256, 0, 0, const_cast<char*>(DEADLOCK_BENCH_LOG),
+            const_cast<char*>(DEADLOCK_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(DEADLOCK_BENCH_FILE));
+    for (int64_t key = 0; key < DEADLOCK_BENCH_TABLE_SIZE; ++key)
+    {
+        char value[120];
+        std::sprintf(value, "%ld", key);
+        db_insert(table_id, key, value);
+    }
+
+    std::atomic<int> remain { DEADLOCK_BENCH_TRXS };
+    std::atomic<long long> commits { 0 };
+    std::atomic<long long> aborts { 0 };
+
+    auto worker = [&](int seed) {
+        std::mt19937 gen(seed);
+        char value[120];
+        while (remain.fetch_sub(1) > 0)
+        {
+            int64_t keys[DEADLOCK_BENCH_OPS_PER_TRX];
+            for (auto& key : keys)
+            {
+                key = gen() % DEADLOCK_BENCH_TABLE_SIZE;
+            }
+
+            int trx_id = trx_begin();
+            bool aborted = false;
+            for (int i = 0; i < DEADLOCK_BENCH_OPS_PER_TRX && !aborted; ++i)
+            {
+                bool seen = false;
+                for (int j = 0; j < i; ++j)
+                {
+                    seen |= keys[i] == keys[j];
+                }
+                if (seen)
+                {
+                    continue;
+                }
+                if (gen() % 2 == 0)
+                {
+                    aborted = db_find(table_id, keys[i], value, trx_id) != 0;
+                }
+                else
+                {
+                    std::sprintf(value, "%ld", keys[i] * (gen() % 100));
+                    aborted = db_update(table_id, keys[i], value, trx_id) != 0;
+                }
+            }
+
+            if (aborted)
+            {
+                ++aborts;
+            }
+            else
+            {
+                trx_commit(trx_id);
+                ++commits;
+            }
+        }
+    };
+
+    bench_timer timer;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i)
+    {
+        threads.emplace_back(worker, 2038 + i);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double sec = timer.elapsed_sec();
+
+    close_table(table_id);
+    shutdown_db();
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "threads=%d aborts=%lld", num_threads,
+                  aborts.load());
+    print_result(name, commits, sec);
+}
+
+void BENCH_DEADLOCK()
+{
+    const std::pair<DeadlockPolicy, const char*> policies[] = {
+        { DeadlockPolicy::DETECT, "detect (full rebuild)" },
+        { DeadlockPolicy::DETECT_INCREMENTAL, "detect (incremental)" },
+        { DeadlockPolicy::DETECT_BACKGROUND, "detect (background)" },
+        { DeadlockPolicy::WAIT_DIE, "wait-die" },
+        { DeadlockPolicy::WOUND_WAIT, "wound-wait" },
+    };
+
+    // ops는 commit 된 transaction 수
+    for (auto [policy, name] : policies)
+    {
+        std::printf("%s\n", name);
+        for (int num_threads : { 4, 16, 64 })
+        {
+            run(policy, num_threads);
+        }
+    }
+
+    LockManager::instance().set_deadlock_config({});
+    std::remove(DEADLOCK_BENCH_FILE);
+    std::remove(DEADLOCK_BENCH_LOG);
+    std::remove(DEADLOCK_BENCH_MSG);
+}
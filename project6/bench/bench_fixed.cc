@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "bench.hpp"
+#include "buffer_manager.hpp"
+#include "dbms_api.hpp"
+
+// value 너비를 고정한 table의 크기와 find / scan 처리량
+// 8바이트 이하의 value를 너비마다 같은 수로 bulk load 하고, buffer보다 큰
+// table에서 page read가 얼마나 줄어드는지 본다. slotted는 너비를 정하지
+// 않은 기본 table이다.
+constexpr auto FIXED_BENCH_RECORDS = 1000000;
+constexpr auto FIXED_BENCH_BUFFER = 1024;
+constexpr auto FIXED_BENCH_FINDS = 200000;
+constexpr auto FIXED_BENCH_SCANS = 100;
+constexpr auto FIXED_BENCH_RANGE = 10000;
+constexpr auto FIXED_BENCH_FILE = "DATA37";
+constexpr auto FIXED_BENCH_LOG = "fixed_bench.log";
+constexpr auto FIXED_BENCH_MSG = "fixed_bench.txt";
+
+static int next_record(int64_t* key, char* value, void* arg)
+{
+    auto& i = *static_cast<int64_t*>(arg);
+    *key = i++;
+    std::sprintf(value, "%08ld", *key);
+    return 0;
+}
+
+static int count_record(int64_t key, char* value, void* arg)
+{
+    do_not_optimize(value[0]);
+    ++*static_cast<long long*>(arg);
+    return 0;
+}
+
+// value_width가 0이면 slotted table
+static void run(int value_width)
+{
+    std::string name = value_width == 0 ? std::string("slotted")
+                                        : "width " + std::to_string(value_width);
+    char* file = const_cast<char*>(FIXED_BENCH_FILE);
+    auto open = [&]() {
+        init_db(FIXED_BENCH_BUFFER, 0, 0, const_cast<char*>(FIXED_BENCH_LOG),
+                const_cast<char*>(FIXED_BENCH_MSG));
+        return value_width == 0 ? open_table(file)
+                                : open_fixed_table(file, value_width);
+    };
+
+    std::remove(FIXED_BENCH_FILE);
+    std::remove(FIXED_BENCH_LOG);
+    int table_id = open();
+    int64_t i = 0;
+    bench_timer timer;
+    db_bulk_load(table_id, FIXED_BENCH_RECORDS, next_record, &i, 90);
+    double sec = timer.elapsed_sec();
+    close_table(table_id);
+    shutdown_db();
+    std::FILE* fp = std::fopen(FIXED_BENCH_FILE, "rb");
+    std::fseek(fp, 0, SEEK_END);
+    long pages = std::ftell(fp) / PAGESIZE;
+    std::fclose(fp);
+    print_result(name + " bulk load (pages " + std::to_string(pages) + ")",
+                 FIXED_BENCH_RECORDS, sec);
+
+    // ops는 읽은 record 수
+    table_id = open();
+    BufferController::instance().reset_stats();
+    std::mt19937_64 gen(2038);
+    char value[120];
+    long long found = 0;
+    timer.reset();
+    for (int q = 0; q < FIXED_BENCH_FINDS; ++q)
+    {
+        found += db_find(table_id, gen() % FIXED_BENCH_RECORDS, value, 0) == 0;
+    }
+    sec = timer.elapsed_sec();
+    print_result(name + " find (page reads " +
+                     std::to_string(BufferController::instance().misses()) +
+                     ")",
+                 found, sec);
+
+    long long count = 0;
+    timer.reset();
+    for (int q = 0; q < FIXED_BENCH_SCANS; ++q)
+    {
+        int64_t lo = gen() % (FIXED_BENCH_RECORDS - FIXED_BENCH_RANGE);
+        db_scan(table_id, lo, lo + FIXED_BENCH_RANGE - 1, 0, count_record,
+                &count);
+    }
+    print_result(name + " scan", count, timer.elapsed_sec());
+    close_table(table_id);
+    shutdown_db();
+}
+
+void BENCH_FIXED()
+{
+    for (int value_width : { 0, 120, 64, 16, 8 })
+    {
+        run(value_width);
+    }
+
+    std::remove(FIXED_BENCH_FILE);
+    std::remove(FIXED_BENCH_LOG);
+    std::remove(FIXED_BENCH_MSG);
+}
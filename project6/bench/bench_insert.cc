@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+
+// 여러 thread가 동시에 insert / delete 할 때의 처리량
+// thread마다 key를 interleave 해서 나눠 가지므로 모든 thread가 같은 leaf
+// 근처에서 insert 하고, split도 같은 경로에서 일어난다.
+constexpr auto INSERT_BENCH_RECORDS = 400000;
+constexpr auto INSERT_BENCH_FILE = "DATA20";
+constexpr auto INSERT_BENCH_LOG = "insert_bench.log";
+constexpr auto INSERT_BENCH_MSG = "insert_bench.txt";
+
+template<typename Work>
+static double run_threads(int num_threads, Work work)
+{
+    bench_timer timer;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back(work, t);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return timer.elapsed_sec();
+}
+
+static void run(int num_threads)
+{
+    std::remove(INSERT_BENCH_FILE);
+    std::remove(INSERT_BENCH_LOG);
+    init_db(4096, 0, 0, const_cast<char*>(INSERT_BENCH_LOG),
+            const_cast<char*>(INSERT_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(INSERT_BENCH_FILE));
+
+    double sec = run_threads(num_threads, [=](int t) {
+        char value[120];
+        for (int64_t key = t; key < INSERT_BENCH_RECORDS; key += num_threads)
+        {
+            std::sprintf(value, "%ld", key);
+            db_insert(table_id, key, value);
+        }
+    });
+    print_result("insert (threads=" + std::to_string(num_threads) + ")",
+                 INSERT_BENCH_RECORDS, sec);
+
+    sec = run_threads(num_threads, [=](int t) {
+        for (int64_t key = t; key < INSERT_BENCH_RECORDS; key += num_threads)
+        {
+            db_delete(table_id, key);
+        }
+    });
+    print_result("delete (threads=" + std::to_string(num_threads) + ")",
+                 INSERT_BENCH_RECORDS, sec);
+
+    close_table(table_id);
+    shutdown_db();
+}
+
+void BENCH_INSERT()
+{
+    // ops는 insert / delete 한 record 수
+    for (int num_threads : { 1, 2, 4, 8 })
+    {
+        run(num_threads);
+    }
+
+    std::remove(INSERT_BENCH_FILE);
+    std::remove(INSERT_BENCH_LOG);
+    std::remove(INSERT_BENCH_MSG);
+}
@@ -0,0 +1,108 @@
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "bench.hpp"
+#include "buffer_manager.hpp"
+#include "dbms_api.hpp"
+#include "page.hpp"
+
+// key 분포에 따른 internal node 수와 find 처리량
+// 연속된 key와 임의의 64bit key를 같은 수만큼 넣고, 파일의 internal page
+// 수를 센 뒤 작은 buffer에서 임의의 있는 key를 찾는다.
+constexpr auto INTERNAL_BENCH_RECORDS = 500000;
+constexpr auto INTERNAL_BENCH_FINDS = 200000;
+constexpr auto INTERNAL_BENCH_BUFFER = 256;
+constexpr auto INTERNAL_BENCH_FILE = "DATA30";
+constexpr auto INTERNAL_BENCH_LOG = "internal_bench.log";
+constexpr auto INTERNAL_BENCH_MSG = "internal_bench.txt";
+
+static int64_t key_of(bool random, int64_t i)
+{
+    if (!random)
+    {
+        return i;
+    }
+    std::mt19937_64 gen(i);
+    return static_cast<int64_t>(gen());
+}
+
+// root부터 닿는 page만 센다. 빈 page와 overflow page는 세지 않는다.
+static void count_internals(std::ifstream& file, pagenum_t pagenum,
+                            long& internals)
+{
+    page_t page;
+    file.seekg(pagenum * PAGESIZE);
+    file.read(reinterpret_cast<char*>(&page), PAGESIZE);
+    if (page.nodePageHeader().isLeaf)
+    {
+        return;
+    }
+    ++internals;
+    count_internals(file, page.leftmost(), internals);
+    for (int i = 0; i < page.number_of_keys(); ++i)
+    {
+        count_internals(file, page.internal_child(i), internals);
+    }
+}
+
+static void run(bool random)
+{
+    std::string name = random ? "random keys" : "sequential keys";
+    std::remove(INTERNAL_BENCH_FILE);
+    std::remove(INTERNAL_BENCH_LOG);
+    init_db(4096, 0, 0, const_cast<char*>(INTERNAL_BENCH_LOG),
+            const_cast<char*>(INTERNAL_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(INTERNAL_BENCH_FILE));
+    std::mt19937_64 order(2038);
+    // 연속된 key도 임의의 순서로 넣어서 split 위치를 고르게 한다.
+    for (int64_t i = 0; i < INTERNAL_BENCH_RECORDS; ++i)
+    {
+        int64_t key = random ? key_of(true, i)
+                             : static_cast<int64_t>(order() %
+                                                    INTERNAL_BENCH_RECORDS);
+        db_insert(table_id, key, const_cast<char*>("v"));
+    }
+    close_table(table_id);
+    shutdown_db();
+
+    std::ifstream file(INTERNAL_BENCH_FILE, std::ios::binary);
+    page_t header;
+    file.read(reinterpret_cast<char*>(&header), PAGESIZE);
+    long internals = 0;
+    count_internals(file, header.headerPageHeader().rootPageNumber, internals);
+    std::printf("%s: %ld internal pages\n", name.c_str(), internals);
+
+    init_db(INTERNAL_BENCH_BUFFER, 0, 0, const_cast<char*>(INTERNAL_BENCH_LOG),
+            const_cast<char*>(INTERNAL_BENCH_MSG));
+    table_id = open_table(const_cast<char*>(INTERNAL_BENCH_FILE));
+    BufferController::instance().reset_stats();
+    bench_timer timer;
+    char value[120];
+    for (int q = 0; q < INTERNAL_BENCH_FINDS; ++q)
+    {
+        db_find(table_id, key_of(random, order() % INTERNAL_BENCH_RECORDS),
+                value, 0);
+        do_not_optimize(value[0]);
+    }
+    double sec = timer.elapsed_sec();
+    auto misses = BufferController::instance().misses();
+    close_table(table_id);
+    shutdown_db();
+    print_result(name + " find (page reads " + std::to_string(misses) + ")",
+                 INTERNAL_BENCH_FINDS, sec);
+}
+
+void BENCH_INTERNAL()
+{
+    // ops는 find 호출 수
+    for (bool random : { false, true })
+    {
+        run(random);
+    }
+
+    std::remove(INTERNAL_BENCH_FILE);
+    std::remove(INTERNAL_BENCH_LOG);
+    std::remove(INTERNAL_BENCH_MSG);
+}
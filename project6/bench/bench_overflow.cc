@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+
+// overflow page chain에 둔 큰 value의 insert / find / update 처리량
+// update는 한 record를 transaction 안에서 반복해서 바꾸고, 매번 value의
+// 1바이트만 다르다. log는 바뀐 page에만 남으므로 value가 커져도 log 양은
+// 같고, 비교와 chain을 따라가는 비용만 늘어난다.
+constexpr auto OVERFLOW_BENCH_BYTES = 64 << 20;
+constexpr auto OVERFLOW_BENCH_FINDS = 2000;
+constexpr auto OVERFLOW_BENCH_UPDATES = 2000;
+constexpr auto OVERFLOW_BENCH_FILE = "DATA28";
+constexpr auto OVERFLOW_BENCH_LOG = "overflow_bench.log";
+constexpr auto OVERFLOW_BENCH_MSG = "overflow_bench.txt";
+
+static void run(int value_size)
+{
+    std::remove(OVERFLOW_BENCH_FILE);
+    std::remove(OVERFLOW_BENCH_LOG);
+    init_db(16384, 0, 0, const_cast<char*>(OVERFLOW_BENCH_LOG),
+            const_cast<char*>(OVERFLOW_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(OVERFLOW_BENCH_FILE));
+    int num_records = OVERFLOW_BENCH_BYTES / value_size;
+    std::string value(value_size, 'v');
+    std::string name = std::to_string(value_size) + " bytes";
+
+    bench_timer timer;
+    for (int64_t key = 0; key < num_records; ++key)
+    {
+        db_insert_n(table_id, key, value.data(), value.size());
+    }
+    print_result("insert " + name, num_records, timer.elapsed_sec());
+
+    std::mt19937 gen(2038);
+    std::vector<char> buffer(value_size);
+    int length;
+    timer.reset();
+    for (int i = 0; i < OVERFLOW_BENCH_FINDS; ++i)
+    {
+        db_find_value(table_id, gen() % num_records, buffer.data(),
+                      buffer.size(), &length, 0);
+        do_not_optimize(buffer[length - 1]);
+    }
+    print_result("find " + name, OVERFLOW_BENCH_FINDS, timer.elapsed_sec());
+
+    timer.reset();
+    for (int i = 0; i < OVERFLOW_BENCH_UPDATES; ++i)
+    {
+        value[gen() % value_size] ^= 1;
+        int trx = trx_begin();
+        db_update_n(table_id, 0, value.data(), value.size(), trx);
+        trx_commit(trx);
+    }
+    print_result("update 1 byte " + name, OVERFLOW_BENCH_UPDATES,
+                 timer.elapsed_sec());
+
+    close_table(table_id);
+    shutdown_db();
+}
+
+void BENCH_OVERFLOW()
+{
+    // ops는 insert / find / update 한 record 수
+    for (int value_size : { 1 << 10, 8 << 10, 64 << 10 })
+    {
+        run(value_size);
+    }
+
+    std::remove(OVERFLOW_BENCH_FILE);
+    std::remove(OVERFLOW_BENCH_LOG);
+    std::remove(OVERFLOW_BENCH_MSG);
+}
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "bench.hpp"
+#include "bptree.hpp"
+#include "buffer_manager.hpp"
+#include "dbms_api.hpp"
+
+// 지금 빌드한 page 크기에서의 find / scan 처리량
+// page 크기를 바꿔 가며 비교하려면 make bench_page_size로 크기마다 다시
+// 빌드해서 돌린다. buffer는 page 수가 아니라 byte로 크기를 맞추고, table은
+// buffer보다 크게 만들어서 page read가 일어나게 한다.
+constexpr auto PAGE_SIZE_BENCH_RECORDS = 1000000;
+constexpr auto PAGE_SIZE_BENCH_BUFFER_BYTES = 32 << 20;
+constexpr auto PAGE_SIZE_BENCH_FINDS = 100000;
+constexpr auto PAGE_SIZE_BENCH_SCANS = 100;
+constexpr auto PAGE_SIZE_BENCH_RANGE = 10000;
+constexpr auto PAGE_SIZE_BENCH_FILE = "DATA23";
+constexpr auto PAGE_SIZE_BENCH_LOG = "page_size_bench.log";
+constexpr auto PAGE_SIZE_BENCH_MSG = "page_size_bench.txt";
+
+static int next_record(int64_t* key, char* value, void* arg)
+{
+    auto& i = *static_cast<int64_t*>(arg);
+    *key = i++;
+    std::sprintf(value, "%ld", *key);
+    return 0;
+}
+
+static int count_record(int64_t key, char* value, void* arg)
+{
+    do_not_optimize(value[0]);
+    ++*static_cast<long long*>(arg);
+    return 0;
+}
+
+// buffer를 비운 상태에서 read를 돌리고, 걸린 시간과 page read 수를 적는다.
+template<typename Read>
+static void run(const std::string& name, Read read)
+{
+    init_db(PAGE_SIZE_BENCH_BUFFER_BYTES / PAGESIZE, 0, 0,
+            const_cast<char*>(PAGE_SIZE_BENCH_LOG),
+            const_cast<char*>(PAGE_SIZE_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(PAGE_SIZE_BENCH_FILE));
+    BufferController::instance().reset_stats();
+
+    bench_timer timer;
+    long long ops = read(table_id);
+    double sec = timer.elapsed_sec();
+    auto misses = BufferController::instance().misses();
+
+    close_table(table_id);
+    shutdown_db();
+    print_result(name + " (page reads " + std::to_string(misses) + ")", ops,
+                 sec);
+}
+
+void BENCH_PAGE_SIZE()
+{
+    std::printf("page size %d (leaf order %d, internal order %d)\n", PAGESIZE,
+                LEAF_ORDER, INTERNAL_ORDER);
+
+    std::remove(PAGE_SIZE_BENCH_FILE);
+    std::remove(PAGE_SIZE_BENCH_LOG);
+    init_db(PAGE_SIZE_BENCH_BUFFER_BYTES / PAGESIZE, 0, 0,
+            const_cast<char*>(PAGE_SIZE_BENCH_LOG),
+            const_cast<char*>(PAGE_SIZE_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(PAGE_SIZE_BENCH_FILE));
+    int64_t i = 0;
+    db_bulk_load(table_id, PAGE_SIZE_BENCH_RECORDS, next_record, &i, 90);
+    close_table(table_id);
+    shutdown_db();
+
+    // ops는 읽은 record 수
+    run("find", [](int table_id) {
+        std::mt19937_64 gen(2038);
+        char value[120];
+        long long count = 0;
+        for (int q = 0; q < PAGE_SIZE_BENCH_FINDS; ++q)
+        {
+            int64_t key = gen() % PAGE_SIZE_BENCH_RECORDS;
+            count += db_find(table_id, key, value, 0) == 0;
+        }
+        return count;
+    });
+
+    run("scan", [](int table_id) {
+        std::mt19937_64 gen(2038);
+        long long count = 0;
+        for (int q = 0; q < PAGE_SIZE_BENCH_SCANS; ++q)
+        {
+            int64_t lo =
+                gen() % (PAGE_SIZE_BENCH_RECORDS - PAGE_SIZE_BENCH_RANGE);
+            db_scan(table_id, lo, lo + PAGE_SIZE_BENCH_RANGE - 1, 0,
+                    count_record, &count);
+        }
+        return count;
+    });
+
+    std::remove(PAGE_SIZE_BENCH_FILE);
+    std::remove(PAGE_SIZE_BENCH_LOG);
+    std::remove(PAGE_SIZE_BENCH_MSG);
+}
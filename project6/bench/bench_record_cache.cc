@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "buffer_manager.hpp"
+#include "dbms_api.hpp"
+#include "record_cache.hpp"
+
+// 같은 memory를 buffer와 record cache에 나눠 줄 때의 find 처리량
+// 100바이트 value를 가진 record를 buffer보다 훨씬 크게 넣고, find의 90%는
+// table 전체에 흩어진 hot key로, 나머지는 아무 key로 보낸다. hot key는
+// leaf마다 하나 남짓이라 buffer만 있으면 frame 대부분이 cold record로 찬다.
+constexpr auto RECORD_CACHE_BENCH_RECORDS = 1000000;
+constexpr auto RECORD_CACHE_BENCH_HOT_KEYS = 50000;
+constexpr auto RECORD_CACHE_BENCH_MEMORY = 16 << 20;
+constexpr auto RECORD_CACHE_BENCH_FINDS = 400000;
+constexpr auto RECORD_CACHE_BENCH_FILE = "DATA39";
+constexpr auto RECORD_CACHE_BENCH_LOG = "record_cache_bench.log";
+constexpr auto RECORD_CACHE_BENCH_MSG = "record_cache_bench.txt";
+
+static int next_record(int64_t* key, char* value, void* arg)
+{
+    auto& i = *static_cast<int64_t*>(arg);
+    *key = i++;
+    std::sprintf(value, "%0100ld", *key);
+    return 0;
+}
+
+static int64_t next_key(std::mt19937_64& gen)
+{
+    if (gen() % 10 != 0)
+    {
+        // hot key를 table 전체에 흩는다.
+        uint64_t hot = gen() % RECORD_CACHE_BENCH_HOT_KEYS;
+        return hot * 2654435761ULL % RECORD_CACHE_BENCH_RECORDS;
+    }
+    return gen() % RECORD_CACHE_BENCH_RECORDS;
+}
+
+// memory 중 cache_bytes를 record cache에, 나머지를 buffer에 준다.
+static void run(int cache_bytes, int num_readers)
+{
+    db_set_record_cache(cache_bytes);
+    init_db((RECORD_CACHE_BENCH_MEMORY - cache_bytes) / PAGESIZE, 0, 0,
+            const_cast<char*>(RECORD_CACHE_BENCH_LOG),
+            const_cast<char*>(RECORD_CACHE_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(RECORD_CACHE_BENCH_FILE));
+
+    // 한 번 돌려서 buffer와 cache를 채운 뒤에 잰다.
+    auto read = [=](int seed) {
+        char value[120];
+        std::mt19937_64 gen(seed);
+        for (int q = 0; q < RECORD_CACHE_BENCH_FINDS / num_readers; ++q)
+        {
+            db_find(table_id, next_key(gen), value, 0);
+            do_not_optimize(value[0]);
+        }
+    };
+    read(2038);
+    BufferController::instance().reset_stats();
+    RecordCache::instance().reset_stats();
+
+    bench_timer timer;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < num_readers; ++t)
+    {
+        readers.emplace_back(read, t);
+    }
+    for (auto& thread : readers)
+    {
+        thread.join();
+    }
+    double sec = timer.elapsed_sec();
+    auto misses = BufferController::instance().misses();
+    auto hits = RecordCache::instance().hits();
+
+    close_table(table_id);
+    shutdown_db();
+    db_set_record_cache(0);
+
+    long long ops = RECORD_CACHE_BENCH_FINDS / num_readers * num_readers;
+    print_result("cache " + std::to_string(cache_bytes >> 20) + "MB (readers=" +
+                     std::to_string(num_readers) + ", hits " +
+                     std::to_string(hits * 100 / ops) + "%, page reads " +
+                     std::to_string(misses) + ")",
+                 ops, sec);
+}
+
+void BENCH_RECORD_CACHE()
+{
+    std::printf("memory %dMB = buffer + record cache\n",
+                RECORD_CACHE_BENCH_MEMORY >> 20);
+
+    std::remove(RECORD_CACHE_BENCH_FILE);
+    std::remove(RECORD_CACHE_BENCH_LOG);
+    init_db(1024, 0, 0, const_cast<char*>(RECORD_CACHE_BENCH_LOG),
+            const_cast<char*>(RECORD_CACHE_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(RECORD_CACHE_BENCH_FILE));
+    int64_t i = 0;
+    db_bulk_load(table_id, RECORD_CACHE_BENCH_RECORDS, next_record, &i, 90);
+    close_table(table_id);
+    shutdown_db();
+
+    // ops는 find 한 횟수
+    for (int num_readers : { 1, 4 })
+    {
+        for (int cache_bytes : { 0, 8 << 20, 12 << 20 })
+        {
+            run(cache_bytes, num_readers);
+        }
+    }
+
+    std::remove(RECORD_CACHE_BENCH_FILE);
+    std::remove(RECORD_CACHE_BENCH_LOG);
+    std::remove(RECORD_CACHE_BENCH_MSG);
+}
@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+
+// range read 비교
+// - find: key마다 db_find (매번 root부터 내려간다)
+// - cursor: db_scan_open / next
+// - callback: db_scan
+// transaction이 있으면 읽는 record마다 S lock을 얻는다.
+constexpr auto SCAN_BENCH_RECORDS = 100000;
+constexpr auto SCAN_BENCH_RANGE = 1000;
+constexpr auto SCAN_BENCH_QUERIES = 500;
+constexpr auto SCAN_BENCH_FILE = "DATA15";
+constexpr auto SCAN_BENCH_LOG = "scan_bench.log";
+constexpr auto SCAN_BENCH_MSG = "scan_bench.txt";
+
+static int count_record(int64_t key, char* value, void* arg)
+{
+    do_not_optimize(value[0]);
+    ++*static_cast<long long*>(arg);
+    return 0;
+}
+
+template<typename Read>
+static void run(const std::string& name, const std::vector<int64_t>& queries,
+                bool with_trx, Read read)
+{
+    long long records = 0;
+    bench_timer timer;
+    for (auto lo : queries)
+    {
+        int trx = with_trx ? trx_begin() : 0;
+        records += read(lo, lo + SCAN_BENCH_RANGE - 1, trx);
+        if (with_trx)
+        {
+            trx_commit(trx);
+        }
+    }
+    print_result(name + (with_trx ? " (trx)" : ""), records,
+                 timer.elapsed_sec());
+}
+
+void BENCH_SCAN()
+{
+    std::remove(SCAN_BENCH_FILE);
+    std::remove(SCAN_BENCH_LOG);
+    init_db(4096, 0, 0, const_cast<char*>(SCAN_BENCH_LOG),
+            const_cast<char*>(SCAN_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(SCAN_BENCH_FILE));
+    for (int64_t key = 0; key < SCAN_BENCH_RECORDS; ++key)
+    {
+        db_insert(table_id, key, const_cast<char*>(std::to_string(key).c_str()));
+    }
+
+    std::mt19937_64 gen(2038);
+    std::vector<int64_t> queries(SCAN_BENCH_QUERIES);
+    for (auto& lo : queries)
+    {
+        lo = gen() % (SCAN_BENCH_RECORDS - SCAN_BENCH_RANGE);
+    }
+
+    // ops는 읽은 record 수
+    for (bool with_trx : { false, true })
+    {
+        run("find", queries, with_trx, [table_id](int64_t lo, int64_t hi,
+                                                  int trx) {
+            char value[120];
+            long long count = 0;
+            for (int64_t key = lo; key <= hi; ++key)
+            {
+                count += db_find(table_id, key, value, trx) == 0;
+            }
+            return count;
+        });
+
+        run("cursor", queries, with_trx, [table_id](int64_t lo, int64_t hi,
+                                                    int trx) {
+            char value[120];
+            int64_t key;
+            long long count = 0;
+            int cursor = db_scan_open(table_id, lo, hi, trx);
+            while (db_scan_next(cursor, &key, value) == 0)
+            {
+                ++count;
+            }
+            db_scan_close(cursor);
+            return count;
+        });
+
+        run("callback", queries, with_trx, [table_id](int64_t lo, int64_t hi,
+                                                      int trx) {
+            long long count = 0;
+            db_scan(table_id, lo, hi, trx, count_record, &count);
+            return count;
+        });
+    }
+
+    close_table(table_id);
+    shutdown_db();
+    std::remove(SCAN_BENCH_FILE);
+    std::remove(SCAN_BENCH_LOG);
+    std::remove(SCAN_BENCH_MSG);
+}
@@ -0,0 +1,91 @@
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "page.hpp"
+
+// page_t의 key 탐색 kernel 비교
+// - linear: 기존 구현 (앞에서부터 한 칸씩 비교)
+// - branchless: cmov 기반 binary search
+// - page_t: page_t::lower_bound / upper_bound가 사용하는 특화 kernel
+
+// cold: page가 cache에 들어가지 않는 경우, hot: L1에 들어가는 경우
+constexpr auto SEARCH_BENCH_COLD_PAGES = 1024;
+constexpr auto SEARCH_BENCH_HOT_PAGES = 4;
+constexpr auto SEARCH_BENCH_LOOKUPS = 1 << 22;
+
+template<typename T, typename Search>
+static void run(const std::string& name, const std::vector<page_t>& pages,
+                const std::vector<keyType>& queries, Search search)
+{
+    long long checksum = 0;
+    bench_timer timer;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        auto& page = pages[i % pages.size()];
+        checksum += search(page, queries[i]);
+    }
+    double sec = timer.elapsed_sec();
+    do_not_optimize(checksum);
+    print_result(name, queries.size(), sec);
+}
+
+template<typename T>
+static void bench_entry(const std::string& type_name, int n, int num_pages)
+{
+    std::mt19937_64 gen(2038);
+    std::vector<page_t> pages(num_pages);
+    for (auto& page : pages)
+    {
+        page = page_t {};
+        page.set_is_leaf(std::is_same<T, Record>::value);
+        keyType key = gen() % 1000;
+        for (int i = 0; i < n; ++i)
+        {
+            key += 1 + gen() % 16;
+            T entry {};
+            entry.key = key;
+            page.push_back(entry);
+        }
+    }
+
+    std::vector<keyType> queries(SEARCH_BENCH_LOOKUPS);
+    for (auto& q : queries)
+    {
+        q = gen() % (1000 + 16 * n);
+    }
+
+    std::printf(" %s (n = %d, pages = %d)\n", type_name.c_str(), n,
+                num_pages);
+
+    run<T>("linear lower_bound", pages, queries,
+           [n](const page_t& page, keyType key) {
+               return linear_lower_bound(&page.get<T>(0), n, key);
+           });
+    run<T>("branchless lower_bound", pages, queries,
+           [n](const page_t& page, keyType key) {
+               return branchless_lower_bound(&page.get<T>(0), n, key);
+           });
+    run<T>("page_t::lower_bound", pages, queries,
+           [](const page_t& page, keyType key) {
+               return page.lower_bound<T>(key);
+           });
+    run<T>("linear upper_bound", pages, queries,
+           [n](const page_t& page, keyType key) {
+               return linear_upper_bound(&page.get<T>(0), n, key);
+           });
+    run<T>("page_t::upper_bound", pages, queries,
+           [](const page_t& page, keyType key) {
+               return page.upper_bound<T>(key);
+           });
+}
+
+void BENCH_SEARCH()
+{
+    for (int pages : { SEARCH_BENCH_COLD_PAGES, SEARCH_BENCH_HOT_PAGES })
+    {
+        bench_entry<Record>("Records", page_layout::records, pages);
+        bench_entry<Internal>("Internals", page_layout::internals, pages);
+        bench_entry<Internal>("Internals", 32, pages);
+    }
+}
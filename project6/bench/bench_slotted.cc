@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "bench.hpp"
+#include "dbms_api.hpp"
+#include "page.hpp"
+
+// value 길이에 따른 slotted leaf의 크기와 find / update 처리량
+// 같은 수의 record를 임의의 순서로 넣고, 파일의 page 수와 임의의 key를
+// 찾는 처리량을 적는다. update는 value를 두 배 길이로 바꾼다.
+constexpr auto SLOTTED_BENCH_RECORDS = 200000;
+constexpr auto SLOTTED_BENCH_OPS = 200000;
+constexpr auto SLOTTED_BENCH_FILE = "DATA26";
+constexpr auto SLOTTED_BENCH_LOG = "slotted_bench.log";
+constexpr auto SLOTTED_BENCH_MSG = "slotted_bench.txt";
+
+static void run(int length)
+{
+    std::remove(SLOTTED_BENCH_FILE);
+    std::remove(SLOTTED_BENCH_LOG);
+    init_db(4096, 0, 0, const_cast<char*>(SLOTTED_BENCH_LOG),
+            const_cast<char*>(SLOTTED_BENCH_MSG));
+    int table_id = open_table(const_cast<char*>(SLOTTED_BENCH_FILE));
+
+    std::mt19937_64 gen(2038);
+    std::string value(length, 'v');
+    for (int i = 0; i < SLOTTED_BENCH_RECORDS; ++i)
+    {
+        db_insert_n(table_id, gen() % (SLOTTED_BENCH_RECORDS * 4), value.data(),
+                    length);
+    }
+    std::string name = "length " + std::to_string(length);
+
+    bench_timer timer;
+    char ret[120];
+    int ret_length;
+    for (int i = 0; i < SLOTTED_BENCH_OPS; ++i)
+    {
+        db_find_n(table_id, gen() % (SLOTTED_BENCH_RECORDS * 4), ret,
+                  &ret_length, 0);
+        do_not_optimize(ret[0]);
+    }
+    print_result(name + " find", SLOTTED_BENCH_OPS, timer.elapsed_sec());
+
+    std::string longer(std::min(2 * length, 119), 'u');
+    timer.reset();
+    for (int i = 0; i < SLOTTED_BENCH_OPS; ++i)
+    {
+        db_update_n(table_id, gen() % (SLOTTED_BENCH_RECORDS * 4),
+                    longer.data(), longer.size(), 0);
+    }
+    print_result(name + " update", SLOTTED_BENCH_OPS, timer.elapsed_sec());
+
+    close_table(table_id);
+    shutdown_db();
+
+    std::ifstream file(SLOTTED_BENCH_FILE, std::ios::binary | std::ios::ate);
+    std::printf("%s: %ld pages\n", name.c_str(),
+                static_cast<long>(file.tellg()) / PAGESIZE);
+}
+
+void BENCH_SLOTTED()
+{
+    // ops는 find / update 호출 수 (없는 key 포함)
+    for (int length : { 4, 16, 64, 119 })
+    {
+        run(length);
+    }
+
+    std::remove(SLOTTED_BENCH_FILE);
+    std::remove(SLOTTED_BENCH_LOG);
+    std::remove(SLOTTED_BENCH_MSG);
+}
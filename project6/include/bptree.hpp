@@ -1,34 +1,54 @@
 #ifndef __BPTREE_HPP__
 #define __BPTREE_HPP__
 
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string_view>
+#include <vector>
 
 #include "buffer_manager.hpp"
 #include "frame.hpp"
 #include "log_manager_legacy.hpp"
 #include "page.hpp"
 #include "transaction_manager.hpp"
-#include "scoped_page_latch.hpp"
+#include "page_guard.hpp"
 
-constexpr auto LEAF_ORDER = 32;
-constexpr auto INTERNAL_ORDER = 249;
+constexpr auto LEAF_ORDER = page_layout::records + 1;
+constexpr auto INTERNAL_ORDER = page_layout::internals + 1;
 constexpr auto VERBOSE_OUTPUT = false;
 constexpr auto DELAYED_MIN = 1;
 constexpr auto INVALID_NODE_ID = EMPTY_PAGE_NUMBER;
+// 같은 level의 가장 왼쪽 node의 low key
+constexpr auto MIN_KEY = std::numeric_limits<keyType>::min();
+// bulk load에서 node를 채우는 비율
+constexpr auto BULK_LOAD_FILL_FACTOR = 0.9;
+// bulk load에서 write 한 번에 쓰는 page 수
+constexpr auto BULK_LOAD_CHUNK_PAGES = 256;
 
 using node_t = page_t;
 using nodeId_t = pagenum_t;
-using record_t = Record;
+using record_t = KeyValue;
 using internal_t = Internal;
 using manager_t = BufferManager;
 
+// node는 복사본이 아니라 guard가 pin 하고 있는 buffer frame을 직접 가리킨다.
+// 수정한 뒤에는 commit_node로 dirty 표시를 해야 한다.
 struct node_tuple
 {
-    nodeId_t id;
-    node_t node;
-    int buffer_index;
+    nodeId_t id = INVALID_NODE_ID;
+    page_guard guard;
+
+    node_t& node() const
+    {
+        return guard.frame();
+    }
+
     node_tuple() = default;
     node_tuple(const node_tuple&) = delete;
     node_tuple(node_tuple&&) = delete;
@@ -41,6 +61,56 @@ struct node_tuple
     }
 };
 
+// merge 할 수 있는 delete가 X latch를 잡고 있는 경로.
+// nodes는 위에서부터 leaf까지이고, root가 바뀔 수 있으면 root_lock도 잡는다.
+struct latch_path
+{
+    std::unique_lock<std::shared_mutex> smo_lock;
+    std::unique_lock<std::shared_mutex> root_lock;
+    std::deque<node_tuple> nodes;
+};
+
+enum class ScanResult
+{
+    FOUND,
+    END,
+    ABORTED
+};
+
+// [lo, hi] 범위의 record를 key 순서대로 읽는 cursor.
+// leaf 하나 분량의 record를 batch로 복사해 두고 하나씩 돌려준다.
+// next 사이에는 latch 없이 leaf를 pin만 해 두고, 다음 leaf로는 root부터
+// 다시 내려가지 않고 next_leaf를 따라간다.
+struct scan_cursor
+{
+    keyType lo;
+    keyType hi;
+    int transaction_id = TransactionManager::invliad_transaction_id;
+    node_tuple leaf;
+    // 마지막으로 읽은 key. started면 이 key 다음부터 읽는다.
+    bool started = false;
+    keyType last_key;
+    bool done = false;
+    std::vector<record_t> batch;
+    std::size_t pos = 0;
+};
+
+// insert / delete / find / scan은 여러 thread에서 동시에 부를 수 있다.
+// node는 Lehman-Yao의 B-link 형식으로, 모든 level에서 [low key, high key)와
+// 오른쪽 node를 가리키는 right link를 갖는다.
+// - 내려갈 때는 부모의 latch를 잡은 채로 자식을 pin만 하고, 부모를 놓은
+//   뒤에 자식을 latch 한다. 그 사이 자식이 split 되었으면 key가 high key
+//   이상이므로 right link를 따라간다. latch는 한 번에 하나만 잡는다.
+// - insert는 leaf에만 X latch를 잡는다. split은 새 node를 right link로 먼저
+//   연결하고 latch를 놓은 다음, 부모에 key를 넣는다. 부모는 내려오며
+//   지나온 node에서 right link를 따라 찾는다.
+// - merge 할 수 있는 delete는 smo_latch를 X로 잡아 split과 겹치지 않게 하고,
+//   root부터 X latch로 내려가며 바뀌지 않을 node를 만나면 그 위를 놓는다.
+//   merge 할 이웃은 기다리지 않고 try_lock 하고, 못 잡으면 merge 하지 않는다.
+// - merge로 빠진 node는 비워 두고, pin 하고 있던 thread는 그것을 보고
+//   root부터 다시 내려간다. redistribute로 key가 왼쪽 node로 넘어갔을 때도
+//   (key < low key) 다시 내려간다.
+// lock_path 밖에서는 latch를 잡은 채로 왼쪽에서 오른쪽으로만 기다린다.
 class BPTree
 {
  public:
@@ -48,47 +118,167 @@ class BPTree
     void set_table(int table_id);
     int char_to_valType(valType& dst, const char* src) const;
     int get_table_id() const;
-    bool open_table(const std::string& filename);
+    bool open_table(const std::string& filename,
+                    FileFormat format = FileFormat::RAW,
+                    LeafFormat leaf_format = DEFAULT_LEAF_FORMAT);
     // Insertion.
-    bool insert(keyType key, const valType& value);
+    // value는 rec.length 바이트이다. (최대 max_value_length)
+    bool insert(const record_t& rec);
     bool update(
-        keyType key, const valType& value,
+        const record_t& rec,
         int transaction_id = TransactionManager::invliad_transaction_id);
     bool delete_key(keyType key);
+    // key가 있으면 update, 없으면 insert 한다. root부터 한 번만 내려간다.
+    bool upsert(
+        const record_t& rec,
+        int transaction_id = TransactionManager::invliad_transaction_id);
 
     bool find(keyType key, record_t& ret,
               int transaction_id = TransactionManager::invliad_transaction_id);
 
+    // max_value_length보다 긴 value는 overflow page chain에 둔다. (slotted
+    // leaf에서만, 최대 max_overflow_length)
+    bool insert(keyType key, ValueRef value);
+    bool update(
+        keyType key, ValueRef value,
+        int transaction_id = TransactionManager::invliad_transaction_id);
+    bool upsert(
+        keyType key, ValueRef value,
+        int transaction_id = TransactionManager::invliad_transaction_id);
+    // value의 앞 capacity 바이트까지 buffer에 읽고, 전체 길이를 length에
+    // 담는다.
+    bool find(keyType key, uint8_t* buffer, int capacity, int& length,
+              int transaction_id = TransactionManager::invliad_transaction_id);
+
+    // Range scan.
+    // transaction이 주어지면 읽는 record마다 S lock을 얻는다.
+    bool scan_open(
+        scan_cursor& cursor, keyType lo, keyType hi,
+        int transaction_id = TransactionManager::invliad_transaction_id);
+    ScanResult scan_next(scan_cursor& cursor, record_t& ret);
+    void scan_close(scan_cursor& cursor);
+    // callback이 false를 돌려주면 멈춘다. abort 되면 false
+    bool scan(keyType lo, keyType hi,
+              const std::function<bool(const record_t&)>& callback,
+              int transaction_id = TransactionManager::invliad_transaction_id);
+
+    // Bulk load.
+    // key가 strictly increasing인 count개의 record를 next로 하나씩 받아서
+    // leaf부터 위로 tree를 만든다. next는 record를 채우고 true를 돌려준다.
+    // node는 fill_factor 만큼만 채우고, page는 pagenum 순서대로 buffer를
+    // 거치지 않고 쓰며, root는 마지막에 한 번만 바꾼다.
+    // tree가 비어 있지 않으면 insert를 반복한다.
+    bool bulk_load(std::size_t count,
+                   const std::function<bool(record_t&)>& next,
+                   double fill_factor = BULK_LOAD_FILL_FACTOR);
+
+    // Leaf format.
+    // leaf를 왼쪽부터 하나씩 format으로 다시 쓰고, 새 형식에서 들어가지
+    // 않는 leaf는 나눈 뒤 다시 쓴다. commit 하지 않은 update가 있는 leaf는
+    // 건너뛰고 그 수를 반환한다. 다시 부르면 남은 leaf를 바꾼다.
+    // Records leaf가 남아 있지 않게 되면 table의 형식도 바꾼다.
+    // format은 cell이 있는 형식이어야 한다. 실패하면 -1
+    int set_leaf_format(LeafFormat format);
+
  private:
-    bool find_leaf(keyType key, node_tuple& ret);
-    bool exist_key(keyType key);
-    bool insert_into_leaf(node_tuple& leaf, const record_t& rec);
-    bool insert_into_leaf_after_splitting(node_tuple& leaf,
-                                          const record_t& rec);
-    bool insert_into_new_root(node_tuple& left, keyType key, node_tuple& right);
-    bool insert_into_node(node_tuple& parent, int left_index, keyType key,
-                          node_tuple& right);
-    bool insert_into_node_after_splitting(node_tuple& parent, int left_index,
-                                          keyType key, node_tuple& right);
-    bool insert_into_parent(node_tuple& left, keyType key, node_tuple& right);
+    // record lock을 얻는다. 기다려야 하면 기다리고, abort 되었으면
+    // transaction을 abort 하고 false
+    bool lock_record(keyType key, LockMode mode, int transaction_id);
+    bool fill_scan_batch(scan_cursor& cursor);
+    bool find_leaf(keyType key, node_tuple& ret,
+                   LatchMode leaf_mode = LatchMode::NONE);
+    // key를 맡는 level의 node를 찾아 mode로 latch 한다. ancestors가 있으면
+    // 지나온 node를 level별로 적는다. tree가 비어 있거나 root가 level보다
+    // 낮으면 false
+    bool find_node(keyType key, uint32_t level, node_tuple& node,
+                   LatchMode mode, std::vector<nodeId_t>* ancestors = nullptr);
+    // pin 해 둔 node를 mode로 latch 하고, key가 high key 이상이면 right link를
+    // 따라간다. node가 빠졌거나 key가 low key보다 작으면 latch를 놓고 false
+    bool move_right(keyType key, node_tuple& node, LatchMode mode);
+    // root부터 X latch를 잡으며 key가 있는 leaf까지 내려간다.
+    // tree가 비어 있으면 nodes는 비어 있다.
+    bool lock_path(keyType key, latch_path& path);
+    // key 하나를 빼도 merge가 일어나지 않는 node인지
+    bool is_safe(const node_t& node) const;
+    int min_keys(const node_t& node) const;
+    // 다른 thread가 pin 하고 있어서 free 하지 못한 page를 다시 free 한다.
+    void collect_garbage();
+    // key가 들어갈 leaf를 pin 해서 leaf에 담고, leaf 안에서 key의 위치를
+    // 반환한다. key가 없으면 -1. tree가 비어 있으면 leaf는 invalid이다.
+    int find_slot(keyType key, node_tuple& leaf,
+                  LatchMode leaf_mode = LatchMode::NONE);
+    // find_slot이 X latch로 찾은 leaf에 insert / update 한다.
+    // leaf에 자리가 없으면 smo_latch를 잡고 다시 내려가서 split 한다.
+    bool insert_at(node_tuple& leaf, const record_t& record);
+    bool update_at(node_tuple& leaf, keyType key, ValueRef value,
+                   int transaction_id);
+    // compactable이면 다른 cell을 compact 해서라도 넣는다.
+    bool insert_into_leaf(node_tuple& leaf, const record_t& rec,
+                          bool compactable);
+    // leaf를 차지하는 byte가 비슷한 두 leaf로 나누고 부모에 넣는다.
+    // rec이 있으면 나누면서 함께 넣는다.
+    bool split_leaf(node_tuple& leaf, const record_t* rec,
+                    std::vector<nodeId_t>& ancestors);
+    // leaf에 undo 할 update가 없어서 log 없이 record를 옮겨도 되는지
+    bool can_reorganize(const node_t& leaf) const;
+    // rec이 leaf에 들어가는지. compact 해야 들어가면 can_reorganize일 때만
+    // true이고 compactable을 true로 한다.
+    bool leaf_fits(const node_t& leaf, const record_t& rec,
+                   bool& compactable) const;
+    // update로 value가 커졌는데 leaf에 자리가 없을 때, key가 있는 leaf를
+    // 나눈다.
+    bool make_room(keyType key);
+    // value의 앞 prefix_capacity 바이트까지는 cell에 담고 나머지를 head부터
+    // 이어지는 overflow page chain에 쓴다. head가 없으면 새로 만든다.
+    // cell은 chain을 가리키는 leaf cell이 된다.
+    bool write_chain(pagenum_t head, ValueRef value, int prefix_capacity,
+                     record_t& cell, int transaction_id, bool logged = true);
+    // page의 offset부터 data를 쓴다. 바뀐 부분만 update log를 남긴다.
+    bool write_page(node_tuple& page, int offset, const void* data,
+                    int length, int transaction_id, bool logged);
+    // cell이 담은 value의 앞 capacity 바이트까지 buffer에 읽는다.
+    bool read_value(const record_t& cell, uint8_t* buffer, int capacity,
+                    int& length);
+    // rec.overflow의 value를 앞 max_value_length 바이트까지 rec으로 읽는다.
+    bool read_overflow(record_t& rec);
+    bool free_chain(pagenum_t head);
+    // target에 바꾼 범위마다 update log를 남기고 pageLsn을 맞춘다.
+    bool log_changes(node_tuple& target, const page_changes& changes,
+                     int count, int transaction_id);
+    // target의 entry를 모두 neighbor로 옮길 수 있는지. internal node는
+    // 부모의 k_prime도 함께 내려온다.
+    bool can_coalesce(const node_t& target, const node_t& neighbor,
+                      keyType k_prime) const;
+    bool insert_into_new_root(nodeId_t left_id, keyType key, nodeId_t right_id,
+                              uint32_t level);
+    bool insert_into_node_after_splitting(node_tuple& parent, keyType key,
+                                          nodeId_t right_id,
+                                          std::vector<nodeId_t>& ancestors);
+    // left를 split 해서 생긴 right를 부모에 넣는다. left와 right의 latch는
+    // 여기서 놓는다.
+    bool insert_into_parent(node_tuple& left, keyType key, node_tuple& right,
+                            std::vector<nodeId_t>& ancestors);
+    // level에서 key를 맡는 node에 (key, right_id)를 넣는다. 그 level에
+    // root인 left_id 밖에 없으면 새 root를 만든다.
+    bool insert_into_level(uint32_t level, nodeId_t left_id, keyType key,
+                           nodeId_t right_id, std::vector<nodeId_t>& ancestors);
 
     bool delete_entry(node_tuple& target, keyType key);
     bool remove_entry_from_node(node_tuple& target, keyType key);
     bool adjust_root(node_tuple& root);
     bool coalesce_nodes(node_tuple& target, node_tuple& neighbor,
-                        node_tuple& parent, int k_prime);
+                        node_tuple& parent, keyType k_prime);
     bool redistribute_nodes(node_tuple& target, node_tuple& neighbor,
-                            node_tuple& parent, int k_prime, int k_prime_index,
-                            int neighbor_index);
+                            node_tuple& parent, keyType k_prime,
+                            int k_prime_index, int neighbor_index);
     bool update_parent_with_commit(nodeId_t target_id, nodeId_t parent_id);
-    bool load_node(node_tuple& target);
-    bool commit_node(nodeId_t page, const node_t& n);
-    bool commit_node(const node_tuple& target);
+    bool load_node(node_tuple& target, LatchMode mode = LatchMode::NONE);
+    bool commit_node(node_tuple& target);
     bool free_node(node_tuple& target);
-    nodeId_t create_node();
+    bool create_node(node_tuple& target);
     bool is_valid(nodeId_t node_id) const;
 
-    constexpr int cut(int length)
+    constexpr int cut(int length) const
     {
         if (length % 2)
         {
@@ -102,7 +292,18 @@ class BPTree
     int get_left_index(const node_t& parent, nodeId_t left) const;
     bool start_new_tree(const record_t& rec);
     manager_t manager;
-    int leaf_order;
+    // split은 S, merge 할 수 있는 delete는 X로 잡는다.
+    std::shared_mutex smo_latch;
+    std::shared_mutex root_latch;
+    // free_node에서 바로 free 하지 못한 page
+    std::mutex garbage_latch;
+    std::vector<nodeId_t> garbage;
+    // 새로 만드는 leaf의 형식. split으로 생기는 leaf는 나눈 leaf를 따른다.
+    // set_leaf_format이 다른 thread가 tree를 쓰는 동안 바꾼다.
+    std::atomic<LeafFormat> leaf_format;
+    // leaf_format의 leaf에 들어가는 record 수 + 1. cell이 있는 형식은
+    // LEAF_ORDER로 본다.
+    std::atomic<int> leaf_order;
     int table_id;
     int internal_order;
     bool verbose_output;
@@ -4,7 +4,9 @@
 #include <unistd.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
@@ -12,14 +14,48 @@
 #include <shared_mutex>
 #include <stack>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "file_manager.hpp"
 #include "frame.hpp"
 #include "logger.hpp"
+#include "page_guard.hpp"
+#include "page_table.hpp"
 
-struct node_tuple;
+// buffer frame eviction policy. init_db 할 때 고른다.
+enum class BufferPolicy
+{
+    LRU = 0,
+    CLOCK = 1,
+    LRU_K = 2,
+    TWO_Q = 3
+};
+
+// frame의 next / prev로 연결되는 doubly linked list.
+// lru가 가장 오래된 frame, mru가 가장 최근에 들어온 frame이다.
+struct FrameList
+{
+    int mru = INVALID_BUFFER_INDEX;
+    int lru = INVALID_BUFFER_INDEX;
+    std::size_t size = 0;
+};
+
+// background page cleaner 설정
+struct PageCleanerConfig
+{
+    bool enabled = true;
+    // dirty frame이 buffer의 이 비율(%)을 넘으면 eviction 후보가 아닌
+    // frame도 write 한다.
+    double dirty_target_pct = 10.0;
+    // eviction 후보(LRU tail 쪽)에서부터 미리 write 해 둘 frame 수
+    std::size_t lru_scan_depth = 64;
+    // 초당 write 할 최대 page 수
+    std::size_t max_pages_per_sec = 4000;
+    // cleaner가 깨어나는 주기 (ms)
+    int interval_ms = 10;
+};
 
 class BufferManager
 {
@@ -28,23 +64,31 @@ class BufferManager
     ~BufferManager();
 
     // node manager interface
-    bool open(const std::string& name);
-    // bool commit(pagenum_t pagenum, std::function<void(page_t&)> func, bool
-    // auto_release = true); int load(pagenum_t pagenum,
-    // std::function<void(const page_t&)> func, bool auto_release = true);
-    bool commit(pagenum_t pagenum, const page_t& page);
-    int load(pagenum_t pagenum, page_t& page);
+    // 파일을 새로 만들 때만 format과 leaf_format을 쓴다.
+    bool open(const std::string& name, FileFormat format = FileFormat::RAW,
+              LeafFormat leaf_format = DEFAULT_LEAF_FORMAT);
+    // pagenum에 해당하는 frame을 pin 해서 guard에 담는다. page는 복사하지
+    // 않으므로 guard가 살아있는 동안만 참조할 수 있다.
+    bool load(pagenum_t pagenum, page_guard& guard,
+              LatchMode mode = LatchMode::NONE);
     pagenum_t create();
-    void release(pagenum_t pagenum);
-    void retain(pagenum_t pagenum);
-    void release_shared(pagenum_t pagenum);
-    void retain_shared(pagenum_t pagenum);
     bool free(pagenum_t pagenum);
+    // 다른 thread가 pin 하고 있으면 free 하지 않고 false
+    bool try_free(pagenum_t pagenum);
     int get_manager_id() const;
     pagenum_t root() const;
     bool set_root(pagenum_t pagenum);
+    LeafFormat leaf_format() const;
+    bool set_leaf_format(LeafFormat format);
     bool close();
 
+    // bulk load interface
+    // 새로 잡은 page는 buffer에 없으므로 buffer를 거치지 않고 바로 쓴다.
+    pagenum_t extend(pagenum_t count);
+    bool commit_pages(pagenum_t pagenum, const page_t* pages,
+                      std::size_t count);
+    bool sync();
+
  private:
     FileManager* fileManager;
     int manager_id = -1;
@@ -58,72 +102,151 @@ class BufferController
         static BufferController bufferController;
         return bufferController;
     }
-    int openFileManager(const std::string& name);
+    int openFileManager(const std::string& name,
+                        FileFormat format = FileFormat::RAW);
     FileManager& getFileManager(int file_id);
     bool fileManagerExist(int file_id);
 
-    // bool get(int file_id, pagenum_t pagenum, std::function<void(const
-    // page_t&)> func, bool auto_release = true); bool put(int file_id,
-    // pagenum_t pagenum, std::function<void(page_t&)> func, bool auto_release =
-    // true);]
     frame_t& at(int idx);
-    int get(int file_id, pagenum_t pagenum, page_t& frame);
-    bool put(int file_id, pagenum_t pagenum, const page_t& frame);
-    int create(int file_id);
+    // page_guard interface
+    // frame을 찾거나 load 한 뒤 pin 하고, frame index를 반환한다.
+    int pin(int file_id, pagenum_t pagenum);
+    void unpin(int frame_index);
+    pagenum_t create(int file_id);
     bool free(int file_id, pagenum_t pagenum);
-    void release_frame(int file_id, pagenum_t pagenum);
-    void retain_frame(int file_id, pagenum_t pagenum);
-    void release_frame_shared(int file_id, pagenum_t pagenum);
-    void retain_frame_shared(int file_id, pagenum_t pagenum);
+    bool try_free(int file_id, pagenum_t pagenum);
     bool sync(bool lock = true);
+    // 지금까지 write 한 page를 file 별로 disk에 내린다. frame은 write 하지
+    // 않는다. (checkpoint가 log를 버리기 전에)
+    bool sync_files();
     bool fsync(int file_id, bool free_flag = false);
-    bool init_buffer(std::size_t buffer_size);
-    bool clear_buffer();
+    bool init_buffer(std::size_t buffer_size,
+                     BufferPolicy policy = BufferPolicy::LRU);
+    // write_frames가 false면 dirty frame을 write 하지 않고 버린다. (crash)
+    bool clear_buffer(bool write_frames = true);
     pagenum_t frame_id_to_pagenum(int frame_id);
     std::size_t size() const;
     std::size_t capacity() const;
+    BufferPolicy get_policy() const;
+
+    // buffer hit / miss 통계
+    std::size_t hits() const;
+    std::size_t misses() const;
+    void reset_stats();
+
+    // background page cleaner
+    // init_buffer에서 시작되고, clear_buffer에서 멈춘다.
+    void set_page_cleaner_config(const PageCleanerConfig& config);
+    PageCleanerConfig get_page_cleaner_config() const;
+    // cleaner가 write 한 page 수
+    std::size_t cleaned_pages() const;
+    std::size_t dirty_frames() const;
 
     friend class BufferCircularLinearTraversalPolicy;
     friend class BufferLRUTraversalPolicy;
+    friend class BufferClockTraversalPolicy;
     friend void TEST_BUFFER();
-    friend class node_tuple;
-
-    std::mutex mtx;
 
  private:
+    // buffer hit은 page_table의 partition latch만 잡는다.
+    // miss(frame 할당, eviction, load)와 free, sync는 alloc_latch로
+    // 직렬화하고, eviction policy의 list / queue는 policy_latch로 보호한다.
+    // alloc_latch를 먼저 잡고, policy_latch와 partition latch는 동시에 잡지
+    // 않는다.
+    std::mutex alloc_latch;
+    std::mutex policy_latch;
     std::unique_ptr<std::vector<frame_t>> buffer;
     std::unordered_map<int, std::unique_ptr<FileManager>> fileManagers;
-    std::unordered_map<int, std::unordered_map<pagenum_t, int>> index_table;
+    PageTable page_table;
     std::map<std::string, int> nameFileManagerMap;
     std::atomic<std::size_t> num_buffer;
     std::size_t buffer_size;
-    int mru;
-    int lru;
     bool valid_buffer_controller;
     std::unique_ptr<std::stack<int>> free_indexes;
-    BufferController() : mru(INVALID_BUFFER_INDEX), lru(INVALID_BUFFER_INDEX)
+
+    BufferPolicy policy;
+    std::atomic<std::size_t> hit_count;
+    std::atomic<std::size_t> miss_count;
+    // LRU의 list, 2Q에서는 Am queue
+    FrameList lru_list;
+    // 2Q의 A1in queue (FIFO)
+    FrameList a1in_list;
+    // 2Q의 A1out queue. A1in에서 쫓겨난 page의 id만 기억한다.
+    std::deque<std::pair<uint64_t, uint64_t>> a1out_queue;
+    std::unordered_map<uint64_t, uint64_t> a1out_table;
+    uint64_t a1out_seq;
+    // CLOCK의 hand
+    int clock_hand;
+    // LRU-K의 참조 시각
+    std::atomic<uint64_t> access_clock;
+
+    // page cleaner
+    // cleaner_latch는 cleaner가 frame 하나를 write 하는 동안 잡는다.
+    // frame_free는 이 latch를 잡아서 cleaner가 잠시 pin 한 frame 때문에
+    // 실패하지 않도록 한다. alloc_latch를 먼저 잡는다.
+    std::mutex cleaner_latch;
+    std::thread cleaner_thread;
+    std::mutex cleaner_wakeup_latch;
+    std::condition_variable cleaner_wakeup;
+    bool cleaner_stop;
+    PageCleanerConfig cleaner_config;
+    std::atomic<std::size_t> cleaned_count;
+    int cleaner_cursor;
+
+    BufferController()
+        : policy(BufferPolicy::LRU),
+          hit_count(0),
+          miss_count(0),
+          a1out_seq(0),
+          clock_hand(0),
+          access_clock(0),
+          cleaner_stop(true),
+          cleaned_count(0),
+          cleaner_cursor(0)
     {
         // Do nothing
     }
     ~BufferController()
     {
+        stop_page_cleaner();
         // clear_buffer();
     }
 
     int find(int file_id, pagenum_t pagenum);
-    void memorize_index(int file_id, pagenum_t pagenum, int frame_index);
-    void forget_index(int file_id, pagenum_t pagenum);
+    void touch(int buffer_index);
     int frame_alloc();
+    bool frame_evict(int buffer_index);
     bool frame_free(int buffer_index, bool push_free_indexes_flag = true);
-    bool update_recently_used(int buffer_index, frame_t& frame, bool unlink);
-    bool unlink_frame(int buffer_index, frame_t& frame);
+    bool update_recently_used(FrameList& list, int buffer_index,
+                              frame_t& frame, bool unlink);
+    bool unlink_frame(FrameList& list, int buffer_index, frame_t& frame);
+
+    // eviction policy hook. policy_latch를 잡은 채로 호출한다.
+    // (policy_on_hit은 제외)
+    void policy_on_load(int buffer_index);
+    void policy_on_hit(int buffer_index);
+    void policy_on_evict(int buffer_index);
+    int select_victim();
+    int select_victim_lru_k();
+    int select_victim_2q();
+    int select_victim_from(FrameList& list);
+    // 곧 eviction 될 frame을 순서대로 최대 n개 담는다.
+    // policy_latch를 잡은 채로 호출한다.
+    void eviction_candidates(std::size_t n, std::vector<int>& out);
+
+    void start_page_cleaner();
+    void stop_page_cleaner();
+    void page_cleaner_loop();
+    // 한 주기 동안 dirty frame을 write 하고, write 한 page 수를 반환한다.
+    std::size_t clean_round();
+    bool clean_frame(int buffer_index);
 
     template<typename Policy>
     int select_victim()
     {
         for (auto it = Policy::begin(); it != Policy::end(); ++it)
         {
-            if (!it->is_use_now())
+            if (!it->is_use_now() && Policy::evictable(*it))
             {
                 return it.frame_index();
             }
@@ -171,7 +294,7 @@ class BufferLRUTraversalPolicy
             ptr = BufferController::instance().buffer->at(ptr).next;
             if (ptr == -1)
             {
-                ptr = BufferController::instance().lru;
+                ptr = BufferController::instance().lru_list.lru;
             }
         }
         void operator--() = delete;
@@ -188,7 +311,7 @@ class BufferLRUTraversalPolicy
     };
     static iterator begin()
     {
-        return iterator(BufferController::instance().lru);
+        return iterator(BufferController::instance().lru_list.lru);
     }
 
     static iterator end()
@@ -212,6 +335,79 @@ class BufferLRUTraversalPolicy
         // Traversal Policy
         return BufferController::instance().buffer->size();
     }
+
+    static bool evictable(frame_t&)
+    {
+        return true;
+    }
+};
+
+// CLOCK: hand를 돌리면서 참조 bit가 꺼진 frame을 고른다.
+// 참조 bit가 켜진 frame은 bit를 끄고 한 번 더 기회를 준다.
+class BufferClockTraversalPolicy
+{
+ public:
+    class iterator
+    {
+     public:
+        iterator(int ptr) : ptr(ptr)
+        {
+            // Do nothing
+        }
+
+        int frame_index() const
+        {
+            return ptr;
+        }
+
+        bool operator==(const iterator& rhs) const
+        {
+            return rhs.ptr == ptr;
+        }
+
+        bool operator!=(const iterator& rhs) const
+        {
+            return rhs.ptr != ptr;
+        }
+
+        frame_t* operator->()
+        {
+            return &BufferController::instance().buffer->at(ptr);
+        }
+
+        void operator++()
+        {
+            auto& bc = BufferController::instance();
+            ptr = (ptr + 1) % bc.capacity();
+            bc.clock_hand = ptr;
+        }
+        void operator--() = delete;
+        void operator++(int) = delete;
+        void operator--(int) = delete;
+
+        frame_t& operator*()
+        {
+            return BufferController::instance().buffer->at(ptr);
+        }
+
+     private:
+        int ptr;
+    };
+
+    static iterator begin()
+    {
+        return iterator(BufferController::instance().clock_hand);
+    }
+
+    static iterator end()
+    {
+        return iterator(BufferController::instance().capacity());
+    }
+
+    static bool evictable(frame_t& frame)
+    {
+        return !frame.referenced.exchange(false);
+    }
 };
 
 // TODO: unittest BufferCircularLinearTraversalPolicy
@@ -6,8 +6,20 @@
 int init_db(int buf_num);
 int init_db(int buf_num, int flag, int log_num, char* log_path,
             char* logmsg_path);
+// buffer_policy: 0 = LRU, 1 = CLOCK, 2 = LRU-K, 3 = 2Q
+int init_db(int buf_num, int flag, int log_num, char* log_path,
+            char* logmsg_path, int buffer_policy);
 
 int open_table(char* pathname);
+// 파일이 없으면 page를 압축해서 저장하는 형식으로 만든다.
+// 이미 있는 파일은 만들 때의 형식대로 열린다. (open_table도 마찬가지)
+int open_compressed_table(char* pathname);
+// 파일이 없으면 value를 value_width 바이트로 고정한 table로 만든다.
+// (8, 16, 32, 64, 120) value는 그보다 길 수 없고, 짧으면 뒤를 0으로 채워서
+// value_width 바이트로 읽힌다. 120은 NUL로 끝나는 value를 담는 Records leaf로,
+// value는 119바이트까지이고 NUL 앞까지 읽힌다.
+// 이미 있는 파일은 만들 때의 형식대로 열린다.
+int open_fixed_table(char* pathname, int value_width);
 
 int db_insert(int table_id, int64_t key, char* value);
 
@@ -17,6 +29,49 @@ int db_update(int table_id, int64_t key, char* values, int trx_id);
 
 int db_delete(int table_id, int64_t key);
 
+// value를 NUL로 끝나는 문자열이 아니라 length 바이트로 다룬다.
+// (0 <= length <= 16MB, value 안에 0이 있어도 된다)
+// 119바이트보다 긴 value는 overflow page에 두고, db_find / scan은 그 앞
+// 119바이트만 읽는다.
+int db_insert_n(int table_id, int64_t key, const char* value, int length);
+// ret_val에 value의 앞 119바이트까지 쓰고 length에 전체 길이를 적는다.
+// ret_val은 119바이트 이상
+int db_find_n(int table_id, int64_t key, char* ret_val, int* length,
+              int trx_id);
+// buffer에 value의 앞 capacity 바이트까지 쓰고 length에 전체 길이를 적는다.
+int db_find_value(int table_id, int64_t key, char* buffer, int capacity,
+                  int* length, int trx_id);
+int db_update_n(int table_id, int64_t key, const char* value, int length,
+                int trx_id);
+
+// key가 있으면 db_update, 없으면 db_insert 처럼 동작한다.
+// insert는 db_insert와 마찬가지로 transaction에 묶이지 않는다.
+int db_upsert(int table_id, int64_t key, char* value, int trx_id);
+
+// [lo, hi] 범위의 record를 key 순서대로 읽는다.
+// trx_id가 0이 아니면 읽는 record마다 S lock을 얻는다.
+int db_scan_open(int table_id, int64_t lo, int64_t hi, int trx_id);
+// 0: record를 읽음, 1: 끝, -1: abort (cursor는 닫힌다)
+int db_scan_next(int cursor_id, int64_t* key, char* ret_val);
+int db_scan_close(int cursor_id);
+// callback이 0이 아닌 값을 돌려주면 멈춘다. abort 되면 -1
+int db_scan(int table_id, int64_t lo, int64_t hi, int trx_id,
+            int (*callback)(int64_t key, char* value, void* arg), void* arg);
+// 빈 table에 key 순서로 정렬된 record num_records개를 한번에 넣는다.
+// next는 key와 value를 채우고 0을 돌려준다. node는 fill_percent% 만큼 채운다.
+int db_bulk_load(int table_id, int num_records,
+                 int (*next)(int64_t* key, char* value, void* arg), void* arg,
+                 int fill_percent);
+// table의 leaf 형식을 바꾼다. 1 = slotted, 2 = columnar (key 배열과 value
+// cell을 따로 둔다). 있는 leaf도 모두 새 형식으로 다시 쓴다.
+// commit 하지 않은 update가 있어서 바꾸지 못한 leaf가 있으면 그 수를
+// 돌려주고, 다시 부르면 남은 leaf를 바꾼다. 실패하면 -1
+int db_set_leaf_format(int table_id, int format);
+// db_find 앞에 자주 읽는 record의 value를 담는 cache를 둔다. 크기는
+// capacity_bytes 바이트이고 0이면 쓰지 않는다. (기본값) 부를 때마다 비운다.
+// update / delete / abort는 cache의 record를 지우고, trx_id가 있는 db_find는
+// cache를 보기 전에 S lock을 얻는다. 실패하면 -1
+int db_set_record_cache(int64_t capacity_bytes);
 int close_table(int table_id);
 
 int shutdown_db();
@@ -3,22 +3,58 @@
 
 #include <unistd.h>
 
+#include <atomic>
 #include <cstdio>
 #include <memory>
+#include <mutex>
 #include <string_view>
 #include <vector>
 
 #include "frame.hpp"
 #include "page.hpp"
+#include "page_guard.hpp"
 
 class BufferManager;
 
 constexpr auto FILE_HEADER_PAGENUM = 0;
+// 새로 만드는 파일의 leaf 형식
+constexpr auto DEFAULT_LEAF_FORMAT = LeafFormat::SLOTTED;
+
+// 압축 파일 형식
+// header page(page 0)는 offset 0에 그대로 둔다. 나머지 page는
+// COMPRESSED_GROUP_PAGES개씩 group으로 묶고, group마다 page map 한 page와
+// 그 뒤의 data 영역을 둔다. page는 압축해서 data 영역의 sector 몇 개에
+// 이어서 쓰고, page map이 그 위치를 가리킨다. data 영역은 page를 그대로
+// 쓸 때의 두 배만큼 잡아 두지만 쓰지 않는 곳은 구멍이라 disk를 차지하지
+// 않는다.
+// 옮겨가거나 줄어들어서 비는 sector는 다음 sync에서 page map이 disk에
+// 내려간 뒤에야 다시 쓰고, COMPRESSED_HOLE_SIZE 단위로 모두 비면 구멍을
+// 뚫는다. 그 전에 멈추면 disk의 page map은 예전 sector를 가리키고, 예전
+// sector에는 예전 page가 그대로 있다.
+constexpr int COMPRESSED_SECTOR_SIZE = 512;
+constexpr int COMPRESSED_HOLE_SIZE = 4096;
+
+struct PageMapEntry
+{
+    // group의 data 영역 안의 첫 sector와 sector 수. sector 수가 0이면 쓴 적
+    // 없는 page이고 0으로 읽는다.
+    uint32_t sector;
+    uint16_t sectors;
+    uint16_t reserved;
+};
 
+constexpr int COMPRESSED_GROUP_PAGES = PAGESIZE / sizeof(PageMapEntry);
+
+// header page는 buffer의 frame을 그대로 참조한다.
+// 수정한 뒤에는 set_file_header로 dirty 표시를 해야 한다.
 struct header_frame
 {
-    page_t page;
-    int buffer_index = -1;
+    page_guard guard;
+
+    page_t& page()
+    {
+        return guard.frame();
+    }
 };
 
 class FileManager
@@ -28,7 +64,8 @@ class FileManager
     ~FileManager();
 
     // node manager interface
-    bool open(const std::string& name);
+    // 파일이 없으면 format으로 만든다. 있는 파일은 header의 형식대로 연다.
+    bool open(const std::string& name, FileFormat format = FileFormat::RAW);
     bool commit(pagenum_t pagenum, const page_t& page);
     bool load(pagenum_t pagenum, page_t& page);
     pagenum_t create();
@@ -36,14 +73,57 @@ class FileManager
     int get_manager_id() const;
     pagenum_t root() const;
     bool set_root(pagenum_t pagenum);
+    // 새로 만드는 leaf의 형식
+    LeafFormat leaf_format() const;
+    bool set_leaf_format(LeafFormat format);
     void set_buffer_manager(BufferManager* bufferManager);
 
-    bool init_file_if_created();
+    // bulk load interface
+    // 파일 끝에 count개의 page 자리를 잡고 첫 pagenum을 반환한다.
+    // free list는 쓰지 않으므로 잡은 page는 pagenum이 연속이다.
+    pagenum_t extend(pagenum_t count);
+    // pagenum부터 연속된 count개의 page를 write 한 번으로 쓴다.
+    // buffer를 거치지 않으므로 buffer에 올라온 적 없는 page에만 쓴다.
+    bool commit_pages(pagenum_t pagenum, const page_t* pages,
+                      std::size_t count);
+
+    // 새로 만든 파일이면 header를 쓴다. 새로 만드는 leaf는 leaf_format이다.
+    bool init_file_if_created(LeafFormat leaf_format = DEFAULT_LEAF_FORMAT);
+    FileFormat file_format() const;
+
+    // durability barrier. 지금까지 write 한 page를 fdatasync로 disk에
+    // 내린다. write는 OS page cache에만 쓰므로, page가 disk에 있어야 하는
+    // 시점(sync, close_table, recovery 후 log truncate 전)에 호출한다.
+    bool sync();
 
  private:
+    // 압축 파일의 page map group
+    struct page_group
+    {
+        std::vector<PageMapEntry> map;
+        // sector마다 SECTOR_FREE / SECTOR_USED / SECTOR_PENDING
+        std::vector<uint8_t> sectors;
+        // 마지막 sync 이후 map이 바뀌었는지
+        bool dirty = false;
+    };
+    // 다음 sync에서 돌려받을 sector
+    struct pending_run
+    {
+        std::size_t group;
+        uint32_t sector;
+        uint32_t sectors;
+    };
+
     int fd;
     BufferManager* bufferManager;
     bool file_created;
+    FileFormat format;
+    // groups와 pending, 그리고 sector 할당을 보호한다.
+    std::mutex map_latch;
+    std::vector<page_group> groups;
+    std::vector<pending_run> pending;
+    // 마지막 sync 이후에 write가 있었는지
+    std::atomic<bool> need_sync;
     // payload 포인터가 가리키는 공간부터 size만큼 읽어와 File의 seek 위치에
     // 쓰기
     bool write(long int seek, const void* payload, std::size_t size);
@@ -57,11 +137,28 @@ class FileManager
     // Page 읽어옴. 성공하면 true 반환
     bool pageRead(pagenum_t pagenum, page_t& page);
 
+    // 압축 파일 형식의 page write / read
+    bool compressedWrite(pagenum_t pagenum, const page_t& page);
+    bool compressedRead(pagenum_t pagenum, page_t& page);
+    // 파일에 있는 page map을 읽어서 sector 할당 상태를 만든다.
+    bool loadPageMap();
+    // group 안의 비어 있는 sector 연속 count개를 잡는다. 없으면 false
+    // map_latch를 잡고 부른다.
+    bool allocateSectors(std::size_t group, uint32_t count, uint32_t& sector);
+    // pending_run을 돌려받고 빈 곳에 구멍을 뚫는다. map_latch를 잡고 부른다.
+    void releaseSectors(const pending_run& run);
+    // dirty한 page map을 쓰고 disk에 내린 뒤, 그 전에 비운 sector를
+    // 돌려받는다.
+    bool syncPageMap();
+
     // pagenum에 해당하는 Page free. 성공하면 true 반환.
     bool pageFree(pagenum_t pagenum);
 
-    bool get_file_header(header_frame& header) const;
-    bool set_file_header(const header_frame& header);
+    // header를 고치는 쪽은 EXCLUSIVE latch를 잡는다.
+    // insert / delete가 동시에 page를 만들고 지울 수 있기 때문이다.
+    bool get_file_header(header_frame& header,
+                         LatchMode mode = LatchMode::EXCLUSIVE) const;
+    bool set_file_header(header_frame& header);
 
     // 새 페이지 추가
     pagenum_t pageCreate();
@@ -24,9 +24,18 @@ struct frame_t : public page_t
     std::atomic<int> pin;
     int next;
     int prev;
-    bool is_dirty;
+    std::atomic<bool> is_dirty;
     std::shared_mutex mtx;
 
+    // eviction policy가 사용하는 정보
+    // CLOCK: 마지막으로 hand가 지나간 뒤에 참조되었는지
+    std::atomic<bool> referenced;
+    // LRU-K: 가장 최근 참조 시각과 그 이전 참조 시각 (K = 2)
+    std::atomic<uint64_t> last_access;
+    std::atomic<uint64_t> prev_access;
+    // 2Q: frame이 들어있는 queue
+    int queue;
+
     void print_frame()
     {
         print_node();
@@ -42,7 +51,11 @@ struct frame_t : public page_t
         rhs.pin = pin.load();
         rhs.next = next;
         rhs.prev = prev;
-        rhs.is_dirty = is_dirty;
+        rhs.is_dirty = is_dirty.load();
+        rhs.referenced = referenced.load();
+        rhs.last_access = last_access.load();
+        rhs.prev_access = prev_access.load();
+        rhs.queue = queue;
         rhs.change_page(*this);
     }
 
@@ -76,6 +89,10 @@ struct frame_t : public page_t
         next = INVALID_BUFFER_INDEX;
         prev = INVALID_BUFFER_INDEX;
         is_dirty = false;
+        referenced = false;
+        last_access = 0;
+        prev_access = 0;
+        queue = -1;
     }
 };
 
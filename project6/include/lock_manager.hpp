@@ -1,14 +1,18 @@
 #ifndef __LOCK_MANAGER_HPP__
 #define __LOCK_MANAGER_HPP__
 
+#include <array>
 #include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <list>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 enum class LockMode
 {
@@ -39,6 +43,16 @@ struct LockHash
 
     bool operator<(const LockHash& rhs) const;
     bool operator==(const LockHash& rhs) const;
+
+    uint64_t hash() const;
+
+    struct Hasher
+    {
+        std::size_t operator()(const LockHash& lock_hash) const
+        {
+            return lock_hash.hash();
+        }
+    };
 };
 
 struct lock_t
@@ -51,19 +65,36 @@ struct lock_t
 
     lock_t(LockHash hash, LockMode lockMode, int ownerTransactionID);
 
-    bool wait() const;
+    // lock이 획득될 때까지 기다린다. 잠깐 spin 해보고, 그래도 안되면
+    // signal이 올 때까지 condition variable에서 잠든다.
+    void wait();
+    // 이 lock을 기다리는 thread(owner) 하나만 깨운다.
     void signal();
+
+ private:
+    std::mutex wait_latch;
+    std::condition_variable granted;
+
+    // 최근 spin으로 lock을 얻었으면 늘리고, 결국 잠들었으면 줄인다.
+    static std::atomic<int> spin_limit;
 };
 
 struct LockList
 {
     std::list<std::unique_ptr<lock_t>> locks;
+    // list에 EXCLUSIVE lock(획득 / 대기 모두)이 하나라도 있으면 EXCLUSIVE
     LockMode mode = LockMode::EMPTY;
     int wait_count;
     int acquire_count;
+    // list에 있는 EXCLUSIVE lock 수. mode를 list를 훑지 않고 정한다.
+    int exclusive_count;
     LockList();
     LockList(const LockList& rhs);
 
+    void push_front(std::unique_ptr<lock_t> lock);
+    void push_back(std::unique_ptr<lock_t> lock);
+    void erase(std::list<std::unique_ptr<lock_t>>::iterator it);
+
     void print() const
     {
         std::cout << "acquire: " << acquire_count << ", wait: " << wait_count
@@ -90,6 +121,32 @@ struct LockList
     }
 };
 
+// deadlock을 다루는 방법
+// - DETECT: lock을 기다릴 때마다 lock table 전체로 wait-for graph를 만든다.
+// - DETECT_INCREMENTAL: wait-for graph를 유지하면서, 새로 생긴 edge에서
+//   출발하는 cycle만 찾는다.
+// - DETECT_BACKGROUND: lock을 기다릴 때는 검사하지 않고, detector thread가
+//   주기적으로 cycle을 찾아 가장 늦게 시작한 transaction을 abort 시킨다.
+// - WAIT_DIE: 자기보다 먼저 시작한 transaction을 기다려야 하면 abort 한다.
+// - WOUND_WAIT: 자기보다 늦게 시작한 transaction을 abort 시키고 기다린다.
+// transaction id가 작을수록 먼저 시작한 transaction이다.
+enum class DeadlockPolicy
+{
+    DETECT = 0,
+    DETECT_INCREMENTAL = 1,
+    DETECT_BACKGROUND = 2,
+    WAIT_DIE = 3,
+    WOUND_WAIT = 4
+};
+std::ostream& operator<<(std::ostream& os, const DeadlockPolicy& dt);
+
+struct DeadlockConfig
+{
+    DeadlockPolicy policy = DeadlockPolicy::DETECT_INCREMENTAL;
+    // DETECT_BACKGROUND의 detector가 깨어나는 주기 (ms)
+    int detect_interval_ms = 10;
+};
+
 class LockManager
 {
  public:
@@ -99,16 +156,43 @@ class LockManager
         return lockManager;
     }
     lock_t* lock_acquire(int table_id, int64_t key, int trx_id, LockMode mode);
-    bool lock_release(lock_t* lock_obj, bool abort = false);
+    bool lock_release(lock_t* lock_obj);
     lock_t* lock_upgrade(int table_id, int64_t key, int trx_id, LockMode mode);
-    void lock_wait(lock_t* lock_obj);
-    const std::map<LockHash, LockList>& get_table() const;
+    // lock을 얻으면 true, 기다리는 동안 abort 대상이 되었으면 false
+    bool lock_wait(lock_t* lock_obj);
     bool deadlock_detection(int now_transaction_id);
     void reset();
-    std::mutex mtx;
+
+    // commit / abort가 끝난 transaction의 wait-for graph, wound 표시를
+    // 지운다.
+    void transaction_finished(int trx_id);
+
+    void set_deadlock_config(const DeadlockConfig& config);
+    DeadlockConfig get_deadlock_config() const;
+    // policy가 DETECT_BACKGROUND일 때만 detector thread를 띄운다.
+    void start_detector();
+    void stop_detector();
+
+    static constexpr int PARTITION_BITS = 6;
+    static constexpr int NUM_PARTITIONS = 1 << PARTITION_BITS;
 
  private:
-    std::map<LockHash, LockList> lock_table;
+    // record -> lock list 를 저장하는 hash table.
+    // partition 별로 latch를 따로 두어서 서로 다른 record의 lock을 얻고 놓는
+    // thread끼리는 경쟁하지 않는다. deadlock detection처럼 전체를 봐야 할
+    // 때는 모든 partition의 latch를 순서대로 잡는다.
+    struct Partition
+    {
+        std::mutex mtx;
+        std::unordered_map<LockHash, LockList, LockHash::Hasher> lock_table;
+    };
+
+    std::array<Partition, NUM_PARTITIONS> partitions;
+
+    Partition& partition_of(const LockHash& hash)
+    {
+        return partitions[hash.hash() >> (64 - PARTITION_BITS)];
+    }
 
     struct graph_node
     {
@@ -118,7 +202,61 @@ class LockManager
 
     void dfs(int now, std::unordered_map<int, graph_node>& graph, bool& stop);
 
+    using wait_for_graph = std::unordered_map<int, std::unordered_set<int>>;
+
+    // waiter가 list에서 기다려야 하는 (앞에 있는) transaction들
+    static std::unordered_set<int> blockers_of(const LockList& list,
+                                               const lock_t* waiter);
+
+    // WAIT_DIE: list에 자기보다 먼저 시작한 transaction이 있으면 기다리지
+    // 않고 abort 한다.
+    bool must_die(const LockList& list, int trx_id) const;
+
+    // 방금 lock을 기다리기 시작한 transaction 처리. deadlock이 생기거나
+    // 이미 abort 대상이면 false
+    bool on_wait(lock_t* lock_ptr, const std::unordered_set<int>& blockers);
+
+    // DETECT_INCREMENTAL
+    // trx_id에서 나가는 edge를 바꾸고, 그 edge를 따라 trx_id로 돌아오는지
+    // 본다.
+    bool add_wait_edges(int trx_id, const std::unordered_set<int>& blockers);
+    void erase_wait_edges(int trx_id);
+    // list의 lock을 놓은 뒤, 기다리던 waiters 중 lock을 얻은 것의 edge는
+    // 지우고 계속 기다리는 것의 edge는 남은 blocker로 바꾼다.
+    // list의 partition latch를 잡은 채로 부른다.
+    void refresh_wait_edges(const LockList& list,
+                            const std::vector<const lock_t*>& waiters);
+
+    // WOUND_WAIT, DETECT_BACKGROUND
+    // victim이 lock을 기다리는 중이면 그 lock을 ABORTED로 바꿔서 깨우고,
+    // 아니면 다음 lock_acquire에서 abort 되도록 표시만 해 둔다.
+    void wound(int victim);
+    bool is_wounded(int trx_id);
+
+    // DETECT_BACKGROUND
+    wait_for_graph build_wait_for_graph();
+    // cycle이 있으면 그 중 가장 늦게 시작한 transaction, 없으면 0
+    static int find_victim(const wait_for_graph& graph);
+    void detector_loop();
+
+    DeadlockConfig deadlock_config;
+
+    // lock order: partition.mtx -> graph_latch
+    std::mutex graph_latch;
+    wait_for_graph waits_for;
+
+    // lock order: waits_latch -> partition.mtx 로 같이 잡지 않는다.
+    std::mutex waits_latch;
+    std::unordered_set<int> wounded;
+    std::unordered_map<int, lock_t*> waiting_for;
+
+    std::thread detector_thread;
+    std::mutex detector_wakeup_latch;
+    std::condition_variable detector_wakeup;
+    bool detector_stop = false;
+
     LockManager() = default;
+    ~LockManager();
 };
 
 #endif /* __LOCK_MANAGER_HPP__*/
\ No newline at end of file
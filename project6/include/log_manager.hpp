@@ -5,17 +5,24 @@
 
 #include <array>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <fstream>
+#include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include "buffer_manager.hpp"
 #include "page.hpp"
 
-constexpr auto LOG_BUFFER_SIZE = 10000;
+// log buffer의 크기 (byte)
+constexpr std::size_t LOG_BUFFER_SIZE = 1 << 20;
 
 enum class LogType : int32_t
 {
@@ -24,6 +31,11 @@ enum class LogType : int32_t
     COMMIT = 2,
     ROLLBACK = 3,
     COMPENSATE = 4,
+    // fuzzy checkpoint. BEGIN과 END 사이에 TRX / DIRTY record가 이어진다.
+    CHECKPOINT_BEGIN = 5,
+    CHECKPOINT_TRX = 6,
+    CHECKPOINT_DIRTY = 7,
+    CHECKPOINT_END = 8,
     INVALID
 };
 
@@ -36,12 +48,20 @@ enum class RecoveryMode
     UNDO_CRASH = 2
 };
 
+constexpr auto INVALID_LSN = -1;
+
 struct LogHeader
 {
     uint32_t header = 0xffeeaaff;
+    // 이 lsn보다 앞의 log는 recovery에 필요 없다.
     int64_t start_lsn;
+    // 마지막으로 완료된 checkpoint의 CHECKPOINT_BEGIN lsn
+    int64_t checkpoint_lsn = INVALID_LSN;
 };
 
+// 첫 log record의 lsn. header 자리는 비워둔다.
+constexpr int64_t LOG_START_LSN = sizeof(LogHeader);
+
 struct CommonLogRecord
 {
     int64_t lsn;
@@ -82,14 +102,28 @@ struct CompensateLogRecord
     int32_t log_size;
 } __attribute__((packed));
 
+// checkpoint 할 때의 transaction table / dirty page table 항목 하나.
+// CHECKPOINT_TRX: transaction_id와 그 transaction의 마지막 lsn
+// CHECKPOINT_DIRTY: table_id, page_number와 그 page의 recLSN
+struct CheckpointLogRecord
+{
+    int64_t lsn;
+    int64_t prev_lsn;
+    int32_t transaction_id;
+    LogType type = LogType::INVALID;
+    int32_t table_id;
+    int64_t page_number;
+    int64_t target_lsn;
+    int32_t log_size;
+} __attribute__((packed));
+
 std::ostream& operator<<(std::ostream& os, const CommonLogRecord& dt);
 std::ostream& operator<<(std::ostream& os, const UpdateLogRecord& dt);
 std::ostream& operator<<(std::ostream& os, const CompensateLogRecord& dt);
+std::ostream& operator<<(std::ostream& os, const CheckpointLogRecord& dt);
 
-using LogRecord =
-    std::variant<CommonLogRecord, UpdateLogRecord, CompensateLogRecord>;
-
-constexpr auto INVALID_LSN = -1;
+using LogRecord = std::variant<CommonLogRecord, UpdateLogRecord,
+                               CompensateLogRecord, CheckpointLogRecord>;
 
 constexpr std::size_t get_log_record_size(const LogRecord& rec)
 {
@@ -101,6 +135,8 @@ constexpr std::size_t get_log_record_size(const LogRecord& rec)
             return sizeof(UpdateLogRecord);
         case 2:
             return sizeof(CompensateLogRecord);
+        case 3:
+            return sizeof(CheckpointLogRecord);
     }
     exit(-1);
     return 0;
@@ -116,6 +152,8 @@ constexpr int64_t get_log_record_lsn(const LogRecord& rec)
             return std::get<UpdateLogRecord>(rec).lsn;
         case 2:
             return std::get<CompensateLogRecord>(rec).lsn;
+        case 3:
+            return std::get<CheckpointLogRecord>(rec).lsn;
     }
     exit(-1);
     return 0;
@@ -131,35 +169,59 @@ constexpr int32_t get_log_record_trx(const LogRecord& rec)
             return std::get<UpdateLogRecord>(rec).transaction_id;
         case 2:
             return std::get<CompensateLogRecord>(rec).transaction_id;
+        case 3:
+            return std::get<CheckpointLogRecord>(rec).transaction_id;
     }
     exit(-1);
     return 0;
 }
 
+// log file에 쓰일 byte를 그대로 담는 ring buffer.
+// lsn은 log file의 offset이고, ring에서는 lsn % LOG_BUFFER_SIZE 위치에 있다.
+// append는 last_lsn을 fetch_add 해서 자리를 잡은 뒤 ring에 바로 쓰고,
+// 앞선 record가 모두 publish 되면 자신의 record를 publish 한다.
+// flush는 [flushed_lsn, published_lsn) 구간을 한 번에 write 한다.
 class LogBuffer
 {
  public:
     LogBuffer();
+    ~LogBuffer();
     void open(const std::string& log_path);
     // buffer에 LogRecord를 추가한 뒤, 추가된 rec의 lsn을 반환
     int64_t append(const LogRecord& rec);
     void flush();
     bool flush_prev_lsn(int64_t page_lsn);
+    // group commit. lsn 위치의 log가 disk에 기록될 때까지 기다린다.
+    // 기다리는 thread 중 하나(leader)가 그때까지 append 된 log를 모두
+    // flush 하고, 나머지는 leader의 fsync가 끝나면 함께 깨어난다.
+    bool flush_until(int64_t lsn);
+    // 이 값보다 작은 lsn의 log는 모두 disk에 기록되었다.
+    int64_t get_flushed_lsn() const;
     void reset();
-    void truncate();
-    std::atomic<int> last_lsn;
+    // 다음 log가 lsn 위치부터 쓰이도록 한다. append 중에는 호출하면 안 된다.
+    void set_last_lsn(int64_t lsn);
+    int64_t get_last_lsn() const;
+    // header를 갱신해서 start_lsn 앞의 log를 버린다. 버린 부분은 file에서
+    // 구멍을 뚫어(punch hole) 공간을 돌려준다. lsn(= offset)은 그대로다.
+    void truncate(int64_t start_lsn, int64_t checkpoint_lsn);
 
  private:
-    std::atomic<int> flushed_lsn;
+    // 다음 record가 들어갈 lsn
+    std::atomic<int64_t> last_lsn;
+    // 이 값보다 작은 lsn의 log는 모두 ring에 다 쓰였다.
+    std::atomic<int64_t> published_lsn;
+    // 이 값보다 작은 lsn의 log는 모두 disk에 기록되었다.
+    std::atomic<int64_t> flushed_lsn;
     std::mutex flush_latch;
-    std::array<std::mutex, LOG_BUFFER_SIZE> buffer_latch;
-    std::atomic<int> buffer_head;
-    std::atomic<int> buffer_tail;
-    std::array<LogRecord, LOG_BUFFER_SIZE> buffer;
-    std::mutex value_latch;
+    std::array<char, LOG_BUFFER_SIZE> ring;
     int fd;
 
-    void flush_without_value_latch_lock();
+    std::mutex group_latch;
+    std::condition_variable group_flushed;
+    bool group_flushing;
+
+    // ring의 lsn 위치부터 size만큼 복사한다. (ring 끝에서 넘어가면 앞으로)
+    void copy_to_ring(int64_t lsn, const void* src, std::size_t size);
 };
 
 class LogReader
@@ -167,15 +229,32 @@ class LogReader
  public:
     LogReader(const std::string& log_path, int64_t start_lsn);
     LogReader(const std::string& log_path);
+    LogReader(const LogReader&) = delete;
+    LogReader& operator=(const LogReader&) = delete;
+    ~LogReader();
     std::tuple<LogType, LogRecord> get(int64_t lsn) const;
     void print() const;
     std::tuple<LogType, LogRecord> next() const;
     std::tuple<LogType, LogRecord> prev() const;
     void set_lsn(int64_t lsn);
+    int64_t get_lsn() const;
+    // header에 기록된 마지막 checkpoint의 lsn. 없으면 INVALID_LSN
+    int64_t get_checkpoint_lsn() const;
 
  private:
     int fd;
     mutable int64_t now_lsn;
+    int64_t checkpoint_lsn;
+};
+
+// fuzzy checkpoint 설정
+struct CheckpointConfig
+{
+    bool enabled = true;
+    // checkpointer가 깨어나는 주기 (ms)
+    int interval_ms = 1000;
+    // 마지막 checkpoint 이후 log가 이만큼(byte) 쌓였을 때만 checkpoint 한다.
+    int64_t log_bytes = 4 * LOG_BUFFER_SIZE;
 };
 
 class LogManager
@@ -204,26 +283,80 @@ class LogManager
 
     bool flush();
 
+    bool flush_until(int64_t lsn);
+
+    int64_t get_flushed_lsn() const;
+
     bool rollback(int transaction_id);
 
-    void make_dirty(pagenum_t pagenum);
+    // 진행중인 transaction의 BEGIN lsn 중 가장 앞선 것. 없으면 INT64_MAX
+    // pageLsn이 이보다 앞선 page에는 undo 할 update가 없다.
+    int64_t oldest_active_lsn();
+
+    // dirty page table
+    // page를 log와 함께 수정할 때 recLSN을 기록하고, page가 write 되면
+    // written page table로 옮긴다. write는 fdatasync 전까지 OS page cache에만
+    // 있으므로, checkpoint가 data file을 sync 한 뒤에야 지운다.
+    // 둘 다 page latch를 잡은 채로 호출한다.
+    void make_dirty(int table_id, pagenum_t pagenum, int64_t lsn);
+    void make_clean(int table_id, pagenum_t pagenum);
+    // write 했지만 아직 sync 되지 않은 page 수
+    std::size_t unsynced_pages();
+
+    // fuzzy checkpoint
+    // transaction table과 dirty page table을 log에 남기고, recovery에
+    // 필요 없는 log 앞부분을 버린다. init_db 후에 checkpointer가 주기적으로
+    // 호출한다.
+    bool checkpoint();
+    void set_checkpoint_config(const CheckpointConfig& config);
+    CheckpointConfig get_checkpoint_config() const;
+    void start_checkpointer();
+    void stop_checkpointer();
 
     void reset();
 
+    ~LogManager();
+
  private:
     std::string log_path;
     std::string logmsg_path;
 
     LogBuffer buffer;
 
+    // log append와 transaction table / dirty page table 갱신은 shared로,
+    // checkpoint의 snapshot은 exclusive로 잡는다. snapshot에는
+    // CHECKPOINT_BEGIN 앞의 모든 log가 반영되어 있다.
+    std::shared_mutex checkpoint_latch;
+
     std::mutex trx_table_latch;
-    std::unordered_map<int, int> trx_table;
+    // transaction id -> 마지막 lsn
+    std::unordered_map<int, int64_t> trx_table;
+    // transaction id -> BEGIN lsn. 진행중인 transaction만 있다.
+    std::unordered_map<int, int64_t> trx_begin_table;
 
     std::mutex dirty_table_latch;
-    std::unordered_map<int, int> dirty_table;
+    // (table id, page number) -> recLSN
+    std::map<std::pair<int, pagenum_t>, int64_t> dirty_table;
+    // write 했지만 아직 sync 되지 않은 page. (table id, page number) -> recLSN
+    std::map<std::pair<int, pagenum_t>, int64_t> written_table;
+
+    // checkpointer
+    std::mutex checkpoint_run_latch;
+    std::thread checkpointer_thread;
+    std::mutex checkpointer_wakeup_latch;
+    std::condition_variable checkpointer_wakeup;
+    bool checkpointer_stop = true;
+    CheckpointConfig checkpoint_config;
+    std::atomic<int64_t> last_checkpoint_lsn { INVALID_LSN };
 
     LogManager() = default;
 
+    // checkpoint_latch를 shared로 잡은 채로 호출한다.
+    int64_t append_log(int transaction_id, const LogRecord& rec);
+    // transaction의 마지막 lsn. 없으면 INVALID_LSN
+    int64_t get_trx_last_lsn(int transaction_id);
+    void checkpointer_loop();
+
     class Message
     {
      public:
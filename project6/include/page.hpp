@@ -2,23 +2,106 @@
 #define __PAGE_HPP__
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "page_search.hpp"
 
 class FileManager;
 
+// page 크기. database 파일마다 header에 적어 두고, 다른 크기로 만든 파일은
+// 열지 않는다. 빌드할 때 정한다. (make PAGESIZE=8192, make clean 필요)
+#ifndef PAGESIZE
 #define PAGESIZE 4096
+#endif
+static_assert(PAGESIZE == 4096 || PAGESIZE == 8192 || PAGESIZE == 16384 ||
+                  PAGESIZE == 32768,
+              "PAGESIZE must be 4, 8, 16 or 32 KB");
 
 constexpr auto value_size = 120;
 using valType = std::array<uint8_t, 120>;
 using keyType = int64_t;
 using pagenum_t = uint64_t;
 
+// leaf에 들어가는 value의 최대 길이. slotted leaf의 cell(길이 1바이트 +
+// value)이 update log의 image(valType) 하나에 들어가야 한다.
+constexpr auto max_value_length = value_size - 1;
+// 이보다 길면 overflow page chain에 넣는다. (slotted leaf만)
+constexpr auto max_overflow_length = 16 << 20;
+
 std::ostream& operator<<(std::ostream& os, const valType& dt);
 
+// NUL로 끝나는 문자열로 채운 value의 길이 (최대 max_value_length)
+int value_length(const valType& value);
+
+// leaf page 형식. leaf마다 header에 적고, 새로 만드는 leaf의 형식은 파일
+// header에 적힌 table의 형식을 따른다.
+enum class LeafFormat : uint8_t
+{
+    // Record(key, 120바이트 value)의 배열. 형식을 적기 전에 만든 파일
+    RECORDS = 0,
+    // 앞에서부터 slot directory, 뒤에서부터 가변 길이 value의 cell
+    SLOTTED = 1,
+    // SLOTTED와 같은 cell을 쓰되, 앞에 key 배열과 CellRef 배열을 따로 둔다.
+    // key를 찾는 동안 key 배열만 읽는다.
+    COLUMNAR = 2,
+    // FixedRecord(key, 8 / 16 / 32 / 64바이트 value)의 배열. table을 만들 때
+    // 정하며, value는 항상 그 너비만큼 읽힌다. 120바이트는 RECORDS이다.
+    FIXED_8 = 3,
+    FIXED_16 = 4,
+    FIXED_32 = 5,
+    FIXED_64 = 6,
+};
+
+// 가변 길이 value와 overflow page chain을 담을 수 있는 형식인지
+inline bool leaf_has_cells(LeafFormat format)
+{
+    return format == LeafFormat::SLOTTED || format == LeafFormat::COLUMNAR;
+}
+
+// value 너비가 width인 고정 너비 형식. 없는 너비면 false
+bool fixed_leaf_format(int width, LeafFormat& format);
+// format의 leaf 안에 둘 수 있는 value의 최대 길이. cell이 있는 형식은 이보다
+// 긴 value를 overflow page chain에 둔다.
+int leaf_value_limit(LeafFormat format);
+
+// Records leaf 형식(RECORDS, FIXED_*)의 value 너비를 compile-time 상수
+// (std::integral_constant)로 넘겨서 f를 부른다.
+template<typename F>
+decltype(auto) with_value_width(LeafFormat format, F&& f)
+{
+    switch (format)
+    {
+        case LeafFormat::FIXED_8:
+            return f(std::integral_constant<int, 8> {});
+        case LeafFormat::FIXED_16:
+            return f(std::integral_constant<int, 16> {});
+        case LeafFormat::FIXED_32:
+            return f(std::integral_constant<int, 32> {});
+        case LeafFormat::FIXED_64:
+            return f(std::integral_constant<int, 64> {});
+        default:
+            return f(std::integral_constant<int, value_size> {});
+    }
+}
+
+// internal node 형식. node마다 header에 적는다.
+enum class InternalFormat : uint8_t
+{
+    // Internal(key, pagenum)의 배열. 형식을 적기 전에 만든 파일
+    WIDE = 0,
+    // key는 keyBase와의 차이를 keyShift 만큼 민 값을 keyWidth 바이트로,
+    // child는 childWidth 바이트로 줄여서 따로 모아 둔다.
+    PACKED = 1,
+};
+
 constexpr auto EMPTY_PAGE_NUMBER = 0;
 
 struct NodePageHeader
@@ -26,44 +109,190 @@ struct NodePageHeader
     pagenum_t parentPageNumber;
     uint32_t isLeaf;
     uint32_t numberOfKeys;
-    std::array<uint8_t, 8> reserved;
+    // leaf가 0이고 위로 갈수록 1씩 커진다.
+    uint32_t level;
+    // leaf의 형식 (LeafFormat)
+    uint8_t leafFormat;
+    // internal node의 형식 (InternalFormat)
+    uint8_t internalFormat;
+    // slotted leaf에서 cell이 시작하는 곳 (entry 영역 안의 offset).
+    // cell은 entry 영역 끝에서부터 앞으로 쌓인다.
+    uint16_t cellBegin;
     // TODO: 이거 그냥 0으로 초기화해도 되나?
     int64_t pageLsn;
-    std::array<uint8_t, 88> reserved2;
+    // B-link: node가 맡는 key 범위 [lowKey, highKey)와 같은 level의 오른쪽
+    // node. 오른쪽 node가 없으면 highKey는 무한대로 본다.
+    // leaf의 오른쪽 node는 onePageNumber(next_leaf)에 둔다.
+    keyType lowKey;
+    keyType highKey;
+    pagenum_t rightPageNumber;
+    // PACKED internal node의 key / child 너비
+    keyType keyBase;
+    uint8_t keyShift;
+    uint8_t keyWidth;
+    uint8_t childWidth;
+    std::array<uint8_t, 53> reserved2;
     pagenum_t onePageNumber;
 
     friend std::ostream& operator<<(std::ostream& os,
                                     const NodePageHeader& nph);
 };
 
+// data 파일 형식. header page에 적고 파일을 만들 때 정한다.
+enum class FileFormat : uint32_t
+{
+    // page n을 PAGESIZE * n에 그대로 쓴다.
+    RAW = 0,
+    // header page만 그대로 두고, 나머지 page는 압축해서 page map이 가리키는
+    // 곳에 쓴다. (file_manager.cc)
+    COMPRESSED = 1,
+};
+
 struct HeaderPageHeader
 {
     pagenum_t freePageNumber;
     pagenum_t rootPageNumber;
     pagenum_t numberOfPages;
-    std::array<uint8_t, sizeof(struct NodePageHeader) - 24> reserved;
+    // 0이면 page 크기를 적기 전에 만든 파일로, 4096이다.
+    uint64_t pageSize;
+    // 새로 만드는 leaf의 형식 (LeafFormat)
+    uint32_t leafFormat;
+    // 파일 형식 (FileFormat)
+    uint32_t fileFormat;
+    std::array<uint8_t, sizeof(struct NodePageHeader) - 40> reserved;
 
     friend std::ostream& operator<<(std::ostream& os,
                                     const HeaderPageHeader& hph);
 };
 
+// 큰 value를 담는 overflow page chain의 page.
+// 같은 page가 node로 읽혀도 leaf가 아니고 leftmost가 없는 빈 node로 보이도록
+// isLeaf 자리는 0으로 둔다. pageLsn은 node와 같은 자리에 있다.
+struct OverflowPageHeader
+{
+    // chain의 다음 page. 없으면 EMPTY_PAGE_NUMBER
+    pagenum_t nextPageNumber;
+    uint32_t isLeaf;
+    // 이 page의 entry 영역에 담긴 byte 수
+    uint32_t length;
+    // chain의 첫 page에만 적는 value 전체 길이 (leaf에 둔 prefix 포함)
+    uint32_t totalLength;
+    uint32_t reserved;
+    int64_t pageLsn;
+    std::array<uint8_t, sizeof(struct NodePageHeader) - 32> reserved2;
+};
+static_assert(offsetof(OverflowPageHeader, isLeaf) ==
+                  offsetof(NodePageHeader, isLeaf) &&
+              offsetof(OverflowPageHeader, pageLsn) ==
+                  offsetof(NodePageHeader, pageLsn));
+
 struct FreePageHeader
 {
     pagenum_t nextFreePageNumber;
     std::array<uint8_t, sizeof(struct NodePageHeader) - 8> reserved;
 };
 
-struct Record
+// Records leaf의 entry. value는 Width 바이트이고 남는 곳은 0이다.
+template<int Width>
+struct FixedRecord
 {
     keyType key;
-    valType value;
+    std::array<uint8_t, Width> value;
     void init(keyType key, const valType& val)
     {
         this->key = key;
-        memcpy(&value, &val, sizeof(valType));
+        memcpy(&value, &val, Width);
+    }
+};
+using Record = FixedRecord<value_size>;
+
+// leaf 형식과 상관없이 tree 밖으로 주고받는 record.
+// value의 앞 length 바이트가 값이고 나머지는 0이다.
+// leaf에서 읽은 value가 overflow page chain에 있으면 overflow에 그 첫
+// page를 담고, value와 length는 leaf에 둔 prefix이다.
+struct KeyValue
+{
+    keyType key;
+    valType value;
+    uint8_t length;
+    pagenum_t overflow = EMPTY_PAGE_NUMBER;
+    void init(keyType key, const valType& val, int length)
+    {
+        this->key = key;
+        this->length = length;
+        value.fill(0);
+        memcpy(&value, &val, length);
+        overflow = EMPTY_PAGE_NUMBER;
     }
 };
 
+// cell의 위치(entry 영역 안의 offset)와 크기. cell은 길이 1바이트와
+// value로 되어 있고, 크기는 CELL_ALIGN의 배수로 잡아서 value가 조금
+// 길어지는 update는 cell 안에서 끝난다.
+struct CellRef
+{
+    uint16_t offset;
+    uint16_t capacity;
+};
+
+// leaf_update가 cell에 들어가지 않는 value를 어디에 쓰는지
+enum class CellMove
+{
+    // 옮기지 않는다. cell에 들어가지 않으면 -1
+    NONE,
+    // cellBegin 앞의 빈 곳에 새 cell을 잡는다.
+    FREE_GAP,
+    // 빈 곳이 모자라면 compact 한 뒤에 잡는다.
+    COMPACT,
+};
+
+// slotted leaf의 slot. key 순서로 entry 영역 앞에서부터 놓인다.
+// search kernel이 key를 읽을 수 있도록 key가 맨 앞에 있다.
+struct Slot
+{
+    keyType key;
+    CellRef cell;
+    uint32_t reserved;
+};
+
+// columnar leaf의 key 배열 원소. entry 영역 앞에 key n개가 붙어 있고, 그
+// 바로 뒤에 같은 순서로 CellRef n개가 있다.
+struct LeafKey
+{
+    keyType key;
+};
+
+// valType에 들어가지 않을 수도 있는 value를 넘길 때. max_value_length보다 길면
+// overflow page chain에 넣는다.
+struct ValueRef
+{
+    const uint8_t* data;
+    int length;
+};
+
+constexpr auto CELL_ALIGN = 8;
+// 길이 대신 이 값으로 시작하는 cell은 value가 overflow page chain에 있고,
+// 뒤의 7바이트가 chain의 첫 page 번호이다. 가장 작은 cell에도 들어간다.
+constexpr uint8_t OVERFLOW_CELL = 0xFF;
+constexpr auto OVERFLOW_CELL_SIZE = 8;
+// OVERFLOW_CELL 뒤에 prefix 길이 1바이트와 value의 prefix가 더 있는 cell.
+// chain에는 prefix 뒤의 byte만 담는다.
+constexpr uint8_t PREFIXED_OVERFLOW_CELL = 0xFE;
+// 큰 value를 넣을 때 leaf에 두는 prefix의 길이. cell이 32바이트가 된다.
+constexpr auto OVERFLOW_PREFIX = 32 - OVERFLOW_CELL_SIZE - 1;
+
+// update가 page에서 바꾼 byte 범위 하나. update log 하나가 된다.
+struct page_change
+{
+    int offset;
+    int length;
+    valType before;
+    valType after;
+};
+// update 하나가 바꾸는 범위의 최대 개수 (cell, slot, header)
+constexpr auto MAX_PAGE_CHANGES = 3;
+using page_changes = std::array<page_change, MAX_PAGE_CHANGES>;
+
 struct Internal
 {
     keyType key;
@@ -75,30 +304,54 @@ struct Internal
     }
 };
 
-struct Records
+// page 크기에 따른 node 배치. header 뒤를 entry로 채우고, tree의 order는
+// 여기서 나온다.
+template<std::size_t PageSize>
+struct node_layout
+{
+    static constexpr std::size_t entry_bytes = PageSize - sizeof(NodePageHeader);
+    template<int Width>
+    static constexpr int fixed_records =
+        entry_bytes / sizeof(FixedRecord<Width>);
+    static constexpr int records = fixed_records<value_size>;
+    static constexpr int internals = entry_bytes / sizeof(Internal);
+};
+using page_layout = node_layout<PAGESIZE>;
+
+template<int Width>
+struct FixedRecords
 {
-    std::array<Record, 31> records;
+    std::array<FixedRecord<Width>, page_layout::fixed_records<Width>> records;
     constexpr auto begin()
     {
         return std::begin(records);
     }
-    Record& operator[](int idx)
+    const FixedRecord<Width>* data() const
+    {
+        return records.data();
+    }
+    FixedRecord<Width>& operator[](int idx)
     {
-        return const_cast<Record&>(std::as_const(*this)[idx]);
+        return const_cast<FixedRecord<Width>&>(std::as_const(*this)[idx]);
     }
-    const Record& operator[](int idx) const
+    const FixedRecord<Width>& operator[](int idx) const
     {
         return records[idx];
     }
 };
+using Records = FixedRecords<value_size>;
 
 struct Internals
 {
-    std::array<Internal, 248> internals;
+    std::array<Internal, page_layout::internals> internals;
     constexpr auto begin()
     {
         return std::begin(internals);
     }
+    const Internal* data() const
+    {
+        return internals.data();
+    }
     Internal& operator[](int idx)
     {
         return const_cast<Internal&>(std::as_const(*this)[idx]);
@@ -110,6 +363,22 @@ struct Internals
     }
 };
 
+// entry 타입(FixedRecord, Internal)이 page에 놓이는 배열 타입
+template<typename T>
+struct entry_array;
+
+template<int Width>
+struct entry_array<FixedRecord<Width>>
+{
+    using type = FixedRecords<Width>;
+};
+
+template<>
+struct entry_array<Internal>
+{
+    using type = Internals;
+};
+
 template<typename It>
 struct range_t
 {
@@ -152,19 +421,30 @@ struct page_t
         HeaderPageHeader headerPageHeader;
         NodePageHeader nodePageHeader;
         FreePageHeader freePageHeader;
+        OverflowPageHeader overflowPageHeader;
     } header;
 
     union Entry
     {
         Records records;
         Internals internals;
+        // slotted leaf
+        std::array<uint8_t, page_layout::entry_bytes> bytes;
     } entry;
 
-    template<typename T>
-    const T& getEntry() const;
+    // entry 영역을 배열 S(Records, FixedRecords, Internals)로 본다.
+    template<typename S>
+    const S& getEntry() const
+    {
+        static_assert(sizeof(S) <= page_layout::entry_bytes);
+        return *reinterpret_cast<const S*>(entry.bytes.data());
+    }
 
-    template<typename T>
-    T& getEntry();
+    template<typename S>
+    S& getEntry()
+    {
+        return const_cast<S&>(std::as_const(*this).getEntry<S>());
+    }
 
     template<typename T>
     const T& getHeader() const;
@@ -187,6 +467,11 @@ struct page_t
         return header.freePageHeader;
     }
 
+    OverflowPageHeader& overflowPageHeader()
+    {
+        return header.overflowPageHeader;
+    }
+
     auto& records()
     {
         return entry.records;
@@ -212,6 +497,11 @@ struct page_t
         return header.freePageHeader;
     }
 
+    const OverflowPageHeader& overflowPageHeader() const
+    {
+        return header.overflowPageHeader;
+    }
+
     const auto& records() const
     {
         return entry.records;
@@ -225,10 +515,7 @@ struct page_t
     template<typename T>
     void push_back(const T& value)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
+        using S = typename entry_array<T>::type;
         getEntry<S>()[static_cast<int>(
             getHeader<NodePageHeader>().numberOfKeys++)] = value;
     }
@@ -236,33 +523,25 @@ struct page_t
     template<typename T, typename K, typename B>
     void emplace_back(const K& key, const B& v)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
-
-        if constexpr (std::is_same<Record, T>::value)
+        using S = typename entry_array<T>::type;
+        auto& entry = getEntry<S>()[static_cast<int>(
+            getHeader<NodePageHeader>().numberOfKeys++)];
+        entry.key = key;
+        if constexpr (std::is_same<Internal, T>::value)
         {
-            auto& entry = getEntry<Records>()[static_cast<int>(
-                getHeader<NodePageHeader>().numberOfKeys++)];
-            entry.key = key;
-            entry.value = v;
+            entry.node_id = v;
         }
         else
         {
-            auto& entry = getEntry<Internals>()[static_cast<int>(
-                getHeader<NodePageHeader>().numberOfKeys++)];
-            entry.key = key;
-            entry.node_id = v;
+            entry.value = v;
         }
     }
 
     template<typename T>
     void insert(const T& entry, int insertion_point)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
         auto& header = nodePageHeader();
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
+        using S = typename entry_array<T>::type;
 
         S& entries = getEntry<S>();
 
@@ -278,11 +557,8 @@ struct page_t
     template<typename T>
     void erase(int erase_point)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
         auto& header = nodePageHeader();
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
+        using S = typename entry_array<T>::type;
 
         S& entries = getEntry<S>();
 
@@ -298,15 +574,12 @@ struct page_t
     template<typename T>
     decltype(auto) range(std::size_t begin = 0, std::size_t end = 0)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
+        using S = typename entry_array<T>::type;
         if (end == 0)
         {
             end = getHeader<NodePageHeader>().numberOfKeys;
         }
 
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
         return range_t(std::next(std::begin(getEntry<S>()), begin),
                        std::next(std::begin(getEntry<S>()), end));
     }
@@ -314,14 +587,11 @@ struct page_t
     template<typename T, typename It>
     void range_copy(It it, int begin = 0, int end = -1)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
+        using S = typename entry_array<T>::type;
         if (end == -1)
         {
             end = getHeader<NodePageHeader>().numberOfKeys;
         }
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
         std::copy(std::next(std::begin(getEntry<S>()), begin),
                   std::next(std::begin(getEntry<S>()), end), it);
     }
@@ -329,21 +599,15 @@ struct page_t
     template<typename T, typename It>
     void range_assignment(It begin, It end)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
+        using S = typename entry_array<T>::type;
         std::copy(begin, end, std::begin(getEntry<S>()));
         getHeader<NodePageHeader>().numberOfKeys = std::distance(begin, end);
     }
 
-    template<typename T>
-    int satisfy_condition_first(std::function<bool(const T&)> condition) const
+    template<typename T, typename Pred>
+    int satisfy_condition_first(Pred condition) const
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
+        using S = typename entry_array<T>::type;
         int index {};
         auto n = static_cast<int>(getHeader<NodePageHeader>().numberOfKeys);
         auto& arr = getEntry<S>();
@@ -354,50 +618,72 @@ struct page_t
         return index;
     }
 
+    // key 이상인 첫 entry의 index
+    template<typename T>
+    int lower_bound(keyType key) const
+    {
+        using S = typename entry_array<T>::type;
+        return search_kernel<T>::lower_bound(
+            getEntry<S>().data(), number_of_keys(), key);
+    }
+
+    // key 초과인 첫 entry의 index
+    template<typename T>
+    int upper_bound(keyType key) const
+    {
+        using S = typename entry_array<T>::type;
+        return search_kernel<T>::upper_bound(
+            getEntry<S>().data(), number_of_keys(), key);
+    }
+
     template<typename T>
     int index_key(keyType key) const
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
-        int index {};
-        auto n = static_cast<int>(getHeader<NodePageHeader>().numberOfKeys);
-        auto& arr = getEntry<S>();
-        while (index < n && arr[index].key != key)
+        int index = lower_bound<T>(key);
+        if (index == number_of_keys() || get<T>(index).key != key)
         {
-            ++index;
+            return -1;
         }
-        return index == n ? -1 : index;
+        return index;
     }
 
     int key_grt(keyType key) const
+    {
+        return internal_upper_bound(key);
+    }
+
+    // node_id를 child로 가지는 entry의 index. child는 정렬되어 있지 않으므로
+    // 선형 탐색한다.
+    int index_child(pagenum_t node_id) const
     {
         int index {};
         auto n = number_of_keys();
-        auto& arr = internals();
-        while (index < n && arr[index].key <= key)
+        while (index < n && internal_child(index) != node_id)
         {
             ++index;
         }
         return index;
     }
 
+    template<typename T>
+    const T& get(std::size_t idx) const
+    {
+        using S = typename entry_array<T>::type;
+        return getEntry<S>()[idx];
+    }
+
     template<typename T>
     T& get(std::size_t idx)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
-        using S = typename std::conditional<std::is_same<Record, T>::value,
-                                            Records, Internals>::type;
+        using S = typename entry_array<T>::type;
         return getEntry<S>()[idx];
     }
 
     template<typename T>
     int get_offset(std::size_t idx)
     {
-        static_assert(std::is_same<Record, T>::value ||
-                      std::is_same<Internal, T>::value);
+        using S = typename entry_array<T>::type;
+        static_assert(sizeof(S) <= page_layout::entry_bytes);
         int offset = sizeof(NodePageHeader) + sizeof(T) * idx + sizeof(keyType);
         return offset;
     }
@@ -416,6 +702,68 @@ struct page_t
 
     void print_node() const;
 
+    // leaf 연산. leaf의 형식에 따라 Records, slotted, columnar leaf로
+    // 동작한다. (leaf_page.cc)
+    LeafFormat leaf_format() const;
+    // header의 형식을 정하고 entry를 비운다. 나머지 header는 그대로 둔다.
+    void leaf_init(LeafFormat format);
+    int leaf_lower_bound(keyType key) const;
+    int leaf_upper_bound(keyType key) const;
+    // key의 index. 없으면 -1
+    int leaf_index(keyType key) const;
+    keyType leaf_key(int idx) const;
+    // value가 있는 overflow page chain. leaf 안에 있으면 EMPTY_PAGE_NUMBER
+    pagenum_t leaf_overflow(int idx) const;
+    // value를 chain으로 옮길 때 idx의 cell 안에 남길 수 있는 prefix 길이
+    int leaf_prefix_capacity(int idx) const;
+    void leaf_read(int idx, KeyValue& ret) const;
+    // rec 하나가 이 leaf에서 차지하는 byte 수
+    int leaf_cost(const KeyValue& rec) const;
+    // record들이 차지하는 byte 수. slotted leaf의 지워진 cell은 빠진다.
+    int leaf_used() const;
+    int leaf_capacity() const;
+    // compactable이 아니면 살아있는 cell을 옮기지 않고 들어갈 때만 true
+    bool leaf_fits(const KeyValue& rec, bool compactable = true) const;
+    // idx 자리에 넣는다. 같은 compactable로 leaf_fits인지 먼저 확인해야
+    // 한다.
+    void leaf_insert(int idx, const KeyValue& rec, bool compactable = true);
+    void leaf_erase(int idx);
+    // idx의 value를 rec의 것으로 바꾸고, 바꾼 byte 범위를 changes에 적어서
+    // 그 개수를 반환한다. 이 leaf에 자리가 없으면 바꾸지 않고 -1
+    // rec.overflow가 있으면 cell이 그 page를 가리키게 하며, 이것은 항상
+    // cell 안에서 끝난다.
+    // cell을 옮기는 update는 CellRef와 cellBegin을 log에 적는데, 그 자리는
+    // 다른 record를 넣고 빼면 바뀐다. 그래서 undo 할 update는 NONE으로 부른다.
+    // compact는 다른 record의 cell을 log 없이 옮기므로, 그 cell을 undo 할
+    // update가 없을 때만 COMPACT로 부른다.
+    int leaf_update(int idx, const KeyValue& rec, page_changes& changes,
+                    CellMove move = CellMove::FREE_GAP);
+    // record를 모두 format의 leaf로 다시 쓴다. 들어가지 않으면 바꾸지 않고
+    // false. compact와 마찬가지로 log를 남기지 않는다.
+    bool leaf_convert(LeafFormat format);
+
+    // internal node 연산. 형식에 따라 Internals 또는 PACKED로 동작한다.
+    // 바꿀 때는 항상 PACKED로, entry가 들어가는 가장 좁은 너비로 다시 쓴다.
+    // (internal_page.cc)
+    InternalFormat internal_format() const;
+    keyType internal_key(int idx) const;
+    pagenum_t internal_child(int idx) const;
+    // key 초과인 첫 key의 index
+    int internal_upper_bound(keyType key) const;
+    // key가 있는 index. 없으면 -1
+    int internal_index(keyType key) const;
+    // key가 들어갈 child. upper_bound가 0이면 leftmost
+    pagenum_t internal_child_for(keyType key) const;
+    // entry를 모두 읽는다. (leftmost는 빼고)
+    void internal_read(std::vector<Internal>& entries) const;
+    // entries로 internal node를 다시 쓴다. 들어가지 않으면 바꾸지 않고 false
+    bool internal_assign(const std::vector<Internal>& entries);
+    static bool internal_fits(const std::vector<Internal>& entries);
+    // idx 자리에 넣는다. 들어가지 않으면 바꾸지 않고 false
+    bool internal_insert(int idx, keyType key, pagenum_t child);
+    // entry를 지우는 것은 너비를 늘리지 않으므로 항상 성공한다.
+    void internal_erase(int idx);
+
     int number_of_keys() const;
     pagenum_t parent() const;
     void set_parent(pagenum_t parent);
@@ -426,6 +774,17 @@ struct page_t
     void set_leftmost(pagenum_t leftmost);
     pagenum_t next_leaf() const;
     void set_next_leaf(pagenum_t next_leaf);
+
+    uint32_t level() const;
+    void set_level(uint32_t level);
+    keyType low_key() const;
+    void set_low_key(keyType key);
+    keyType high_key() const;
+    void set_high_key(keyType key);
+    pagenum_t right_sibling() const;
+    void set_right_sibling(pagenum_t right_sibling);
 };
 
+static_assert(sizeof(page_t) == PAGESIZE);
+
 #endif /* __PAGE_HPP__*/
\ No newline at end of file
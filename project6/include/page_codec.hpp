@@ -0,0 +1,22 @@
+#ifndef __PAGE_CODEC_HPP__
+#define __PAGE_CODEC_HPP__
+
+#include <cstdint>
+
+#include "page.hpp"
+
+// 압축 파일 형식에서 page를 압축하는 LZ77 codec. (LZ4 block과 같은 꼴)
+// page에는 0으로 채운 빈 곳(valType의 뒷부분, 반쯤 찬 leaf)과 비슷한 slot,
+// 비슷한 value가 많으므로 앞에서 나온 byte열을 가리키는 것으로 줄인다.
+// sequence 하나는 token, 그대로 쓸 byte들, 2바이트 offset이다.
+// - token의 위 4bit: 그대로 쓸 byte 수, 아래 4bit: 복사할 byte 수 - 4
+// - 15이면 뒤에 255가 아닌 byte가 나올 때까지 byte 값을 더한다.
+// - 마지막 sequence는 그대로 쓸 byte만 있고 offset이 없다.
+constexpr int page_codec_bound = PAGESIZE + PAGESIZE / 255 + 16;
+
+// page를 out에 압축하고 그 길이를 반환한다. out은 page_codec_bound 바이트
+int page_compress(const page_t& page, uint8_t* out);
+// length 바이트를 page로 푼다. 망가진 입력이면 false
+bool page_decompress(const uint8_t* in, int length, page_t& page);
+
+#endif /* __PAGE_CODEC_HPP__*/
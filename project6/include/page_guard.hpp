@@ -0,0 +1,61 @@
+#ifndef __PAGE_GUARD_HPP__
+#define __PAGE_GUARD_HPP__
+
+#include "frame.hpp"
+
+enum class LatchMode
+{
+    NONE = 0,
+    SHARED = 1,
+    EXCLUSIVE = 2
+};
+
+// buffer frame을 pin 한 채로 page를 복사 없이 참조한다.
+// 생성될 때 frame을 pin 하고 mode에 맞는 latch를 잡으며, 소멸될 때 latch를
+// 풀고 unpin 한다. pin 되어 있는 동안 frame은 eviction 되지 않는다.
+// LatchMode::NONE은 latch 없이 pin만 한다.
+class page_guard
+{
+ public:
+    page_guard();
+    page_guard(int file_id, pagenum_t pagenum,
+               LatchMode mode = LatchMode::NONE);
+    ~page_guard();
+
+    page_guard(const page_guard&) = delete;
+    page_guard& operator=(const page_guard&) = delete;
+    page_guard(page_guard&& rhs) noexcept;
+    page_guard& operator=(page_guard&& rhs) noexcept;
+
+    // 기존에 잡고 있던 frame은 새 frame을 잡은 뒤에 놓는다. (latch coupling)
+    bool acquire(int file_id, pagenum_t pagenum,
+                 LatchMode mode = LatchMode::NONE);
+    void release();
+
+    // pin은 유지한 채로 latch만 잡거나 놓는다.
+    void lock(LatchMode mode);
+    // latch를 기다리지 않는다. 잡지 못하면 false
+    bool try_lock(LatchMode mode);
+    void unlock();
+
+    const page_t& page() const;
+    // 쓰기용 참조. frame을 dirty로 표시한다.
+    page_t& mutable_page();
+    void mark_dirty();
+
+    frame_t& frame() const;
+    int frame_index() const;
+    LatchMode mode() const;
+
+    explicit operator bool() const
+    {
+        return frame_ptr != nullptr;
+    }
+
+ private:
+    frame_t* frame_ptr;
+    int index;
+    LatchMode latch_mode;
+};
+
+#endif /* __PAGE_GUARD_HPP__*/
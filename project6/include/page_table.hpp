@@ -0,0 +1,108 @@
+#ifndef __PAGE_TABLE_HPP__
+#define __PAGE_TABLE_HPP__
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "page.hpp"
+
+// (file_id, pagenum) -> frame index 를 저장하는 hash table.
+// partition 별로 latch를 따로 두어서 서로 다른 page를 찾는 thread끼리는
+// 경쟁하지 않는다. partition 안은 linear probing open addressing 이다.
+class PageTable
+{
+ public:
+    static constexpr int PARTITION_BITS = 6;
+    static constexpr int NUM_PARTITIONS = 1 << PARTITION_BITS;
+
+    PageTable();
+
+    // expected_size개의 page가 들어갈 수 있도록 비운다.
+    void reset(std::size_t expected_size);
+
+    // 찾으면 partition latch를 잡은 채로 on_found(frame_index)를 호출한다.
+    // latch가 잡혀 있는 동안에는 같은 page가 erase 될 수 없으므로, on_found
+    // 안에서 frame을 pin 하면 eviction과 경쟁하지 않는다.
+    template<typename Func>
+    int find(int file_id, pagenum_t pagenum, Func&& on_found)
+    {
+        uint64_t hash = hash_key(file_id, pagenum);
+        auto& partition = partitions[partition_of(hash)];
+        std::shared_lock<std::shared_mutex> latch { partition.mtx };
+        int slot = partition.lookup(hash, file_id, pagenum);
+        if (slot == -1)
+        {
+            return INVALID_INDEX;
+        }
+        int frame_index = partition.slots[slot].frame_index;
+        on_found(frame_index);
+        return frame_index;
+    }
+
+    int find(int file_id, pagenum_t pagenum)
+    {
+        return find(file_id, pagenum, [](int) {});
+    }
+
+    void insert(int file_id, pagenum_t pagenum, int frame_index);
+
+    // pred()가 참일 때만 지운다. pred는 partition latch를 잡은 채로
+    // 호출된다.
+    template<typename Pred>
+    bool erase_if(int file_id, pagenum_t pagenum, Pred&& pred)
+    {
+        uint64_t hash = hash_key(file_id, pagenum);
+        auto& partition = partitions[partition_of(hash)];
+        std::unique_lock<std::shared_mutex> latch { partition.mtx };
+        int slot = partition.lookup(hash, file_id, pagenum);
+        if (slot == -1 || !pred())
+        {
+            return false;
+        }
+        partition.erase(slot);
+        return true;
+    }
+
+    bool erase(int file_id, pagenum_t pagenum)
+    {
+        return erase_if(file_id, pagenum, []() { return true; });
+    }
+
+ private:
+    static constexpr int INVALID_INDEX = -1;
+
+    struct Slot
+    {
+        int file_id;
+        int frame_index;
+        pagenum_t pagenum;
+    };
+
+    struct Partition
+    {
+        std::shared_mutex mtx;
+        std::vector<Slot> slots;
+        std::size_t mask = 0;
+        std::size_t count = 0;
+
+        void reset(std::size_t capacity);
+        int lookup(uint64_t hash, int file_id, pagenum_t pagenum) const;
+        void insert(uint64_t hash, const Slot& slot);
+        void erase(int slot);
+        void grow();
+    };
+
+    static uint64_t hash_key(int file_id, pagenum_t pagenum);
+
+    static std::size_t partition_of(uint64_t hash)
+    {
+        return hash >> (64 - PARTITION_BITS);
+    }
+
+    std::array<Partition, NUM_PARTITIONS> partitions;
+};
+
+#endif /* __PAGE_TABLE_HPP__*/
@@ -0,0 +1,122 @@
+#ifndef __RECORD_CACHE_HPP__
+#define __RECORD_CACHE_HPP__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "page.hpp"
+
+// (table_id, key) -> value 를 저장하는 record 단위 cache.
+// buffer는 page를 통째로 들고 있어서, 자주 읽는 record가 여러 page에 흩어져
+// 있으면 frame 대부분이 읽지 않는 이웃 record로 찬다. 이 cache는 find가 읽은
+// record의 value만 들고 있으므로 같은 memory에 더 많은 hot record가 들어간다.
+// 크기는 byte 단위이고 0이면 쓰지 않는다. partition 별로 latch와 LRU list를
+// 따로 둔다.
+// cache가 page와 어긋나지 않도록 insert는 record가 있는 leaf의 S latch를,
+// erase는 X latch를 잡은 채로 부른다. (BPTree)
+class RecordCache
+{
+ public:
+    static constexpr int PARTITION_BITS = 6;
+    static constexpr int NUM_PARTITIONS = 1 << PARTITION_BITS;
+    // entry 하나가 value 외에 차지하는 byte (list / hash node)
+    static constexpr std::size_t ENTRY_OVERHEAD = 64;
+
+    static RecordCache& instance()
+    {
+        static RecordCache cache;
+        return cache;
+    }
+
+    // 비우고 크기를 capacity byte로 바꾼다.
+    void reset(std::size_t capacity);
+    void clear();
+    bool enabled() const
+    {
+        return partition_capacity.load(std::memory_order_relaxed) != 0;
+    }
+    std::size_t capacity() const;
+    // entry가 차지하는 byte
+    std::size_t size() const;
+
+    // 찾으면 value의 앞 capacity 바이트를 buffer에 쓰고 length에 전체
+    // 길이를 적는다.
+    bool find(int table_id, keyType key, uint8_t* buffer, int capacity,
+              int& length);
+    void insert(int table_id, keyType key, const uint8_t* value, int length);
+    void erase(int table_id, keyType key);
+    // table이 닫히거나 leaf 형식이 바뀔 때
+    void erase_table(int table_id);
+
+    std::size_t hits() const;
+    std::size_t misses() const;
+    void reset_stats();
+
+ private:
+    struct RecordId
+    {
+        int table_id;
+        keyType key;
+
+        bool operator==(const RecordId& rhs) const
+        {
+            return table_id == rhs.table_id && key == rhs.key;
+        }
+    };
+
+    struct RecordIdHash
+    {
+        std::size_t operator()(const RecordId& id) const
+        {
+            return hash_key(id.table_id, id.key);
+        }
+    };
+
+    struct Entry
+    {
+        RecordId id;
+        std::vector<uint8_t> value;
+    };
+
+    struct Partition
+    {
+        std::mutex mtx;
+        // 앞이 최근에 읽은 entry
+        std::list<Entry> lru;
+        std::unordered_map<RecordId, std::list<Entry>::iterator, RecordIdHash>
+            entries;
+        // latch를 잡고 바꾸지만 size / hits / misses는 latch 없이 읽는다.
+        std::atomic<std::size_t> used { 0 };
+        std::atomic<std::size_t> hits { 0 };
+        std::atomic<std::size_t> misses { 0 };
+
+        void erase(std::list<Entry>::iterator it);
+    };
+
+    std::atomic<std::size_t> partition_capacity;
+    std::array<Partition, NUM_PARTITIONS> partitions;
+
+    RecordCache() : partition_capacity(0)
+    {
+        // Do nothing
+    }
+
+    static uint64_t hash_key(int table_id, keyType key);
+
+    Partition& partition_of(int table_id, keyType key)
+    {
+        return partitions[hash_key(table_id, key) >> (64 - PARTITION_BITS)];
+    }
+
+    static std::size_t charge(std::size_t length)
+    {
+        return length + ENTRY_OVERHEAD;
+    }
+};
+
+#endif /* __RECORD_CACHE_HPP__*/
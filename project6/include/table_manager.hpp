@@ -1,6 +1,8 @@
 #ifndef __TABLE_MANAGER_HPP__
 #define __TABLE_MANAGER_HPP__
 
+#include <functional>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 
@@ -11,6 +13,7 @@ struct table_t;
 
 constexpr auto INVALID_TABLE_ID = -1;
 constexpr auto MAX_TABLE_NUM = 10;
+constexpr auto INVALID_CURSOR_ID = -1;
 
 class TableManager
 {
@@ -21,16 +24,58 @@ class TableManager
         return tm;
     }
 
-    bool init_db(int buf_num, int flag, int log_num, char* log_path, char* logmsg);
+    bool init_db(int buf_num, int flag, int log_num, char* log_path, char* logmsg,
+                 BufferPolicy policy = BufferPolicy::LRU);
     bool shutdown_db();
-    int open_table(const std::string& name);
+    // buffer와 log buffer를 disk에 쓰지 않고 닫는다. 테스트에서 crash를
+    // 흉내 낼 때 쓰고, 다음 init_db가 recovery 한다.
+    bool crash_db();
+    int open_table(const std::string& name,
+                   FileFormat format = FileFormat::RAW,
+                   LeafFormat leaf_format = DEFAULT_LEAF_FORMAT);
     bool close_table(int table_id);
+    bool insert(int table_id, const record_t& rec);
+    bool update(int table_id, const record_t& rec,
+                int trx_id = TransactionManager::invliad_transaction_id);
+    bool delete_key(int table_id, keyType key);
+    bool upsert(int table_id, const record_t& rec,
+                int trx_id = TransactionManager::invliad_transaction_id);
+    // value가 NUL로 끝나는 문자열일 때
     bool insert(int table_id, keyType key, const valType& value);
     bool update(int table_id, keyType key, const valType& value,
                 int trx_id = TransactionManager::invliad_transaction_id);
-    bool delete_key(int table_id, keyType key);
+    bool upsert(int table_id, keyType key, const valType& value,
+                int trx_id = TransactionManager::invliad_transaction_id);
     bool find(int table_id, keyType key, record_t& ret,
               int trx_id = TransactionManager::invliad_transaction_id);
+    // max_value_length보다 긴 value도 다룬다. find는 value의 앞 capacity
+    // 바이트까지 buffer에 읽고 전체 길이를 length에 담는다.
+    bool insert(int table_id, keyType key, ValueRef value);
+    bool update(int table_id, keyType key, ValueRef value,
+                int trx_id = TransactionManager::invliad_transaction_id);
+    bool upsert(int table_id, keyType key, ValueRef value,
+                int trx_id = TransactionManager::invliad_transaction_id);
+    bool find(int table_id, keyType key, uint8_t* buffer, int capacity,
+              int& length,
+              int trx_id = TransactionManager::invliad_transaction_id);
+    // range scan. scan_open이 돌려준 cursor id로 scan_next / scan_close 한다.
+    // cursor는 한 thread에서만 사용한다.
+    int scan_open(int table_id, keyType lo, keyType hi,
+                  int trx_id = TransactionManager::invliad_transaction_id);
+    ScanResult scan_next(int cursor_id, record_t& ret);
+    bool scan_close(int cursor_id);
+    bool scan(int table_id, keyType lo, keyType hi,
+              const std::function<bool(const record_t&)>& callback,
+              int trx_id = TransactionManager::invliad_transaction_id);
+    // key 순서로 정렬된 record로 빈 table을 채운다.
+    bool bulk_load(int table_id, std::size_t count,
+                   const std::function<bool(record_t&)>& next,
+                   double fill_factor = BULK_LOAD_FILL_FACTOR);
+    // leaf를 format으로 바꾼다. 바꾸지 못한 leaf 수, 실패하면 -1
+    int set_leaf_format(int table_id, LeafFormat format);
+    // find 앞에 capacity byte의 record cache를 둔다. 0이면 쓰지 않는다.
+    // (init_db / shutdown_db 사이에도 남아 있다)
+    void set_record_cache(std::size_t capacity);
     static void char_to_valType(valType& dst, const char* src)
     {
         std::fill(std::begin(dst), std::end(dst), 0);
@@ -48,6 +93,18 @@ class TableManager
     std::unordered_map<int, std::unique_ptr<table_t>> tables;
     std::unordered_map<std::string, int> name_id_table;
     bool valid_table_manager;
+
+    struct open_cursor
+    {
+        int table_id;
+        scan_cursor cursor;
+    };
+    std::mutex cursor_latch;
+    std::unordered_map<int, std::unique_ptr<open_cursor>> cursors;
+    int cursor_counter = 0;
+    // table의 cursor를 모두 닫는다. (leaf의 pin을 놓는다)
+    void close_cursors(int table_id);
+
     TableManager() : valid_table_manager(false)
     {
         // Do nothing
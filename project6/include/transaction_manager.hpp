@@ -5,6 +5,7 @@
 #include <list>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include "buffer_manager.hpp"
@@ -28,10 +29,15 @@ struct Transaction
     Transaction(const Transaction& rhs);
     bool commit();
     bool abort();
-    bool lock_release(bool abort = false);
+    bool lock_release();
     int transactionID;
     std::atomic<TransactionState> state;
+    // 주인 thread만 바꾸지만, 바꾸는 동안은 mtx를 잡는다.
     std::list<std::tuple<LockHash, lock_t*>> locks;
+    // lock_t::signal이 state를 바꾸는 동안 잡는다. 깨어난 주인은 이 latch를
+    // 한 번 잡아서 signal이 끝난 뒤에 transaction을 지운다.
+    // LockManager의 latch를 잡은 채로 잡을 수 있으므로, 이 latch를 잡고
+    // LockManager를 부르면 안 된다.
     std::mutex mtx;
 };
 
@@ -51,6 +57,8 @@ class TransactionManager
     }
     int begin();
     int commit(int id);
+    // transaction은 주인 thread가 commit / abort 할 때만 지워지므로, 그
+    // 전까지는 돌려받은 참조를 latch 없이 써도 된다.
     Transaction& get(int transaction_id);
     const std::unordered_map<int, Transaction>& get_transactions() const;
     int abort(int transaction_id);
@@ -58,20 +66,29 @@ class TransactionManager
 
     LockAcquireResult lock_acquire(int table_id, int64_t key, int trx_id,
                                    LockMode mode);
-    void lock_wait(lock_t* lock);
+    // 기다리는 동안 deadlock 처리로 abort 대상이 되었으면 false
+    bool lock_wait(lock_t* lock);
 
     static constexpr int invliad_transaction_id = 0;
 
-    std::mutex mtx;
-
  private:
     std::atomic<int> counter;
+    // transactions에 넣고 지울 때만 exclusive로, 찾을 때는 shared로 잡는다.
+    // lock을 얻고 놓는 동안에는 잡지 않으므로, 서로 다른 record의 lock은
+    // LockManager의 partition latch만 거친다.
+    // lock order: LockManager partition.mtx -> mtx -> Transaction::mtx
+    std::shared_mutex mtx;
     std::unordered_map<int, Transaction> transactions;
 
     TransactionManager() : counter(0)
     {
         // Do nothing
     }
+
+    // 없으면 nullptr
+    Transaction* find(int transaction_id);
+    // commit / abort가 끝난 transaction을 지운다.
+    void erase(int transaction_id);
 };
 
 #endif /* __TRX_MANAGER_HPP__*/
\ No newline at end of file
@@ -1,311 +1,690 @@
 #include "bptree.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 #include "log_manager.hpp"
 #include "logger.hpp"
-#include "scoped_page_latch.hpp"
+#include "record_cache.hpp"
 
-scoped_node_latch::scoped_node_latch(int manager_id, nodeId_t id)
-    : manager_id(manager_id),
-      id(id),
-      locked(false)
+BPTree::BPTree(bool verbose_output, int delayed_min)
+    : leaf_format(LeafFormat::RECORDS),
+      leaf_order(LEAF_ORDER),
+      internal_order(INTERNAL_ORDER),
+      verbose_output(verbose_output),
+      delayed_min(delayed_min)
 {
-    lock();
+    // Do nothing
 }
 
-scoped_node_latch::~scoped_node_latch()
+void BPTree::set_table(int table_id)
 {
-    unlock();
-} 
+    this->table_id = table_id;
+}
 
-void scoped_node_latch::lock()
+// 고정 너비 leaf는 value가 짧을수록 record가 많이 들어간다.
+static int leaf_order_of(LeafFormat format)
 {
-    if (locked)
+    if (leaf_has_cells(format))
     {
-        return;
+        return LEAF_ORDER;
     }
+    return with_value_width(format, [](auto width) {
+        return page_layout::fixed_records<decltype(width)::value> + 1;
+    });
+}
 
-    locked = true;
-    page_t temp;
-    buffer_index = BufferController::instance().get(manager_id, id, temp);
+bool BPTree::open_table(const std::string &filename, FileFormat format,
+                        LeafFormat leaf_format)
+{
+    CHECK_WITH_LOG(manager.open(filename, format, leaf_format), false,
+                   "open table failure");
+    this->leaf_format = manager.leaf_format();
+    leaf_order = leaf_order_of(this->leaf_format);
+    return true;
+}
 
-    auto& frame = BufferController::instance().at(buffer_index);
-    DB_CRASH_COND(frame.file_id == manager_id && frame.pagenum == id, -1, "invalid frame");
-    frame.mtx.lock();
-    if (frame.pin != 0)
-    {
-        std::cout << "???: " << frame.pin << std::endl;
-    }
-    ++frame.pin;
+int BPTree::char_to_valType(valType &dst, const char *src) const
+{
+    std::fill(std::begin(dst), std::end(dst), 0);
+    std::copy_n(src, std::min(static_cast<int>(strlen(src)), 119),
+                std::begin(dst));
+    return 0;
 }
 
-void scoped_node_latch::unlock()
+int BPTree::get_table_id() const
 {
-    if (!locked)
+    return table_id;
+}
+
+bool BPTree::insert(const record_t &rec)
+{
+    if (rec.length > leaf_value_limit(leaf_format))
     {
-        std::cout << "???";
-        return;
+        return false;
     }
-    auto& frame = BufferController::instance().at(buffer_index);
-    DB_CRASH_COND(frame.file_id == manager_id && frame.pagenum == id, -1, "invalid frame");
-    --frame.pin;
-    if (frame.pin != 0)
+    // 중복을 허용하지 않음
+    node_tuple leaf;
+    if (find_slot(rec.key, leaf, LatchMode::EXCLUSIVE) != -1)
     {
-        std::cout << "???: " << frame.pin << std::endl;
+        return false;
     }
-    frame.mtx.unlock();
-    locked = false;
-}
 
-scoped_node_latch_shared::scoped_node_latch_shared(int manager_id, nodeId_t id)
-    : manager_id(manager_id),
-      id(id),
-      locked(false)
-{
-    lock_shared();
+    return insert_at(leaf, rec);
 }
 
-scoped_node_latch_shared::~scoped_node_latch_shared()
+bool BPTree::update(const record_t &rec, int transaction_id)
 {
-    unlock_shared();
+    return update(rec.key, ValueRef { rec.value.data(), rec.length },
+                  transaction_id);
 }
 
-void scoped_node_latch_shared::lock_shared()
+bool BPTree::upsert(const record_t &rec, int transaction_id)
 {
-    if (locked)
+    if (rec.length > leaf_value_limit(leaf_format))
     {
-        return;
+        return false;
+    }
+    ValueRef value { rec.value.data(), rec.length };
+    node_tuple leaf;
+    if (find_slot(rec.key, leaf, LatchMode::EXCLUSIVE) != -1)
+    {
+        leaf.guard.unlock();
+        return update_at(leaf, rec.key, value, transaction_id);
     }
-    locked = true;
-    page_t temp;
-    buffer_index = BufferController::instance().get(manager_id, id, temp);
 
-    auto& frame = BufferController::instance().at(buffer_index);
-    DB_CRASH_COND(frame.file_id == manager_id && frame.pagenum == id, -1, "invalid frame");
-    frame.mtx.lock_shared();
-    ++frame.pin;
+    // split 하려고 다시 내려가는 사이에 다른 thread가 같은 key를 넣었으면
+    // update 한다.
+    return insert_at(leaf, rec) || update(rec.key, value, transaction_id);
 }
 
-void scoped_node_latch_shared::unlock_shared()
+bool BPTree::insert(keyType key, ValueRef value)
 {
-    if (!locked)
+    if (value.length <= max_value_length)
     {
-        std::cout << "???";
-        return;
+        record_t rec;
+        rec.key = key;
+        rec.length = value.length;
+        rec.value.fill(0);
+        std::memcpy(rec.value.data(), value.data, value.length);
+        return insert(rec);
+    }
+    if (!leaf_has_cells(leaf_format))
+    {
+        return false;
     }
-    auto& frame = BufferController::instance().at(buffer_index);
-    DB_CRASH_COND(frame.file_id == manager_id && frame.pagenum == id, -1, "invalid frame");
-    --frame.pin;
-    frame.mtx.unlock_shared();
-    locked = false;
-}
 
-BPTree::BPTree(bool verbose_output, int delayed_min)
-    : leaf_order(LEAF_ORDER),
-      internal_order(INTERNAL_ORDER),
-      verbose_output(verbose_output),
-      delayed_min(delayed_min)
-{
-    // Do nothing
-}
+    // 있는 key면 chain을 만들기 전에 실패한다.
+    {
+        node_tuple leaf;
+        if (find_slot(key, leaf) != -1)
+        {
+            return false;
+        }
+    }
 
-void BPTree::set_table(int table_id)
-{
-    this->table_id = table_id;
+    // insert와 마찬가지로 chain도 log를 남기지 않는다.
+    record_t cell;
+    CHECK(write_chain(INVALID_NODE_ID, value, OVERFLOW_PREFIX, cell,
+                      TransactionManager::invliad_transaction_id, false));
+    cell.key = key;
+    if (!insert(cell))
+    {
+        CHECK(free_chain(cell.overflow));
+        return false;
+    }
+    return true;
 }
 
-bool BPTree::open_table(const std::string &filename)
+bool BPTree::update(keyType key, ValueRef value, int transaction_id)
 {
-    CHECK_WITH_LOG(manager.open(filename), false, "open table failure");
-    return true;
+    node_tuple leaf;
+    if (find_slot(key, leaf) == -1)
+    {
+        return false;
+    }
+
+    return update_at(leaf, key, value, transaction_id);
 }
 
-int BPTree::char_to_valType(valType &dst, const char *src) const
+bool BPTree::upsert(keyType key, ValueRef value, int transaction_id)
 {
-    std::fill(std::begin(dst), std::end(dst), 0);
-    std::copy_n(src, std::min(static_cast<int>(strlen(src)), 119),
-                std::begin(dst));
-    return 0;
+    if (value.length <= max_value_length)
+    {
+        record_t rec;
+        rec.key = key;
+        rec.length = value.length;
+        rec.value.fill(0);
+        std::memcpy(rec.value.data(), value.data, value.length);
+        return upsert(rec, transaction_id);
+    }
+
+    node_tuple leaf;
+    if (find_slot(key, leaf) != -1)
+    {
+        return update_at(leaf, key, value, transaction_id);
+    }
+    return insert(key, value) || update(key, value, transaction_id);
 }
 
-int BPTree::get_table_id() const
+bool BPTree::insert_at(node_tuple &leaf, const record_t &record)
 {
-    return table_id;
+    bool compactable = false;
+    if (leaf && leaf_fits(leaf.node(), record, compactable))
+    {
+        bool result = insert_into_leaf(leaf, record, compactable);
+        return result;
+    }
+
+    // leaf를 놓고 smo_latch를 잡은 뒤 다시 내려간다. 그 사이에 tree가
+    // 바뀌었을 수 있으므로 key가 있는지 다시 본다.
+    leaf.guard.release();
+    leaf.id = INVALID_NODE_ID;
+
+    std::shared_lock<std::shared_mutex> smo_lock { smo_latch };
+    std::vector<nodeId_t> ancestors;
+    while (!find_node(record.key, 0, leaf, LatchMode::EXCLUSIVE, &ancestors))
+    {
+        std::unique_lock<std::shared_mutex> root_lock { root_latch };
+        if (!is_valid(manager.root()))
+        {
+            return start_new_tree(record);
+        }
+    }
+
+    if (leaf.node().leaf_index(record.key) != -1)
+    {
+        return false;
+    }
+
+    bool result = leaf_fits(leaf.node(), record, compactable)
+                      ? insert_into_leaf(leaf, record, compactable)
+                      : split_leaf(leaf, &record, ancestors);
+    return result;
 }
 
-bool BPTree::insert(keyType key, const valType &value)
+bool BPTree::update_at(node_tuple &leaf, keyType key, ValueRef value,
+                       int transaction_id)
 {
-    // 중복을 허용하지 않음
-    if (exist_key(key))
+    // Records leaf에는 overflow page chain이 없다.
+    if (!leaf_has_cells(leaf_format) &&
+        value.length > leaf_value_limit(leaf_format))
     {
         return false;
     }
 
-    record_t record;
-    record = {key, value};
+    // record lock을 먼저 얻고 page latch는 그 뒤에 잡는다.
+    // latch를 잡은 채로 TransactionManager::mtx를 기다리면, mtx를 잡고 같은
+    // page를 rollback 하려는 thread와 deadlock이 생긴다.
+    // lock을 기다리는 동안에도 leaf는 pin 되어 있으므로 eviction 되지 않는다.
+    if (transaction_id != TransactionManager::invliad_transaction_id &&
+        !lock_record(key, LockMode::EXCLUSIVE, transaction_id))
+    {
+        return false;
+    }
 
-    if (!is_valid(manager.root()))
+    record_t rec;
+    if (value.length <= max_value_length)
     {
-        return start_new_tree(record);
+        rec.key = key;
+        rec.length = value.length;
+        rec.value.fill(0);
+        std::memcpy(rec.value.data(), value.data, value.length);
     }
 
-    node_tuple leaf;
-    CHECK(find_leaf(key, leaf));
+    // latch 없이 찾은 slot이므로 latch를 잡고 leaf 안에서 다시 찾는다.
+    // 그 사이 split / merge로 record가 다른 leaf로 옮겨갔으면 다시 내려간다.
+    leaf.guard.lock(LatchMode::EXCLUSIVE);
+    int i = leaf.node().is_leaf() ? leaf.node().leaf_index(key) : -1;
+    page_changes changes;
+    int count = -1;
+    while (true)
+    {
+        if (i == -1)
+        {
+            leaf.guard.unlock();
+            i = find_slot(key, leaf, LatchMode::EXCLUSIVE);
+        }
+        if (i == -1)
+        {
+            return false;
+        }
+
+        // 이미 chain에 있는 value는 chain에 쓴다.
+        if (value.length > max_value_length ||
+            is_valid(leaf.node().leaf_overflow(i)))
+        {
+            break;
+        }
+
+        // transaction의 update는 cell을 옮기지 않는다. 옮긴 CellRef와
+        // cellBegin의 자리는 다른 record를 넣고 빼면 바뀌어서, undo가 엉뚱한
+        // 곳에 쓰인다. 들어가지 않으면 아래에서 overflow page chain에 쓴다.
+        bool transactional =
+            transaction_id != TransactionManager::invliad_transaction_id;
+        bool reorganizable = !transactional && can_reorganize(leaf.node());
+        count = leaf.guard.mutable_page().leaf_update(
+            i, rec, changes,
+            transactional   ? CellMove::NONE
+            : reorganizable ? CellMove::COMPACT
+                            : CellMove::FREE_GAP);
+        if (count != -1 || !reorganizable)
+        {
+            break;
+        }
 
-    /*
-    현재는 insert를 thread-safe 하지 않게 구현하므로, latch를 제거
-    */
-    // scoped_node_latch leaf_latch {manager.get_manager_id(), leaf.id};
+        // 커진 value가 leaf에 들어가지 않는다. leaf를 나눈 뒤 다시 내려간다.
+        leaf.guard.release();
+        leaf.id = INVALID_NODE_ID;
+        CHECK(make_room(key));
+        i = -1;
+    }
 
-    if (leaf.node.number_of_keys() < leaf_order - 1)
+    if (count == -1)
     {
-        bool result = insert_into_leaf(leaf, record);
-        return result;
+        // value를 overflow page chain에 쓰고 cell은 그 chain을 가리키게
+        // 한다. transaction의 update이거나, leaf에 commit 하지 않은 update가
+        // 있어서 나눌 수 없을 때도 여기로 온다. cell의 크기는 그대로이므로
+        // cell 안에서 끝난다.
+        record_t cell;
+        CHECK(write_chain(leaf.node().leaf_overflow(i), value,
+                          leaf.node().leaf_prefix_capacity(i), cell,
+                          transaction_id));
+        cell.key = key;
+        count = leaf.guard.mutable_page().leaf_update(i, cell, changes);
+        CHECK(count != -1);
     }
 
-    bool result = insert_into_leaf_after_splitting(leaf, record);
-    return result;
+    RecordCache::instance().erase(get_table_id(), key);
+    CHECK(log_changes(leaf, changes, count, transaction_id));
+    return true;
 }
 
-bool BPTree::update(keyType key, const valType &value, int transaction_id)
+bool BPTree::can_reorganize(const node_t &leaf) const
 {
-    std::unique_lock<std::mutex> buffer_latch{
-        BufferController::instance().mtx};
+    return leaf.nodePageHeader().pageLsn <
+           LogManager::instance().oldest_active_lsn();
+}
 
-    if (!exist_key(key))
+bool BPTree::leaf_fits(const node_t &leaf, const record_t &rec,
+                       bool &compactable) const
+{
+    // 옮기지 않고 들어가면 oldest_active_lsn을 보지 않는다.
+    compactable = false;
+    if (leaf.leaf_fits(rec, false))
     {
-        return false;
+        return true;
     }
+    compactable = can_reorganize(leaf);
+    return compactable && leaf.leaf_fits(rec);
+}
 
+bool BPTree::make_room(keyType key)
+{
+    std::shared_lock<std::shared_mutex> smo_lock { smo_latch };
+    std::vector<nodeId_t> ancestors;
     node_tuple leaf;
-    CHECK(find_leaf(key, leaf));
+    if (!find_node(key, 0, leaf, LatchMode::EXCLUSIVE, &ancestors))
+    {
+        return true;
+    }
+    // 그 사이 다른 thread가 나눴거나 update 했으면 다시 update 해 본다.
+    if (leaf.node().number_of_keys() < 2 || !can_reorganize(leaf.node()))
+    {
+        return true;
+    }
+    return split_leaf(leaf, nullptr, ancestors);
+}
+
+bool BPTree::write_chain(pagenum_t head, ValueRef value, int prefix_capacity,
+                         record_t &cell, int transaction_id, bool logged)
+{
+    int prefix = std::min(value.length, prefix_capacity);
+    cell.length = prefix;
+    cell.value.fill(0);
+    std::memcpy(cell.value.data(), value.data, prefix);
+
+    // 있던 chain의 page를 앞에서부터 다시 쓰고, 모자라면 page를 이어
+    // 붙인다. 짧아져서 남는 page는 chain에 그대로 두었다가 다시 길어질 때
+    // 쓴다. undo가 그 page를 다시 가리킬 수 있으므로 free 하지 않는다.
+    node_tuple page;
+    bool fresh = !is_valid(head);
+    page.id = fresh ? manager.create() : head;
+    CHECK_WITH_LOG(is_valid(page.id), false, "create overflow page failure");
+    cell.overflow = page.id;
+    int offset = prefix;
+    while (true)
+    {
+        CHECK(load_node(page, LatchMode::EXCLUSIVE));
+        if (fresh)
+        {
+            page.node() = node_t {};
+            CHECK(commit_node(page));
+        }
+
+        auto header = page.node().overflowPageHeader();
+        header.length = std::min<int>(value.length - offset,
+                                      page_layout::entry_bytes);
+        if (page.id == cell.overflow)
+        {
+            header.totalLength = value.length;
+        }
+        CHECK(write_page(page, sizeof(NodePageHeader), value.data + offset,
+                         header.length, transaction_id, logged));
+        offset += header.length;
 
-    scoped_node_latch latch{ manager.get_manager_id(), leaf.id };
+        fresh = offset < value.length && !is_valid(header.nextPageNumber);
+        if (fresh)
+        {
+            header.nextPageNumber = manager.create();
+            CHECK_WITH_LOG(is_valid(header.nextPageNumber), false,
+                           "create overflow page failure");
+        }
+        CHECK(write_page(page, 0, &header,
+                         offsetof(OverflowPageHeader, pageLsn), transaction_id,
+                         logged));
+        if (offset >= value.length)
+        {
+            return true;
+        }
+        page.id = header.nextPageNumber;
+    }
+}
 
-    if (transaction_id != TransactionManager::invliad_transaction_id)
+bool BPTree::write_page(node_tuple &page, int offset, const void *data,
+                        int length, int transaction_id, bool logged)
+{
+    // update log의 image 하나에 들어가는 만큼씩 나눠서, 바뀐 조각만 쓴다.
+    auto *raw = reinterpret_cast<uint8_t *>(&page.guard.mutable_page());
+    const auto *src = static_cast<const uint8_t *>(data);
+    int64_t lsn = INVALID_LSN;
+    for (int done = 0; done < length; done += value_size)
     {
-        std::unique_lock<std::mutex> trxmanager_latch{
-            TransactionManager::instance().mtx};
-        auto &trx = TransactionManager::instance().get(transaction_id);
-        auto [lock, state] = TransactionManager::instance().lock_acquire(
-            get_table_id(), key, transaction_id, LockMode::EXCLUSIVE);
-        switch (state)
+        int n = std::min(length - done, value_size);
+        uint8_t *dst = raw + offset + done;
+        if (std::memcmp(dst, src + done, n) == 0)
         {
-        case LockState::INVALID:
-            return false;
-        case LockState::ACQUIRED:
-            break;
-        case LockState::ABORTED:
-            // abort 시에도 page latch를 계속 잡고 있어야 한다.
-            // abort 할 때 해당 페이지가 중간에 eviction 되면 버그가
-            // 발생한다.
-            TransactionManager::instance().abort(transaction_id);
-            return false;
-        case LockState::WAITING:
-            trx.mtx.lock();
-            trxmanager_latch.unlock();
-            latch.unlock();
-            buffer_latch.unlock();
-            trx.mtx.unlock();
-            TransactionManager::instance().lock_wait(lock);
-            buffer_latch.lock();
-            latch.lock();
+            continue;
+        }
+        if (logged)
+        {
+            valType before {};
+            valType after {};
+            std::memcpy(before.data(), dst, n);
+            std::memcpy(after.data(), src + done, n);
+            lsn = LogManager::instance().update_log(
+                transaction_id, manager.get_manager_id(), page.id,
+                offset + done, n, before, after);
         }
+        std::memcpy(dst, src + done, n);
     }
 
-    int idx = latch.buffer_index;
-    auto& frame = BufferController::instance().at(idx);
+    if (lsn != INVALID_LSN)
+    {
+        page.node().overflowPageHeader().pageLsn = lsn;
+    }
+    return true;
+}
 
-    buffer_latch.unlock();
+bool BPTree::read_value(const record_t &cell, uint8_t *buffer, int capacity,
+                        int &length)
+{
+    std::memcpy(buffer, cell.value.data(), std::min<int>(cell.length, capacity));
+    length = cell.length;
+    if (!is_valid(cell.overflow))
+    {
+        return true;
+    }
 
-    valType before;
+    // chain의 page를 하나씩 S latch로 잡고 frame에서 buffer로 바로 복사한다.
+    // capacity를 채우면 나머지 page는 읽지 않는다.
+    node_tuple page;
+    page.id = cell.overflow;
+    CHECK(load_node(page, LatchMode::SHARED));
+    length = page.node().overflowPageHeader().totalLength;
+    int end = std::min(capacity, length);
+    for (int offset = cell.length; offset < end;)
+    {
+        const auto &header = page.node().overflowPageHeader();
+        int n = std::min<int>(header.length, end - offset);
+        std::memcpy(buffer + offset, page.node().entry.bytes.data(), n);
+        offset += n;
+        if (offset < end)
+        {
+            page.id = header.nextPageNumber;
+            CHECK(load_node(page, LatchMode::SHARED));
+        }
+    }
+    return true;
+}
 
-    int i = frame.index_key<record_t>(key);
-    before = frame.records()[i].value;
-    frame.records()[i].value = value;
+bool BPTree::read_overflow(record_t &rec)
+{
+    record_t cell = rec;
+    int length;
+    CHECK(read_value(cell, rec.value.data(), max_value_length, length));
+    rec.length = std::min(length, max_value_length);
+    rec.overflow = EMPTY_PAGE_NUMBER;
+    return true;
+}
 
-    auto lsn = LogManager::instance().update_log(
-        transaction_id, manager.get_manager_id(), leaf.id,
-        frame.get_offset<record_t>(i), sizeof(valType), before, value);
+bool BPTree::free_chain(pagenum_t head)
+{
+    node_tuple page;
+    for (page.id = head; is_valid(page.id);)
+    {
+        CHECK(load_node(page, LatchMode::EXCLUSIVE));
+        pagenum_t next = page.node().overflowPageHeader().nextPageNumber;
+        CHECK(free_node(page));
+        page.id = next;
+    }
+    return true;
+}
 
-    frame.nodePageHeader().pageLsn = lsn;
-    frame.is_dirty = true;
+bool BPTree::log_changes(node_tuple &target, const page_changes &changes,
+                         int count, int transaction_id)
+{
+    int64_t lsn = INVALID_LSN;
+    for (int c = 0; c < count; ++c)
+    {
+        lsn = LogManager::instance().update_log(
+            transaction_id, manager.get_manager_id(), target.id,
+            changes[c].offset, changes[c].length, changes[c].before,
+            changes[c].after);
+    }
 
+    target.guard.mutable_page().nodePageHeader().pageLsn = lsn;
     return true;
 }
 
-bool BPTree::insert_into_leaf(node_tuple &leaf, const record_t &rec)
+bool BPTree::insert_into_leaf(node_tuple &leaf, const record_t &rec,
+                              bool compactable)
 {
-    int insertion_point =
-        leaf.node.satisfy_condition_first<record_t>([&rec](auto &now) {
-            return now.key >= rec.key;
-        });
-    leaf.node.insert(rec, insertion_point);
+    int insertion_point = leaf.node().leaf_lower_bound(rec.key);
+    leaf.node().leaf_insert(insertion_point, rec, compactable);
 
     CHECK(commit_node(leaf));
 
     return true;
 }
 
-bool BPTree::insert_into_leaf_after_splitting(node_tuple &leaf,
-                                              const record_t &rec)
+// (left, right] 안에서 아래 bit가 0인 것이 가장 많은 key.
+// 부모에는 key 전체가 아니라 이 separator를 올리므로, 부모의 key 차이가
+// 아래 bit를 공유해서 PACKED internal node에 좁게 들어간다.
+static keyType shortest_separator(keyType left, keyType right)
 {
-    node_tuple new_leaf{create_node()};
-    new_leaf.node.set_is_leaf(true);
-    int insertion_index =
-        leaf.node.satisfy_condition_first<record_t>([&rec](auto &now) {
-            return now.key >= rec.key;
-        });
-
-    std::vector<record_t> temp;
-    temp.reserve(leaf_order + 1);
-
-    auto back = std::back_inserter(temp);
+    // 부호 bit를 뒤집으면 unsigned 비교가 key 순서와 같다.
+    constexpr uint64_t sign = uint64_t { 1 } << 63;
+    uint64_t low = static_cast<uint64_t>(left) ^ sign;
+    uint64_t separator = static_cast<uint64_t>(right) ^ sign;
+    while (separator != 0)
+    {
+        uint64_t cleared = separator & (separator - 1);
+        if (cleared <= low)
+        {
+            break;
+        }
+        separator = cleared;
+    }
+    return static_cast<keyType>(separator ^ sign);
+}
 
-    leaf.node.range_copy<record_t>(back, 0, insertion_index);
-    back = rec;
-    leaf.node.range_copy<record_t>(back, insertion_index);
+bool BPTree::split_leaf(node_tuple &leaf, const record_t *rec,
+                        std::vector<nodeId_t> &ancestors)
+{
+    auto &node = leaf.node();
+    node_tuple new_leaf;
+    CHECK(create_node(new_leaf));
+    new_leaf.node().leaf_init(node.leaf_format());
+
+    int n = node.number_of_keys();
+    std::vector<record_t> temp(n + (rec ? 1 : 0));
+    int insertion_index = rec ? node.leaf_lower_bound(rec->key) : n;
+    for (int i = 0, j = 0; i < n; ++i, ++j)
+    {
+        if (j == insertion_index)
+        {
+            temp[j++] = *rec;
+        }
+        node.leaf_read(i, temp[j]);
+    }
+    if (insertion_index == n && rec)
+    {
+        temp[n] = *rec;
+    }
 
-    int split = cut(leaf_order - 1);
+    // 앞에서부터 byte를 더해서 절반을 넘는 곳에서 나눈다.
+    int total = 0;
+    for (auto &now : temp)
+    {
+        total += node.leaf_cost(now);
+    }
+    int split = 0;
+    for (int used = 0; split + 1 < static_cast<int>(temp.size()) &&
+                       (split == 0 || 2 * used < total);
+         ++split)
+    {
+        used += node.leaf_cost(temp[split]);
+    }
 
-    leaf.node.range_assignment<record_t>(temp.begin(), temp.begin() + split);
-    new_leaf.node.range_assignment<record_t>(temp.begin() + split, temp.end());
+    node.leaf_init(node.leaf_format());
+    for (int i = 0; i < split; ++i)
+    {
+        node.leaf_insert(i, temp[i]);
+    }
+    for (int i = split; i < static_cast<int>(temp.size()); ++i)
+    {
+        new_leaf.node().leaf_insert(i - split, temp[i]);
+    }
 
-    new_leaf.node.set_next_leaf(leaf.node.next_leaf());
-    leaf.node.set_next_leaf(new_leaf.id);
-    new_leaf.node.set_parent(leaf.node.parent());
+    // new_leaf의 parent는 부모에 key를 넣을 때 정한다.
+    keyType split_key = shortest_separator(temp[split - 1].key, temp[split].key);
+    new_leaf.node().set_low_key(split_key);
+    new_leaf.node().set_high_key(leaf.node().high_key());
+    new_leaf.node().set_next_leaf(leaf.node().next_leaf());
+    leaf.node().set_high_key(split_key);
+    leaf.node().set_next_leaf(new_leaf.id);
 
     CHECK(commit_node(leaf));
     CHECK(commit_node(new_leaf));
 
-    return insert_into_parent(leaf, new_leaf.node.get<record_t>(0).key,
-                              new_leaf);
+    return insert_into_parent(leaf, split_key, new_leaf, ancestors);
 }
 
 bool BPTree::insert_into_parent(node_tuple &left, keyType key,
-                                node_tuple &right)
+                                node_tuple &right,
+                                std::vector<nodeId_t> &ancestors)
+{
+    // right link로 split이 이미 보이므로, 부모를 잡기 전에 놓는다.
+    uint32_t level = left.node().level() + 1;
+    nodeId_t left_id = left.id;
+    nodeId_t right_id = right.id;
+    left.guard.release();
+    right.guard.release();
+    return insert_into_level(level, left_id, key, right_id, ancestors);
+}
+
+bool BPTree::insert_into_level(uint32_t level, nodeId_t left_id, keyType key,
+                               nodeId_t right_id,
+                               std::vector<nodeId_t> &ancestors)
 {
+    // 내려올 때 지나온 node에서 시작한다. 그 사이 split 되었으면 move_right가
+    // 오른쪽으로 따라간다.
     node_tuple parent;
-    parent.id = left.node.parent();
-    if (!is_valid(parent.id))
+    while (true)
+    {
+        if (level < ancestors.size() && is_valid(ancestors[level]))
+        {
+            parent.id = ancestors[level];
+            CHECK(load_node(parent));
+            if (move_right(key, parent, LatchMode::EXCLUSIVE))
+            {
+                break;
+            }
+            ancestors.resize(level);
+            continue;
+        }
+        if (find_node(key, level, parent, LatchMode::EXCLUSIVE, &ancestors))
+        {
+            break;
+        }
+
+        // root가 left의 level에 있다. left가 root면 새 root를 만들고, 아니면
+        // root를 split 한 다른 thread가 새 root를 만들 때까지 기다린다.
+        std::unique_lock<std::shared_mutex> root_lock { root_latch };
+        if (manager.root() == left_id)
+        {
+            return insert_into_new_root(left_id, key, right_id, level);
+        }
+        root_lock.unlock();
+        std::this_thread::yield();
+    }
+
+    if (parent.node().internal_insert(parent.node().key_grt(key), key,
+                                      right_id))
     {
-        return insert_into_new_root(left, key, right);
+        CHECK(commit_node(parent));
+        // 자식의 parent는 그 자식을 가진 부모의 X latch를 잡고 고친다.
+        return update_parent_with_commit(right_id, parent.id);
     }
 
-    CHECK(load_node(parent));
+    return insert_into_node_after_splitting(parent, key, right_id, ancestors);
+}
+
+// left 뒤에 (k_prime, right의 leftmost)와 right의 entry를 붙인 것
+static std::vector<internal_t> joined(const node_t &left, keyType k_prime,
+                                      const node_t &right)
+{
+    std::vector<internal_t> entries, tail;
+    left.internal_read(entries);
+    right.internal_read(tail);
+    entries.push_back({ k_prime, right.leftmost() });
+    entries.insert(entries.end(), tail.begin(), tail.end());
+    return entries;
+}
 
-    int left_index = get_left_index(parent.node, left.id);
-    if (static_cast<int>(parent.node.nodePageHeader().numberOfKeys) <
-        internal_order - 1)
+bool BPTree::can_coalesce(const node_t &target, const node_t &neighbor,
+                          keyType k_prime) const
+{
+    if (!target.is_leaf())
     {
-        return insert_into_node(parent, left_index, key, right);
+        bool left = neighbor.low_key() < target.low_key();
+        return node_t::internal_fits(left ? joined(neighbor, k_prime, target)
+                                          : joined(target, k_prime, neighbor));
     }
 
-    return insert_into_node_after_splitting(parent, left_index, key, right);
+    int used = neighbor.leaf_used();
+    record_t rec;
+    for (int i = 0; i < target.number_of_keys(); ++i)
+    {
+        target.leaf_read(i, rec);
+        used += neighbor.leaf_cost(rec);
+    }
+    return used <= neighbor.leaf_capacity();
 }
 
 int BPTree::get_left_index(const node_t &parent, nodeId_t left_id) const
@@ -315,185 +694,279 @@ int BPTree::get_left_index(const node_t &parent, nodeId_t left_id) const
         return 0;
     }
 
-    int left_index =
-        parent.satisfy_condition_first<internal_t>([&left_id](auto &now) {
-            return now.node_id == left_id;
-        });
-    return left_index + 1;
+    return parent.index_child(left_id) + 1;
 }
 
-bool BPTree::load_node(node_tuple &target)
+bool BPTree::load_node(node_tuple &target, LatchMode mode)
 {
-    int result = manager.load(target.id, target.node);
-    CHECK_WITH_LOG(result != INVALID_BUFFER_INDEX, false,
+    // target이 이미 다른 node를 잡고 있었다면, 새 node를 잡은 뒤에 놓는다.
+    CHECK_WITH_LOG(manager.load(target.id, target.guard, mode), false,
                    "load node failure: %ld", target.id);
-    target.buffer_index = result;
     return true;
 }
 
-bool BPTree::commit_node(nodeId_t node_id, const node_t &node)
+bool BPTree::commit_node(node_tuple &target)
 {
-    CHECK_WITH_LOG(manager.commit(node_id, node), false,
-                   "commit node failure: %ld", node_id);
+    CHECK_WITH_LOG(target.guard, false, "commit node failure: %ld", target.id);
+    target.guard.mark_dirty();
     return true;
 }
 
-bool BPTree::commit_node(const node_tuple &target)
+bool BPTree::free_node(node_tuple &target)
 {
-    CHECK_WITH_LOG(manager.commit(target.id, target.node), false,
-                   "commit node failure: %ld", target.id);
+    // latch 없이 pin만 하고 기다리던 thread(find, update, scan cursor)가
+    // 빠진 node임을 알 수 있도록 비워 둔다. 비운 page는 leaf가 아니다.
+    target.node() = node_t {};
+    CHECK(commit_node(target));
+
+    // pin이 남아있으면 frame을 free 할 수 없으므로 나중에 free 한다.
+    target.guard.release();
+    if (!manager.try_free(target.id))
+    {
+        std::unique_lock<std::mutex> crit { garbage_latch };
+        garbage.push_back(target.id);
+    }
     return true;
 }
 
-bool BPTree::free_node(node_tuple &target)
+void BPTree::collect_garbage()
 {
-    CHECK_WITH_LOG(manager.free(target.id), false, "free page failure: %ld",
-                   target.id);
-    return true;
+    std::vector<nodeId_t> pages;
+    {
+        std::unique_lock<std::mutex> crit { garbage_latch };
+        pages.swap(garbage);
+    }
+
+    for (auto pagenum : pages)
+    {
+        if (!manager.try_free(pagenum))
+        {
+            std::unique_lock<std::mutex> crit { garbage_latch };
+            garbage.push_back(pagenum);
+        }
+    }
 }
 
-nodeId_t BPTree::create_node()
+bool BPTree::create_node(node_tuple &target)
 {
-    nodeId_t t = manager.create();
-    CHECK_WITH_LOG(t != INVALID_NODE_ID, INVALID_NODE_ID,
-                   "create node failure");
-    return t;
+    // 아무도 모르는 page이므로 X latch는 기다리지 않고 잡힌다.
+    target.id = manager.create();
+    CHECK_WITH_LOG(is_valid(target.id), false, "create node failure");
+    CHECK(load_node(target, LatchMode::EXCLUSIVE));
+    target.node() = node_t {};
+    target.node().set_low_key(MIN_KEY);
+    return true;
 }
 
-bool BPTree::insert_into_new_root(node_tuple &left, keyType key,
-                                  node_tuple &right)
+bool BPTree::insert_into_new_root(nodeId_t left_id, keyType key,
+                                  nodeId_t right_id, uint32_t level)
 {
-    node_tuple root = {create_node()};
-    CHECK(root);
+    node_tuple root;
+    CHECK(create_node(root));
 
-    root.node.set_leftmost(left.id);
-    root.node.emplace_back<internal_t>(key, right.id);
-
-    left.node.set_parent(root.id);
-    right.node.set_parent(root.id);
-
-    CHECK(commit_node(left));
-    CHECK(commit_node(right));
+    root.node().set_level(level);
+    root.node().set_leftmost(left_id);
+    CHECK(root.node().internal_assign({ { key, right_id } }));
     CHECK(commit_node(root));
 
-    CHECK(manager.set_root(root.id));
+    CHECK(update_parent_with_commit(left_id, root.id));
+    CHECK(update_parent_with_commit(right_id, root.id));
 
-    return true;
-}
+    CHECK(manager.set_root(root.id));
 
-bool BPTree::insert_into_node(node_tuple &parent, int left_index, keyType key,
-                              node_tuple &right)
-{
-    CHECK_WITH_LOG(left_index >= 0 && left_index < 248, false, "left_index: %d",
-                   left_index);
-    parent.node.insert<internal_t>({key, right.id}, left_index);
-    CHECK(commit_node(parent));
     return true;
 }
 
-bool BPTree::insert_into_node_after_splitting(node_tuple &parent,
-                                              int left_index, keyType key,
-                                              node_tuple &target)
+bool BPTree::insert_into_node_after_splitting(node_tuple &parent, keyType key,
+                                              nodeId_t right_id,
+                                              std::vector<nodeId_t> &ancestors)
 {
-    node_tuple right = {create_node()};
-    CHECK(right);
-
     std::vector<internal_t> temp;
-    temp.reserve(internal_order);
+    parent.node().internal_read(temp);
+    int insertion_index = parent.node().key_grt(key);
+    temp.insert(temp.begin() + insertion_index, { key, right_id });
+
+    // temp[split - 1]이 부모로 올라가고, 앞은 parent에 뒤는 right에 남는다.
+    // 새 key 때문에 너비가 늘어난 쪽은 entry가 덜 들어가므로, 가운데에서
+    // 가장 가까우면서 양쪽이 모두 들어가는 곳에서 나눈다.
+    int n = temp.size();
+    auto left_fits = [&](int split) {
+        return node_t::internal_fits({ temp.begin(), temp.begin() + split - 1 });
+    };
+    auto right_fits = [&](int split) {
+        return node_t::internal_fits({ temp.begin() + split, temp.end() });
+    };
+    // left_fits는 split이 작을수록, right_fits는 클수록 참이다.
+    int lo = 1, hi = n - 1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi + 1) / 2;
+        if (left_fits(mid))
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    int max_split = lo;
+    lo = 1, hi = n - 1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (right_fits(mid))
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    int min_split = lo;
 
-    auto back = std::back_inserter(temp);
-    parent.node.range_copy<internal_t>(back, 0, left_index);
-    back = {key, target.id};
-    parent.node.range_copy<internal_t>(back, left_index);
+    bool with_key = min_split <= max_split && left_fits(max_split) &&
+                    right_fits(min_split);
+    if (!with_key)
+    {
+        // 어떻게 나눠도 새 key가 있는 쪽이 넘친다. 새 key 없이 나누면 두 쪽
+        // 모두 원래 node의 일부라서 들어가므로, 먼저 나눈 뒤 다시 넣는다.
+        temp.erase(temp.begin() + insertion_index);
+        n = temp.size();
+    }
+    int split = with_key ? std::clamp(cut(n), min_split, max_split) : cut(n);
 
-    int split = cut(internal_order);
+    node_tuple right;
+    CHECK(create_node(right));
 
     keyType k_prime = temp[split - 1].key;
-
-    parent.node.range_assignment<internal_t>(temp.begin(),
-                                             temp.begin() + split - 1);
-
-    right.node.set_leftmost(temp[split - 1].node_id);
-    right.node.range_assignment<internal_t>(temp.begin() + split, temp.end());
-    right.node.set_parent(parent.node.parent());
-
-    CHECK(update_parent_with_commit(right.node.leftmost(), right.id));
-    for (auto &tmp : right.node.range<internal_t>())
+    CHECK(parent.node().internal_assign({ temp.begin(),
+                                          temp.begin() + split - 1 }));
+
+    right.node().set_level(parent.node().level());
+    right.node().set_leftmost(temp[split - 1].node_id);
+    CHECK(right.node().internal_assign({ temp.begin() + split, temp.end() }));
+
+    right.node().set_low_key(k_prime);
+    right.node().set_high_key(parent.node().high_key());
+    right.node().set_right_sibling(parent.node().right_sibling());
+    parent.node().set_high_key(k_prime);
+    parent.node().set_right_sibling(right.id);
+
+    // right_id가 parent에 남았으면 parent, right로 옮겨갔으면 아래에서 다시
+    // right로 고친다.
+    if (with_key)
     {
-        CHECK(update_parent_with_commit(tmp.node_id, right.id));
+        CHECK(update_parent_with_commit(right_id, parent.id));
+    }
+    CHECK(update_parent_with_commit(right.node().leftmost(), right.id));
+    for (int i = 0; i < right.node().number_of_keys(); ++i)
+    {
+        CHECK(update_parent_with_commit(right.node().internal_child(i),
+                                        right.id));
     }
 
     CHECK(commit_node(parent));
     CHECK(commit_node(right));
 
-    return insert_into_parent(parent, k_prime, right);
+    uint32_t level = parent.node().level();
+    CHECK(insert_into_parent(parent, k_prime, right, ancestors));
+    // 나눈 뒤에는 key를 맡는 node에 자리가 있다.
+    return with_key ||
+           insert_into_level(level, INVALID_NODE_ID, key, right_id, ancestors);
 }
 
 bool BPTree::delete_key(keyType key)
 {
-    if (!exist_key(key))
+    node_tuple leaf;
+    if (find_slot(key, leaf, LatchMode::EXCLUSIVE) == -1)
     {
         return false;
     }
 
-    node_tuple leaf;
-    CHECK(find_leaf(key, leaf));
+    if (is_safe(leaf.node()))
+    {
+        RecordCache::instance().erase(get_table_id(), key);
+        CHECK_WITH_LOG(remove_entry_from_node(leaf, key), false,
+                       "remove entry from node failure: %ld", key);
+        return commit_node(leaf);
+    }
 
-    CHECK_WITH_LOG(delete_entry(leaf, key), false, "delete entry failure");
+    // merge가 필요할 수 있으므로 X latch로 다시 내려간다.
+    leaf.guard.release();
 
-    return true;
+    bool result;
+    {
+        latch_path path;
+        CHECK(lock_path(key, path));
+        if (path.nodes.empty() ||
+            path.nodes.back().node().leaf_index(key) == -1)
+        {
+            return false;
+        }
+
+        RecordCache::instance().erase(get_table_id(), key);
+        result = delete_entry(path.nodes.back(), key);
+        CHECK_WITH_LOG(result, false, "delete entry failure");
+    }
+
+    // merge로 빠진 page는 latch를 모두 놓은 뒤에 free 한다.
+    collect_garbage();
+    return result;
 }
 
 bool BPTree::delete_entry(node_tuple &target, keyType key)
 {
     CHECK_WITH_LOG(remove_entry_from_node(target, key), false,
                    "remove entry from node failure: %ld", key);
-    CHECK(commit_node(target));
-
-    if (target.id == manager.root())
-    {
-        return adjust_root(target);
-    }
-
-    int min_keys;
-    if (delayed_min)
-    {
-        min_keys = delayed_min;
-    }
-    else
+    CHECK(commit_node(target));
+
+    // root_latch 없이 header의 root를 읽지 않도록, 부모가 없는 것으로 root를
+    // 알아본다.
+    if (!is_valid(target.node().parent()))
     {
-        min_keys =
-            target.node.is_leaf() ? cut(leaf_order - 1) : cut(leaf_order) - 1;
+        return adjust_root(target);
     }
 
-    if (static_cast<int>(target.node.number_of_keys()) >= min_keys)
+    if (static_cast<int>(target.node().number_of_keys()) >=
+        min_keys(target.node()))
     {
         return true;
     }
 
     node_tuple parent;
-    parent.id = target.node.parent();
+    parent.id = target.node().parent();
     CHECK(load_node(parent));
     CHECK(parent);
-    CHECK(parent.node.number_of_keys() > 0);
+    // 이웃을 잡지 못해 merge 하지 않은 node는 key가 없을 수 있다.
+    // 그러면 target의 이웃이 없으므로 그대로 둔다.
+    if (parent.node().number_of_keys() == 0)
+    {
+        return true;
+    }
 
-    int neighbor_index = get_left_index(parent.node, target.id) - 1;
+    int neighbor_index = get_left_index(parent.node(), target.id) - 1;
     int k_prime_index = neighbor_index == -1 ? 0 : neighbor_index;
-    keyType k_prime = parent.node.get<internal_t>(k_prime_index).key;
+    keyType k_prime = parent.node().internal_key(k_prime_index);
 
     node_tuple neighbor;
     neighbor.id =
         neighbor_index == -1
-            ? parent.node.get<internal_t>(0).node_id
+            ? parent.node().internal_child(0)
             : neighbor_index == 0
-                  ? parent.node.leftmost()
-                  : parent.node.get<internal_t>(neighbor_index - 1).node_id;
+                  ? parent.node().leftmost()
+                  : parent.node().internal_child(neighbor_index - 1);
     CHECK(load_node(neighbor));
+    // scan은 왼쪽 leaf의 latch를 잡은 채로 오른쪽 leaf를 기다리므로,
+    // 이웃을 기다리면 deadlock이 생길 수 있다. 못 잡으면 merge 하지 않고
+    // target을 덜 찬 채로 둔다.
+    if (!neighbor.guard.try_lock(LatchMode::EXCLUSIVE))
+    {
+        return true;
+    }
 
-    int capacity = target.node.is_leaf() ? leaf_order : internal_order - 1;
-
-    if (static_cast<int>(target.node.number_of_keys() +
-                         neighbor.node.number_of_keys()) < capacity)
+    if (can_coalesce(target.node(), neighbor.node(), k_prime))
     {
         if (neighbor_index == -1)
         {
@@ -513,17 +986,22 @@ bool BPTree::delete_entry(node_tuple &target, keyType key)
 
 bool BPTree::remove_entry_from_node(node_tuple &target, keyType key)
 {
-    if (target.node.is_leaf())
+    if (target.node().is_leaf())
     {
-        int idx = target.node.index_key<record_t>(key);
+        int idx = target.node().leaf_index(key);
         CHECK_WITH_LOG(idx != -1, false, "invalid key: %ld", key);
-        target.node.erase<record_t>(idx);
+        pagenum_t overflow = target.node().leaf_overflow(idx);
+        target.node().leaf_erase(idx);
+        if (is_valid(overflow))
+        {
+            CHECK(free_chain(overflow));
+        }
     }
     else
     {
-        int idx = target.node.index_key<internal_t>(key);
+        int idx = target.node().internal_index(key);
         CHECK_WITH_LOG(idx != -1, false, "invalid key: %ld", key);
-        target.node.erase<internal_t>(idx);
+        target.node().internal_erase(idx);
     }
 
     return true;
@@ -531,18 +1009,18 @@ bool BPTree::remove_entry_from_node(node_tuple &target, keyType key)
 
 bool BPTree::adjust_root(node_tuple &root)
 {
-    if (root.node.number_of_keys() > 0)
+    if (root.node().number_of_keys() > 0)
     {
         return true;
     }
 
-    if (root.node.is_leaf())
+    if (root.node().is_leaf())
     {
         CHECK(manager.set_root(INVALID_NODE_ID));
     }
     else
     {
-        nodeId_t new_root_id = root.node.leftmost();
+        nodeId_t new_root_id = root.node().leftmost();
         CHECK(manager.set_root(new_root_id));
 
         CHECK(update_parent_with_commit(new_root_id, INVALID_NODE_ID));
@@ -555,35 +1033,40 @@ bool BPTree::adjust_root(node_tuple &root)
 
 bool BPTree::update_parent_with_commit(nodeId_t target_id, nodeId_t parent_id)
 {
-    node_tuple temp{target_id};
+    node_tuple temp;
+    temp.id = target_id;
     CHECK(load_node(temp));
-    temp.node.set_parent(parent_id);
+    temp.node().set_parent(parent_id);
     CHECK(commit_node(temp));
 
     return true;
 }
 
 bool BPTree::coalesce_nodes(node_tuple &target, node_tuple &neighbor,
-                            node_tuple &parent, int k_prime)
+                            node_tuple &parent, keyType k_prime)
 {
-    if (target.node.is_leaf())
+    if (target.node().is_leaf())
     {
-        for (auto &rec : target.node.range<record_t>())
+        record_t rec;
+        for (int i = 0; i < target.node().number_of_keys(); ++i)
         {
-            neighbor.node.push_back(rec);
+            target.node().leaf_read(i, rec);
+            neighbor.node().leaf_insert(neighbor.node().number_of_keys(), rec);
         }
-        neighbor.node.set_next_leaf(target.node.next_leaf());
     }
     else
     {
-        neighbor.node.emplace_back<internal_t>(k_prime, target.node.leftmost());
-        CHECK(update_parent_with_commit(target.node.leftmost(), neighbor.id));
-        for (auto &internal : target.node.range<internal_t>())
+        CHECK(neighbor.node().internal_assign(
+            joined(neighbor.node(), k_prime, target.node())));
+        CHECK(update_parent_with_commit(target.node().leftmost(), neighbor.id));
+        for (int i = 0; i < target.node().number_of_keys(); ++i)
         {
-            neighbor.node.push_back(internal);
-            CHECK(update_parent_with_commit(internal.node_id, neighbor.id));
+            CHECK(update_parent_with_commit(target.node().internal_child(i),
+                                            neighbor.id));
         }
     }
+    neighbor.node().set_high_key(target.node().high_key());
+    neighbor.node().set_right_sibling(target.node().right_sibling());
 
     CHECK(commit_node(neighbor));
     CHECK(delete_entry(parent, k_prime));
@@ -593,59 +1076,95 @@ bool BPTree::coalesce_nodes(node_tuple &target, node_tuple &neighbor,
 }
 
 bool BPTree::redistribute_nodes(node_tuple &target, node_tuple &neighbor,
-                                node_tuple &parent, int k_prime,
+                                node_tuple &parent, keyType k_prime,
                                 int k_prime_index, int neighbor_index)
 {
-    if (neighbor_index != -1)
+    // 새 separator가 부모에 들어가지 않으면(PACKED 너비가 늘어나서) 옮기지
+    // 않고 target을 덜 찬 채로 둔다.
+    std::vector<internal_t> parent_entries;
+    parent.node().internal_read(parent_entries);
+    auto &separator = parent_entries[k_prime_index].key;
+
+    if (!target.node().is_leaf())
     {
-        // left neighbor
-        if (!target.node.is_leaf())
+        // k_prime이 target으로 내려오고 neighbor의 끝 key가 올라간다.
+        std::vector<internal_t> target_entries, neighbor_entries;
+        target.node().internal_read(target_entries);
+        neighbor.node().internal_read(neighbor_entries);
+        nodeId_t moved;
+        if (neighbor_index != -1)
         {
-            target.node.insert<internal_t>({k_prime, target.node.leftmost()},
-                                           0);
-
-            auto &new_one = neighbor.node.back<internal_t>();
-
-            parent.node.get<internal_t>(k_prime_index).key = new_one.key;
-            target.node.set_leftmost(new_one.node_id);
-
-            CHECK(update_parent_with_commit(new_one.node_id, target.id));
+            // left neighbor
+            target_entries.insert(target_entries.begin(),
+                                  { k_prime, target.node().leftmost() });
+            separator = neighbor_entries.back().key;
+            moved = neighbor_entries.back().node_id;
+            neighbor_entries.pop_back();
         }
         else
         {
-            target.node.insert(neighbor.node.back<record_t>(), 0);
+            // right neighbor
+            target_entries.push_back({ k_prime, neighbor.node().leftmost() });
+            separator = neighbor_entries.front().key;
+            moved = neighbor_entries.front().node_id;
+            neighbor_entries.erase(neighbor_entries.begin());
+        }
+        if (!node_t::internal_fits(target_entries) ||
+            !node_t::internal_fits(parent_entries))
+        {
+            return true;
+        }
 
-            parent.node.get<record_t>(k_prime_index).key =
-                target.node.first<record_t>().key;
+        CHECK(target.node().internal_assign(target_entries));
+        CHECK(neighbor.node().internal_assign(neighbor_entries));
+        if (neighbor_index != -1)
+        {
+            target.node().set_leftmost(moved);
+            CHECK(update_parent_with_commit(moved, target.id));
+        }
+        else
+        {
+            neighbor.node().set_leftmost(moved);
+            CHECK(update_parent_with_commit(target_entries.back().node_id,
+                                            target.id));
         }
     }
     else
     {
-        // right neighbor
-        if (!target.node.is_leaf())
+        // record 하나를 옮기고, 그 양쪽 key 사이에서 separator를 고른다.
+        record_t rec;
+        int from = neighbor_index != -1 ? neighbor.node().number_of_keys() - 1
+                                        : 0;
+        neighbor.node().leaf_read(from, rec);
+        CHECK(target.node().leaf_fits(rec));
+        separator = neighbor_index != -1
+                        ? shortest_separator(
+                              from > 0 ? neighbor.node().leaf_key(from - 1)
+                                       : neighbor.node().low_key(),
+                              rec.key)
+                        : shortest_separator(rec.key,
+                                             neighbor.node().leaf_key(1));
+        if (!node_t::internal_fits(parent_entries))
         {
-            target.node.emplace_back<internal_t>(k_prime,
-                                                 neighbor.node.leftmost());
-
-            auto &leftmost = neighbor.node.first<internal_t>();
-            parent.node.get<internal_t>(k_prime_index).key = leftmost.key;
-            neighbor.node.set_leftmost(leftmost.node_id);
-
-            CHECK(update_parent_with_commit(
-                target.node.back<internal_t>().node_id, target.id));
-
-            target.node.erase<internal_t>(0);
+            return true;
         }
-        else
-        {
-            target.node.push_back(neighbor.node.first<record_t>());
 
-            parent.node.get<record_t>(k_prime_index).key =
-                neighbor.node.get<record_t>(1).key;
+        int to = neighbor_index != -1 ? 0 : target.node().number_of_keys();
+        target.node().leaf_insert(to, rec);
+        neighbor.node().leaf_erase(from);
+    }
 
-            neighbor.node.erase<record_t>(0);
-        }
+    if (neighbor_index != -1)
+    {
+        neighbor.node().set_high_key(separator);
+        target.node().set_low_key(separator);
+    }
+    else
+    {
+        target.node().set_high_key(separator);
+        neighbor.node().set_low_key(separator);
     }
+    CHECK(parent.node().internal_assign(parent_entries));
 
     CHECK(commit_node(target));
     CHECK(commit_node(neighbor));
@@ -654,27 +1173,50 @@ bool BPTree::redistribute_nodes(node_tuple &target, node_tuple &neighbor,
     return true;
 }
 
-bool BPTree::exist_key(keyType key)
+int BPTree::find_slot(keyType key, node_tuple &leaf, LatchMode leaf_mode)
 {
-    node_tuple leaf;
-    if (!find_leaf(key, leaf))
+    if (!find_leaf(key, leaf, leaf_mode))
     {
-        return false;
+        return -1;
     }
 
-    int i = leaf.node.index_key<record_t>(key);
-    if (i == -1)
+    return leaf.node().leaf_index(key);
+}
+
+bool BPTree::find(keyType key, record_t &ret, int transaction_id)
+{
+    int length;
+    ret.value.fill(0);
+    if (!find(key, ret.value.data(), max_value_length, length, transaction_id))
     {
         return false;
     }
-
+    ret.key = key;
+    ret.length = std::min(length, max_value_length);
+    ret.overflow = EMPTY_PAGE_NUMBER;
     return true;
 }
 
-bool BPTree::find(keyType key, record_t &ret, int transaction_id)
+bool BPTree::find(keyType key, uint8_t *buffer, int capacity, int &length,
+                  int transaction_id)
 {
-    std::unique_lock<std::mutex> buffer_latch{
-        BufferController::instance().mtx};
+    // update와 마찬가지로 record lock을 얻은 뒤에 page latch를 잡는다.
+    // record cache도 lock을 얻은 뒤에 본다.
+    bool need_lock =
+        transaction_id != TransactionManager::invliad_transaction_id;
+    auto &cache = RecordCache::instance();
+    if (cache.enabled())
+    {
+        if (need_lock && !lock_record(key, LockMode::SHARED, transaction_id))
+        {
+            return false;
+        }
+        need_lock = false;
+        if (cache.find(get_table_id(), key, buffer, capacity, length))
+        {
+            return true;
+        }
+    }
 
     node_tuple leaf;
     if (!find_leaf(key, leaf))
@@ -682,83 +1224,759 @@ bool BPTree::find(keyType key, record_t &ret, int transaction_id)
         return false;
     }
 
-    scoped_node_latch_shared latch_shared{ manager.get_manager_id(), leaf.id };
+    if (need_lock && !lock_record(key, LockMode::SHARED, transaction_id))
+    {
+        return false;
+    }
 
-    if (transaction_id != TransactionManager::invliad_transaction_id)
+    // lock을 기다리는 사이 split / merge로 record가 다른 leaf로 옮겨갔을 수
+    // 있으므로, 없으면 latch를 잡고 다시 내려가서 확인한다.
+    leaf.guard.lock(LatchMode::SHARED);
+    int i = leaf.node().is_leaf() ? leaf.node().leaf_index(key) : -1;
+    if (i == -1)
+    {
+        leaf.guard.unlock();
+        i = find_slot(key, leaf, LatchMode::SHARED);
+    }
+    if (i == -1)
     {
-        std::unique_lock<std::mutex> trx_latch{
-            TransactionManager::instance().mtx};
+        return false;
+    }
 
-        auto &trx = TransactionManager::instance().get(transaction_id);
+    record_t cell;
+    leaf.node().leaf_read(i, cell);
+    // S latch를 잡고 있는 동안 넣어야 update가 지운 뒤에 이전 value가
+    // 들어가지 않는다. overflow page chain에 있는 value는 넣지 않는다.
+    if (cache.enabled() && !is_valid(cell.overflow))
+    {
+        cache.insert(get_table_id(), key, cell.value.data(), cell.length);
+    }
+    return read_value(cell, buffer, capacity, length);
+}
 
-        auto [lock, state] = TransactionManager::instance().lock_acquire(
-            get_table_id(), key, transaction_id, LockMode::SHARED);
-        switch (state)
+bool BPTree::lock_record(keyType key, LockMode mode, int transaction_id)
+{
+    // 서로 다른 record의 lock은 LockManager의 partition latch만 거친다.
+    auto [lock, state] = TransactionManager::instance().lock_acquire(
+        get_table_id(), key, transaction_id, mode);
+    switch (state)
+    {
+    case LockState::INVALID:
+        return false;
+    case LockState::ACQUIRED:
+        break;
+    case LockState::ABORTED:
+        TransactionManager::instance().abort(transaction_id);
+        return false;
+    case LockState::WAITING:
+        if (!TransactionManager::instance().lock_wait(lock))
         {
-        case LockState::INVALID:
-            return false;
-        case LockState::ACQUIRED:
-            break;
-        case LockState::ABORTED:
-            // abort 시에는 page latch를 잡고 있어야 할 이유가 없다.
-            // latch_shared.unlock_shared();
             TransactionManager::instance().abort(transaction_id);
             return false;
-        case LockState::WAITING:
-            trx.mtx.lock();
-            trx_latch.unlock();
-            latch_shared.unlock_shared();
-            buffer_latch.unlock();
-            trx.mtx.unlock();
-            TransactionManager::instance().lock_wait(lock);
-            buffer_latch.lock();
-            latch_shared.lock_shared();
         }
     }
 
-    buffer_latch.unlock();
+    return true;
+}
+
+bool BPTree::scan_open(scan_cursor &cursor, keyType lo, keyType hi,
+                       int transaction_id)
+{
+    cursor.lo = lo;
+    cursor.hi = hi;
+    cursor.transaction_id = transaction_id;
+    cursor.started = false;
+    cursor.batch.clear();
+    cursor.pos = 0;
+    // 빈 tree면 처음부터 끝난 cursor다.
+    cursor.done = lo > hi || !find_leaf(lo, cursor.leaf);
+    return true;
+}
 
-    int i = leaf.node.index_key<record_t>(key);
-    if (i == -1)
+ScanResult BPTree::scan_next(scan_cursor &cursor, record_t &ret)
+{
+    if (cursor.pos == cursor.batch.size())
     {
-        return false;
+        if (!fill_scan_batch(cursor))
+        {
+            scan_close(cursor);
+            return ScanResult::ABORTED;
+        }
+        if (cursor.batch.empty())
+        {
+            scan_close(cursor);
+            return ScanResult::END;
+        }
+    }
+
+    ret = cursor.batch[cursor.pos++];
+    return ScanResult::FOUND;
+}
+
+void BPTree::scan_close(scan_cursor &cursor)
+{
+    cursor.done = true;
+    cursor.batch.clear();
+    cursor.pos = 0;
+    cursor.leaf.guard.release();
+    cursor.leaf.id = INVALID_NODE_ID;
+}
+
+bool BPTree::scan(keyType lo, keyType hi,
+                  const std::function<bool(const record_t &)> &callback,
+                  int transaction_id)
+{
+    scan_cursor cursor;
+    CHECK(scan_open(cursor, lo, hi, transaction_id));
+
+    record_t rec;
+    ScanResult result;
+    while ((result = scan_next(cursor, rec)) == ScanResult::FOUND)
+    {
+        if (!callback(rec))
+        {
+            scan_close(cursor);
+            return true;
+        }
     }
- 
-    ret = leaf.node.get<record_t>(i);
 
+    return result == ScanResult::END;
+}
+
+bool BPTree::fill_scan_batch(scan_cursor &cursor)
+{
+    cursor.batch.clear();
+    cursor.pos = 0;
+    if (cursor.done)
+    {
+        return true;
+    }
+
+    // 현재 leaf에서 last_key 다음부터 hi까지를 읽는다. 읽을 게 없으면 leaf
+    // latch를 잡은 채로 다음 leaf를 잡고 넘어간다.
+    auto &guard = cursor.leaf.guard;
+    guard.lock(LatchMode::SHARED);
+
+    std::vector<keyType> keys;
+    while (!cursor.done && cursor.batch.empty())
+    {
+        // merge로 빠진 leaf에 pin 해 두었으면 root부터 다시 찾는다.
+        if (!cursor.leaf.node().is_leaf())
+        {
+            guard.unlock();
+            if (!find_leaf(cursor.started ? cursor.last_key : cursor.lo,
+                           cursor.leaf, LatchMode::SHARED))
+            {
+                cursor.done = true;
+                break;
+            }
+            continue;
+        }
+
+        const auto &node = cursor.leaf.node();
+        int n = node.number_of_keys();
+        int i = cursor.started ? node.leaf_upper_bound(cursor.last_key)
+                               : node.leaf_lower_bound(cursor.lo);
+
+        keys.clear();
+        for (; i < n && node.leaf_key(i) <= cursor.hi; ++i)
+        {
+            keys.push_back(node.leaf_key(i));
+        }
+
+        if (keys.empty())
+        {
+            nodeId_t next = node.next_leaf();
+            if (i < n || !is_valid(next))
+            {
+                cursor.done = true;
+                break;
+            }
+            cursor.leaf.id = next;
+            CHECK(manager.load(next, guard, LatchMode::SHARED));
+            continue;
+        }
+
+        // find와 마찬가지로 lock은 latch를 놓고 얻는다. 그 사이 split으로
+        // 오른쪽 leaf로 옮겨간 record는 여기서 빠지고, 다음 leaf에서 읽힌다.
+        if (cursor.transaction_id != TransactionManager::invliad_transaction_id)
+        {
+            guard.unlock();
+            for (auto key : keys)
+            {
+                if (!lock_record(key, LockMode::SHARED, cursor.transaction_id))
+                {
+                    return false;
+                }
+            }
+            guard.lock(LatchMode::SHARED);
+        }
+
+        for (auto key : keys)
+        {
+            int j = node.leaf_index(key);
+            if (j == -1)
+            {
+                continue;
+            }
+            auto &rec = cursor.batch.emplace_back();
+            node.leaf_read(j, rec);
+            if (is_valid(rec.overflow))
+            {
+                CHECK(read_overflow(rec));
+            }
+            cursor.started = true;
+            cursor.last_key = key;
+        }
+    }
+
+    guard.unlock();
     return true;
 }
 
-bool BPTree::find_leaf(keyType key, node_tuple &node)
+// n개를 m개의 group으로 고르게 나눌 때 j번째 group의 시작 위치.
+// 앞의 n % m개 group이 하나씩 더 갖는다.
+static std::size_t group_begin(std::size_t n, std::size_t m, std::size_t j)
+{
+    return j * (n / m) + std::min(j, n % m);
+}
+
+// n개를 m개의 group으로 고르게 나눌 때 i번째가 속하는 group
+static std::size_t group_of(std::size_t n, std::size_t m, std::size_t i)
+{
+    std::size_t q = n / m;
+    std::size_t r = n % m;
+    if (i < r * (q + 1))
+    {
+        return i / (q + 1);
+    }
+    return r + (i - r * (q + 1)) / q;
+}
+
+static std::size_t ceil_div(std::size_t a, std::size_t b)
+{
+    return (a + b - 1) / b;
+}
+
+bool BPTree::bulk_load(std::size_t count,
+                       const std::function<bool(record_t &)> &next,
+                       double fill_factor)
 {
-    node.id = manager.root();
-    if (!is_valid(node.id))
+    // 다 만들 때까지 다른 thread가 빈 tree에 insert 하지 못하게 막는다.
+    std::unique_lock<std::shared_mutex> root_lock { root_latch };
+    if (is_valid(manager.root()))
+    {
+        root_lock.unlock();
+        record_t rec;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            CHECK_WITH_LOG(next(rec), false, "bulk load input ended early");
+            CHECK(insert(rec));
+        }
+        return true;
+    }
+    if (count == 0)
+    {
+        return true;
+    }
+
+    // leaf는 record를 byte로 fill_factor 만큼 채운다. 반올림해서
+    // fill_factor에 가장 가까워질 때까지 넣는다.
+    node_t probe {};
+    probe.leaf_init(leaf_format);
+    const int leaf_capacity = probe.leaf_capacity();
+    const double leaf_limit = fill_factor * leaf_capacity;
+    auto leaf_room = [&](int used, int cost) {
+        return used == 0 ||
+               (used + cost / 2.0 <= leaf_limit && used + cost <= leaf_capacity);
+    };
+    // level 1은 leaf를 앞에서부터 fanout개씩 묶는다. 마지막 묶음이 leaf
+    // 하나뿐이면 앞 묶음에 붙이므로 한 자리를 남겨 둔다.
+    // internal node가 key를 적어도 하나 갖도록 fanout은 4 이상으로 한다.
+    const int fanout = std::clamp(
+        static_cast<int>(std::lround(fill_factor * internal_order)), 4,
+        internal_order - 1);
+    const int upper_fanout = std::clamp(
+        static_cast<int>(std::lround(fill_factor * internal_order)), 4,
+        internal_order);
+
+    // value 길이에 따라 leaf가 담는 record 수가 달라서, 다 읽기 전에는 leaf
+    // 수를 모른다. leaf의 부모(level 1)는 모든 value가 가장 길 때의 수만큼
+    // leaf 앞에 자리를 잡아 두고, 남은 자리는 마지막에 돌려준다. 그러면
+    // leaf를 만들면서 부모의 pagenum을 알 수 있어서, leaf를 한 번씩만
+    // pagenum 순서대로 쓰면 된다. 그 위 level은 leaf를 다 쓴 뒤에 만든다.
+    record_t longest;
+    longest.length = max_value_length;
+    std::size_t min_records = 0;
+    for (int used = 0, cost = probe.leaf_cost(longest);
+         leaf_room(used, cost); used += cost)
+    {
+        ++min_records;
+    }
+    const std::size_t max_parents =
+        count <= min_records ? 0
+                             : ceil_div(ceil_div(count, min_records), fanout);
+
+    // 실패하면 잡았던 page를 모두 돌려준다.
+    std::vector<std::pair<nodeId_t, std::size_t>> extents;
+    auto extend = [&](std::size_t pages) {
+        nodeId_t id = manager.extend(pages);
+        if (is_valid(id))
+        {
+            extents.emplace_back(id, pages);
+        }
+        return id;
+    };
+
+    std::vector<node_t> chunk;
+    chunk.reserve(BULK_LOAD_CHUNK_PAGES);
+    nodeId_t chunk_id = INVALID_NODE_ID;
+    auto flush = [&]() {
+        bool result = manager.commit_pages(chunk_id, chunk.data(), chunk.size());
+        chunk_id += chunk.size();
+        chunk.clear();
+        return result;
+    };
+
+    nodeId_t parent_base = INVALID_NODE_ID;
+    nodeId_t leaf_base = INVALID_NODE_ID;
+    // 각 level의 첫 pagenum과 node 수. level 0이 leaf, 마지막 level이 root
+    std::vector<nodeId_t> first_ids;
+    std::vector<std::size_t> sizes;
+    // 각 node의 첫 key. 부모의 separator이자 node의 low key가 된다.
+    std::vector<keyType> first_keys;
+
+    // 모은 leaf를 파일 끝에 잡은 자리에 쓴다. 잡는 자리는 앞의 leaf에
+    // 이어지므로 leaf는 pagenum이 연속이다.
+    std::size_t leaves_written = 0;
+    auto flush_leaves = [&](bool last) {
+        nodeId_t id = extend(chunk.size());
+        CHECK_WITH_LOG(is_valid(id), false, "bulk load extend failure");
+        if (leaves_written == 0)
+        {
+            leaf_base = id;
+        }
+        CHECK_WITH_LOG(id == leaf_base + leaves_written, false,
+                       "bulk load leaves are not contiguous: %ld", id);
+        for (std::size_t k = 0; k < chunk.size(); ++k)
+        {
+            chunk[k].set_next_leaf(id + k + 1);
+        }
+        if (last)
+        {
+            chunk.back().set_next_leaf(INVALID_NODE_ID);
+        }
+        leaves_written += chunk.size();
+        chunk_id = id;
+        return flush();
+    };
+
+    auto build_leaves = [&]() {
+        if (max_parents)
+        {
+            parent_base = extend(max_parents);
+            CHECK_WITH_LOG(is_valid(parent_base), false,
+                           "bulk load extend failure");
+        }
+
+        record_t rec;
+        keyType prev_key = 0;
+        node_t *leaf = nullptr;
+        int used = 0;
+        for (std::size_t read = 0; read < count; ++read)
+        {
+            CHECK_WITH_LOG(next(rec), false, "bulk load input ended early");
+            CHECK_WITH_LOG(read == 0 || prev_key < rec.key, false,
+                           "bulk load input is not sorted: %ld", rec.key);
+            CHECK_WITH_LOG(rec.length <= leaf_value_limit(leaf_format), false,
+                           "bulk load value is too long: %ld", rec.key);
+            keyType last_key = prev_key;
+            prev_key = rec.key;
+
+            int cost = probe.leaf_cost(rec);
+            if (!leaf || !leaf_room(used, cost))
+            {
+                // leaf 사이의 separator는 split과 같이 앞 leaf의 마지막 key와
+                // 이 key 사이에서 고른다.
+                keyType separator = rec.key;
+                if (leaf)
+                {
+                    separator = shortest_separator(last_key, rec.key);
+                    leaf->set_high_key(separator);
+                }
+                if (chunk.size() == BULK_LOAD_CHUNK_PAGES)
+                {
+                    CHECK(flush_leaves(false));
+                }
+                std::size_t j = first_keys.size();
+                leaf = &chunk.emplace_back();
+                leaf->leaf_init(leaf_format);
+                leaf->set_parent(max_parents ? parent_base + j / fanout
+                                             : INVALID_NODE_ID);
+                leaf->set_low_key(j == 0 ? MIN_KEY : separator);
+                first_keys.push_back(separator);
+                used = 0;
+            }
+            leaf->leaf_insert(leaf->number_of_keys(), rec);
+            used += cost;
+        }
+
+        // 마지막 leaf는 아직 chunk에 있으므로 부모를 바꿀 수 있다.
+        std::size_t leaves = first_keys.size();
+        if (leaves == 1)
+        {
+            leaf->set_parent(INVALID_NODE_ID);
+        }
+        else if (leaves % fanout == 1)
+        {
+            leaf->set_parent(leaf->parent() - 1);
+        }
+        return flush_leaves(true);
+    };
+
+    // level의 j번째 node가 갖는 자식의 범위 (아래 level의 index)
+    auto children = [&](std::size_t level, std::size_t j) {
+        if (level == 1)
+        {
+            return std::make_pair(j * fanout, j + 1 == sizes[1]
+                                                  ? sizes[0]
+                                                  : (j + 1) * fanout);
+        }
+        return std::make_pair(group_begin(sizes[level - 1], sizes[level], j),
+                              group_begin(sizes[level - 1], sizes[level], j + 1));
+    };
+
+    auto build_internals = [&]() {
+        std::size_t leaves = first_keys.size();
+        sizes = { leaves };
+        first_ids = { leaf_base };
+        if (leaves == 1)
+        {
+            return true;
+        }
+
+        sizes.push_back(ceil_div(leaves, fanout) - (leaves % fanout == 1));
+        first_ids.push_back(parent_base);
+        std::size_t upper = 0;
+        while (sizes.back() > 1)
+        {
+            sizes.push_back(ceil_div(sizes.back(), upper_fanout));
+            upper += sizes.back();
+        }
+        if (upper)
+        {
+            nodeId_t id = extend(upper);
+            CHECK_WITH_LOG(is_valid(id), false, "bulk load extend failure");
+            for (std::size_t level = 2; level < sizes.size(); ++level)
+            {
+                first_ids.push_back(id);
+                id += sizes[level];
+            }
+        }
+
+        auto parent_of = [&](std::size_t level, std::size_t j) -> nodeId_t {
+            if (level + 1 == sizes.size())
+            {
+                return INVALID_NODE_ID;
+            }
+            return first_ids[level + 1] +
+                   group_of(sizes[level], sizes[level + 1], j);
+        };
+
+        for (std::size_t level = 1; level < sizes.size(); ++level)
+        {
+            // level 1은 leaf 앞에 잡은 자리에, 그 위는 leaf 뒤에 쓴다.
+            if (level <= 2)
+            {
+                CHECK(chunk.empty() || flush());
+                chunk_id = first_ids[level];
+            }
+            std::vector<keyType> keys(sizes[level]);
+            std::vector<internal_t> entries;
+            for (std::size_t j = 0; j < sizes[level]; ++j)
+            {
+                if (chunk.size() == BULK_LOAD_CHUNK_PAGES)
+                {
+                    CHECK(flush());
+                }
+                auto &node = chunk.emplace_back();
+                auto [begin, end] = children(level, j);
+                node.set_parent(parent_of(level, j));
+                node.set_level(level);
+                node.set_low_key(j == 0 ? MIN_KEY : first_keys[begin]);
+                if (j + 1 < sizes[level])
+                {
+                    node.set_high_key(first_keys[end]);
+                    node.set_right_sibling(first_ids[level] + j + 1);
+                }
+                node.set_leftmost(first_ids[level - 1] + begin);
+                entries.clear();
+                for (auto c = begin + 1; c < end; ++c)
+                {
+                    entries.push_back({ first_keys[c], first_ids[level - 1] + c });
+                }
+                CHECK_WITH_LOG(node.internal_assign(entries), false,
+                               "bulk load internal node overflow");
+                keys[j] = first_keys[begin];
+            }
+            first_keys.swap(keys);
+        }
+        return flush();
+    };
+
+    if (!build_leaves() || !build_internals())
     {
+        // root를 바꾸기 전이므로 잡아둔 page를 돌려주기만 하면 된다.
+        for (auto [base, pages] : extents)
+        {
+            for (std::size_t i = 0; i < pages; ++i)
+            {
+                manager.free(base + i);
+            }
+        }
         return false;
     }
 
-    CHECK(load_node(node));
+    // level 1에 쓰지 않은 자리를 돌려준다.
+    std::size_t parents = sizes.size() > 1 ? sizes[1] : 0;
+    for (std::size_t i = parents; i < max_parents; ++i)
+    {
+        manager.free(parent_base + i);
+    }
+
+    // root가 disk에 없는 page를 가리키지 않도록 page를 먼저 내린다.
+    CHECK_WITH_LOG(manager.sync(), false, "bulk load sync failure");
+    CHECK(manager.set_root(first_ids.back()));
+    return true;
+}
+
+int BPTree::set_leaf_format(LeafFormat format)
+{
+    CHECK_RET(leaf_has_cells(format), -1);
+
+    int skipped = 0;
+    bool records_left = false;
+    keyType key = std::numeric_limits<keyType>::min();
+    while (true)
+    {
+        // 바꾸는 leaf를 다른 thread가 나누거나 합치지 못하게 한다.
+        std::unique_lock<std::shared_mutex> smo_lock { smo_latch };
+        std::vector<nodeId_t> ancestors;
+        node_tuple leaf;
+        if (!find_node(key, 0, leaf, LatchMode::EXCLUSIVE, &ancestors))
+        {
+            break;
+        }
+
+        auto &node = leaf.node();
+        if (node.leaf_format() != format)
+        {
+            // 다시 쓰면 cell이 옮겨가므로 compact와 같은 조건에서만 한다.
+            if (!can_reorganize(node))
+            {
+                ++skipped;
+                records_left |= !leaf_has_cells(node.leaf_format());
+            }
+            else if (node.leaf_convert(format))
+            {
+                CHECK_RET(commit_node(leaf), -1);
+            }
+            else
+            {
+                // 새 형식에서 더 커지는 leaf는 나눈 뒤 같은 key부터 다시 본다.
+                CHECK_RET(node.number_of_keys() >= 2, -1);
+                CHECK_RET(split_leaf(leaf, nullptr, ancestors), -1);
+                continue;
+            }
+        }
+
+        if (!is_valid(node.next_leaf()))
+        {
+            break;
+        }
+        key = node.high_key();
+    }
+
+    // Records leaf가 남아 있으면 그 leaf에 overflow page chain이 들어가지
+    // 않도록 table의 형식은 그대로 둔다.
+    if (!records_left)
+    {
+        CHECK_RET(manager.set_leaf_format(format), -1);
+        leaf_format = format;
+        leaf_order = leaf_order_of(format);
+    }
+    // 형식에 따라 value를 읽는 길이가 달라질 수 있다.
+    RecordCache::instance().erase_table(get_table_id());
+    return skipped;
+}
+
+bool BPTree::find_leaf(keyType key, node_tuple &node, LatchMode leaf_mode)
+{
+    return find_node(key, 0, node, leaf_mode);
+}
+
+// free_node가 비운 page. 살아있는 internal node는 leftmost가 항상 있다.
+static bool is_dead(const node_t &node)
+{
+    return !node.is_leaf() && node.leftmost() == INVALID_NODE_ID;
+}
+
+bool BPTree::find_node(keyType key, uint32_t level, node_tuple &node,
+                       LatchMode mode, std::vector<nodeId_t> *ancestors)
+{
+    // B-link: 부모의 latch를 잡은 채로 자식을 pin 하고, 부모를 놓은 뒤에
+    // 자식을 latch 한다. pin 되어 있는 동안에는 merge 되어도 page가 free
+    // 되지 않으므로, 빠진 node인지 보고 root부터 다시 내려가면 된다.
+    while (true)
+    {
+        {
+            std::shared_lock<std::shared_mutex> root_lock { root_latch };
+            node.id = manager.root();
+            if (!is_valid(node.id))
+            {
+                node.guard.release();
+                return false;
+            }
+            CHECK(load_node(node));
+        }
+
+        bool restart = false;
+        while (true)
+        {
+            if (!move_right(key, node, LatchMode::SHARED))
+            {
+                restart = true;
+                break;
+            }
+
+            uint32_t now = node.node().level();
+            if (now < level)
+            {
+                node.guard.release();
+                node.id = INVALID_NODE_ID;
+                return false;
+            }
+            if (now == level)
+            {
+                break;
+            }
+
+            if (ancestors)
+            {
+                if (ancestors->size() <= now)
+                {
+                    ancestors->resize(now + 1, INVALID_NODE_ID);
+                }
+                (*ancestors)[now] = node.id;
+            }
+
+            nodeId_t child = node.node().internal_child_for(key);
+            page_guard parent = std::move(node.guard);
+            node.id = child;
+            CHECK(load_node(node));
+        }
+        if (restart)
+        {
+            continue;
+        }
+
+        if (mode == LatchMode::SHARED)
+        {
+            return true;
+        }
+        // latch를 바꾸는 사이에 split / merge 되었을 수 있으므로 다시 본다.
+        node.guard.unlock();
+        if (mode == LatchMode::NONE || move_right(key, node, mode))
+        {
+            return true;
+        }
+    }
+}
+
+bool BPTree::move_right(keyType key, node_tuple &node, LatchMode mode)
+{
+    node.guard.lock(mode);
+    while (true)
+    {
+        const auto &page = node.node();
+        if (is_dead(page) || key < page.low_key())
+        {
+            node.guard.unlock();
+            return false;
+        }
+
+        nodeId_t right = page.right_sibling();
+        if (!is_valid(right) || key < page.high_key())
+        {
+            return true;
+        }
 
-    // TODO: latch crabbing
+        // scan과 같이 왼쪽 node의 latch를 잡은 채로 오른쪽 node를 기다린다.
+        page_guard left = std::move(node.guard);
+        node.id = right;
+        CHECK(load_node(node, mode));
+    }
+}
 
-    while (!node.node.is_leaf())
+bool BPTree::lock_path(keyType key, latch_path &path)
+{
+    // split이 진행 중이지 않으므로 부모의 key가 모두 들어가 있고, right
+    // link를 따라갈 필요가 없다.
+    path.smo_lock = std::unique_lock<std::shared_mutex> { smo_latch };
+    path.root_lock = std::unique_lock<std::shared_mutex> { root_latch };
+    nodeId_t id = manager.root();
+    while (is_valid(id))
     {
-        int idx = node.node.key_grt(key) - 1;
-        node.id = (idx == -1) ? node.node.leftmost()
-                              : node.node.get<internal_t>(idx).node_id;
-        CHECK(load_node(node));
+        auto &node = path.nodes.emplace_back();
+        node.id = id;
+        CHECK(load_node(node, LatchMode::EXCLUSIVE));
+
+        // 이 node에서 merge가 멈추므로 위의 latch는 필요 없다.
+        if (is_safe(node.node()))
+        {
+            if (path.root_lock)
+            {
+                path.root_lock.unlock();
+            }
+            while (path.nodes.size() > 1)
+            {
+                path.nodes.pop_front();
+            }
+        }
+
+        if (node.node().is_leaf())
+        {
+            break;
+        }
+        id = node.node().internal_child_for(key);
     }
 
     return true;
 }
 
+bool BPTree::is_safe(const node_t &node) const
+{
+    // root는 key가 하나도 남지 않을 때 바뀐다.
+    int n = node.number_of_keys();
+    return n - 1 >= std::max(min_keys(node), 1);
+}
+
+int BPTree::min_keys(const node_t &node) const
+{
+    if (delayed_min)
+    {
+        return delayed_min;
+    }
+    return node.is_leaf() ? cut(leaf_order - 1) : cut(leaf_order) - 1;
+}
+
 bool BPTree::start_new_tree(const record_t &rec)
 {
-    node_tuple root = {create_node()};
-    root.node.set_is_leaf(true);
-    CHECK(root);
+    node_tuple root;
+    CHECK(create_node(root));
+    root.node().leaf_init(leaf_format);
 
-    root.node.insert(rec, 0);
+    root.node().leaf_insert(0, rec);
 
     CHECK(commit_node(root));
     CHECK(manager.set_root(root.id));
@@ -25,80 +25,87 @@ bool BufferManager::close()
     return true;
 }
 
-bool BufferManager::open(const std::string &name)
+bool BufferManager::open(const std::string &name, FileFormat format,
+                         LeafFormat leaf_format)
 {
     auto &bc = BufferController::instance();
-    manager_id = bc.openFileManager(name);
+    manager_id = bc.openFileManager(name, format);
     fileManager = &bc.getFileManager(manager_id);
     CHECK_WITH_LOG(fileManager, false, "buffer manager open failure: %s",
                    name.c_str());
     fileManager->set_buffer_manager(this);
-    CHECK(fileManager->init_file_if_created());
+    CHECK(fileManager->init_file_if_created(leaf_format));
     return true;
 }
 
-int BufferManager::load(pagenum_t pagenum, page_t &page)
+bool BufferManager::load(pagenum_t pagenum, page_guard &guard, LatchMode mode)
 {
-    int result = BufferController::instance().get(manager_id, pagenum, page);
-    return result;
+    return guard.acquire(manager_id, pagenum, mode);
 }
 
-bool BufferManager::commit(pagenum_t pagenum, const page_t &page)
+pagenum_t BufferManager::create()
 {
-    return BufferController::instance().put(manager_id, pagenum, page);
+    return BufferController::instance().create(manager_id);
 }
 
-void BufferManager::release(pagenum_t pagenum)
+bool BufferManager::free(pagenum_t pagenum)
 {
-    BufferController::instance().release_frame(manager_id, pagenum);
+    return BufferController::instance().free(manager_id, pagenum);
 }
 
-void BufferManager::retain(pagenum_t pagenum)
+bool BufferManager::try_free(pagenum_t pagenum)
 {
-    BufferController::instance().retain_frame(manager_id, pagenum);
+    return BufferController::instance().try_free(manager_id, pagenum);
 }
 
-void BufferManager::release_shared(pagenum_t pagenum)
+int BufferManager::get_manager_id() const
 {
-    BufferController::instance().release_frame_shared(manager_id, pagenum);
+    return manager_id;
 }
 
-void BufferManager::retain_shared(pagenum_t pagenum)
+pagenum_t BufferManager::root() const
 {
-    BufferController::instance().retain_frame_shared(manager_id, pagenum);
+    return fileManager->root();
 }
 
-pagenum_t BufferManager::create()
+bool BufferManager::set_root(pagenum_t pagenum)
 {
-    return BufferController::instance().frame_id_to_pagenum(
-        BufferController::instance().create(manager_id));
+    return fileManager->set_root(pagenum);
 }
 
-bool BufferManager::free(pagenum_t pagenum)
+LeafFormat BufferManager::leaf_format() const
 {
-    return BufferController::instance().free(manager_id, pagenum);
+    return fileManager->leaf_format();
 }
 
-int BufferManager::get_manager_id() const
+bool BufferManager::set_leaf_format(LeafFormat format)
 {
-    return manager_id;
+    return fileManager->set_leaf_format(format);
 }
 
-pagenum_t BufferManager::root() const
+pagenum_t BufferManager::extend(pagenum_t count)
 {
-    return fileManager->root();
+    return fileManager->extend(count);
 }
 
-bool BufferManager::set_root(pagenum_t pagenum)
+bool BufferManager::commit_pages(pagenum_t pagenum, const page_t* pages,
+                                 std::size_t count)
 {
-    return fileManager->set_root(pagenum);
+    return fileManager->commit_pages(pagenum, pages, count);
 }
 
-bool BufferController::init_buffer(std::size_t buffer_size)
+bool BufferManager::sync()
+{
+    return fileManager->sync();
+}
+
+bool BufferController::init_buffer(std::size_t buffer_size,
+                                   BufferPolicy policy)
 {
     CHECK_WITH_LOG(this->buffer_size < buffer_size, false,
                    "cannot be made smaller than the current buffer size %ld",
                    this->buffer_size);
+    stop_page_cleaner();
     this->buffer_size = buffer_size;
 
     buffer = std::make_unique<std::vector<frame_t>>(buffer_size);
@@ -109,11 +116,17 @@ bool BufferController::init_buffer(std::size_t buffer_size)
     }
 
     fileManagers.clear();
-    index_table.clear();
+    page_table.reset(buffer_size);
     nameFileManagerMap.clear();
 
-    mru = INVALID_BUFFER_INDEX;
-    lru = INVALID_BUFFER_INDEX;
+    this->policy = policy;
+    lru_list = FrameList {};
+    a1in_list = FrameList {};
+    a1out_queue.clear();
+    a1out_table.clear();
+    clock_hand = 0;
+    access_clock = 0;
+    reset_stats();
     num_buffer = 0;
 
     free_indexes = std::make_unique<std::stack<int>>();
@@ -122,30 +135,37 @@ bool BufferController::init_buffer(std::size_t buffer_size)
         free_indexes->push(i);
     }
     valid_buffer_controller = true;
+    cleaned_count = 0;
+    cleaner_cursor = 0;
+    start_page_cleaner();
     return true;
 }
 
-bool BufferController::clear_buffer()
+bool BufferController::clear_buffer(bool write_frames)
 {
     if (!valid_buffer_controller)
     {
         return true;
     }
-    CHECK_WITH_LOG(sync(false), false, "sync failure");
+    stop_page_cleaner();
+    CHECK_WITH_LOG(!write_frames || sync(false), false, "sync failure");
     buffer.reset();
     fileManagers.clear();
-    index_table.clear();
+    page_table.reset(0);
     nameFileManagerMap.clear();
     free_indexes.reset();
-    mru = INVALID_BUFFER_INDEX;
-    lru = INVALID_BUFFER_INDEX;
+    lru_list = FrameList {};
+    a1in_list = FrameList {};
+    a1out_queue.clear();
+    a1out_table.clear();
     num_buffer = 0;
     buffer_size = 0;
     valid_buffer_controller = false;
     return true;
 }
 
-int BufferController::openFileManager(const std::string &name)
+int BufferController::openFileManager(const std::string &name,
+                                      FileFormat format)
 {
     // project6 명세대로, DATA[file_id]
     if (name.substr(0, 4) != "DATA")
@@ -172,7 +192,7 @@ int BufferController::openFileManager(const std::string &name)
     }
 
     auto &fm = fileManagers[id] = std::make_unique<FileManager>();
-    CHECK_RET(fm->open(name), -1);
+    CHECK_RET(fm->open(name, format), -1);
 
     return id;
     // if (nameFileManagerMap.find(name) == nameFileManagerMap.end())
@@ -203,139 +223,57 @@ bool BufferController::fileManagerExist(int file_id)
     return fileManagers.find(file_id) != fileManagers.end();
 }
 
-void BufferController::release_frame(int file_id, pagenum_t pagenum)
+int BufferController::pin(int file_id, pagenum_t pagenum)
 {
-    int index = find(file_id, pagenum);
-    if (index == INVALID_BUFFER_INDEX)
-    {
-        std::cerr << "release_frame Logical error. file_id: " << file_id
-                  << ", pagenum: " << pagenum << std::endl;
-        index = load(file_id, pagenum);
-        if (index == INVALID_BUFFER_INDEX)
-        {
-            std::cerr << "load failed....\n";
-            return;
-        }
-    }
-
-    auto &frame = buffer->at(index);
-    --frame.pin;
-    frame.mtx.unlock();
-}
-
-void BufferController::retain_frame(int file_id, pagenum_t pagenum)
-{
-    int index = find(file_id, pagenum);
-    if (index == INVALID_BUFFER_INDEX)
+    // buffer hit: partition latch를 잡은 채로 pin 하므로 그 사이에 eviction
+    // 될 수 없다.
+    auto pin_frame = [this](int index) { ++(*buffer)[index].pin; };
+    int index = page_table.find(file_id, pagenum, pin_frame);
+    if (index != INVALID_BUFFER_INDEX)
     {
-        std::cerr << "retain_frame Logical error. file_id: " << file_id
-                  << ", pagenum: " << pagenum << std::endl;
-        index = load(file_id, pagenum);
-        if (index == INVALID_BUFFER_INDEX)
-        {
-            std::cerr << "load failed....\n";
-            return;
-        }
+        ++hit_count;
+        touch(index);
+        return index;
     }
 
-    auto &frame = buffer->at(index);
-    frame.mtx.lock();
-    ++frame.pin;
-}
-
-void BufferController::release_frame_shared(int file_id, pagenum_t pagenum)
-{
-    int index = find(file_id, pagenum);
-    if (index == INVALID_BUFFER_INDEX)
-    {
-        std::cerr << "release_frame_shared Logical error. file_id: " << file_id
-                  << ", pagenum: " << pagenum << std::endl;
-        index = load(file_id, pagenum);
-        if (index == INVALID_BUFFER_INDEX)
-        {
-            std::cerr << "load failed....\n";
-            return;
-        }
-    }
-    auto &frame = buffer->at(index);
-    --frame.pin;
-    frame.mtx.unlock_shared();
-}
+    // buffer miss
+    std::unique_lock<std::mutex> alloc_lock { alloc_latch };
 
-void BufferController::retain_frame_shared(int file_id, pagenum_t pagenum)
-{
-    int index = find(file_id, pagenum);
-    if (index == INVALID_BUFFER_INDEX)
+    // 기다리는 동안 다른 thread가 먼저 load 했을 수 있다.
+    index = page_table.find(file_id, pagenum, pin_frame);
+    if (index != INVALID_BUFFER_INDEX)
     {
-        std::cerr << "retain_frame_shared Logical error. file_id: " << file_id
-                  << ", pagenum: " << pagenum << std::endl;
-        index = load(file_id, pagenum);
-        if (index == INVALID_BUFFER_INDEX)
-        {
-            std::cerr << "load failed....\n";
-            return;
-        }
+        ++hit_count;
+        touch(index);
     }
-
-    auto &frame = buffer->at(index);
-    frame.mtx.lock_shared();
-    ++frame.pin;
-}
-
-int BufferController::get(int file_id, pagenum_t pagenum, page_t &page)
-{
-    int index = find(file_id, pagenum);
-    if (index == INVALID_BUFFER_INDEX)
+    else
     {
+        ++miss_count;
         index = load(file_id, pagenum);
+        CHECK_WITH_LOG(index != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX,
+                       "Buffer load failure. file: %d / pagenum: %ld", file_id,
+                       pagenum);
+        // eviction은 alloc_latch를 잡아야 하므로 여기서 pin 해도 안전하다.
+        ++(*buffer)[index].pin;
     }
 
-    CHECK_WITH_LOG(index != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX,
-                   "Buffer load failure. file: %d / pagenum: %ld", file_id,
-                   pagenum);
-    auto &buffer_frame = (*buffer)[index];
-    page = buffer_frame;
-
-    CHECK_RET(update_recently_used(index, buffer_frame, true),
-              INVALID_BUFFER_INDEX);
-
     return index;
 }
 
-bool BufferController::put(int file_id, pagenum_t pagenum, const page_t &frame)
+void BufferController::unpin(int frame_index)
 {
-    int index = find(file_id, pagenum);
-    if (index == INVALID_BUFFER_INDEX)
-    {
-        index = load(file_id, pagenum);
-    }
-
-    CHECK_WITH_LOG(index != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX,
-                   "Buffer load failure. file: %d / pagenum: %ld", file_id,
-                   pagenum);
-    auto &buffer_frame = (*buffer)[index];
-
-    buffer_frame.change_page(frame);
-    buffer_frame.is_dirty = true;
-
-    CHECK_RET(update_recently_used(index, buffer_frame, true),
-              INVALID_BUFFER_INDEX);
-
-    return true;
+    auto &frame = buffer->at(frame_index);
+    DB_CRASH_COND(frame.pin > 0, -1, "unpin unpinned frame. pagenum: %ld",
+                  frame.pagenum);
+    --frame.pin;
 }
 
-int BufferController::create(int file_id)
+pagenum_t BufferController::create(int file_id)
 {
+    // file header page도 buffer를 거치므로 alloc_latch를 잡지 않는다.
+    // 새 page는 처음 pin 될 때 buffer에 올라온다.
     auto &fileManager = getFileManager(file_id);
-    auto pagenum = fileManager.create();
-
-    int result = load(file_id, pagenum);
-
-    CHECK_RET(result != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX);
-    CHECK_RET(update_recently_used(result, buffer->at(result), true),
-              INVALID_BUFFER_INDEX);
-
-    return result;
+    return fileManager.create();
 }
 
 pagenum_t BufferController::frame_id_to_pagenum(int frame_id)
@@ -348,12 +286,36 @@ pagenum_t BufferController::frame_id_to_pagenum(int frame_id)
 
 bool BufferController::free(int file_id, pagenum_t pagenum)
 {
-    int index = find(file_id, pagenum);
-    if (index != INVALID_BUFFER_INDEX)
     {
-        CHECK_WITH_LOG(frame_free(index), false,
-                       "frame free failure\nfile_id: %d / pagenu,:%ld", file_id,
-                       pagenum);
+        std::unique_lock<std::mutex> alloc_lock { alloc_latch };
+        int index = find(file_id, pagenum);
+        if (index != INVALID_BUFFER_INDEX)
+        {
+            CHECK_WITH_LOG(frame_free(index), false,
+                           "frame free failure\nfile_id: %d / pagenu,:%ld",
+                           file_id, pagenum);
+        }
+    }
+    // file header page를 pin 해야 하므로 alloc_latch를 놓고 호출한다.
+    return getFileManager(file_id).free(pagenum);
+}
+
+bool BufferController::try_free(int file_id, pagenum_t pagenum)
+{
+    {
+        std::unique_lock<std::mutex> alloc_lock { alloc_latch };
+        int index = find(file_id, pagenum);
+        if (index != INVALID_BUFFER_INDEX)
+        {
+            // frame_free와 같지만, pin 되어 있으면 오류로 보지 않고 false를
+            // 돌려준다.
+            std::unique_lock<std::mutex> cleaner_lock { cleaner_latch };
+            if (!frame_evict(index))
+            {
+                return false;
+            }
+            free_indexes->push(index);
+        }
     }
     return getFileManager(file_id).free(pagenum);
 }
@@ -368,32 +330,55 @@ std::size_t BufferController::capacity() const
     return buffer->size();
 }
 
-bool BufferController::update_recently_used(int buffer_index, frame_t &frame,
-                                            bool unlink)
+BufferPolicy BufferController::get_policy() const
+{
+    return policy;
+}
+
+std::size_t BufferController::hits() const
+{
+    return hit_count;
+}
+
+std::size_t BufferController::misses() const
+{
+    return miss_count;
+}
+
+void BufferController::reset_stats()
+{
+    hit_count = 0;
+    miss_count = 0;
+}
+
+bool BufferController::update_recently_used(FrameList &list, int buffer_index,
+                                            frame_t &frame, bool unlink)
 {
     if (unlink)
     {
-        unlink_frame(buffer_index, frame);
+        unlink_frame(list, buffer_index, frame);
     }
 
-    frame.prev = mru;
+    frame.prev = list.mru;
     frame.next = INVALID_BUFFER_INDEX;
 
-    if (lru == INVALID_BUFFER_INDEX)
+    if (list.lru == INVALID_BUFFER_INDEX)
     {
-        lru = buffer_index;
+        list.lru = buffer_index;
     }
 
-    if (mru != INVALID_BUFFER_INDEX)
+    if (list.mru != INVALID_BUFFER_INDEX)
     {
-        (*buffer)[mru].next = buffer_index;
+        (*buffer)[list.mru].next = buffer_index;
     }
-    mru = buffer_index;
+    list.mru = buffer_index;
+    ++list.size;
 
     return true;
 }
 
-bool BufferController::unlink_frame(int buffer_index, frame_t &frame)
+bool BufferController::unlink_frame(FrameList &list, int buffer_index,
+                                    frame_t &frame)
 {
     if (frame.prev != INVALID_BUFFER_INDEX)
     {
@@ -401,10 +386,10 @@ bool BufferController::unlink_frame(int buffer_index, frame_t &frame)
     }
     else
     {
-        CHECK_WITH_LOG(lru == buffer_index, false,
-                       "logical error detected: lru: %d, buffer_index: %d", lru,
-                       buffer_index);
-        lru = frame.next;
+        CHECK_WITH_LOG(list.lru == buffer_index, false,
+                       "logical error detected: lru: %d, buffer_index: %d",
+                       list.lru, buffer_index);
+        list.lru = frame.next;
     }
 
     if (frame.next != INVALID_BUFFER_INDEX)
@@ -413,33 +398,27 @@ bool BufferController::unlink_frame(int buffer_index, frame_t &frame)
     }
     else
     {
-        CHECK_WITH_LOG(mru == buffer_index, false,
-                       "logical error detected: mru: %d, buffer_index: %d", mru,
-                       buffer_index);
-        mru = frame.prev;
+        CHECK_WITH_LOG(list.mru == buffer_index, false,
+                       "logical error detected: mru: %d, buffer_index: %d",
+                       list.mru, buffer_index);
+        list.mru = frame.prev;
     }
 
+    frame.prev = INVALID_BUFFER_INDEX;
+    frame.next = INVALID_BUFFER_INDEX;
+    --list.size;
+
     return true;
 }
 
 int BufferController::find(int file_id, pagenum_t pagenum)
 {
-    if (index_table[file_id].find(pagenum) != index_table[file_id].end())
-    {
-        return index_table[file_id][pagenum];
-    }
-    return INVALID_BUFFER_INDEX;
+    return page_table.find(file_id, pagenum);
 }
 
-void BufferController::memorize_index(int file_id, pagenum_t pagenum,
-                                      int frame_index)
+void BufferController::touch(int buffer_index)
 {
-    index_table[file_id][pagenum] = frame_index;
-}
-
-void BufferController::forget_index(int file_id, pagenum_t pagenum)
-{
-    index_table[file_id].erase(pagenum);
+    policy_on_hit(buffer_index);
 }
 
 bool BufferController::sync(bool lock)
@@ -448,6 +427,11 @@ bool BufferController::sync(bool lock)
     {
         return true;
     }
+    std::unique_lock<std::mutex> alloc_lock { alloc_latch, std::defer_lock };
+    if (lock)
+    {
+        alloc_lock.lock();
+    }
     for (auto &frame : *buffer)
     {
         if (frame.valid() && frame.is_dirty)
@@ -458,6 +442,28 @@ bool BufferController::sync(bool lock)
                 frame.file_id, frame.pagenum);
         }
     }
+
+    // 모든 page를 write 한 뒤에 file 별로 한 번씩 disk에 내린다.
+    for (auto &[file_id, fileManager] : fileManagers)
+    {
+        CHECK_WITH_LOG(fileManager->sync(), false, "file sync failure: %d",
+                       file_id);
+    }
+    return true;
+}
+
+bool BufferController::sync_files()
+{
+    if (!valid_buffer_controller)
+    {
+        return true;
+    }
+    std::unique_lock<std::mutex> alloc_lock { alloc_latch };
+    for (auto &[file_id, fileManager] : fileManagers)
+    {
+        CHECK_WITH_LOG(fileManager->sync(), false, "file sync failure: %d",
+                       file_id);
+    }
     return true;
 }
 
@@ -467,8 +473,10 @@ bool BufferController::fsync(int file_id, bool free_flag)
     {
         return true;
     }
-    for (auto &frame : *buffer)
+    std::unique_lock<std::mutex> alloc_lock { alloc_latch };
+    for (int index = 0; index < static_cast<int>(capacity()); ++index)
     {
+        auto &frame = buffer->at(index);
         if (frame.valid() && frame.file_id == file_id)
         {
             if (frame.is_dirty)
@@ -483,10 +491,13 @@ bool BufferController::fsync(int file_id, bool free_flag)
             {
                 CHECK_WITH_LOG(frame.pin == 0, false,
                                "cannot free frame. frame.pin == %d", frame.pin.load());
-                frame_free(index_table[file_id][frame.pagenum]);
+                frame_free(index);
             }
         }
     }
+
+    CHECK_WITH_LOG(getFileManager(file_id).sync(), false,
+                   "file sync failure: %d", file_id);
     return true;
 }
 
@@ -505,45 +516,71 @@ int BufferController::frame_alloc()
         return idx;
     }
 
-    int index = select_victim<BufferLRUTraversalPolicy>();
+    while (true)
+    {
+        int index;
+        {
+            std::unique_lock<std::mutex> policy_lock { policy_latch };
+            index = select_victim();
+        }
 
-    CHECK_WITH_LOG(index != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX,
-                   "alloc frame failure");
-    CHECK_WITH_LOG(frame_free(index, false), INVALID_BUFFER_INDEX,
-                   "frame free failure");
+        CHECK_WITH_LOG(index != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX,
+                       "alloc frame failure");
 
-    return index;
+        // victim을 고른 뒤 page table에서 지우기 전에 다른 thread가 pin 했다면
+        // 다시 고른다.
+        if (frame_evict(index))
+        {
+            return index;
+        }
+    }
 }
 
-bool BufferController::frame_free(int buffer_index, bool push_free_indexes_flag)
+bool BufferController::frame_evict(int buffer_index)
 {
     auto &frame = buffer->at(buffer_index);
-    // 지금은 병렬 x
-    if (frame.is_use_now())
+
+    // partition latch를 잡은 채로 pin을 확인하고 지우므로, 지운 뒤에는 어떤
+    // thread도 이 frame을 새로 pin 할 수 없다.
+    bool erased = page_table.erase_if(frame.file_id, frame.pagenum, [&frame]() {
+        return !frame.is_use_now();
+    });
+    if (!erased)
     {
-        frame.print_frame();
+        return false;
     }
-    CHECK_WITH_LOG(!frame.is_use_now(), false, "concurrency not supported");
 
-    while (frame.is_use_now())
     {
-        // wait
+        std::unique_lock<std::mutex> policy_lock { policy_latch };
+        policy_on_evict(buffer_index);
     }
 
-    CHECK(unlink_frame(buffer_index, frame));
-
     if (frame.is_dirty)
     {
         CHECK(commit(frame.file_id, frame));
     }
 
-    forget_index(frame.file_id, frame.pagenum);
     frame.init();
+    --num_buffer;
+    return true;
+}
+
+bool BufferController::frame_free(int buffer_index, bool push_free_indexes_flag)
+{
+    // page cleaner가 잠시 pin 한 frame이면 write가 끝날 때까지 기다린다.
+    std::unique_lock<std::mutex> cleaner_lock { cleaner_latch };
+    auto &frame = buffer->at(buffer_index);
+    if (frame.is_use_now())
+    {
+        frame.print_frame();
+    }
+    CHECK_WITH_LOG(frame_evict(buffer_index), false,
+                   "cannot free frame in use");
+
     if (push_free_indexes_flag)
     {
         free_indexes->push(buffer_index);
     }
-    --num_buffer;
     return true;
 }
 
@@ -554,17 +591,21 @@ int BufferController::load(int file_id, pagenum_t pagenum)
     CHECK_RET(index != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX);
     auto &frame = buffer->at(index);
 
-    frame_t page;
-    CHECK_WITH_LOG(fileManager.load(pagenum, page), INVALID_BUFFER_INDEX,
+    // 임시 page를 거치지 않고 frame에 바로 읽어온다.
+    CHECK_WITH_LOG(fileManager.load(pagenum, frame), INVALID_BUFFER_INDEX,
                    "frame load failure: %ld", pagenum);
-    frame.change_page(page);
     frame.file_id = file_id;
     frame.pagenum = pagenum;
-    memorize_index(file_id, pagenum, index);
     ++num_buffer;
 
-    CHECK_WITH_LOG(update_recently_used(index, frame, false),
-                   INVALID_BUFFER_INDEX, "update recently used failure");
+    {
+        std::unique_lock<std::mutex> policy_lock { policy_latch };
+        policy_on_load(index);
+    }
+
+    // page를 다 읽은 뒤에 page table에 등록해야 다른 thread가 읽다 만 page를
+    // 보지 않는다.
+    page_table.insert(file_id, pagenum, index);
 
     return index;
 }
@@ -579,5 +620,7 @@ bool BufferController::commit(int file_id, const frame_t &frame)
     LogManager::instance().flush_prev_lsn(frame.nodePageHeader().pageLsn);
     CHECK_WITH_LOG(fileManager.commit(frame.pagenum, frame), false,
                    "commit frame failure: %ld", frame.pagenum);
+    // page가 disk에 기록되었으므로 dirty page table에서 뺀다.
+    LogManager::instance().make_clean(file_id, frame.pagenum);
     return true;
 }
\ No newline at end of file
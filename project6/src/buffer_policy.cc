@@ -0,0 +1,266 @@
+#include "buffer_manager.hpp"
+
+#include <algorithm>
+
+// buffer frame eviction policy 구현
+// - LRU: frame을 참조할 때마다 list의 mru 쪽으로 옮긴다.
+// - CLOCK: 참조할 때는 reference bit만 켠다. hand를 돌리면서 bit가 꺼진
+//   frame을 고른다.
+// - LRU-K (K = 2): 두 번째로 최근 참조된 시각이 가장 오래된 frame을 고른다.
+//   한 번만 참조된 frame이 먼저 쫓겨난다.
+// - 2Q: 처음 들어온 page는 A1in(FIFO)에, A1in에서 쫓겨난 뒤 다시 참조된
+//   page는 Am(LRU)에 넣는다. 한 번 훑고 지나가는 scan이 Am을 밀어내지 못한다.
+
+// 2Q에서 frame이 들어있는 queue
+constexpr auto QUEUE_A1IN = 0;
+constexpr auto QUEUE_AM = 1;
+
+static uint64_t page_key(int file_id, pagenum_t pagenum)
+{
+    return (static_cast<uint64_t>(file_id) << 48) ^ pagenum;
+}
+
+void BufferController::policy_on_load(int buffer_index)
+{
+    auto& frame = buffer->at(buffer_index);
+    switch (policy)
+    {
+        case BufferPolicy::LRU:
+            update_recently_used(lru_list, buffer_index, frame, false);
+            break;
+        case BufferPolicy::CLOCK:
+            frame.referenced = true;
+            break;
+        case BufferPolicy::LRU_K:
+            frame.prev_access = 0;
+            frame.last_access = ++access_clock;
+            break;
+        case BufferPolicy::TWO_Q: {
+            auto it = a1out_table.find(page_key(frame.file_id, frame.pagenum));
+            if (it != a1out_table.end())
+            {
+                a1out_table.erase(it);
+                frame.queue = QUEUE_AM;
+                update_recently_used(lru_list, buffer_index, frame, false);
+            }
+            else
+            {
+                frame.queue = QUEUE_A1IN;
+                update_recently_used(a1in_list, buffer_index, frame, false);
+            }
+            break;
+        }
+    }
+}
+
+void BufferController::policy_on_hit(int buffer_index)
+{
+    auto& frame = buffer->at(buffer_index);
+    switch (policy)
+    {
+        case BufferPolicy::LRU: {
+            // list를 기다리면서까지 갱신하지는 않는다. 다른 thread가
+            // policy_latch를 잡고 있으면 이번 참조는 순서에 반영하지 않는다.
+            std::unique_lock<std::mutex> policy_lock { policy_latch,
+                                                       std::try_to_lock };
+            if (policy_lock)
+            {
+                update_recently_used(lru_list, buffer_index, frame, true);
+            }
+            break;
+        }
+        case BufferPolicy::CLOCK:
+            // 이미 켜져 있으면 cache line을 더럽히지 않는다.
+            if (!frame.referenced.load(std::memory_order_relaxed))
+            {
+                frame.referenced = true;
+            }
+            break;
+        case BufferPolicy::LRU_K:
+            frame.prev_access = frame.last_access.load();
+            frame.last_access = ++access_clock;
+            break;
+        case BufferPolicy::TWO_Q: {
+            // A1in 안에서의 재참조는 무시한다. (correlated reference)
+            if (frame.queue != QUEUE_AM)
+            {
+                break;
+            }
+            std::unique_lock<std::mutex> policy_lock { policy_latch,
+                                                       std::try_to_lock };
+            if (policy_lock)
+            {
+                update_recently_used(lru_list, buffer_index, frame, true);
+            }
+            break;
+        }
+    }
+}
+
+void BufferController::policy_on_evict(int buffer_index)
+{
+    auto& frame = buffer->at(buffer_index);
+    switch (policy)
+    {
+        case BufferPolicy::LRU:
+            unlink_frame(lru_list, buffer_index, frame);
+            break;
+        case BufferPolicy::CLOCK:
+        case BufferPolicy::LRU_K:
+            break;
+        case BufferPolicy::TWO_Q: {
+            if (frame.queue == QUEUE_AM)
+            {
+                unlink_frame(lru_list, buffer_index, frame);
+                break;
+            }
+
+            unlink_frame(a1in_list, buffer_index, frame);
+
+            // A1out은 buffer 크기의 절반만큼 page id를 기억한다.
+            uint64_t key = page_key(frame.file_id, frame.pagenum);
+            a1out_table[key] = ++a1out_seq;
+            a1out_queue.emplace_back(key, a1out_seq);
+            while (a1out_queue.size() > std::max<std::size_t>(1, capacity() / 2))
+            {
+                auto [old_key, seq] = a1out_queue.front();
+                a1out_queue.pop_front();
+                auto it = a1out_table.find(old_key);
+                if (it != a1out_table.end() && it->second == seq)
+                {
+                    a1out_table.erase(it);
+                }
+            }
+            break;
+        }
+    }
+}
+
+int BufferController::select_victim()
+{
+    switch (policy)
+    {
+        case BufferPolicy::LRU:
+            return select_victim<BufferLRUTraversalPolicy>();
+        case BufferPolicy::CLOCK:
+            return select_victim<BufferClockTraversalPolicy>();
+        case BufferPolicy::LRU_K:
+            return select_victim_lru_k();
+        case BufferPolicy::TWO_Q:
+            return select_victim_2q();
+    }
+    return INVALID_BUFFER_INDEX;
+}
+
+int BufferController::select_victim_lru_k()
+{
+    // 한 번만 참조된 frame은 prev_access가 0이므로 먼저 골라진다.
+    // 그 안에서는 마지막 참조가 오래된 frame을 고른다.
+    int victim = INVALID_BUFFER_INDEX;
+    uint64_t victim_prev = UINT64_MAX;
+    uint64_t victim_last = UINT64_MAX;
+    for (int i = 0; i < static_cast<int>(capacity()); ++i)
+    {
+        auto& frame = buffer->at(i);
+        if (!frame.valid() || frame.is_use_now())
+        {
+            continue;
+        }
+        uint64_t prev = frame.prev_access;
+        uint64_t last = frame.last_access;
+        if (prev < victim_prev || (prev == victim_prev && last < victim_last))
+        {
+            victim = i;
+            victim_prev = prev;
+            victim_last = last;
+        }
+    }
+    CHECK_WITH_LOG(victim != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX,
+                   "select victim failure");
+    return victim;
+}
+
+int BufferController::select_victim_2q()
+{
+    // A1in이 buffer의 1/4을 넘으면 A1in에서, 아니면 Am에서 고른다.
+    std::size_t a1in_max = std::max<std::size_t>(1, capacity() / 4);
+    int victim = INVALID_BUFFER_INDEX;
+    if (a1in_list.size > a1in_max || lru_list.size == 0)
+    {
+        victim = select_victim_from(a1in_list);
+    }
+    if (victim == INVALID_BUFFER_INDEX)
+    {
+        victim = select_victim_from(lru_list);
+    }
+    if (victim == INVALID_BUFFER_INDEX)
+    {
+        victim = select_victim_from(a1in_list);
+    }
+    CHECK_WITH_LOG(victim != INVALID_BUFFER_INDEX, INVALID_BUFFER_INDEX,
+                   "select victim failure");
+    return victim;
+}
+
+int BufferController::select_victim_from(FrameList& list)
+{
+    for (int i = list.lru; i != INVALID_BUFFER_INDEX; i = buffer->at(i).next)
+    {
+        if (!buffer->at(i).is_use_now())
+        {
+            return i;
+        }
+    }
+    return INVALID_BUFFER_INDEX;
+}
+
+void BufferController::eviction_candidates(std::size_t n,
+                                           std::vector<int>& out)
+{
+    auto push_from = [this, n, &out](const FrameList& list) {
+        for (int i = list.lru; i != INVALID_BUFFER_INDEX && out.size() < n;
+             i = buffer->at(i).next)
+        {
+            out.push_back(i);
+        }
+    };
+
+    switch (policy)
+    {
+        case BufferPolicy::LRU:
+            push_from(lru_list);
+            break;
+        case BufferPolicy::CLOCK: {
+            int count = std::min(n, capacity());
+            for (int i = 0; i < count; ++i)
+            {
+                out.push_back((clock_hand + i) % capacity());
+            }
+            break;
+        }
+        case BufferPolicy::LRU_K: {
+            std::vector<std::pair<std::pair<uint64_t, uint64_t>, int>> frames;
+            for (int i = 0; i < static_cast<int>(capacity()); ++i)
+            {
+                auto& frame = buffer->at(i);
+                if (frame.valid())
+                {
+                    frames.push_back(
+                        { { frame.prev_access, frame.last_access }, i });
+                }
+            }
+            std::size_t count = std::min(n, frames.size());
+            std::partial_sort(frames.begin(), frames.begin() + count,
+                              frames.end());
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out.push_back(frames[i].second);
+            }
+            break;
+        }
+        case BufferPolicy::TWO_Q:
+            push_from(a1in_list);
+            push_from(lru_list);
+            break;
+    }
+}
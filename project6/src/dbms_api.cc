@@ -1,24 +1,62 @@
 #include "dbms_api.hpp"
 
 #include <cstdio>
+#include <cstring>
 
 #include "lock_manager.hpp"
 #include "table_manager.hpp"
 #include "transaction_manager.hpp"
 #include "log_manager.hpp"
 
+static void copy_value(char* dst, const record_t& record)
+{
+    std::memcpy(dst, record.value.data(), record.length);
+    dst[record.length] = '\0';
+}
+
+// length가 맞지 않으면 false
+static bool make_value(ValueRef& ref, const char* value, int length)
+{
+    if (length < 0 || length > max_overflow_length)
+    {
+        return false;
+    }
+    ref.data = reinterpret_cast<const uint8_t*>(value);
+    ref.length = length;
+    return true;
+}
+
+static ValueRef text_value(const char* value)
+{
+    return { reinterpret_cast<const uint8_t*>(value),
+             static_cast<int>(std::strlen(value)) };
+}
+
 int init_db(int buf_num)
 {
     return init_db(buf_num, 0, 0, (char*)"default.log", (char*)"msg.txt");
 }
 
 int init_db(int buf_num, int flag, int log_num, char* log_path, char* logmsg)
+{
+    return init_db(buf_num, flag, log_num, log_path, logmsg,
+                   static_cast<int>(BufferPolicy::LRU));
+}
+
+int init_db(int buf_num, int flag, int log_num, char* log_path, char* logmsg,
+            int buffer_policy)
 {
     // TODO: 구현
+    if (buffer_policy < static_cast<int>(BufferPolicy::LRU) ||
+        buffer_policy > static_cast<int>(BufferPolicy::TWO_Q))
+    {
+        return -1;
+    }
     LockManager::instance().reset();
     TransactionManager::instance().reset();
     LogManager::instance().reset();
-    return TableManager::instance().init_db(buf_num, flag, log_num, log_path, logmsg) ? 0 : -1;
+    return TableManager::instance().init_db(buf_num, flag, log_num, log_path, logmsg,
+                                            BufferPolicy(buffer_policy)) ? 0 : -1;
 }
 
 int open_table(char* pathname)
@@ -27,11 +65,30 @@ int open_table(char* pathname)
     return table_id != INVALID_TABLE_ID ? table_id : -1;
 }
 
+int open_compressed_table(char* pathname)
+{
+    int table_id = TableManager::instance().open_table(
+        pathname, FileFormat::COMPRESSED);
+    return table_id != INVALID_TABLE_ID ? table_id : -1;
+}
+
+int open_fixed_table(char* pathname, int value_width)
+{
+    LeafFormat format = LeafFormat::RECORDS;
+    if (value_width != value_size && !fixed_leaf_format(value_width, format))
+    {
+        return -1;
+    }
+    int table_id = TableManager::instance().open_table(
+        pathname, FileFormat::RAW, format);
+    return table_id != INVALID_TABLE_ID ? table_id : -1;
+}
+
 int db_insert(int table_id, int64_t key, char* value)
 {
-    valType val;
-    TableManager::char_to_valType(val, value);
-    return TableManager::instance().insert(table_id, key, val) ? 0 : -1;
+    return TableManager::instance().insert(table_id, key, text_value(value))
+               ? 0
+               : -1;
 }
 
 int db_find(int table_id, int64_t key, char* ret_val, int trx_id)
@@ -42,41 +99,66 @@ int db_find(int table_id, int64_t key, char* ret_val, int trx_id)
         return -1;
     }
 
-    for (int i = 0; i < value_size; ++i)
+    copy_value(ret_val, record);
+    return 0;
+}
+
+int db_update(int table_id, int64_t key, char* values, int trx_id)
+{
+    return TableManager::instance().update(table_id, key, text_value(values),
+                                           trx_id)
+               ? 0
+               : 1;
+}
+
+int db_insert_n(int table_id, int64_t key, const char* value, int length)
+{
+    ValueRef ref;
+    if (!make_value(ref, value, length))
     {
-        if (!record.value[i])
-        {
-            ret_val[i] = '\0';
-            break;
-        }
-        ret_val[i] = record.value[i];
+        return -1;
     }
+    return TableManager::instance().insert(table_id, key, ref) ? 0 : -1;
+}
 
+int db_find_n(int table_id, int64_t key, char* ret_val, int* length,
+              int trx_id)
+{
+    if (!TableManager::instance().find(table_id, key,
+                                       reinterpret_cast<uint8_t*>(ret_val),
+                                       max_value_length, *length, trx_id))
+    {
+        return -1;
+    }
     return 0;
 }
 
-int db_update(int table_id, int64_t key, char* values, int trx_id)
+int db_find_value(int table_id, int64_t key, char* buffer, int capacity,
+                  int* length, int trx_id)
 {
-    record_t record;
-    // if (!TableManager::instance().find(table_id, key, record))
-    // {
-    //     return -1;
-    // }
+    if (capacity < 0 ||
+        !TableManager::instance().find(table_id, key,
+                                       reinterpret_cast<uint8_t*>(buffer),
+                                       capacity, *length, trx_id))
+    {
+        return -1;
+    }
+    return 0;
+}
 
-    TableManager::char_to_valType(record.value, values);
-    return TableManager::instance().update(table_id, key, record.value, trx_id)
-               ? 0
-               : 1;
+int db_update_n(int table_id, int64_t key, const char* value, int length,
+                int trx_id)
+{
+    ValueRef ref;
+    if (!make_value(ref, value, length))
+    {
+        return -1;
+    }
+    return TableManager::instance().update(table_id, key, ref, trx_id) ? 0 : 1;
 }
 
 int trx_abort(int trx_id)
 {
-    std::unique_lock<std::mutex> buffer_latch {
-        BufferController::instance().mtx
-    };
-    std::unique_lock<std::mutex> trxmanager_latch {
-        TransactionManager::instance().mtx
-    };
     return TransactionManager::instance().abort(trx_id);
 }
 
@@ -85,6 +167,104 @@ int db_delete(int table_id, int64_t key)
     return TableManager::instance().delete_key(table_id, key) ? 0 : -1;
 }
 
+int db_upsert(int table_id, int64_t key, char* value, int trx_id)
+{
+    return TableManager::instance().upsert(table_id, key, text_value(value),
+                                           trx_id)
+               ? 0
+               : -1;
+}
+
+int db_scan_open(int table_id, int64_t lo, int64_t hi, int trx_id)
+{
+    return TableManager::instance().scan_open(table_id, lo, hi, trx_id);
+}
+
+int db_scan_next(int cursor_id, int64_t* key, char* ret_val)
+{
+    record_t record;
+    switch (TableManager::instance().scan_next(cursor_id, record))
+    {
+        case ScanResult::FOUND:
+            *key = record.key;
+            copy_value(ret_val, record);
+            return 0;
+        case ScanResult::END:
+            return 1;
+        case ScanResult::ABORTED:
+            break;
+    }
+    TableManager::instance().scan_close(cursor_id);
+    return -1;
+}
+
+int db_scan_close(int cursor_id)
+{
+    return TableManager::instance().scan_close(cursor_id) ? 0 : -1;
+}
+
+int db_scan(int table_id, int64_t lo, int64_t hi, int trx_id,
+            int (*callback)(int64_t key, char* value, void* arg), void* arg)
+{
+    char value[value_size + 1];
+    return TableManager::instance().scan(
+               table_id, lo, hi,
+               [&](const record_t& record) {
+                   copy_value(value, record);
+                   return callback(record.key, value, arg) == 0;
+               },
+               trx_id)
+               ? 0
+               : -1;
+}
+
+int db_bulk_load(int table_id, int num_records,
+                 int (*next)(int64_t* key, char* value, void* arg), void* arg,
+                 int fill_percent)
+{
+    if (num_records < 0 || fill_percent <= 0 || fill_percent > 100)
+    {
+        return -1;
+    }
+    char value[value_size + 1];
+    return TableManager::instance().bulk_load(
+               table_id, num_records,
+               [&](record_t& record) {
+                   std::memset(value, 0, sizeof(value));
+                   if (next(&record.key, value, arg) != 0)
+                   {
+                       return false;
+                   }
+                   TableManager::char_to_valType(record.value, value);
+                   record.length = value_length(record.value);
+                   return true;
+               },
+               fill_percent / 100.0)
+               ? 0
+               : -1;
+}
+
+int db_set_leaf_format(int table_id, int format)
+{
+    if (format != static_cast<int>(LeafFormat::SLOTTED) &&
+        format != static_cast<int>(LeafFormat::COLUMNAR))
+    {
+        return -1;
+    }
+    return TableManager::instance().set_leaf_format(
+        table_id, static_cast<LeafFormat>(format));
+}
+
+int db_set_record_cache(int64_t capacity_bytes)
+{
+    if (capacity_bytes < 0)
+    {
+        return -1;
+    }
+    TableManager::instance().set_record_cache(capacity_bytes);
+    return 0;
+}
+
 int close_table(int table_id)
 {
     return TableManager::instance().close_table(table_id) ? 0 : -1;
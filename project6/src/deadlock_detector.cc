@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "lock_manager.hpp"
+#include "logger.hpp"
+
+// deadlock policy
+// lock_acquire / lock_upgrade가 lock을 기다려야 할 때 on_wait을 부르고,
+// false가 돌아오면 방금 넣은 lock을 놓고 abort 시킨다.
+// WOUND_WAIT, DETECT_BACKGROUND는 다른 transaction을 abort 시켜야 하므로
+// 기다리는 lock을 waiting_for에 등록해 둔다. wound는 그 lock을 ABORTED로
+// 바꾸고 깨우며, 깨어난 transaction은 lock_wait이 false를 돌려받고
+// abort 한다.
+
+std::ostream& operator<<(std::ostream& os, const DeadlockPolicy& dt)
+{
+    switch (dt)
+    {
+        case DeadlockPolicy::DETECT:
+            os << "DETECT";
+            break;
+        case DeadlockPolicy::DETECT_INCREMENTAL:
+            os << "DETECT_INCREMENTAL";
+            break;
+        case DeadlockPolicy::DETECT_BACKGROUND:
+            os << "DETECT_BACKGROUND";
+            break;
+        case DeadlockPolicy::WAIT_DIE:
+            os << "WAIT_DIE";
+            break;
+        case DeadlockPolicy::WOUND_WAIT:
+            os << "WOUND_WAIT";
+            break;
+    }
+    return os;
+}
+
+std::unordered_set<int> LockManager::blockers_of(const LockList& list,
+                                                 const lock_t* waiter)
+{
+    // lock은 list 순서대로 주므로, waiter는 앞에 있는 lock 중 호환되지 않는
+    // 것들을 기다린다. 앞에 있는 SHARED 대기자는 SHARED waiter와 같이
+    // 깨어나므로 제외한다.
+    std::unordered_set<int> blockers;
+    for (const auto& lock : list.locks)
+    {
+        if (lock.get() == waiter)
+        {
+            break;
+        }
+        if (lock->ownerTransactionID == waiter->ownerTransactionID)
+        {
+            continue;
+        }
+        if (lock->state == LockState::ACQUIRED ||
+            lock->lockMode == LockMode::EXCLUSIVE ||
+            waiter->lockMode == LockMode::EXCLUSIVE)
+        {
+            blockers.insert(lock->ownerTransactionID);
+        }
+    }
+    return blockers;
+}
+
+bool LockManager::must_die(const LockList& list, int trx_id) const
+{
+    if (deadlock_config.policy != DeadlockPolicy::WAIT_DIE)
+    {
+        return false;
+    }
+    return std::any_of(list.locks.begin(), list.locks.end(),
+                       [trx_id](const auto& lock) {
+                           return lock->ownerTransactionID < trx_id;
+                       });
+}
+
+bool LockManager::on_wait(lock_t* lock_ptr,
+                          const std::unordered_set<int>& blockers)
+{
+    int trx_id = lock_ptr->ownerTransactionID;
+    switch (deadlock_config.policy)
+    {
+        case DeadlockPolicy::DETECT:
+            return !deadlock_detection(trx_id);
+        case DeadlockPolicy::DETECT_INCREMENTAL:
+            if (add_wait_edges(trx_id, blockers))
+            {
+                erase_wait_edges(trx_id);
+                return false;
+            }
+            return true;
+        case DeadlockPolicy::WAIT_DIE:
+            // must_die를 통과했으면 기다리는 대상은 모두 늦게 시작했다.
+            return true;
+        case DeadlockPolicy::WOUND_WAIT:
+            for (int blocker : blockers)
+            {
+                if (blocker > trx_id)
+                {
+                    wound(blocker);
+                }
+            }
+            [[fallthrough]];
+        case DeadlockPolicy::DETECT_BACKGROUND:
+        {
+            // wound 표시 확인과 등록을 한번에 해야, 그 사이에 온 wound를
+            // 놓치지 않는다.
+            std::unique_lock<std::mutex> crit { waits_latch };
+            if (wounded.count(trx_id) > 0)
+            {
+                return false;
+            }
+            waiting_for[trx_id] = lock_ptr;
+            return true;
+        }
+    }
+    return true;
+}
+
+bool LockManager::add_wait_edges(int trx_id,
+                                 const std::unordered_set<int>& blockers)
+{
+    std::unique_lock<std::mutex> crit { graph_latch };
+    waits_for[trx_id] = blockers;
+
+    // 새 edge가 만든 cycle은 반드시 trx_id를 지나므로, trx_id에서 출발해서
+    // 다시 trx_id로 돌아오는지만 보면 된다.
+    std::unordered_set<int> visited;
+    std::vector<int> stack(blockers.begin(), blockers.end());
+    while (!stack.empty())
+    {
+        int now = stack.back();
+        stack.pop_back();
+        if (now == trx_id)
+        {
+            return true;
+        }
+        if (!visited.insert(now).second)
+        {
+            continue;
+        }
+        auto it = waits_for.find(now);
+        if (it == waits_for.end())
+        {
+            continue;
+        }
+        stack.insert(stack.end(), it->second.begin(), it->second.end());
+    }
+    return false;
+}
+
+void LockManager::erase_wait_edges(int trx_id)
+{
+    std::unique_lock<std::mutex> crit { graph_latch };
+    waits_for.erase(trx_id);
+}
+
+void LockManager::refresh_wait_edges(const LockList& list,
+                                     const std::vector<const lock_t*>& waiters)
+{
+    std::unique_lock<std::mutex> crit { graph_latch };
+    for (const auto* waiter : waiters)
+    {
+        // 아직 on_wait 전이면 edge가 없다.
+        auto it = waits_for.find(waiter->ownerTransactionID);
+        if (it == waits_for.end())
+        {
+            continue;
+        }
+        if (waiter->state == LockState::WAITING)
+        {
+            it->second = blockers_of(list, waiter);
+        }
+        else
+        {
+            waits_for.erase(it);
+        }
+    }
+}
+
+bool LockManager::is_wounded(int trx_id)
+{
+    if (deadlock_config.policy != DeadlockPolicy::WOUND_WAIT &&
+        deadlock_config.policy != DeadlockPolicy::DETECT_BACKGROUND)
+    {
+        return false;
+    }
+    std::unique_lock<std::mutex> crit { waits_latch };
+    return wounded.count(trx_id) > 0;
+}
+
+void LockManager::wound(int victim)
+{
+    // lock은 주인 transaction만 놓으므로, waiting_for에 남아 있는 동안
+    // lock_ptr은 유효하다.
+    lock_t* lock_ptr;
+    LockHash hash;
+    {
+        std::unique_lock<std::mutex> crit { waits_latch };
+        if (!wounded.insert(victim).second)
+        {
+            return;
+        }
+        auto it = waiting_for.find(victim);
+        if (it == waiting_for.end())
+        {
+            // 실행 중이면 다음 lock_acquire에서 abort 한다.
+            return;
+        }
+        lock_ptr = it->second;
+        hash = lock_ptr->hash;
+    }
+
+    // 그 사이에 lock을 얻었거나 놓았을 수 있으므로 list에서 다시 찾는다.
+    auto& partition = partition_of(hash);
+    std::unique_lock<std::mutex> crit { partition.mtx };
+    auto list = partition.lock_table.find(hash);
+    if (list == partition.lock_table.end())
+    {
+        return;
+    }
+    for (auto& lock : list->second.locks)
+    {
+        if (lock.get() == lock_ptr && lock->ownerTransactionID == victim &&
+            lock->state == LockState::WAITING)
+        {
+            lock->state = LockState::ABORTED;
+            lock->signal();
+            return;
+        }
+    }
+}
+
+void LockManager::transaction_finished(int trx_id)
+{
+    switch (deadlock_config.policy)
+    {
+        case DeadlockPolicy::DETECT_INCREMENTAL:
+            erase_wait_edges(trx_id);
+            break;
+        case DeadlockPolicy::DETECT_BACKGROUND:
+        case DeadlockPolicy::WOUND_WAIT:
+        {
+            std::unique_lock<std::mutex> crit { waits_latch };
+            wounded.erase(trx_id);
+            waiting_for.erase(trx_id);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+LockManager::wait_for_graph LockManager::build_wait_for_graph()
+{
+    std::vector<std::unique_lock<std::mutex>> crits;
+    crits.reserve(NUM_PARTITIONS);
+    for (auto& partition : partitions)
+    {
+        crits.emplace_back(partition.mtx);
+    }
+
+    wait_for_graph graph;
+    for (const auto& partition : partitions)
+    {
+        for (const auto& [hash, list] : partition.lock_table)
+        {
+            for (const auto& lock : list.locks)
+            {
+                if (lock->state != LockState::WAITING)
+                {
+                    continue;
+                }
+                auto blockers = blockers_of(list, lock.get());
+                graph[lock->ownerTransactionID].insert(blockers.begin(),
+                                                       blockers.end());
+            }
+        }
+    }
+    return graph;
+}
+
+int LockManager::find_victim(const wait_for_graph& graph)
+{
+    // 0: 아직 안 봄, 1: 지금 경로 위, 2: 끝남
+    std::unordered_map<int, int> color;
+    std::vector<int> path;
+    int victim = 0;
+
+    auto visit = [&](auto& self, int now) -> bool {
+        color[now] = 1;
+        path.push_back(now);
+        if (auto it = graph.find(now); it != graph.end())
+        {
+            for (int next : it->second)
+            {
+                if (color[next] == 1)
+                {
+                    // path에서 next부터 끝까지가 cycle이다.
+                    auto begin = std::find(path.begin(), path.end(), next);
+                    victim = *std::max_element(begin, path.end());
+                    return true;
+                }
+                if (color[next] == 0 && self(self, next))
+                {
+                    return true;
+                }
+            }
+        }
+        color[now] = 2;
+        path.pop_back();
+        return false;
+    };
+
+    for (const auto& [trx_id, next] : graph)
+    {
+        if (color[trx_id] == 0 && visit(visit, trx_id))
+        {
+            break;
+        }
+    }
+    return victim;
+}
+
+void LockManager::set_deadlock_config(const DeadlockConfig& config)
+{
+    // lock을 기다리는 transaction이 없을 때 바꿔야 한다.
+    bool running = detector_thread.joinable();
+    stop_detector();
+    deadlock_config = config;
+    if (running)
+    {
+        start_detector();
+    }
+}
+
+DeadlockConfig LockManager::get_deadlock_config() const
+{
+    return deadlock_config;
+}
+
+void LockManager::start_detector()
+{
+    if (deadlock_config.policy != DeadlockPolicy::DETECT_BACKGROUND ||
+        detector_thread.joinable())
+    {
+        return;
+    }
+    detector_stop = false;
+    detector_thread = std::thread(&LockManager::detector_loop, this);
+}
+
+void LockManager::stop_detector()
+{
+    if (!detector_thread.joinable())
+    {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock { detector_wakeup_latch };
+        detector_stop = true;
+    }
+    detector_wakeup.notify_all();
+    detector_thread.join();
+}
+
+void LockManager::detector_loop()
+{
+    auto interval =
+        std::chrono::milliseconds(deadlock_config.detect_interval_ms);
+    std::unique_lock<std::mutex> lock { detector_wakeup_latch };
+    while (!detector_stop)
+    {
+        detector_wakeup.wait_for(lock, interval,
+                                 [this]() { return detector_stop; });
+        if (detector_stop)
+        {
+            break;
+        }
+        lock.unlock();
+        // victim을 graph에서 빼 가며 cycle이 없어질 때까지 victim을 고른다.
+        auto graph = build_wait_for_graph();
+        std::vector<int> victims;
+        while (int victim = find_victim(graph))
+        {
+            victims.push_back(victim);
+            graph.erase(victim);
+        }
+        for (int victim : victims)
+        {
+            wound(victim);
+        }
+        lock.lock();
+    }
+}
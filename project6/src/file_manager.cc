@@ -1,15 +1,57 @@
 #include "file_manager.hpp"
 
 #include <fcntl.h>
+#include <sys/stat.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 
 #include "buffer_manager.hpp"
 #include "logger.hpp"
+#include "page_codec.hpp"
 
-FileManager::FileManager() : fd(-1), file_created(false)
+constexpr uint8_t SECTOR_FREE = 0;
+constexpr uint8_t SECTOR_USED = 1;
+// 비었지만 disk의 page map이 아직 가리키고 있을 수 있는 sector
+constexpr uint8_t SECTOR_PENDING = 2;
+
+constexpr long GROUP_DATA_SIZE = 2L * COMPRESSED_GROUP_PAGES * PAGESIZE;
+constexpr long GROUP_SIZE = PAGESIZE + GROUP_DATA_SIZE;
+constexpr uint32_t GROUP_SECTORS = GROUP_DATA_SIZE / COMPRESSED_SECTOR_SIZE;
+constexpr uint32_t HOLE_SECTORS =
+    COMPRESSED_HOLE_SIZE / COMPRESSED_SECTOR_SIZE;
+
+static_assert(PAGESIZE % COMPRESSED_HOLE_SIZE == 0,
+              "group data must start at a hole boundary");
+
+// 압축한 page 앞에 붙는 header
+struct StoredPageHeader
+{
+    uint16_t length;
+    // 0이면 압축하지 않은 page, 1이면 page_codec
+    uint8_t codec;
+    uint8_t reserved;
+};
+
+constexpr uint8_t CODEC_NONE = 0;
+constexpr uint8_t CODEC_ZERO_RUN = 1;
+
+static long group_offset(std::size_t group)
+{
+    return PAGESIZE + group * GROUP_SIZE;
+}
+
+static long sector_offset(std::size_t group, uint32_t sector)
+{
+    return group_offset(group) + PAGESIZE +
+           static_cast<long>(sector) * COMPRESSED_SECTOR_SIZE;
+}
+
+FileManager::FileManager()
+    : fd(-1), file_created(false), format(FileFormat::RAW), need_sync(false)
 {
     // Do nothing
 }
@@ -19,7 +61,7 @@ FileManager::~FileManager()
     close(fd);
 }
 
-bool FileManager::open(const std::string& name)
+bool FileManager::open(const std::string& name, FileFormat format)
 {
     // 파일 없음
     if (access(name.c_str(), F_OK) == -1)
@@ -28,41 +70,70 @@ bool FileManager::open(const std::string& name)
         CHECK_WITH_LOG(fd != -1, false, "create file failure");
 
         file_created = true;
+        this->format = format;
+        return true;
     }
-    else
+
+    fd = ::open(name.c_str(), O_RDWR);
+    CHECK_WITH_LOG(fd != -1, false, "open file failure");
+
+    // header page는 어느 형식이든 offset 0에 그대로 있다.
+    HeaderPageHeader header {};
+    CHECK(read(0, &header, sizeof(header)));
+    this->format = static_cast<FileFormat>(header.fileFormat);
+    CHECK_WITH_LOG(this->format == FileFormat::RAW ||
+                       this->format == FileFormat::COMPRESSED,
+                   false, "unknown file format: %u", header.fileFormat);
+    if (this->format == FileFormat::COMPRESSED)
     {
-        fd = ::open(name.c_str(), O_RDWR);
-        CHECK_WITH_LOG(fd != -1, false, "open file failure");
+        CHECK_WITH_LOG(loadPageMap(), false, "load page map failure: %s",
+                       name.c_str());
     }
 
     return true;
 }
-bool FileManager::init_file_if_created()
+bool FileManager::init_file_if_created(LeafFormat leaf_format)
 {
+    header_frame headerPage;
     if (!file_created)
     {
+        CHECK(get_file_header(headerPage, LatchMode::SHARED));
+        auto page_size = headerPage.page().headerPageHeader().pageSize;
+        CHECK_WITH_LOG(page_size == PAGESIZE || (page_size == 0 && PAGESIZE == 4096),
+                       false, "page size mismatch: file %lu, build %d",
+                       page_size, PAGESIZE);
         return true;
     }
     file_created = false;
-    header_frame headerPage {};
-    headerPage.page.headerPageHeader().numberOfPages = 1;
+    CHECK(get_file_header(headerPage));
+    headerPage.page() = page_t {};
+    headerPage.page().headerPageHeader().numberOfPages = 1;
+    headerPage.page().headerPageHeader().pageSize = PAGESIZE;
+    headerPage.page().headerPageHeader().leafFormat =
+        static_cast<uint32_t>(leaf_format);
+    headerPage.page().headerPageHeader().fileFormat =
+        static_cast<uint32_t>(format);
     CHECK(set_file_header(headerPage));
     return true;
 }
 
-bool FileManager::get_file_header(header_frame& header) const
+FileFormat FileManager::file_format() const
 {
-    int index = bufferManager->load(FILE_HEADER_PAGENUM, header.page);
-    CHECK_WITH_LOG(index != INVALID_BUFFER_INDEX, false,
-                   "get file header failure");
-    header.buffer_index = index;
+    return format;
+}
+
+bool FileManager::get_file_header(header_frame& header, LatchMode mode) const
+{
+    CHECK_WITH_LOG(
+        bufferManager->load(FILE_HEADER_PAGENUM, header.guard, mode), false,
+        "get file header failure");
     return true;
 }
 
-bool FileManager::set_file_header(const header_frame& header)
+bool FileManager::set_file_header(header_frame& header)
 {
-    CHECK_WITH_LOG(bufferManager->commit(FILE_HEADER_PAGENUM, header.page),
-                   false, "set file header failure");
+    CHECK_WITH_LOG(header.guard, false, "set file header failure");
+    header.guard.mark_dirty();
     return true;
 }
 
@@ -73,10 +144,30 @@ void FileManager::set_buffer_manager(BufferManager* bufferManager)
 
 bool FileManager::write(long int seek, const void* payload, std::size_t size)
 {
+    // write 마다 fsync 하지 않는다. disk에 내리는 것은 sync()가 한다.
     long count = pwrite(fd, payload, size, seek);
-    int result = fsync(fd);
+    need_sync = true;
 
-    return !result && count != -1;
+    return count == static_cast<long>(size);
+}
+
+bool FileManager::sync()
+{
+    if (format == FileFormat::COMPRESSED)
+    {
+        return syncPageMap();
+    }
+    // 마지막 sync 이후 write가 없었다면 건너뛴다.
+    if (!need_sync.exchange(false))
+    {
+        return true;
+    }
+    if (fdatasync(fd) != 0)
+    {
+        need_sync = true;
+        return false;
+    }
+    return true;
 }
 
 bool FileManager::read(long int seek, void* target, size_t size)
@@ -91,7 +182,7 @@ pagenum_t FileManager::pageCreate()
 {
     header_frame header;
     CHECK_RET(get_file_header(header), EMPTY_PAGE_NUMBER);
-    auto& fileHeader = header.page.headerPageHeader();
+    auto& fileHeader = header.page().headerPageHeader();
     auto pagenum = fileHeader.freePageNumber;
     if (pagenum == EMPTY_PAGE_NUMBER)
     {
@@ -117,15 +208,248 @@ pagenum_t FileManager::pageCreate()
 // Page 씀. 성공하면 true 반환
 bool FileManager::pageWrite(pagenum_t pagenum, const page_t& page)
 {
+    if (format == FileFormat::COMPRESSED && pagenum != FILE_HEADER_PAGENUM)
+    {
+        return compressedWrite(pagenum, page);
+    }
     return write(PAGESIZE * pagenum, &page, sizeof(page_t));
 }
 
 // Page 읽어옴. 성공하면 true 반환
 bool FileManager::pageRead(pagenum_t pagenum, page_t& page)
 {
+    if (format == FileFormat::COMPRESSED && pagenum != FILE_HEADER_PAGENUM)
+    {
+        return compressedRead(pagenum, page);
+    }
     return read(PAGESIZE * pagenum, &page, sizeof(page_t));
 }
 
+bool FileManager::compressedWrite(pagenum_t pagenum, const page_t& page)
+{
+    std::array<uint8_t, sizeof(StoredPageHeader) + page_codec_bound> buffer;
+    auto* header = reinterpret_cast<StoredPageHeader*>(buffer.data());
+    uint8_t* body = buffer.data() + sizeof(StoredPageHeader);
+    int length = page_compress(page, body);
+    *header = { static_cast<uint16_t>(length), CODEC_ZERO_RUN, 0 };
+    if (length >= PAGESIZE)
+    {
+        std::memcpy(body, &page, PAGESIZE);
+        *header = { static_cast<uint16_t>(PAGESIZE), CODEC_NONE, 0 };
+    }
+    int size = sizeof(StoredPageHeader) + header->length;
+    uint32_t count =
+        (size + COMPRESSED_SECTOR_SIZE - 1) / COMPRESSED_SECTOR_SIZE;
+
+    std::size_t group = pagenum / COMPRESSED_GROUP_PAGES;
+    uint32_t sector = 0;
+    for (bool synced = false;; synced = true)
+    {
+        std::unique_lock<std::mutex> lock { map_latch };
+        if (groups.size() <= group)
+        {
+            groups.resize(group + 1);
+        }
+        auto& now = groups[group];
+        if (now.map.empty())
+        {
+            now.map.resize(COMPRESSED_GROUP_PAGES);
+            now.sectors.resize(GROUP_SECTORS, SECTOR_FREE);
+        }
+        auto& entry = now.map[pagenum % COMPRESSED_GROUP_PAGES];
+
+        // 예전 자리에 들어가면 그 자리에 쓰고 남는 sector만 비운다.
+        if (entry.sectors >= count)
+        {
+            sector = entry.sector;
+            if (entry.sectors > count)
+            {
+                pending.push_back({ group, sector + count, entry.sectors - count });
+                std::fill_n(now.sectors.begin() + sector + count,
+                            entry.sectors - count, SECTOR_PENDING);
+                entry.sectors = count;
+                now.dirty = true;
+            }
+            break;
+        }
+
+        if (allocateSectors(group, count, sector))
+        {
+            if (entry.sectors != 0)
+            {
+                pending.push_back({ group, entry.sector, entry.sectors });
+                std::fill_n(now.sectors.begin() + entry.sector, entry.sectors,
+                            SECTOR_PENDING);
+            }
+            entry = { sector, static_cast<uint16_t>(count), 0 };
+            now.dirty = true;
+            break;
+        }
+
+        // 비운 sector를 돌려받은 뒤 한 번 더 찾는다.
+        lock.unlock();
+        CHECK_WITH_LOG(!synced, false, "no space in page group: %zu", group);
+        CHECK(syncPageMap());
+    }
+
+    return write(sector_offset(group, sector), buffer.data(), size);
+}
+
+bool FileManager::compressedRead(pagenum_t pagenum, page_t& page)
+{
+    std::size_t group = pagenum / COMPRESSED_GROUP_PAGES;
+    PageMapEntry entry {};
+    {
+        std::unique_lock<std::mutex> lock { map_latch };
+        if (group < groups.size() && !groups[group].map.empty())
+        {
+            entry = groups[group].map[pagenum % COMPRESSED_GROUP_PAGES];
+        }
+    }
+    if (entry.sectors == 0)
+    {
+        page = page_t {};
+        return true;
+    }
+
+    std::array<uint8_t, sizeof(StoredPageHeader) + page_codec_bound +
+                            COMPRESSED_SECTOR_SIZE>
+        buffer;
+    long size = entry.sectors * COMPRESSED_SECTOR_SIZE;
+    CHECK(size <= static_cast<long>(buffer.size()));
+    // 마지막 sector는 파일 끝에서 잘려 있을 수 있다.
+    long count = pread(fd, buffer.data(), size, sector_offset(group, entry.sector));
+    CHECK(count >= static_cast<long>(sizeof(StoredPageHeader)));
+    StoredPageHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    CHECK(sizeof(header) + header.length <= static_cast<std::size_t>(count));
+
+    const uint8_t* body = buffer.data() + sizeof(header);
+    if (header.codec == CODEC_NONE)
+    {
+        CHECK(header.length == PAGESIZE);
+        std::memcpy(&page, body, PAGESIZE);
+        return true;
+    }
+    CHECK_WITH_LOG(page_decompress(body, header.length, page), false,
+                   "corrupted compressed page: %ld", pagenum);
+    return true;
+}
+
+bool FileManager::loadPageMap()
+{
+    struct stat st;
+    CHECK(fstat(fd, &st) == 0);
+    std::size_t num_groups =
+        st.st_size > PAGESIZE ? (st.st_size - PAGESIZE + GROUP_SIZE - 1) / GROUP_SIZE
+                              : 0;
+
+    std::unique_lock<std::mutex> lock { map_latch };
+    groups.resize(num_groups);
+    for (std::size_t group = 0; group < num_groups; ++group)
+    {
+        auto& now = groups[group];
+        now.map.assign(COMPRESSED_GROUP_PAGES, PageMapEntry {});
+        now.sectors.assign(GROUP_SECTORS, SECTOR_FREE);
+        // 한 번도 sync 하지 않은 group의 map은 비어 있다.
+        CHECK(read(group_offset(group), now.map.data(), PAGESIZE));
+        for (auto& entry : now.map)
+        {
+            CHECK_WITH_LOG(entry.sector + entry.sectors <= GROUP_SECTORS, false,
+                           "corrupted page map: group %zu", group);
+            std::fill_n(now.sectors.begin() + entry.sector, entry.sectors,
+                        SECTOR_USED);
+        }
+    }
+    return true;
+}
+
+bool FileManager::allocateSectors(std::size_t group, uint32_t count,
+                                  uint32_t& sector)
+{
+    // 앞에서부터 찾아서 쓰는 곳을 파일 앞쪽에 모은다.
+    auto& sectors = groups[group].sectors;
+    uint32_t run = 0;
+    for (uint32_t i = 0; i < GROUP_SECTORS; ++i)
+    {
+        run = sectors[i] == SECTOR_FREE ? run + 1 : 0;
+        if (run == count)
+        {
+            sector = i + 1 - count;
+            std::fill_n(sectors.begin() + sector, count, SECTOR_USED);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileManager::releaseSectors(const pending_run& run)
+{
+    auto& sectors = groups[run.group].sectors;
+    std::fill_n(sectors.begin() + run.sector, run.sectors, SECTOR_FREE);
+
+    // run이 걸친 hole 단위 중 모두 빈 곳에 구멍을 뚫는다.
+    // 지원하지 않는 file system이면 공간만 돌려받지 못한다.
+    uint32_t first = run.sector / HOLE_SECTORS * HOLE_SECTORS;
+    for (uint32_t hole = first; hole < run.sector + run.sectors;
+         hole += HOLE_SECTORS)
+    {
+        if (std::all_of(sectors.begin() + hole,
+                        sectors.begin() + hole + HOLE_SECTORS,
+                        [](uint8_t state) { return state == SECTOR_FREE; }))
+        {
+            fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                      sector_offset(run.group, hole), COMPRESSED_HOLE_SIZE);
+        }
+    }
+}
+
+bool FileManager::syncPageMap()
+{
+    std::vector<std::pair<std::size_t, std::vector<PageMapEntry>>> maps;
+    std::vector<pending_run> released;
+    {
+        std::unique_lock<std::mutex> lock { map_latch };
+        for (std::size_t group = 0; group < groups.size(); ++group)
+        {
+            if (groups[group].dirty)
+            {
+                maps.emplace_back(group, groups[group].map);
+                groups[group].dirty = false;
+            }
+        }
+        released.swap(pending);
+    }
+
+    bool ok = true;
+    for (auto& [group, map] : maps)
+    {
+        ok = ok && write(group_offset(group), map.data(), PAGESIZE);
+    }
+    // map을 disk에 내린 뒤에야 예전 sector를 다시 쓸 수 있다.
+    if (ok && need_sync.exchange(false) && fdatasync(fd) != 0)
+    {
+        need_sync = true;
+        ok = false;
+    }
+
+    std::unique_lock<std::mutex> lock { map_latch };
+    if (!ok)
+    {
+        for (auto& [group, map] : maps)
+        {
+            groups[group].dirty = true;
+        }
+        pending.insert(pending.end(), released.begin(), released.end());
+        return false;
+    }
+    for (auto& run : released)
+    {
+        releaseSectors(run);
+    }
+    return true;
+}
+
 // pagenum에 해당하는 Page free. 성공하면 true 반환.
 bool FileManager::pageFree(pagenum_t pagenum)
 {
@@ -133,7 +457,7 @@ bool FileManager::pageFree(pagenum_t pagenum)
 
     header_frame header;
     CHECK(get_file_header(header));
-    auto& fileHeader = header.page.headerPageHeader();
+    auto& fileHeader = header.page().headerPageHeader();
 
     page.freePageHeader().nextFreePageNumber = fileHeader.freePageNumber;
     CHECK_WITH_LOG(pageWrite(pagenum, page), false, "page write failure: %ld",
@@ -156,17 +480,19 @@ int FileManager::get_manager_id() const
 
 pagenum_t FileManager::root() const
 {
+    // root는 BPTree의 root_latch를 잡고서만 바꾸므로, root_latch를 잡은 쪽은
+    // header latch 없이 읽어도 된다.
     header_frame header;
-    CHECK_RET(get_file_header(header), EMPTY_PAGE_NUMBER);
+    CHECK_RET(get_file_header(header, LatchMode::NONE), EMPTY_PAGE_NUMBER);
 
-    return header.page.headerPageHeader().rootPageNumber;
+    return header.page().headerPageHeader().rootPageNumber;
 }
 
 bool FileManager::set_root(pagenum_t pagenum)
 {
     header_frame header;
     CHECK_RET(get_file_header(header), EMPTY_PAGE_NUMBER);
-    auto& fileHeader = header.page.headerPageHeader();
+    auto& fileHeader = header.page().headerPageHeader();
 
     fileHeader.rootPageNumber = pagenum;
     CHECK_WITH_LOG(set_file_header(header), EMPTY_PAGE_NUMBER,
@@ -175,6 +501,26 @@ bool FileManager::set_root(pagenum_t pagenum)
     return true;
 }
 
+LeafFormat FileManager::leaf_format() const
+{
+    header_frame header;
+    CHECK_RET(get_file_header(header, LatchMode::SHARED), LeafFormat::RECORDS);
+
+    return static_cast<LeafFormat>(header.page().headerPageHeader().leafFormat);
+}
+
+bool FileManager::set_leaf_format(LeafFormat format)
+{
+    header_frame header;
+    CHECK(get_file_header(header));
+
+    header.page().headerPageHeader().leafFormat = static_cast<uint32_t>(format);
+    CHECK_WITH_LOG(set_file_header(header), false,
+                   "update file header failure");
+
+    return true;
+}
+
 bool FileManager::commit(pagenum_t pagenum, const page_t& page)
 {
     CHECK_WITH_LOG(pageWrite(pagenum, page), false, "write page failure: %ld",
@@ -197,4 +543,35 @@ pagenum_t FileManager::create()
 bool FileManager::free(pagenum_t pagenum)
 {
     return pageFree(pagenum);
+}
+
+pagenum_t FileManager::extend(pagenum_t count)
+{
+    header_frame header;
+    CHECK_RET(get_file_header(header), EMPTY_PAGE_NUMBER);
+    auto& fileHeader = header.page().headerPageHeader();
+    auto pagenum = fileHeader.numberOfPages;
+    fileHeader.numberOfPages += count;
+
+    CHECK_WITH_LOG(set_file_header(header), EMPTY_PAGE_NUMBER,
+                   "update file header failure");
+    return pagenum;
+}
+
+bool FileManager::commit_pages(pagenum_t pagenum, const page_t* pages,
+                               std::size_t count)
+{
+    if (format == FileFormat::COMPRESSED)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            CHECK_WITH_LOG(compressedWrite(pagenum + i, pages[i]), false,
+                           "write page failure: %ld", pagenum + i);
+        }
+        return true;
+    }
+    CHECK_WITH_LOG(write(PAGESIZE * pagenum, pages, sizeof(page_t) * count),
+                   false, "write pages failure: %ld (%zu pages)", pagenum,
+                   count);
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <limits>
+
+#include "page.hpp"
+
+// PACKED internal node
+// key는 첫 key(keyBase)와의 차이를 keyShift bit 만큼 오른쪽으로 민 값이다.
+// split은 아래 bit가 0인 separator를 고르므로 차이의 아래 bit도 0이라서
+// 밀어낼 수 있다. 민 값이 들어가는 가장 작은 keyWidth 바이트로 적고,
+// child는 모두 32bit에 들어가면 4바이트로 적는다.
+// entry 영역 앞에서부터 key를, 그 뒤에 child를 capacity 개씩 모아 둔다.
+
+struct packing
+{
+    keyType base = 0;
+    int shift = 0;
+    int key_width = 1;
+    int child_width = 4;
+
+    int capacity() const
+    {
+        return page_layout::entry_bytes / (key_width + child_width);
+    }
+};
+
+static uint64_t distance(keyType from, keyType to)
+{
+    return static_cast<uint64_t>(to) - static_cast<uint64_t>(from);
+}
+
+// entries가 들어가는 가장 좁은 packing
+static packing choose(const std::vector<Internal>& entries)
+{
+    packing pack;
+    if (entries.empty())
+    {
+        return pack;
+    }
+
+    pack.base = entries.front().key;
+    int shift = std::numeric_limits<uint64_t>::digits - 1;
+    for (std::size_t i = 1; i < entries.size(); ++i)
+    {
+        shift = std::min(shift,
+                         __builtin_ctzll(distance(pack.base, entries[i].key)));
+    }
+    pack.shift = entries.size() > 1 ? shift : 0;
+
+    uint64_t span = distance(pack.base, entries.back().key) >> pack.shift;
+    while (pack.key_width < 8 && (span >> (8 * pack.key_width)) != 0)
+    {
+        ++pack.key_width;
+    }
+    for (auto& entry : entries)
+    {
+        if (entry.node_id > std::numeric_limits<uint32_t>::max())
+        {
+            pack.child_width = 8;
+            break;
+        }
+    }
+    return pack;
+}
+
+static uint64_t load(const uint8_t* src, int width)
+{
+    uint64_t value = 0;
+    std::memcpy(&value, src, width);
+    return value;
+}
+
+template<int Width>
+static uint64_t load(const uint8_t* src)
+{
+    uint64_t value = 0;
+    std::memcpy(&value, src, Width);
+    return value;
+}
+
+// branchless_upper_bound와 같은 방식으로 민 값 q 이하인 key의 개수를 센다.
+template<int Width>
+static int packed_upper_bound(const uint8_t* keys, int n, uint64_t q)
+{
+    if (n <= 0)
+    {
+        return 0;
+    }
+    int base = 0;
+    while (n > 1)
+    {
+        int half = n / 2;
+        base = (load<Width>(keys + (base + half) * Width) <= q) ? base + half
+                                                                : base;
+        n -= half;
+    }
+    return base + (load<Width>(keys + base * Width) <= q);
+}
+
+static const uint8_t* packed_keys(const page_t& page)
+{
+    return page.entry.bytes.data();
+}
+
+static const uint8_t* packed_children(const page_t& page)
+{
+    auto& head = page.nodePageHeader();
+    int capacity = page_layout::entry_bytes / (head.keyWidth + head.childWidth);
+    return page.entry.bytes.data() + capacity * head.keyWidth;
+}
+
+InternalFormat page_t::internal_format() const
+{
+    return static_cast<InternalFormat>(nodePageHeader().internalFormat);
+}
+
+keyType page_t::internal_key(int idx) const
+{
+    if (internal_format() == InternalFormat::WIDE)
+    {
+        return internals()[idx].key;
+    }
+    auto& head = nodePageHeader();
+    uint64_t delta = load(packed_keys(*this) + idx * head.keyWidth,
+                          head.keyWidth);
+    return static_cast<keyType>(static_cast<uint64_t>(head.keyBase) +
+                                (delta << head.keyShift));
+}
+
+pagenum_t page_t::internal_child(int idx) const
+{
+    if (internal_format() == InternalFormat::WIDE)
+    {
+        return internals()[idx].node_id;
+    }
+    auto& head = nodePageHeader();
+    return load(packed_children(*this) + idx * head.childWidth,
+                head.childWidth);
+}
+
+int page_t::internal_upper_bound(keyType key) const
+{
+    if (internal_format() == InternalFormat::WIDE)
+    {
+        return upper_bound<Internal>(key);
+    }
+
+    auto& head = nodePageHeader();
+    int n = number_of_keys();
+    if (n == 0 || key < head.keyBase)
+    {
+        return 0;
+    }
+    // base + (delta << shift) <= key 는 delta <= (key - base) >> shift 와 같다.
+    uint64_t q = distance(head.keyBase, key) >> head.keyShift;
+    const uint8_t* keys = packed_keys(*this);
+    switch (head.keyWidth)
+    {
+        case 1:
+            return packed_upper_bound<1>(keys, n, q);
+        case 2:
+            return packed_upper_bound<2>(keys, n, q);
+        case 3:
+            return packed_upper_bound<3>(keys, n, q);
+        case 4:
+            return packed_upper_bound<4>(keys, n, q);
+        case 5:
+            return packed_upper_bound<5>(keys, n, q);
+        case 6:
+            return packed_upper_bound<6>(keys, n, q);
+        case 7:
+            return packed_upper_bound<7>(keys, n, q);
+        default:
+            return packed_upper_bound<8>(keys, n, q);
+    }
+}
+
+int page_t::internal_index(keyType key) const
+{
+    int index = internal_upper_bound(key) - 1;
+    if (index == -1 || internal_key(index) != key)
+    {
+        return -1;
+    }
+    return index;
+}
+
+pagenum_t page_t::internal_child_for(keyType key) const
+{
+    int index = internal_upper_bound(key) - 1;
+    return index == -1 ? leftmost() : internal_child(index);
+}
+
+void page_t::internal_read(std::vector<Internal>& entries) const
+{
+    int n = number_of_keys();
+    entries.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        entries[i].init(internal_key(i), internal_child(i));
+    }
+}
+
+bool page_t::internal_fits(const std::vector<Internal>& entries)
+{
+    return static_cast<int>(entries.size()) <= choose(entries).capacity();
+}
+
+bool page_t::internal_assign(const std::vector<Internal>& entries)
+{
+    packing pack = choose(entries);
+    int n = entries.size();
+    if (n > pack.capacity())
+    {
+        return false;
+    }
+
+    auto& head = nodePageHeader();
+    head.internalFormat = static_cast<uint8_t>(InternalFormat::PACKED);
+    head.numberOfKeys = n;
+    head.keyBase = pack.base;
+    head.keyShift = pack.shift;
+    head.keyWidth = pack.key_width;
+    head.childWidth = pack.child_width;
+
+    entry.bytes.fill(0);
+    uint8_t* keys = entry.bytes.data();
+    uint8_t* children = keys + pack.capacity() * pack.key_width;
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t delta = distance(pack.base, entries[i].key) >> pack.shift;
+        std::memcpy(keys + i * pack.key_width, &delta, pack.key_width);
+        std::memcpy(children + i * pack.child_width, &entries[i].node_id,
+                    pack.child_width);
+    }
+    return true;
+}
+
+bool page_t::internal_insert(int idx, keyType key, pagenum_t child)
+{
+    std::vector<Internal> entries;
+    internal_read(entries);
+    entries.insert(entries.begin() + idx, Internal { key, child });
+    return internal_assign(entries);
+}
+
+void page_t::internal_erase(int idx)
+{
+    std::vector<Internal> entries;
+    internal_read(entries);
+    entries.erase(entries.begin() + idx);
+    internal_assign(entries);
+}
@@ -0,0 +1,604 @@
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "page.hpp"
+
+// slotted leaf
+// entry 영역 앞에서부터 Slot 배열이 key 순서로 놓이고, cell은 끝에서부터
+// 앞으로 쌓인다. cell은 길이 1바이트와 value이거나, overflow page chain을
+// 가리키는 cell(OVERFLOW_CELL / PREFIXED_OVERFLOW_CELL)이다.
+// 지운 cell과 update로 옮겨간 cell의 자리는 바로 돌려받지 않고, insert 할
+// 때 cellBegin 앞의 빈 곳이 모자라면 살아있는 cell을 entry 영역 끝으로
+// 모아서(compact) 돌려받는다. compact는 log를 남기지 않으므로, commit 하지
+// 않은 update가 남아 있는 leaf에서 일어나면 그 update의 undo가 옮겨가기
+// 전의 자리에 쓰인다. 그런 leaf에서는 compact 하지 않고 cell 사이의 빈
+// 자리(hole)에 넣으며, 그것도 없으면 넣지 않는다(BPTree가 leaf를 나눈다).
+// transaction의 update는 cell을 옮기지 않으므로 undo는 항상 cell 안에 쓰고,
+// cell 사이의 빈 자리를 undo가 다시 가리키는 일은 없다.
+//
+// columnar leaf
+// cell은 slotted leaf와 같다. directory만 [key n개][CellRef n개]로 나눠서
+// binary search가 key 배열의 cache line만 건드린다. record를 넣고 빼면
+// CellRef 배열 전체가 key 하나만큼 움직인다.
+
+// directory에서 record 하나가 차지하는 byte 수
+static int directory_entry_size(LeafFormat format)
+{
+    return format == LeafFormat::COLUMNAR ? sizeof(LeafKey) + sizeof(CellRef)
+                                          : sizeof(Slot);
+}
+
+// cell에 쓰는 byte 수
+static int cell_length(const KeyValue& rec)
+{
+    if (rec.overflow == EMPTY_PAGE_NUMBER)
+    {
+        return 1 + rec.length;
+    }
+    return rec.length == 0 ? OVERFLOW_CELL_SIZE
+                           : OVERFLOW_CELL_SIZE + 1 + rec.length;
+}
+
+static int cell_capacity(const KeyValue& rec)
+{
+    return (cell_length(rec) + CELL_ALIGN - 1) / CELL_ALIGN * CELL_ALIGN;
+}
+
+static Slot* slots(page_t& page)
+{
+    return reinterpret_cast<Slot*>(page.entry.bytes.data());
+}
+
+static const Slot* slots(const page_t& page)
+{
+    return reinterpret_cast<const Slot*>(page.entry.bytes.data());
+}
+
+static LeafKey* leaf_keys(page_t& page)
+{
+    return reinterpret_cast<LeafKey*>(page.entry.bytes.data());
+}
+
+static const LeafKey* leaf_keys(const page_t& page)
+{
+    return reinterpret_cast<const LeafKey*>(page.entry.bytes.data());
+}
+
+// idx의 CellRef가 entry 영역 안에서 놓인 offset
+static int cell_ref_offset(const page_t& page, int idx)
+{
+    if (page.leaf_format() == LeafFormat::COLUMNAR)
+    {
+        return page.number_of_keys() * sizeof(LeafKey) + idx * sizeof(CellRef);
+    }
+    return idx * sizeof(Slot) + offsetof(Slot, cell);
+}
+
+static CellRef& cell_ref(page_t& page, int idx)
+{
+    return *reinterpret_cast<CellRef*>(page.entry.bytes.data() +
+                                       cell_ref_offset(page, idx));
+}
+
+static const CellRef& cell_ref(const page_t& page, int idx)
+{
+    return *reinterpret_cast<const CellRef*>(page.entry.bytes.data() +
+                                             cell_ref_offset(page, idx));
+}
+
+// directory와 cell 사이의 빈 곳
+static int free_gap(const page_t& page)
+{
+    return page.nodePageHeader().cellBegin -
+           page.number_of_keys() * directory_entry_size(page.leaf_format());
+}
+
+// directory의 idx 자리를 비우고 key와 ref를 넣는다. numberOfKeys는 그대로
+static void open_entry(page_t& page, int idx, keyType key, CellRef ref)
+{
+    int n = page.number_of_keys();
+    if (page.leaf_format() != LeafFormat::COLUMNAR)
+    {
+        auto* slot = slots(page);
+        std::memmove(slot + idx + 1, slot + idx, sizeof(Slot) * (n - idx));
+        slot[idx] = { key, ref, 0 };
+        return;
+    }
+
+    // CellRef 배열을 먼저 key 하나만큼 뒤로 옮긴 뒤 key를 민다.
+    auto* bytes = page.entry.bytes.data();
+    auto* old_refs = reinterpret_cast<CellRef*>(bytes + n * sizeof(LeafKey));
+    auto* new_refs =
+        reinterpret_cast<CellRef*>(bytes + (n + 1) * sizeof(LeafKey));
+    std::memmove(new_refs + idx + 1, old_refs + idx,
+                 sizeof(CellRef) * (n - idx));
+    std::memmove(new_refs, old_refs, sizeof(CellRef) * idx);
+    new_refs[idx] = ref;
+    auto* keys = leaf_keys(page);
+    std::memmove(keys + idx + 1, keys + idx, sizeof(LeafKey) * (n - idx));
+    keys[idx].key = key;
+}
+
+// directory에서 idx를 뺀다. numberOfKeys는 그대로
+static void close_entry(page_t& page, int idx)
+{
+    int n = page.number_of_keys();
+    if (page.leaf_format() != LeafFormat::COLUMNAR)
+    {
+        auto* slot = slots(page);
+        std::memmove(slot + idx, slot + idx + 1, sizeof(Slot) * (n - idx - 1));
+        return;
+    }
+
+    // open_entry의 반대 순서로, key를 당긴 뒤 CellRef 배열을 당긴다.
+    auto* keys = leaf_keys(page);
+    std::memmove(keys + idx, keys + idx + 1, sizeof(LeafKey) * (n - idx - 1));
+    auto* bytes = page.entry.bytes.data();
+    auto* old_refs = reinterpret_cast<CellRef*>(bytes + n * sizeof(LeafKey));
+    auto* new_refs =
+        reinterpret_cast<CellRef*>(bytes + (n - 1) * sizeof(LeafKey));
+    std::memmove(new_refs, old_refs, sizeof(CellRef) * idx);
+    std::memmove(new_refs + idx, old_refs + idx + 1,
+                 sizeof(CellRef) * (n - idx - 1));
+}
+
+// Records leaf 형식(RECORDS, FIXED_*)에서 record 하나의 크기
+static int fixed_record_size(LeafFormat format)
+{
+    return with_value_width(format, [](auto width) {
+        return static_cast<int>(sizeof(FixedRecord<decltype(width)::value>));
+    });
+}
+
+// rec 하나가 format의 leaf에서 차지하는 byte 수
+static int leaf_cost_of(LeafFormat format, const KeyValue& rec)
+{
+    if (!leaf_has_cells(format))
+    {
+        return fixed_record_size(format);
+    }
+    return directory_entry_size(format) + cell_capacity(rec);
+}
+
+static int leaf_capacity_of(LeafFormat format)
+{
+    if (!leaf_has_cells(format))
+    {
+        return with_value_width(format, [](auto width) {
+            constexpr int Width = decltype(width)::value;
+            return page_layout::fixed_records<Width> *
+                   static_cast<int>(sizeof(FixedRecord<Width>));
+        });
+    }
+    return page_layout::entry_bytes;
+}
+
+// cell의 앞 cell_length(rec) 바이트를 쓴다.
+static void write_cell(uint8_t* cell, const KeyValue& rec)
+{
+    if (rec.overflow == EMPTY_PAGE_NUMBER)
+    {
+        cell[0] = rec.length;
+        std::memcpy(cell + 1, rec.value.data(), rec.length);
+        return;
+    }
+    cell[0] = rec.length == 0 ? OVERFLOW_CELL : PREFIXED_OVERFLOW_CELL;
+    std::memcpy(cell + 1, &rec.overflow, OVERFLOW_CELL_SIZE - 1);
+    if (rec.length != 0)
+    {
+        cell[OVERFLOW_CELL_SIZE] = rec.length;
+        std::memcpy(cell + OVERFLOW_CELL_SIZE + 1, rec.value.data(),
+                    rec.length);
+    }
+}
+
+static void read_cell(const uint8_t* cell, KeyValue& ret)
+{
+    ret.value.fill(0);
+    ret.overflow = EMPTY_PAGE_NUMBER;
+    if (cell[0] != OVERFLOW_CELL && cell[0] != PREFIXED_OVERFLOW_CELL)
+    {
+        ret.length = cell[0];
+        std::memcpy(ret.value.data(), cell + 1, ret.length);
+        return;
+    }
+    std::memcpy(&ret.overflow, cell + 1, OVERFLOW_CELL_SIZE - 1);
+    ret.length = 0;
+    if (cell[0] == PREFIXED_OVERFLOW_CELL)
+    {
+        ret.length = cell[OVERFLOW_CELL_SIZE];
+        std::memcpy(ret.value.data(), cell + OVERFLOW_CELL_SIZE + 1,
+                    ret.length);
+    }
+}
+
+// cellBegin 뒤에서 살아있는 cell 사이의 capacity 바이트 이상 빈 자리.
+// 없으면 -1
+static int find_hole(const page_t& page, int capacity)
+{
+    std::vector<CellRef> cells(page.number_of_keys());
+    for (int i = 0; i < page.number_of_keys(); ++i)
+    {
+        cells[i] = cell_ref(page, i);
+    }
+    std::sort(cells.begin(), cells.end(),
+              [](CellRef lhs, CellRef rhs) { return lhs.offset < rhs.offset; });
+
+    int begin = page.nodePageHeader().cellBegin;
+    for (auto cell : cells)
+    {
+        if (cell.offset - begin >= capacity)
+        {
+            return begin;
+        }
+        begin = cell.offset + cell.capacity;
+    }
+    int end = page_layout::entry_bytes;
+    return end - begin >= capacity ? begin : -1;
+}
+
+static void compact(page_t& page)
+{
+    auto& bytes = page.entry.bytes;
+    std::array<uint8_t, page_layout::entry_bytes> temp;
+    int end = page_layout::entry_bytes;
+    for (int i = 0; i < page.number_of_keys(); ++i)
+    {
+        auto& ref = cell_ref(page, i);
+        end -= ref.capacity;
+        std::memcpy(temp.data() + end, bytes.data() + ref.offset, ref.capacity);
+        ref.offset = end;
+    }
+    std::memcpy(bytes.data() + end, temp.data() + end,
+                page_layout::entry_bytes - end);
+    page.nodePageHeader().cellBegin = end;
+}
+
+LeafFormat page_t::leaf_format() const
+{
+    return static_cast<LeafFormat>(nodePageHeader().leafFormat);
+}
+
+void page_t::leaf_init(LeafFormat format)
+{
+    auto& head = nodePageHeader();
+    head.isLeaf = true;
+    head.numberOfKeys = 0;
+    head.leafFormat = static_cast<uint8_t>(format);
+    head.cellBegin = page_layout::entry_bytes;
+}
+
+int page_t::leaf_lower_bound(keyType key) const
+{
+    switch (leaf_format())
+    {
+        case LeafFormat::SLOTTED:
+            return search_kernel<Slot>::lower_bound(slots(*this),
+                                                    number_of_keys(), key);
+        case LeafFormat::COLUMNAR:
+            return search_kernel<LeafKey>::lower_bound(leaf_keys(*this),
+                                                       number_of_keys(), key);
+        default:
+            return with_value_width(leaf_format(), [&](auto width) {
+                return lower_bound<FixedRecord<decltype(width)::value>>(key);
+            });
+    }
+}
+
+int page_t::leaf_upper_bound(keyType key) const
+{
+    switch (leaf_format())
+    {
+        case LeafFormat::SLOTTED:
+            return search_kernel<Slot>::upper_bound(slots(*this),
+                                                    number_of_keys(), key);
+        case LeafFormat::COLUMNAR:
+            return search_kernel<LeafKey>::upper_bound(leaf_keys(*this),
+                                                       number_of_keys(), key);
+        default:
+            return with_value_width(leaf_format(), [&](auto width) {
+                return upper_bound<FixedRecord<decltype(width)::value>>(key);
+            });
+    }
+}
+
+int page_t::leaf_index(keyType key) const
+{
+    int index = leaf_lower_bound(key);
+    if (index == number_of_keys() || leaf_key(index) != key)
+    {
+        return -1;
+    }
+    return index;
+}
+
+keyType page_t::leaf_key(int idx) const
+{
+    switch (leaf_format())
+    {
+        case LeafFormat::SLOTTED:
+            return slots(*this)[idx].key;
+        case LeafFormat::COLUMNAR:
+            return leaf_keys(*this)[idx].key;
+        default:
+            return with_value_width(leaf_format(), [&](auto width) {
+                return get<FixedRecord<decltype(width)::value>>(idx).key;
+            });
+    }
+}
+
+pagenum_t page_t::leaf_overflow(int idx) const
+{
+    if (!leaf_has_cells(leaf_format()))
+    {
+        return EMPTY_PAGE_NUMBER;
+    }
+    const auto* cell = entry.bytes.data() + cell_ref(*this, idx).offset;
+    pagenum_t overflow = EMPTY_PAGE_NUMBER;
+    if (cell[0] == OVERFLOW_CELL || cell[0] == PREFIXED_OVERFLOW_CELL)
+    {
+        std::memcpy(&overflow, cell + 1, OVERFLOW_CELL_SIZE - 1);
+    }
+    return overflow;
+}
+
+int page_t::leaf_prefix_capacity(int idx) const
+{
+    if (!leaf_has_cells(leaf_format()))
+    {
+        return 0;
+    }
+    int capacity = cell_ref(*this, idx).capacity;
+    return std::max(0, capacity - OVERFLOW_CELL_SIZE - 1);
+}
+
+void page_t::leaf_read(int idx, KeyValue& ret) const
+{
+    if (leaf_has_cells(leaf_format()))
+    {
+        ret.key = leaf_key(idx);
+        read_cell(entry.bytes.data() + cell_ref(*this, idx).offset, ret);
+        return;
+    }
+    if (leaf_format() == LeafFormat::RECORDS)
+    {
+        // Records leaf는 NUL로 끝나는 value만 담는다.
+        const auto& rec = records()[idx];
+        ret.init(rec.key, rec.value, value_length(rec.value));
+        return;
+    }
+    // 고정 너비 leaf의 value는 항상 그 너비만큼이다.
+    with_value_width(leaf_format(), [&](auto width) {
+        constexpr int Width = decltype(width)::value;
+        const auto& rec = get<FixedRecord<Width>>(idx);
+        ret.key = rec.key;
+        ret.length = Width;
+        ret.value.fill(0);
+        std::memcpy(ret.value.data(), rec.value.data(), Width);
+        ret.overflow = EMPTY_PAGE_NUMBER;
+    });
+}
+
+int page_t::leaf_cost(const KeyValue& rec) const
+{
+    return leaf_cost_of(leaf_format(), rec);
+}
+
+int page_t::leaf_used() const
+{
+    int n = number_of_keys();
+    if (leaf_has_cells(leaf_format()))
+    {
+        int used = n * directory_entry_size(leaf_format());
+        for (int i = 0; i < n; ++i)
+        {
+            used += cell_ref(*this, i).capacity;
+        }
+        return used;
+    }
+    return n * fixed_record_size(leaf_format());
+}
+
+int page_t::leaf_capacity() const
+{
+    return leaf_capacity_of(leaf_format());
+}
+
+bool page_t::leaf_fits(const KeyValue& rec, bool compactable) const
+{
+    if (leaf_used() + leaf_cost(rec) > leaf_capacity())
+    {
+        return false;
+    }
+    if (compactable || !leaf_has_cells(leaf_format()))
+    {
+        return true;
+    }
+
+    int entry_size = directory_entry_size(leaf_format());
+    int capacity = cell_capacity(rec);
+    return free_gap(*this) >= entry_size + capacity ||
+           (free_gap(*this) >= entry_size && find_hole(*this, capacity) != -1);
+}
+
+void page_t::leaf_insert(int idx, const KeyValue& rec, bool compactable)
+{
+    if (!leaf_has_cells(leaf_format()))
+    {
+        // overflow page는 cell이 있는 leaf에만 있다.
+        with_value_width(leaf_format(), [&](auto width) {
+            FixedRecord<decltype(width)::value> record;
+            record.init(rec.key, rec.value);
+            insert(record, idx);
+        });
+        return;
+    }
+
+    auto& head = nodePageHeader();
+    int capacity = cell_capacity(rec);
+    int offset = -1;
+    if (free_gap(*this) < directory_entry_size(leaf_format()) + capacity)
+    {
+        if (compactable)
+        {
+            compact(*this);
+        }
+        else
+        {
+            offset = find_hole(*this, capacity);
+        }
+    }
+    if (offset == -1)
+    {
+        head.cellBegin -= capacity;
+        offset = head.cellBegin;
+    }
+    auto* cell = entry.bytes.data() + offset;
+    std::memset(cell, 0, capacity);
+    write_cell(cell, rec);
+
+    open_entry(*this, idx, rec.key,
+               { static_cast<uint16_t>(offset),
+                 static_cast<uint16_t>(capacity) });
+    ++head.numberOfKeys;
+}
+
+void page_t::leaf_erase(int idx)
+{
+    if (!leaf_has_cells(leaf_format()))
+    {
+        with_value_width(leaf_format(), [&](auto width) {
+            erase<FixedRecord<decltype(width)::value>>(idx);
+        });
+        return;
+    }
+
+    auto& head = nodePageHeader();
+    const auto& ref = cell_ref(*this, idx);
+    // 맨 앞의 cell이면 바로 돌려받는다.
+    if (ref.offset == head.cellBegin)
+    {
+        head.cellBegin += ref.capacity;
+    }
+    close_entry(*this, idx);
+    --head.numberOfKeys;
+}
+
+// offset부터 length 바이트를 apply로 바꾸고, 바꾸기 전후를 changes에 적는다.
+template<typename Apply>
+static void change(page_t& page, page_changes& changes, int& count, int offset,
+                   int length, Apply apply)
+{
+    auto* raw = reinterpret_cast<uint8_t*>(&page);
+    auto& now = changes[count++];
+    now.offset = offset;
+    now.length = length;
+    std::memcpy(now.before.data(), raw + offset, length);
+    apply();
+    std::memcpy(now.after.data(), raw + offset, length);
+}
+
+int page_t::leaf_update(int idx, const KeyValue& rec, page_changes& changes,
+                        CellMove move)
+{
+    int count = 0;
+    if (!leaf_has_cells(leaf_format()))
+    {
+        if (rec.overflow != EMPTY_PAGE_NUMBER ||
+            rec.length > leaf_value_limit(leaf_format()))
+        {
+            return -1;
+        }
+        with_value_width(leaf_format(), [&](auto width) {
+            constexpr int Width = decltype(width)::value;
+            auto& value = get<FixedRecord<Width>>(idx).value;
+            change(*this, changes, count, get_offset<FixedRecord<Width>>(idx),
+                   Width, [&]() {
+                       std::memcpy(value.data(), rec.value.data(), Width);
+                   });
+        });
+        return count;
+    }
+
+    constexpr int entry_offset = sizeof(NodePageHeader);
+    auto& ref = cell_ref(*this, idx);
+    if (cell_length(rec) <= ref.capacity)
+    {
+        // cell 안에서 끝난다. 예전 value의 뒷부분은 길이 밖이므로 그대로 둔다.
+        change(*this, changes, count, entry_offset + ref.offset,
+               cell_length(rec), [&]() {
+                   write_cell(entry.bytes.data() + ref.offset, rec);
+               });
+        return count;
+    }
+
+    if (move == CellMove::NONE)
+    {
+        return -1;
+    }
+
+    // 더 큰 cell을 빈 곳에 새로 잡고 CellRef가 그것을 가리키게 한다. 예전
+    // cell은 compact 할 때 돌려받는다.
+    int capacity = cell_capacity(rec);
+    if (free_gap(*this) < capacity)
+    {
+        if (move != CellMove::COMPACT ||
+            leaf_used() + capacity > leaf_capacity())
+        {
+            return -1;
+        }
+        compact(*this);
+    }
+
+    auto& head = nodePageHeader();
+    int offset = head.cellBegin - capacity;
+    change(*this, changes, count, entry_offset + offset, capacity, [&]() {
+        auto* cell = entry.bytes.data() + offset;
+        std::memset(cell, 0, capacity);
+        write_cell(cell, rec);
+    });
+    // compact는 CellRef의 자리를 바꾸지 않는다.
+    change(*this, changes, count, entry_offset + cell_ref_offset(*this, idx),
+           sizeof(CellRef), [&]() {
+               ref.offset = offset;
+               ref.capacity = capacity;
+           });
+    change(*this, changes, count, offsetof(NodePageHeader, cellBegin),
+           sizeof(head.cellBegin), [&]() { head.cellBegin = offset; });
+    return count;
+}
+
+bool page_t::leaf_convert(LeafFormat format)
+{
+    if (format == leaf_format())
+    {
+        return true;
+    }
+
+    int n = number_of_keys();
+    std::vector<KeyValue> temp(n);
+    int used = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        leaf_read(i, temp[i]);
+        used += leaf_cost_of(format, temp[i]);
+        if (!leaf_has_cells(format) &&
+            (temp[i].overflow != EMPTY_PAGE_NUMBER ||
+             temp[i].length > leaf_value_limit(format)))
+        {
+            return false;
+        }
+    }
+    if (used > leaf_capacity_of(format))
+    {
+        return false;
+    }
+
+    leaf_init(format);
+    for (int i = 0; i < n; ++i)
+    {
+        leaf_insert(i, temp[i]);
+    }
+    return true;
+}
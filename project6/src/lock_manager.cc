@@ -4,7 +4,6 @@
 #include <iostream>
 #include <queue>
 #include <set>
-#include <thread>
 #include <vector>
 
 #include "logger.hpp"
@@ -30,6 +29,19 @@ bool LockHash::operator==(const LockHash& rhs) const
     return table_id == rhs.table_id && key == rhs.key;
 }
 
+uint64_t LockHash::hash() const
+{
+    // splitmix64 finalizer
+    uint64_t x = (static_cast<uint64_t>(table_id) << 48) ^
+                 static_cast<uint64_t>(key);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
 std::ostream& operator<<(std::ostream& os, const LockMode& dt)
 {
     switch (dt)
@@ -67,6 +79,62 @@ std::ostream& operator<<(std::ostream& os, const LockState& dt)
     return os;
 }
 
+// 앞에서부터 보면서, 앞선 lock들과 모두 호환되는 대기 lock을 깨운다.
+// 하나라도 못 깨우면 그 뒤는 순서대로 기다린다.
+// 기다리던 lock이 중간에서 빠지는 경우(abort)에도, 그 뒤의 SHARED lock이
+// 앞의 SHARED lock과 함께 깨어나야 한다.
+static void grant_waiters(LockList& list)
+{
+    constexpr int NO_OWNER = -1;
+    constexpr int MANY_OWNERS = -2;
+    bool exclusive_ahead = false;
+    int owner_ahead = NO_OWNER;
+
+    for (auto& lock : list.locks)
+    {
+        // wound 된 lock(ABORTED)은 주지 않고 없는 것으로 본다. 주면 주인이
+        // wound 된 줄 모르고 commit 할 수 있다. 주인이 abort 하면서
+        // lock_release로 list에서 뺀다.
+        if (lock->state == LockState::ABORTED)
+        {
+            continue;
+        }
+        if (lock->state == LockState::WAITING)
+        {
+            /*
+            하나의 트랜잭션을 owner로 하는 SLock만 앞에 있으면 XLock을
+            줄 수 있다. (lock_upgrade)
+            */
+            bool compatible =
+                lock->lockMode == LockMode::SHARED
+                    ? !exclusive_ahead
+                    : owner_ahead == NO_OWNER ||
+                          owner_ahead == lock->ownerTransactionID;
+            if (!compatible)
+            {
+                break;
+            }
+            lock->state = LockState::ACQUIRED;
+            ++list.acquire_count;
+            --list.wait_count;
+            lock->signal();
+        }
+
+        if (lock->lockMode == LockMode::EXCLUSIVE)
+        {
+            exclusive_ahead = true;
+        }
+        if (owner_ahead == NO_OWNER)
+        {
+            owner_ahead = lock->ownerTransactionID;
+        }
+        else if (owner_ahead != lock->ownerTransactionID)
+        {
+            owner_ahead = MANY_OWNERS;
+        }
+    }
+}
+
 lock_t* LockManager::lock_acquire(int table_id, int64_t key, int trx_id,
                                   LockMode mode)
 {
@@ -81,42 +149,47 @@ lock_t* LockManager::lock_acquire(int table_id, int64_t key, int trx_id,
         return nullptr;
     }
 
+    if (is_wounded(trx_id))
     {
-        std::unique_lock<std::mutex> crit { mtx };
-        if (auto it = lock_table.find(hash);
-            it == lock_table.end() || (it->second.mode == LockMode::SHARED &&
-                                       lock->lockMode == LockMode::SHARED))
-        {
-            auto& list = lock_table[hash];
+        return nullptr;
+    }
 
+    std::unordered_set<int> blockers;
+    {
+        auto& partition = partition_of(hash);
+        std::unique_lock<std::mutex> crit { partition.mtx };
+        auto& list = partition.lock_table[hash];
+        if (list.locks.empty() || (list.mode == LockMode::SHARED &&
+                                   lock->lockMode == LockMode::SHARED))
+        {
             lock->state = LockState::ACQUIRED;
             // lock->signal();
             auto& transaction = TransactionManager::instance().get(trx_id);
             transaction.state = TransactionState::RUNNING;
             lock->locked = false;
-            list.mode = mode;
-            list.locks.emplace_front(std::move(lock));
+            list.push_front(std::move(lock));
             ++list.acquire_count;
 
             return lock_ptr;
         }
 
+        if (must_die(list, trx_id))
+        {
+            return nullptr;
+        }
+
         // TODO: Transaction 관련 추가
         TransactionManager::instance().get(trx_id).state =
             TransactionState::WAITING;
 
         lock->state = LockState::WAITING;
         lock->locked = true;
-        auto& table = lock_table[hash];
-        if (table.mode == LockMode::SHARED && mode == LockMode::EXCLUSIVE)
-        {
-            table.mode = LockMode::EXCLUSIVE;
-        }
-        table.locks.emplace_back(std::move(lock));
-        ++table.wait_count;
+        list.push_back(std::move(lock));
+        ++list.wait_count;
+        blockers = blockers_of(list, lock_ptr);
     }
 
-    if (deadlock_detection(trx_id))
+    if (!on_wait(lock_ptr, blockers))
     {
         // TransactionManager::instance().abort(trx_id);
         lock_release(lock_ptr);
@@ -139,15 +212,22 @@ lock_t* LockManager::lock_upgrade(int table_id, int64_t key, int trx_id,
         return nullptr;
     }
 
+    if (is_wounded(trx_id))
     {
-        std::unique_lock<std::mutex> crit { mtx };
-        auto locklist_it = lock_table.find(hash);
+        return nullptr;
+    }
+
+    std::unordered_set<int> blockers;
+    {
+        auto& partition = partition_of(hash);
+        std::unique_lock<std::mutex> crit { partition.mtx };
+        auto locklist_it = partition.lock_table.find(hash);
         /*
         lock_upgrade는, SLock을 획득한 트랜잭션이 XLock을 획득하려 할 때
         호출되는 메소드이다. 따라서 제공된 hash에 해당하는 lock list가 존재하지
         않다면 논리적 오류가 발생한 것이다.
         */
-        CHECK_RET(locklist_it != lock_table.end(), nullptr);
+        CHECK_RET(locklist_it != partition.lock_table.end(), nullptr);
 
         auto& lock_list = locklist_it->second;
 
@@ -173,8 +253,7 @@ lock_t* LockManager::lock_upgrade(int table_id, int64_t key, int trx_id,
             // auto& transaction = TransactionManager::instance().get(trx_id);
             // transaction.state = TransactionState::RUNNING;
             lock->locked = false;
-            lock_list.mode = mode;
-            lock_list.locks.emplace_back(std::move(lock));
+            lock_list.push_back(std::move(lock));
             ++lock_list.acquire_count;
             return lock_ptr;
         }
@@ -182,17 +261,22 @@ lock_t* LockManager::lock_upgrade(int table_id, int64_t key, int trx_id,
         일반적인 경우. lock_list에 다른 트랜잭션의 lock이 존재할 경우
         이런 경우 순서상 우선인 트랜잭션들이 모두 commit될 때까지 대기해야 한다.
         */
+        if (must_die(lock_list, trx_id))
+        {
+            return nullptr;
+        }
+
         TransactionManager::instance().get(trx_id).state =
             TransactionState::WAITING;
 
         lock->state = LockState::WAITING;
         lock->locked = true;
-        lock_list.mode = LockMode::EXCLUSIVE;
-        lock_list.locks.emplace_back(std::move(lock));
+        lock_list.push_back(std::move(lock));
         ++lock_list.wait_count;
+        blockers = blockers_of(lock_list, lock_ptr);
     }
 
-    if (deadlock_detection(trx_id))
+    if (!on_wait(lock_ptr, blockers))
     {
         // TransactionManager::instance().abort(trx_id);
         lock_release(lock_ptr);
@@ -202,19 +286,33 @@ lock_t* LockManager::lock_upgrade(int table_id, int64_t key, int trx_id,
     return lock_ptr;
 }
 
-void LockManager::lock_wait(lock_t* lock_obj)
+bool LockManager::lock_wait(lock_t* lock_obj)
 {
-    while (lock_obj->wait())
+    lock_obj->wait();
+
+    int trx_id = lock_obj->ownerTransactionID;
+    switch (deadlock_config.policy)
     {
-        std::this_thread::yield();
+        case DeadlockPolicy::DETECT_INCREMENTAL:
+            erase_wait_edges(trx_id);
+            break;
+        case DeadlockPolicy::DETECT_BACKGROUND:
+        case DeadlockPolicy::WOUND_WAIT:
+        {
+            std::unique_lock<std::mutex> crit { waits_latch };
+            waiting_for.erase(trx_id);
+            break;
+        }
+        default:
+            break;
     }
 
-    std::unique_lock<std::mutex> trx_latch {
-        TransactionManager::instance().mtx
-    };
+    // signal이 transaction의 latch를 놓은 뒤에야 transaction을 지울 수 있다.
     std::unique_lock<std::mutex> crit {
-        TransactionManager::instance().get(lock_obj->ownerTransactionID).mtx
+        TransactionManager::instance().get(trx_id).mtx
     };
+
+    return lock_obj->state != LockState::ABORTED;
 }
 
 void LockManager::dfs(int now, std::unordered_map<int, graph_node>& graph,
@@ -239,24 +337,33 @@ void LockManager::dfs(int now, std::unordered_map<int, graph_node>& graph,
 
 bool LockManager::deadlock_detection(int now_transaction_id)
 {
-    std::unique_lock<std::mutex> crit { mtx };
+    // 일관된 wait-for graph를 얻기 위해 모든 partition을 순서대로 잠근다.
+    std::vector<std::unique_lock<std::mutex>> crits;
+    crits.reserve(NUM_PARTITIONS);
+    for (auto& partition : partitions)
+    {
+        crits.emplace_back(partition.mtx);
+    }
 
     std::unordered_map<int, graph_node> graph;
 
-    for (const auto& lock : lock_table)
+    for (const auto& partition : partitions)
     {
-        const auto& list = lock.second;
-        const auto wait_begin =
-            std::next(list.locks.begin(), list.acquire_count);
-        for (auto acquire = list.locks.begin(); acquire != wait_begin;
-             ++acquire)
+        for (const auto& lock : partition.lock_table)
         {
-            auto acquire_id = acquire->get()->ownerTransactionID;
-            for (auto wait = wait_begin; wait != list.locks.end(); ++wait)
+            const auto& list = lock.second;
+            const auto wait_begin =
+                std::next(list.locks.begin(), list.acquire_count);
+            for (auto acquire = list.locks.begin(); acquire != wait_begin;
+                 ++acquire)
             {
-                auto wait_id = wait->get()->ownerTransactionID;
-                graph[wait_id].next.insert(acquire_id);
-                graph[wait_id].visited = false;
+                auto acquire_id = acquire->get()->ownerTransactionID;
+                for (auto wait = wait_begin; wait != list.locks.end(); ++wait)
+                {
+                    auto wait_id = wait->get()->ownerTransactionID;
+                    graph[wait_id].next.insert(acquire_id);
+                    graph[wait_id].visited = false;
+                }
             }
         }
     }
@@ -267,16 +374,13 @@ bool LockManager::deadlock_detection(int now_transaction_id)
     return deadlock;
 }
 
-bool LockManager::lock_release(lock_t* lock_obj, bool abort)
+bool LockManager::lock_release(lock_t* lock_obj)
 {
     {
-        std::unique_lock<std::mutex> crit { mtx, std::defer_lock };
-        if (!abort)
-        {
-            crit.lock();
-        }
         LockHash hash = lock_obj->hash;
-        auto& lockList = lock_table[hash];
+        auto& partition = partition_of(hash);
+        std::unique_lock<std::mutex> crit { partition.mtx };
+        auto& lockList = partition.lock_table[hash];
         auto& table = lockList.locks;
 
         auto iter =
@@ -318,99 +422,62 @@ bool LockManager::lock_release(lock_t* lock_obj, bool abort)
             // TODO: abort 될때 처리...
             --lockList.wait_count;
         }
-        table.erase(iter);
+        lockList.erase(iter);
 
-        if (lockList.acquire_count > 0)
+        if (lockList.locks.empty())
         {
-            if (lockList.acquire_count == 1 && lockList.wait_count >= 1)
-            {
-                auto& first = *lockList.locks.begin();
-                auto& second = *std::next(lockList.locks.begin());
-                if (first->ownerTransactionID == second->ownerTransactionID)
-                {
-                    /*
-                    하나의 트랜잭션을 owner로 하는 SLock과 XLock이 만났을 때
-                    XLock을 깨워준다
-                    */
-                    CHECK(first->lockMode == LockMode::SHARED);
-                    CHECK(second->lockMode == LockMode::EXCLUSIVE);
-                    second->state = LockState::ACQUIRED;
-                    ++lockList.acquire_count;
-                    --lockList.wait_count;
-                    second->signal();
-                }
-            }
+            partition.lock_table.erase(hash);
+            return true;
+        }
 
-            bool flag = true;
-            for (const auto& it : lockList.locks)
+        // DETECT_INCREMENTAL: 깨어난 waiter의 edge는 lock_wait이 돌아올 때까지
+        // 남아서, 그 사이의 lock 요청이 없는 cycle을 찾는다.
+        std::vector<const lock_t*> waiters;
+        bool incremental =
+            deadlock_config.policy == DeadlockPolicy::DETECT_INCREMENTAL;
+        if (incremental)
+        {
+            for (const auto& lock : table)
             {
-                if (it->lockMode == LockMode::EXCLUSIVE)
+                if (lock->state == LockState::WAITING)
                 {
-                    flag = false;
-                    break;
+                    waiters.push_back(lock.get());
                 }
             }
-
-            if (flag)
-            {
-                lockList.mode = LockMode::SHARED;
-            }
-            else
-            {
-                lockList.mode = LockMode::EXCLUSIVE;
-            }
-
-            return true;
         }
 
-        if (lockList.wait_count == 0)
-        {
-            lock_table.erase(hash);
-            return true;
-        }
+        grant_waiters(lockList);
 
-        if (auto& target = table.front();
-            target->lockMode == LockMode::EXCLUSIVE)
+        if (!waiters.empty())
         {
-            CHECK(target->state == LockState::WAITING);
-            lockList.mode = LockMode::EXCLUSIVE;
-            // TODO: state, count 바꾸는 거 signal에서 담당하게
-            target->state = LockState::ACQUIRED;
-            ++lockList.acquire_count;
-            --lockList.wait_count;
-            target->signal();
-            return true;
-        }
-
-        lockList.mode = LockMode::SHARED;
-
-        for (auto& it : lockList.locks)
-        {
-            if (it->lockMode == LockMode::EXCLUSIVE)
-            {
-                lockList.mode = LockMode::EXCLUSIVE;
-                break;
-            }
-            it->state = LockState::ACQUIRED;
-            ++lockList.acquire_count;
-            --lockList.wait_count;
-            it->signal();
+            refresh_wait_edges(lockList, waiters);
         }
-        ;
     }
 
     return true;
 }
 
-const std::map<LockHash, LockList>& LockManager::get_table() const
+void LockManager::reset()
 {
-    return lock_table;
+    for (auto& partition : partitions)
+    {
+        std::unique_lock<std::mutex> lock(partition.mtx);
+        partition.lock_table.clear();
+    }
+    {
+        std::unique_lock<std::mutex> lock(graph_latch);
+        waits_for.clear();
+    }
+    {
+        std::unique_lock<std::mutex> lock(waits_latch);
+        wounded.clear();
+        waiting_for.clear();
+    }
 }
 
-void LockManager::reset()
+LockManager::~LockManager()
 {
-    std::unique_lock<std::mutex> lock(mtx);
-    lock_table.clear();
+    stop_detector();
 }
 
 lock_t::lock_t(LockHash hash, LockMode lockMode, int ownerTransactionID)
@@ -422,9 +489,27 @@ lock_t::lock_t(LockHash hash, LockMode lockMode, int ownerTransactionID)
     // Do nothing
 }
 
-bool lock_t::wait() const
+// spin 횟수의 범위
+constexpr int MIN_LOCK_SPIN = 16;
+constexpr int MAX_LOCK_SPIN = 4096;
+
+std::atomic<int> lock_t::spin_limit { MIN_LOCK_SPIN };
+
+void lock_t::wait()
 {
-    return locked;
+    int limit = spin_limit;
+    for (int i = 0; i < limit; ++i)
+    {
+        if (!locked)
+        {
+            spin_limit = std::min(limit * 2, MAX_LOCK_SPIN);
+            return;
+        }
+    }
+    spin_limit = std::max(limit / 2, MIN_LOCK_SPIN);
+
+    std::unique_lock<std::mutex> crit { wait_latch };
+    granted.wait(crit, [this]() { return !locked; });
 }
 
 void lock_t::signal()
@@ -432,11 +517,17 @@ void lock_t::signal()
     auto& transaction = TransactionManager::instance().get(ownerTransactionID);
     std::unique_lock<std::mutex> crit { transaction.mtx };
 
-    locked = false;
+    {
+        // wait_latch를 잡고 바꿔야, 검사와 잠들기 사이에 온 signal을 놓치지
+        // 않는다.
+        std::unique_lock<std::mutex> wait_crit { wait_latch };
+        locked = false;
+        granted.notify_one();
+    }
     transaction.state = TransactionState::RUNNING;
 }
 
-LockList::LockList() : wait_count(0), acquire_count(0)
+LockList::LockList() : wait_count(0), acquire_count(0), exclusive_count(0)
 {
     // Do nothing
 }
@@ -444,7 +535,39 @@ LockList::LockList() : wait_count(0), acquire_count(0)
 LockList::LockList(const LockList& rhs)
     : mode(rhs.mode),
       wait_count(rhs.wait_count),
-      acquire_count(rhs.acquire_count)
+      acquire_count(rhs.acquire_count),
+      exclusive_count(rhs.exclusive_count)
 {
     // Do nothing
+}
+
+// EXCLUSIVE lock 수만 세어 두면 mode는 O(1)에 정해진다.
+void LockList::push_front(std::unique_ptr<lock_t> lock)
+{
+    if (lock->lockMode == LockMode::EXCLUSIVE)
+    {
+        ++exclusive_count;
+    }
+    locks.emplace_front(std::move(lock));
+    mode = exclusive_count > 0 ? LockMode::EXCLUSIVE : LockMode::SHARED;
+}
+
+void LockList::push_back(std::unique_ptr<lock_t> lock)
+{
+    if (lock->lockMode == LockMode::EXCLUSIVE)
+    {
+        ++exclusive_count;
+    }
+    locks.emplace_back(std::move(lock));
+    mode = exclusive_count > 0 ? LockMode::EXCLUSIVE : LockMode::SHARED;
+}
+
+void LockList::erase(std::list<std::unique_ptr<lock_t>>::iterator it)
+{
+    if ((*it)->lockMode == LockMode::EXCLUSIVE)
+    {
+        --exclusive_count;
+    }
+    locks.erase(it);
+    mode = exclusive_count > 0 ? LockMode::EXCLUSIVE : LockMode::SHARED;
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <chrono>
+
+#include "buffer_manager.hpp"
+#include "log_manager.hpp"
+
+// fuzzy checkpoint
+// CHECKPOINT_BEGIN을 쓰고 transaction table과 dirty page table의 snapshot을
+// 뜨는 동안만 log append를 막는다. snapshot은 CHECKPOINT_TRX /
+// CHECKPOINT_DIRTY record로 남기고, CHECKPOINT_END까지 disk에 기록된 뒤에
+// header가 새 checkpoint를 가리키게 한다.
+// recovery는 header의 checkpoint부터 analysis를 시작하고, dirty page table의
+// 가장 작은 recLSN부터 redo 한다. 그러므로 (가장 작은 recLSN, 진행중인
+// transaction의 BEGIN lsn, checkpoint lsn) 중 가장 앞선 lsn 이전의 log는
+// 버려도 된다.
+// write 한 page도 fdatasync 전에는 disk에 있다고 할 수 없으므로, 먼저 data
+// file을 sync 하고 그 뒤에 write 된 page는 dirty page로 남긴다.
+
+bool LogManager::checkpoint()
+{
+    // checkpoint는 한번에 하나만 한다.
+    std::unique_lock<std::mutex> run_lock { checkpoint_run_latch };
+
+    // sync가 덮는 page를 먼저 떼어 둔다. sync 하는 동안 write 되는 page는
+    // written_table에 남는다.
+    decltype(written_table) synced_pages;
+    {
+        std::unique_lock<std::mutex> dirty_table_latch_lock {
+            dirty_table_latch
+        };
+        synced_pages.swap(written_table);
+    }
+    if (!BufferController::instance().sync_files())
+    {
+        // 다음 checkpoint에서 다시 sync 한다.
+        std::unique_lock<std::mutex> dirty_table_latch_lock {
+            dirty_table_latch
+        };
+        written_table.insert(synced_pages.begin(), synced_pages.end());
+        return false;
+    }
+
+    int64_t begin_lsn;
+    int64_t start_lsn;
+    std::vector<std::pair<int, int64_t>> trxs;
+    std::vector<std::pair<std::pair<int, pagenum_t>, int64_t>> dirty_pages;
+    {
+        std::unique_lock<std::shared_mutex> checkpoint_lock {
+            checkpoint_latch
+        };
+        CommonLogRecord begin { INVALID_LSN, INVALID_LSN, 0,
+                                LogType::CHECKPOINT_BEGIN,
+                                sizeof(CommonLogRecord) };
+        begin_lsn = buffer.append(begin);
+        start_lsn = begin_lsn;
+
+        {
+            std::unique_lock<std::mutex> trx_table_latch_lock {
+                trx_table_latch
+            };
+            trxs.assign(trx_table.begin(), trx_table.end());
+            for (auto& [trx_id, lsn] : trx_begin_table)
+            {
+                start_lsn = std::min(start_lsn, lsn);
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> dirty_table_latch_lock {
+                dirty_table_latch
+            };
+            dirty_pages.assign(dirty_table.begin(), dirty_table.end());
+            dirty_pages.insert(dirty_pages.end(), written_table.begin(),
+                               written_table.end());
+            for (auto& [page, rec_lsn] : dirty_pages)
+            {
+                start_lsn = std::min(start_lsn, rec_lsn);
+            }
+        }
+    }
+
+    // 나머지는 다른 log와 섞여서 append 되어도 된다.
+    for (auto& [trx_id, lsn] : trxs)
+    {
+        CheckpointLogRecord rec { INVALID_LSN, begin_lsn,
+                                  trx_id,      LogType::CHECKPOINT_TRX,
+                                  0,           0,
+                                  lsn,         sizeof(CheckpointLogRecord) };
+        buffer.append(rec);
+    }
+
+    for (auto& [page, rec_lsn] : dirty_pages)
+    {
+        CheckpointLogRecord rec { INVALID_LSN,
+                                  begin_lsn,
+                                  0,
+                                  LogType::CHECKPOINT_DIRTY,
+                                  page.first,
+                                  static_cast<int64_t>(page.second),
+                                  rec_lsn,
+                                  sizeof(CheckpointLogRecord) };
+        buffer.append(rec);
+    }
+
+    CommonLogRecord end { INVALID_LSN, begin_lsn, 0, LogType::CHECKPOINT_END,
+                          sizeof(CommonLogRecord) };
+    CHECK(buffer.flush_until(buffer.append(end)));
+
+    buffer.truncate(start_lsn, begin_lsn);
+    last_checkpoint_lsn = begin_lsn;
+    return true;
+}
+
+void LogManager::set_checkpoint_config(const CheckpointConfig& config)
+{
+    bool running = checkpointer_thread.joinable();
+    stop_checkpointer();
+    checkpoint_config = config;
+    if (running)
+    {
+        start_checkpointer();
+    }
+}
+
+CheckpointConfig LogManager::get_checkpoint_config() const
+{
+    return checkpoint_config;
+}
+
+void LogManager::start_checkpointer()
+{
+    if (!checkpoint_config.enabled || checkpointer_thread.joinable())
+    {
+        return;
+    }
+    checkpointer_stop = false;
+    checkpointer_thread = std::thread(&LogManager::checkpointer_loop, this);
+}
+
+void LogManager::stop_checkpointer()
+{
+    if (!checkpointer_thread.joinable())
+    {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock { checkpointer_wakeup_latch };
+        checkpointer_stop = true;
+    }
+    checkpointer_wakeup.notify_all();
+    checkpointer_thread.join();
+}
+
+void LogManager::checkpointer_loop()
+{
+    auto interval = std::chrono::milliseconds(checkpoint_config.interval_ms);
+    std::unique_lock<std::mutex> lock { checkpointer_wakeup_latch };
+    while (!checkpointer_stop)
+    {
+        checkpointer_wakeup.wait_for(lock, interval,
+                                     [this]() { return checkpointer_stop; });
+        if (checkpointer_stop)
+        {
+            break;
+        }
+        lock.unlock();
+        // log가 충분히 쌓였을 때만 checkpoint 한다.
+        if (buffer.get_last_lsn() - last_checkpoint_lsn >=
+            checkpoint_config.log_bytes)
+        {
+            checkpoint();
+        }
+        lock.lock();
+    }
+}
@@ -1,13 +1,17 @@
 #include "log_manager.hpp"
 
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <queue>
+#include <thread>
 
-#include "scoped_page_latch.hpp"
+#include "page_guard.hpp"
 
 LogReader::LogReader(const std::string& log_path, int64_t start_lsn)
     : fd(open(log_path.c_str(), O_RDONLY)),
-      now_lsn(start_lsn)
+      now_lsn(start_lsn),
+      checkpoint_lsn(INVALID_LSN)
 {
     // Do nothing
 }
@@ -21,22 +25,33 @@ LogReader::LogReader(const std::string& log_path)
     if (header.header == 0xffeeaaff)
     {
         now_lsn = header.start_lsn;
+        checkpoint_lsn = header.checkpoint_lsn;
     }
     else
     {
-        now_lsn = 0;
+        now_lsn = LOG_START_LSN;
+        checkpoint_lsn = INVALID_LSN;
+    }
+}
+
+LogReader::~LogReader()
+{
+    // abort 할 때마다 reader를 만들므로, 닫지 않으면 fd가 바닥난다.
+    if (fd != -1)
+    {
+        close(fd);
     }
 }
 
 void LogReader::print() const
 {
-    int64_t now = 0;
+    int64_t now = LOG_START_LSN;
     int readed = 1;
 
     do
     {
         LogType type;
-        int32_t record_size;
+        int32_t record_size = 0;
         auto readed = pread(fd, &type, sizeof(type), now + 20);
 
         switch (type)
@@ -56,6 +71,14 @@ void LogReader::print() const
             case LogType::UPDATE:
                 record_size = sizeof(UpdateLogRecord);
                 break;
+            case LogType::CHECKPOINT_BEGIN:
+            case LogType::CHECKPOINT_END:
+                record_size = sizeof(CommonLogRecord);
+                break;
+            case LogType::CHECKPOINT_TRX:
+            case LogType::CHECKPOINT_DIRTY:
+                record_size = sizeof(CheckpointLogRecord);
+                break;
             case LogType::INVALID:
                 record_size = 0;
                 break;
@@ -99,6 +122,17 @@ void LogReader::print() const
                 std::cout << rec << "\n\n";
                 break;
             }
+            case sizeof(CheckpointLogRecord): {
+                CheckpointLogRecord rec;
+                auto readed = pread(fd, &rec, sizeof(rec), now);
+                now += readed;
+                DB_CRASH_COND(
+                    readed == sizeof(rec), -1,
+                    "read CheckpointLogRecord failure. pread return: %ld",
+                    readed);
+                std::cout << rec << "\n\n";
+                break;
+            }
             default:
                 DB_CRASH(-1, "invalid log record size: %d. lsn: %ld",
                          record_size, now);
@@ -127,6 +161,18 @@ std::ostream& operator<<(std::ostream& os, const LogType& dt)
         case LogType::COMPENSATE:
             os << "COMPENSATE";
             break;
+        case LogType::CHECKPOINT_BEGIN:
+            os << "CHECKPOINT_BEGIN";
+            break;
+        case LogType::CHECKPOINT_TRX:
+            os << "CHECKPOINT_TRX";
+            break;
+        case LogType::CHECKPOINT_DIRTY:
+            os << "CHECKPOINT_DIRTY";
+            break;
+        case LogType::CHECKPOINT_END:
+            os << "CHECKPOINT_END";
+            break;
         case LogType::INVALID:
             os << "INVALID";
             break;
@@ -162,6 +208,14 @@ std::ostream& operator<<(std::ostream& os, const CompensateLogRecord& dt)
     return os;
 }
 
+std::ostream& operator<<(std::ostream& os, const CheckpointLogRecord& dt)
+{
+    os << dt.type << ": [" << dt.log_size << ", " << dt.lsn << ", "
+       << dt.prev_lsn << ", " << dt.transaction_id << ", " << dt.table_id
+       << ", " << dt.page_number << ", " << dt.target_lsn << "]";
+    return os;
+}
+
 std::tuple<LogType, LogRecord> LogReader::get(int64_t lsn) const
 {
     LogType type;
@@ -189,6 +243,14 @@ std::tuple<LogType, LogRecord> LogReader::get(int64_t lsn) const
         case LogType::UPDATE:
             record_size = sizeof(UpdateLogRecord);
             break;
+        case LogType::CHECKPOINT_BEGIN:
+        case LogType::CHECKPOINT_END:
+            record_size = sizeof(CommonLogRecord);
+            break;
+        case LogType::CHECKPOINT_TRX:
+        case LogType::CHECKPOINT_DIRTY:
+            record_size = sizeof(CheckpointLogRecord);
+            break;
         case LogType::INVALID:
             record_size = 0;
             break;
@@ -228,6 +290,15 @@ std::tuple<LogType, LogRecord> LogReader::get(int64_t lsn) const
             LogType type = rec.type;
             return { type, rec };
         }
+        case sizeof(CheckpointLogRecord): {
+            CheckpointLogRecord rec;
+            auto readed = pread(fd, &rec, sizeof(rec), lsn);
+            DB_CRASH_COND(readed == sizeof(rec), -1,
+                          "read CheckpointLogRecord failure. pread return: %ld",
+                          readed);
+            LogType type = rec.type;
+            return { type, rec };
+        }
         default:
             DB_CRASH(-1, "invalid log record size: %d. lsn: %ld", record_size,
                      lsn);
@@ -269,96 +340,121 @@ void LogReader::set_lsn(int64_t lsn)
     now_lsn = lsn;
 }
 
-LogBuffer::LogBuffer()
+int64_t LogReader::get_lsn() const
+{
+    return now_lsn;
+}
+
+int64_t LogReader::get_checkpoint_lsn() const
+{
+    return checkpoint_lsn;
+}
+
+LogBuffer::LogBuffer() : fd(-1), group_flushing(false)
 {
     reset();
 }
 
-void LogBuffer::reset()
+LogBuffer::~LogBuffer()
 {
+    if (fd != -1)
     {
-        std::unique_lock<std::mutex> value_latch_lock { value_latch };
-        last_lsn = 0;
-        flushed_lsn = INVALID_LSN;
-        buffer_tail = 0;
-        buffer_head = 0;
+        close(fd);
     }
 }
 
-void LogBuffer::truncate()
+void LogBuffer::reset()
 {
-    LogHeader header;
-    header.start_lsn = last_lsn;
-    pwrite(fd, &header, sizeof(header), 0);
-
-    fsync(fd);
+    set_last_lsn(LOG_START_LSN);
 }
 
-void LogBuffer::open(const std::string& log_path)
+void LogBuffer::set_last_lsn(int64_t lsn)
 {
-    fd = ::open(log_path.c_str(), O_WRONLY | O_CREAT, 0666);
+    std::unique_lock<std::mutex> crit { flush_latch };
+    last_lsn = lsn;
+    published_lsn = lsn;
+    flushed_lsn = lsn;
 }
 
-int64_t LogBuffer::append(const LogRecord& record)
+int64_t LogBuffer::get_last_lsn() const
 {
-    std::unique_lock<std::mutex> value_latch_lock { value_latch };
-    int my_lsn = last_lsn;
-    last_lsn += get_log_record_size(record);
-    int buffer_index = buffer_tail++;
- 
-    // TODO: buffer_index 넘치면 flush
-    if (buffer_index == LOG_BUFFER_SIZE)
-    {
-        --buffer_tail;
-        flush_without_value_latch_lock();
+    return last_lsn;
+}
 
-        buffer_index = buffer_tail++;
-    }
+int64_t LogBuffer::get_flushed_lsn() const
+{
+    return flushed_lsn;
+}
 
-    std::unique_lock<std::mutex> buffer_latch_lock {
-        buffer_latch[buffer_index]
-    };
+void LogBuffer::truncate(int64_t start_lsn, int64_t checkpoint_lsn)
+{
+    LogHeader header;
+    header.start_lsn = start_lsn;
+    header.checkpoint_lsn = checkpoint_lsn;
+    pwrite(fd, &header, sizeof(header), 0);
 
-    value_latch_lock.unlock();
+    fsync(fd);
 
-    buffer[buffer_index] = record;
-    std::visit(
-        [&](auto&& rec) {
-            rec.lsn = my_lsn;
-        },
-        buffer[buffer_index]);
+    // header가 disk에 기록된 뒤에야 앞부분을 버릴 수 있다.
+    // header가 있는 첫 block은 남겨두고, block 단위로 구멍을 뚫는다.
+    // 지원하지 않는 file system이면 공간만 돌려받지 못한다.
+    constexpr int64_t block = 4096;
+    int64_t end = start_lsn / block * block;
+    if (end > block)
+    {
+        fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, block,
+                  end - block);
+    }
+}
 
-    return my_lsn;
+void LogBuffer::open(const std::string& log_path)
+{
+    if (fd != -1)
+    {
+        close(fd);
+    }
+    fd = ::open(log_path.c_str(), O_WRONLY | O_CREAT, 0666);
 }
 
+void LogBuffer::copy_to_ring(int64_t lsn, const void* src, std::size_t size)
+{
+    std::size_t pos = lsn % LOG_BUFFER_SIZE;
+    std::size_t first = std::min(size, LOG_BUFFER_SIZE - pos);
+    std::memcpy(ring.data() + pos, src, first);
+    std::memcpy(ring.data(), static_cast<const char*>(src) + first,
+                size - first);
+}
 
-void LogBuffer::flush_without_value_latch_lock()
+int64_t LogBuffer::append(const LogRecord& record)
 {
-    std::unique_lock<std::mutex> crit { flush_latch };
+    // 자리만 잡고 latch 없이 ring에 쓴다.
+    const int64_t size = get_log_record_size(record);
+    const int64_t lsn = last_lsn.fetch_add(size);
+    const int64_t end = lsn + size;
 
-    for (int i = buffer_head; i < buffer_tail; ++i)
+    // ring이 가득 찼다면, 내 자리가 비워질 때까지 flush 한다.
+    while (end > flushed_lsn + static_cast<int64_t>(LOG_BUFFER_SIZE))
     {
-        buffer_latch[i].lock();
+        flush();
+        std::this_thread::yield();
     }
 
-    for (int i = buffer_head; i < buffer_tail; ++i)
-    {
-        std::visit(
-            [&](auto&& rec) {
-                pwrite(fd, &rec, sizeof(rec), rec.lsn);
-            },
-            buffer[i]);
-    }
+    std::visit(
+        [&](auto rec) {
+            rec.lsn = lsn;
+            copy_to_ring(lsn, &rec, sizeof(rec));
+        },
+        record);
 
-    for (int i = buffer_head; i < buffer_tail; ++i)
+    // 앞선 record가 모두 publish 된 뒤에 publish 해야
+    // [flushed_lsn, published_lsn) 구간에 빈 곳이 생기지 않는다.
+    while (published_lsn != lsn)
     {
-        buffer_latch[i].unlock();
+        std::this_thread::yield();
     }
+    published_lsn = end;
 
-    buffer_tail = 0;
-    buffer_head = 0;
-
-    fsync(fd);
+    return lsn;
 }
 
 void LogBuffer::flush()
@@ -366,93 +462,67 @@ void LogBuffer::flush()
     // flush는 한번에 한 스레드에서만 호출 가능하다.
     std::unique_lock<std::mutex> crit { flush_latch };
 
-    // flush 중에는 log가 추가되는 것을 막는다
-    std::unique_lock<std::mutex> value_latch_lock { value_latch };
-
-    // 버퍼에 존재하는 모든 로그의 latch를 잠근다.
-    // 로그를 작성하는 스레드늨 buffer_tail을 증가시킬 때 buffer_latch를 걸고,
-    // 로그 작성이 완료된 후에 buffer_latch를 푼다. 즉, flush에서 모든
-    // buffer_latch의 lock을 얻을 때까지 대기한다는 건, 현재 작성중인 모든
-    // 로그의 작성이 완료될 때까지 대기한다는 의미이다.
-    for (int i = buffer_head; i < buffer_tail; ++i)
+    const int64_t begin = flushed_lsn;
+    const int64_t end = published_lsn;
+    if (begin == end)
     {
-        buffer_latch[i].lock();
+        return;
     }
 
-    // O_APPEND 옵션이 있어 로그가 파일 맨 뒤에 작성되므로 flushed_lsn을
-    // 신경쓰지 않아도 된다.
-    for (int i = buffer_head; i < buffer_tail; ++i)
+    // flushed_lsn을 옮기기 전까지는 append가 [begin, end) 구간을 덮어쓰지
+    // 않으므로, ring을 그대로 write 한다. ring 끝에서 넘어가면 두 번 나눈다.
+    std::size_t pos = begin % LOG_BUFFER_SIZE;
+    std::size_t size = end - begin;
+    std::size_t first = std::min(size, LOG_BUFFER_SIZE - pos);
+    auto written = pwrite(fd, ring.data() + pos, first, begin);
+    DB_CRASH_COND(written == static_cast<ssize_t>(first), -1,
+                  "write log failure. pwrite return: %ld", written);
+    if (first != size)
     {
-        std::visit(
-            [&](auto&& rec) {
-                pwrite(fd, &rec, sizeof(rec), rec.lsn);
-            },
-            buffer[i]);
+        written = pwrite(fd, ring.data(), size - first, begin + first);
+        DB_CRASH_COND(written == static_cast<ssize_t>(size - first), -1,
+                      "write log failure. pwrite return: %ld", written);
     }
 
-    // latch를 푼다.
-    for (int i = buffer_head; i < buffer_tail; ++i)
-    {
-        buffer_latch[i].unlock();
-    }
-
-    // log buffer를 초기화한다.
-    buffer_tail = 0;
-    buffer_head = 0;
-
     // buffer 파일을 디스크에 기록한다.
     fsync(fd);
+    flushed_lsn = end;
 }
 
 bool LogBuffer::flush_prev_lsn(int64_t page_lsn)
-{ 
-    // flush 함수는 한번에 한 스레드에서만 호출 가능하다.
-    std::unique_lock<std::mutex> crit { flush_latch };
-
-    // flush 중에는 log가 추가되는 것을 막는다
-    std::unique_lock<std::mutex> value_latch_lock { value_latch };
-
-    // buffer_latch를 잠그면서, page_lsn보다 큰 로그가 처음으로 등장하는 위치를
-    // 찾는다.
-    int border = buffer_head;
-    for (border = buffer_head; border < buffer_tail; ++border)
-    { 
-        buffer_latch[border].lock(); 
-        if (std::visit(
-                [&](auto&& arg) {
-                     return arg.lsn > page_lsn;
-                },
-                buffer[border]))
-        {
-            buffer_latch[border].unlock();
-            break;
-        }
-    }
-
-    for (int i = buffer_head; i < border; ++i)
-    {
-        std::visit(
-            [&](auto&& rec) {
-                pwrite(fd, &rec, sizeof(rec), rec.lsn);
-            },
-            buffer[i]);
-    } 
-
-    // latch를 푼다.
-    for (int i = buffer_head; i < border; ++i)
+{
+    // 이미 disk에 기록된 log라면 latch를 잡을 필요가 없다.
+    if (page_lsn < flushed_lsn)
     {
-        buffer_latch[i].unlock();
+        return true;
     }
 
-    // buffer의 앞부분만 flush 했다.
-    // 그러므로, buffer_head를 border 위치로 옮겨 앞부분F을 사용하지 않게
-    // 만든다.
-
-    buffer_head = border;
+    // page_lsn의 log는 이미 publish 되었으므로, 한 번의 flush로 충분하다.
+    flush();
+    return true;
+}
 
-    // buffer 파일을 디스크에 기록한다.
-    fsync(fd);
+bool LogBuffer::flush_until(int64_t lsn)
+{
+    std::unique_lock<std::mutex> lock { group_latch };
+    while (flushed_lsn <= lsn)
+    {
+        if (group_flushing)
+        {
+            // leader의 flush가 끝나기를 기다린다.
+            group_flushed.wait(lock);
+            continue;
+        }
 
+        // leader가 되어, 지금까지 append 된 log를 한꺼번에 flush 한다.
+        // flush 하는 동안 도착한 thread들은 다음 leader가 함께 처리한다.
+        group_flushing = true;
+        lock.unlock();
+        flush();
+        lock.lock();
+        group_flushing = false;
+        group_flushed.notify_all();
+    }
     return true;
 }
 
@@ -465,6 +535,12 @@ void LogManager::open(const std::string& log_path,
 }
 
 int64_t LogManager::log_wrapper(int transaction_id, const LogRecord& rec)
+{
+    std::shared_lock<std::shared_mutex> checkpoint_lock { checkpoint_latch };
+    return append_log(transaction_id, rec);
+}
+
+int64_t LogManager::append_log(int transaction_id, const LogRecord& rec)
 {
     auto lsn = buffer.append(rec);
     std::unique_lock<std::mutex> trx_table_latch_lock { trx_table_latch };
@@ -472,13 +548,55 @@ int64_t LogManager::log_wrapper(int transaction_id, const LogRecord& rec)
     return lsn;
 }
 
+int64_t LogManager::get_trx_last_lsn(int transaction_id)
+{
+    std::unique_lock<std::mutex> trx_table_latch_lock { trx_table_latch };
+    auto it = trx_table.find(transaction_id);
+    return it != trx_table.end() ? it->second : INVALID_LSN;
+}
+
 void LogManager::reset()
 {
+    stop_checkpointer();
     log_path.clear();
     logmsg_path.clear();
     buffer.reset();
     trx_table.clear();
+    trx_begin_table.clear();
     dirty_table.clear();
+    written_table.clear();
+    last_checkpoint_lsn = INVALID_LSN;
+}
+
+LogManager::~LogManager()
+{
+    stop_checkpointer();
+}
+
+void LogManager::make_dirty(int table_id, pagenum_t pagenum, int64_t lsn)
+{
+    std::unique_lock<std::mutex> dirty_table_latch_lock { dirty_table_latch };
+    // 이미 dirty라면 처음 dirty가 된 lsn(recLSN)을 유지한다.
+    dirty_table.emplace(std::make_pair(table_id, pagenum), lsn);
+}
+
+void LogManager::make_clean(int table_id, pagenum_t pagenum)
+{
+    std::unique_lock<std::mutex> dirty_table_latch_lock { dirty_table_latch };
+    auto it = dirty_table.find(std::make_pair(table_id, pagenum));
+    if (it == dirty_table.end())
+    {
+        return;
+    }
+    // sync 전에 다시 write 되면 앞선 recLSN을 유지한다.
+    written_table.insert(*it);
+    dirty_table.erase(it);
+}
+
+std::size_t LogManager::unsynced_pages()
+{
+    std::unique_lock<std::mutex> dirty_table_latch_lock { dirty_table_latch };
+    return written_table.size();
 }
 
 bool LogManager::recovery(RecoveryMode mode, int log_num)
@@ -486,12 +604,33 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
     Message msg { logmsg_path };
     std::vector<int> winners;
     std::vector<int> losers;
+    // analysis에서 복원한 dirty page table. (table id, page number) -> recLSN
+    std::map<std::pair<int, pagenum_t>, int64_t> dirty_pages;
 
-    int64_t last_lsn = 0;
+    auto open_table_file = [](int table_id) {
+        if (!BufferController::instance().fileManagerExist(table_id))
+        {
+            std::string s = "DATA" + std::to_string(table_id);
+            BufferController::instance().openFileManager(s);
+        }
+    };
+
+    auto add_dirty_page = [&dirty_pages](int table_id, pagenum_t pagenum,
+                                         int64_t rec_lsn) {
+        auto [it, inserted] =
+            dirty_pages.emplace(std::make_pair(table_id, pagenum), rec_lsn);
+        it->second = std::min(it->second, rec_lsn);
+    };
 
     // analysis
+    // 마지막 checkpoint부터 읽는다. checkpoint 이전의 transaction table과
+    // dirty page table은 CHECKPOINT_TRX / CHECKPOINT_DIRTY record로 복원한다.
     {
         LogReader reader { log_path };
+        if (reader.get_checkpoint_lsn() != INVALID_LSN)
+        {
+            reader.set_lsn(reader.get_checkpoint_lsn());
+        }
         // reader.print();
         msg.analysis_start();
 
@@ -503,9 +642,45 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
                 break;
             }
 
-            last_lsn = get_log_record_lsn(rec);
-            std::cout << 'l' << last_lsn << ' ';
-            trx_table[get_log_record_trx(rec)] = last_lsn;
+            if (type == LogType::CHECKPOINT_BEGIN ||
+                type == LogType::CHECKPOINT_END)
+            {
+                continue;
+            }
+
+            if (type == LogType::CHECKPOINT_TRX)
+            {
+                auto& record = std::get<CheckpointLogRecord>(rec);
+                int target = record.transaction_id;
+                // checkpoint 도중에 commit 된 transaction은 이미 winner다.
+                if (std::find(winners.begin(), winners.end(), target) !=
+                    winners.end())
+                {
+                    continue;
+                }
+                if (std::find(losers.begin(), losers.end(), target) ==
+                    losers.end())
+                {
+                    losers.emplace_back(target);
+                }
+                // checkpoint 도중에 추가된 log가 먼저 읽혔을 수 있다.
+                auto& last = trx_table[target];
+                last = std::max(last, record.target_lsn);
+                continue;
+            }
+
+            if (type == LogType::CHECKPOINT_DIRTY)
+            {
+                auto& record = std::get<CheckpointLogRecord>(rec);
+                open_table_file(record.table_id);
+                add_dirty_page(record.table_id, record.page_number,
+                               record.target_lsn);
+                continue;
+            }
+
+            int64_t lsn = get_log_record_lsn(rec);
+            std::cout << 'l' << lsn << ' ';
+            trx_table[get_log_record_trx(rec)] = lsn;
 
             if (type == LogType::BEGIN)
             {
@@ -545,43 +720,52 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
             if (type == LogType::UPDATE)
             {
                 auto target = std::get<UpdateLogRecord>(rec);
-                if (!BufferController::instance().fileManagerExist(
-                        target.table_id))
-                {
-                    std::string s = "DATA" + std::to_string(target.table_id);
-                    BufferController::instance().openFileManager(s);
-                }
+                open_table_file(target.table_id);
+                add_dirty_page(target.table_id, target.page_number, lsn);
             }
 
             if (type == LogType::COMPENSATE)
             {
                 auto target = std::get<CompensateLogRecord>(rec);
-                if (!BufferController::instance().fileManagerExist(
-                        target.table_id))
-                {
-                    std::string s = "DATA" + std::to_string(target.table_id);
-                    BufferController::instance().openFileManager(s);
-                }
+                open_table_file(target.table_id);
+                add_dirty_page(target.table_id, target.page_number, lsn);
             }
         }
 
+        // 다음 log는 마지막으로 읽은 log 바로 뒤에 쓴다.
+        buffer.set_last_lsn(reader.get_lsn());
+        last_checkpoint_lsn = reader.get_lsn();
+
         msg.analysis_end(winners, losers);
     }
 
-    if (winners.empty() && losers.empty())
+    if (losers.empty() && dirty_pages.empty())
     {
+        trx_table.clear();
         return true;
     }
 
-    buffer.last_lsn = last_lsn;
-
     msg.redo_pass_start();
 
     std::cout << "redo start" << std::endl;
 
     // REDO
+    // dirty page table의 가장 작은 recLSN부터 시작한다. dirty page table에
+    // 없거나 recLSN보다 앞선 log는 page를 읽지 않고 건너뛴다.
+    int64_t redo_lsn = buffer.get_last_lsn();
+    for (auto& [page, rec_lsn] : dirty_pages)
     {
-        LogReader reader { log_path };
+        redo_lsn = std::min(redo_lsn, rec_lsn);
+    }
+
+    auto need_redo = [&dirty_pages](int table_id, pagenum_t pagenum,
+                                    int64_t lsn) {
+        auto it = dirty_pages.find(std::make_pair(table_id, pagenum));
+        return it != dirty_pages.end() && it->second <= lsn;
+    };
+
+    {
+        LogReader reader { log_path, redo_lsn };
         bool flag = true;
         for (int i = 0; flag; ++i)
         {
@@ -611,21 +795,27 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
                     CompensateLogRecord& record =
                         std::get<CompensateLogRecord>(rec);
 
+                    if (!need_redo(record.table_id, record.page_number,
+                                   record.lsn))
+                    {
+                        msg.consider_redo_compensate(record.lsn,
+                                                     record.transaction_id);
+                        break;
+                    }
+
                     // redo compensate
-                    page_t page;
-                    BufferController::instance().get(record.table_id,
-                                                     record.page_number, page);
+                    page_guard guard(record.table_id, record.page_number,
+                                     LatchMode::EXCLUSIVE);
+                    const page_t& page = guard.page();
 
                     // consider redo?
                     if (page.nodePageHeader().pageLsn < record.lsn)
                     {
-                        
-                        std::memcpy((char*)(&page) + record.offset,
+                        page_t& target = guard.mutable_page();
+                        std::memcpy((char*)(&target) + record.offset,
                                     (char*)(&record.new_image),
                                     record.data_length);
-                        page.nodePageHeader().pageLsn = record.lsn;
-                        BufferController::instance().put(
-                            record.table_id, record.page_number, page);
+                        target.nodePageHeader().pageLsn = record.lsn;
                         msg.compensate(record.lsn, record.next_undo_lsn);
                     }
                     else
@@ -644,20 +834,26 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
                 case LogType::UPDATE: {
                     UpdateLogRecord& record = std::get<UpdateLogRecord>(rec);
 
+                    if (!need_redo(record.table_id, record.page_number,
+                                   record.lsn))
+                    {
+                        msg.consider_redo_update(record.lsn,
+                                                 record.transaction_id);
+                        break;
+                    }
+
                     // redo update
-                    page_t page;
-                    BufferController::instance().get(record.table_id,
-                                                     record.page_number, page);
+                    page_guard guard(record.table_id, record.page_number,
+                                     LatchMode::EXCLUSIVE);
+                    const page_t& page = guard.page();
                     // consider redo?
                     if (page.nodePageHeader().pageLsn < record.lsn)
                     {
-                        
-                        std::memcpy((char*)(&page) + record.offset,
+                        page_t& target = guard.mutable_page();
+                        std::memcpy((char*)(&target) + record.offset,
                                     (char*)(&record.new_image),
                                     record.data_length);
-                        page.nodePageHeader().pageLsn = record.lsn;
-                        BufferController::instance().put(
-                            record.table_id, record.page_number, page);
+                        target.nodePageHeader().pageLsn = record.lsn;
                         msg.update_redo(record.lsn, record.transaction_id);
                     }
                     else
@@ -668,6 +864,11 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
                     }
                     break;
                 }
+                case LogType::CHECKPOINT_BEGIN:
+                case LogType::CHECKPOINT_TRX:
+                case LogType::CHECKPOINT_DIRTY:
+                case LogType::CHECKPOINT_END:
+                    break;
                 case LogType::INVALID:
                     flag = false;
                     break;
@@ -678,7 +879,7 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
     msg.redo_pass_end();
     msg.undo_pass_start();
 
-    std::priority_queue<int> next_undo_lsn_pq;
+    std::priority_queue<int64_t> next_undo_lsn_pq;
 
     for (int it : losers)
     {
@@ -756,10 +957,13 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
                 case LogType::UPDATE: {
                     UpdateLogRecord& record = std::get<UpdateLogRecord>(rec);
 
+                    // checkpoint 이전의 log라면 analysis에서 table을 열지
+                    // 않았을 수 있다.
+                    open_table_file(record.table_id);
+
                     // redo update
-                    page_t page;
-                    BufferController::instance().get(record.table_id,
-                                                     record.page_number, page);
+                    page_guard guard(record.table_id, record.page_number,
+                                     LatchMode::EXCLUSIVE);
 
                     CompensateLogRecord clr {
                         INVALID_LSN,           trx_table[record.transaction_id],
@@ -770,15 +974,20 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
                         record.prev_lsn,       sizeof(CompensateLogRecord)
                     };
                     trx_table[record.transaction_id] = buffer.append(clr);
-                    std::memcpy((char*)(&page) + record.offset,
+                    std::memcpy((char*)(&guard.mutable_page()) + record.offset,
                                 (char*)(&record.old_image), record.data_length);
-                    BufferController::instance().put(record.table_id,
-                                                     record.page_number, page);
                     msg.update_undo(record.lsn, record.transaction_id);
 
                     next_undo_lsn_pq.push(record.prev_lsn);
                     break;
                 }
+                case LogType::CHECKPOINT_BEGIN:
+                case LogType::CHECKPOINT_TRX:
+                case LogType::CHECKPOINT_DIRTY:
+                case LogType::CHECKPOINT_END:
+                    // transaction의 log chain에 checkpoint가 있을 수 없다
+                    DB_CRASH(-1, "checkpoint log in undo chain");
+                    break;
                 case LogType::INVALID:
                     DB_CRASH(-1, "INVALID logtype");
                     break;
@@ -792,7 +1001,10 @@ bool LogManager::recovery(RecoveryMode mode, int log_num)
     buffer.flush();
     BufferController::instance().sync();
 
-    buffer.truncate();
+    // 모든 transaction이 정리되었고 page도 모두 write 했으므로, 지금까지의
+    // log는 더 이상 필요 없다.
+    trx_table.clear();
+    checkpoint();
 
     return true;
 }
@@ -801,15 +1013,36 @@ int64_t LogManager::begin_log(int transaction_id)
 {
     CommonLogRecord record { INVALID_LSN, INVALID_LSN, transaction_id,
                              LogType::BEGIN, sizeof(CommonLogRecord) };
-    return log_wrapper(transaction_id, record);
+    std::shared_lock<std::shared_mutex> checkpoint_lock { checkpoint_latch };
+    auto lsn = append_log(transaction_id, record);
+    std::unique_lock<std::mutex> trx_table_latch_lock { trx_table_latch };
+    trx_begin_table[transaction_id] = lsn;
+    return lsn;
 }
 
 int64_t LogManager::commit_log(int transaction_id)
 {
-    CommonLogRecord record { INVALID_LSN, trx_table[transaction_id],
+    CommonLogRecord record { INVALID_LSN, get_trx_last_lsn(transaction_id),
                              transaction_id, LogType::COMMIT,
                              sizeof(CommonLogRecord) };
-    return log_wrapper(transaction_id, record);
+    std::shared_lock<std::shared_mutex> checkpoint_lock { checkpoint_latch };
+    auto lsn = buffer.append(record);
+    // commit 된 transaction은 checkpoint의 transaction table에서 빠진다.
+    std::unique_lock<std::mutex> trx_table_latch_lock { trx_table_latch };
+    trx_table.erase(transaction_id);
+    trx_begin_table.erase(transaction_id);
+    return lsn;
+}
+
+int64_t LogManager::oldest_active_lsn()
+{
+    std::unique_lock<std::mutex> trx_table_latch_lock { trx_table_latch };
+    int64_t oldest = std::numeric_limits<int64_t>::max();
+    for (auto& [trx_id, lsn] : trx_begin_table)
+    {
+        oldest = std::min(oldest, lsn);
+    }
+    return oldest;
 }
 
 int64_t LogManager::update_log(int transaction_id, int table_id,
@@ -818,7 +1051,7 @@ int64_t LogManager::update_log(int transaction_id, int table_id,
                                const valType& new_image)
 {
     UpdateLogRecord record { INVALID_LSN,
-                             trx_table[transaction_id],
+                             get_trx_last_lsn(transaction_id),
                              transaction_id,
                              LogType::UPDATE,
                              table_id,
@@ -828,7 +1061,10 @@ int64_t LogManager::update_log(int transaction_id, int table_id,
                              old_image,
                              new_image,
                              sizeof(UpdateLogRecord) };
-    return log_wrapper(transaction_id, record);
+    std::shared_lock<std::shared_mutex> checkpoint_lock { checkpoint_latch };
+    auto lsn = append_log(transaction_id, record);
+    make_dirty(table_id, page_number, lsn);
+    return lsn;
 }
 
 bool LogManager::flush_prev_lsn(int64_t page_lsn)
@@ -842,18 +1078,26 @@ bool LogManager::flush()
     return true;
 }
 
+bool LogManager::flush_until(int64_t lsn)
+{
+    return buffer.flush_until(lsn);
+}
+
+int64_t LogManager::get_flushed_lsn() const
+{
+    return buffer.get_flushed_lsn();
+}
+
 bool LogManager::rollback(int transaction_id)
 {
-    auto it = trx_table.find(transaction_id);
-    if (it == trx_table.end())
+    int64_t now = get_trx_last_lsn(transaction_id);
+    if (now == INVALID_LSN)
     {
         // 트랜잭션이 begin 할때 무조건 begin 로그가 작성되는데, trx_table에 trx
         // id가 없다는 건 trx id가 invalid 하다는 의미
         return false;
     }
 
-    int now = it->second;
-
     // rollback 전에 buffer를 flush 하면, abort된 트랜잭션의 로그가 buffer에
     // 일부 남아있는 케이스를 무시하고 간단하게 구현할 수 있다.
     buffer.flush();
@@ -873,10 +1117,15 @@ bool LogManager::rollback(int transaction_id)
             case LogType::UPDATE: {
                 auto& record = std::get<UpdateLogRecord>(rec);
 
+                // page를 먼저 잠가야, compensate 로그를 쓰고 page를 수정하는
+                // 사이에 page가 write 되어 dirty page table에서 빠지지 않는다.
+                page_guard guard(record.table_id, record.page_number,
+                                 LatchMode::EXCLUSIVE);
+
                 // TODO: table_id와 file_id가 같은가?
                 // compensate 로그를 먼저 쓴다.
                 CompensateLogRecord clr {
-                    INVALID_LSN,      trx_table[transaction_id],
+                    INVALID_LSN,      get_trx_last_lsn(transaction_id),
                     transaction_id,   LogType::COMPENSATE,
                     record.table_id,  record.page_number,
                     record.offset,    record.data_length,
@@ -884,24 +1133,20 @@ bool LogManager::rollback(int transaction_id)
                     record.prev_lsn,  sizeof(CompensateLogRecord)
                 };
 
-                auto lsn = buffer.append(clr);
-
+                int64_t lsn;
                 {
-                    std::unique_lock<std::mutex> trx_table_latch_lock {
-                        trx_table_latch
+                    std::shared_lock<std::shared_mutex> checkpoint_lock {
+                        checkpoint_latch
                     };
-                    trx_table[transaction_id] = lsn;
+                    lsn = append_log(transaction_id, clr);
+                    make_dirty(record.table_id, record.page_number, lsn);
                 }
 
-                page_t page;
-                BufferController::instance().get(record.table_id,
-                                                 record.page_number, page);
+                page_t& page = guard.mutable_page();
 
                 page.nodePageHeader().pageLsn = lsn;
                 std::memcpy((char*)(&page) + record.offset,
                             (char*)(&record.old_image), record.data_length);
-                BufferController::instance().put(record.table_id,
-                                                 record.page_number, page);
                 now = record.prev_lsn;
                 break; 
             }
@@ -922,6 +1167,14 @@ bool LogManager::rollback(int transaction_id)
                 DB_CRASH(-1, "commited transaction cannot be rolled back");
                 break;
 
+            case LogType::CHECKPOINT_BEGIN:
+            case LogType::CHECKPOINT_TRX:
+            case LogType::CHECKPOINT_DIRTY:
+            case LogType::CHECKPOINT_END:
+                // transaction의 log chain에 checkpoint가 있을 수 없다
+                DB_CRASH(-1, "checkpoint log in undo chain");
+                break;
+
             case LogType::INVALID:
                 // invalid가 등장하면 안된다
                 DB_CRASH(-1, "invalid log type");
@@ -929,14 +1182,18 @@ bool LogManager::rollback(int transaction_id)
         }
     }
 
-    CommonLogRecord record { INVALID_LSN, trx_table[transaction_id],
+    CommonLogRecord record { INVALID_LSN, get_trx_last_lsn(transaction_id),
                              transaction_id, LogType::ROLLBACK,
                              sizeof(CommonLogRecord) };
-    buffer.append(record);
-
     {
+        std::shared_lock<std::shared_mutex> checkpoint_lock {
+            checkpoint_latch
+        };
+        buffer.append(record);
+
         std::unique_lock<std::mutex> trx_table_latch_lock { trx_table_latch };
         trx_table.erase(transaction_id);
+        trx_begin_table.erase(transaction_id);
     }
 
     buffer.flush();
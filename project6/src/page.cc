@@ -18,10 +18,50 @@ std::ostream& operator<<(std::ostream& os, const valType& dt)
     return os;
 }
 
+int value_length(const valType& value)
+{
+    int length = 0;
+    while (length < max_value_length && value[length])
+    {
+        ++length;
+    }
+    return length;
+}
+
+bool fixed_leaf_format(int width, LeafFormat& format)
+{
+    for (auto fixed : { LeafFormat::FIXED_8, LeafFormat::FIXED_16,
+                        LeafFormat::FIXED_32, LeafFormat::FIXED_64 })
+    {
+        if (leaf_value_limit(fixed) == width)
+        {
+            format = fixed;
+            return true;
+        }
+    }
+    return false;
+}
+
+int leaf_value_limit(LeafFormat format)
+{
+    if (leaf_has_cells(format) || format == LeafFormat::RECORDS)
+    {
+        return max_value_length;
+    }
+    return with_value_width(
+        format, [](auto width) { return decltype(width)::value; });
+}
+
 std::ostream& operator<<(std::ostream& os, const NodePageHeader& nph)
 {
     os << "\nparentPageNumber: " << nph.parentPageNumber
        << "\nisLeaf: " << nph.isLeaf << "\nnumberOfKeys: " << nph.numberOfKeys
+       << "\nlevel: " << nph.level
+       << "\nleafFormat: " << static_cast<int>(nph.leafFormat)
+       << "\ninternalFormat: " << static_cast<int>(nph.internalFormat)
+       << "\ncellBegin: " << nph.cellBegin << "\nlowKey: " << nph.lowKey
+       << "\nhighKey: " << nph.highKey
+       << "\nrightPageNumber: " << nph.rightPageNumber
        << "\nonePageNumber: " << nph.onePageNumber << "\n";
     return os;
 }
@@ -30,6 +70,9 @@ std::ostream& operator<<(std::ostream& os, const HeaderPageHeader& hph)
 {
     os << "\nfreePageNumber:" << hph.freePageNumber
        << "\nnumberOfPages:" << hph.numberOfPages
+       << "\npageSize:" << hph.pageSize
+       << "\nleafFormat:" << hph.leafFormat
+       << "\nfileFormat:" << hph.fileFormat
        << "\nrootPageNumber: " << hph.rootPageNumber << '\n';
     return os;
 }
@@ -40,36 +83,32 @@ void page_t::print_node() const
     std::cout << head;
     if (head.isLeaf)
     {
-        auto& body = records();
+        KeyValue rec;
         for (int i = 0; i < static_cast<int>(head.numberOfKeys); ++i)
         {
-            std::cout << "[" << i << "] (" << body[i].key << ", "
-                      << body[i].value.data() << ")\n";
+            leaf_read(i, rec);
+            std::cout << "[" << i << "] (" << rec.key << ", ";
+            if (rec.overflow != EMPTY_PAGE_NUMBER)
+            {
+                std::cout << "overflow " << rec.overflow;
+            }
+            else
+            {
+                std::cout << rec.value;
+            }
+            std::cout << ")\n";
         }
     }
     else
     {
-        auto& body = internals();
         for (int i = 0; i < static_cast<int>(head.numberOfKeys); ++i)
         {
-            std::cout << "[" << i << "] (" << body[i].key << ", "
-                      << body[i].node_id << ")\n";
+            std::cout << "[" << i << "] (" << internal_key(i) << ", "
+                      << internal_child(i) << ")\n";
         }
     }
 }
 
-template<>
-const Records& page_t::getEntry() const
-{
-    return entry.records;
-}
-
-template<>
-const Internals& page_t::getEntry() const
-{
-    return entry.internals;
-}
-
 template<>
 const HeaderPageHeader& page_t::getHeader() const
 {
@@ -88,18 +127,6 @@ const FreePageHeader& page_t::getHeader() const
     return header.freePageHeader;
 }
 
-template<>
-Records& page_t::getEntry()
-{
-    return const_cast<Records&>(std::as_const(*this).getEntry<Records>());
-}
-
-template<>
-Internals& page_t::getEntry()
-{
-    return const_cast<Internals&>(std::as_const(*this).getEntry<Internals>());
-}
-
 template<>
 HeaderPageHeader& page_t::getHeader()
 {
@@ -165,4 +192,51 @@ pagenum_t page_t::next_leaf() const
 void page_t::set_next_leaf(pagenum_t next_leaf)
 {
     nodePageHeader().onePageNumber = next_leaf;
-}
\ No newline at end of file
+}
+
+uint32_t page_t::level() const
+{
+    return nodePageHeader().level;
+}
+
+void page_t::set_level(uint32_t level)
+{
+    nodePageHeader().level = level;
+}
+
+keyType page_t::low_key() const
+{
+    return nodePageHeader().lowKey;
+}
+
+void page_t::set_low_key(keyType key)
+{
+    nodePageHeader().lowKey = key;
+}
+
+keyType page_t::high_key() const
+{
+    return nodePageHeader().highKey;
+}
+
+void page_t::set_high_key(keyType key)
+{
+    nodePageHeader().highKey = key;
+}
+
+pagenum_t page_t::right_sibling() const
+{
+    return is_leaf() ? next_leaf() : nodePageHeader().rightPageNumber;
+}
+
+void page_t::set_right_sibling(pagenum_t right_sibling)
+{
+    if (is_leaf())
+    {
+        set_next_leaf(right_sibling);
+    }
+    else
+    {
+        nodePageHeader().rightPageNumber = right_sibling;
+    }
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <chrono>
+
+#include "buffer_manager.hpp"
+
+// background page cleaner
+// 주기적으로 깨어나서, 곧 eviction 될 frame 중 dirty인 것을 미리 write 한다.
+// dirty frame의 비율이 목표치를 넘으면 나머지 frame도 돌면서 write 한다.
+// 덕분에 frame_alloc에서 victim을 쫓아낼 때 write와 log flush를 기다리는
+// 일이 줄어든다.
+
+void BufferController::set_page_cleaner_config(const PageCleanerConfig& config)
+{
+    bool running = cleaner_thread.joinable();
+    stop_page_cleaner();
+    cleaner_config = config;
+    if (running)
+    {
+        start_page_cleaner();
+    }
+}
+
+PageCleanerConfig BufferController::get_page_cleaner_config() const
+{
+    return cleaner_config;
+}
+
+std::size_t BufferController::cleaned_pages() const
+{
+    return cleaned_count;
+}
+
+std::size_t BufferController::dirty_frames() const
+{
+    std::size_t count = 0;
+    for (auto& frame : *buffer)
+    {
+        if (frame.valid() && frame.is_dirty)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void BufferController::start_page_cleaner()
+{
+    if (!cleaner_config.enabled || cleaner_thread.joinable())
+    {
+        return;
+    }
+    cleaner_stop = false;
+    cleaner_thread = std::thread(&BufferController::page_cleaner_loop, this);
+}
+
+void BufferController::stop_page_cleaner()
+{
+    if (!cleaner_thread.joinable())
+    {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock { cleaner_wakeup_latch };
+        cleaner_stop = true;
+    }
+    cleaner_wakeup.notify_all();
+    cleaner_thread.join();
+}
+
+void BufferController::page_cleaner_loop()
+{
+    auto interval = std::chrono::milliseconds(cleaner_config.interval_ms);
+    std::unique_lock<std::mutex> lock { cleaner_wakeup_latch };
+    while (!cleaner_stop)
+    {
+        cleaner_wakeup.wait_for(lock, interval, [this]() { return cleaner_stop; });
+        if (cleaner_stop)
+        {
+            break;
+        }
+        lock.unlock();
+        clean_round();
+        lock.lock();
+    }
+}
+
+std::size_t BufferController::clean_round()
+{
+    std::size_t budget = std::max<std::size_t>(
+        1, cleaner_config.max_pages_per_sec * cleaner_config.interval_ms / 1000);
+    std::size_t cleaned = 0;
+
+    // 1. eviction 후보를 먼저 write 한다.
+    std::vector<int> candidates;
+    {
+        std::unique_lock<std::mutex> policy_lock { policy_latch };
+        eviction_candidates(cleaner_config.lru_scan_depth, candidates);
+    }
+    for (int index : candidates)
+    {
+        if (cleaned == budget)
+        {
+            return cleaned;
+        }
+        if (clean_frame(index))
+        {
+            ++cleaned;
+        }
+    }
+
+    // 2. dirty 비율이 목표치 아래로 내려갈 때까지 buffer를 돌면서 write 한다.
+    std::size_t dirty = dirty_frames();
+    auto over_target = [this, &dirty]() {
+        return dirty * 100.0 > cleaner_config.dirty_target_pct * capacity();
+    };
+    for (std::size_t i = 0; i < capacity() && cleaned < budget && over_target();
+         ++i)
+    {
+        cleaner_cursor = (cleaner_cursor + 1) % capacity();
+        if (clean_frame(cleaner_cursor))
+        {
+            ++cleaned;
+            --dirty;
+        }
+    }
+    return cleaned;
+}
+
+bool BufferController::clean_frame(int buffer_index)
+{
+    auto& frame = buffer->at(buffer_index);
+    if (!frame.is_dirty)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> cleaner_lock { cleaner_latch };
+    int file_id = frame.file_id;
+    pagenum_t pagenum = frame.pagenum;
+    if (file_id == -1)
+    {
+        return false;
+    }
+
+    // partition latch를 잡은 채로 pin 해야 eviction과 경쟁하지 않는다.
+    // 아무도 쓰고 있지 않은 frame만 write 한다.
+    bool pinned = false;
+    page_table.find(file_id, pagenum, [&](int index) {
+        if (index == buffer_index && !frame.is_use_now())
+        {
+            ++frame.pin;
+            pinned = true;
+        }
+    });
+    if (!pinned)
+    {
+        return false;
+    }
+
+    bool cleaned = false;
+    if (frame.mtx.try_lock_shared())
+    {
+        // shared latch를 잡는 사이에 다른 thread가 pin 했다면 건너뛴다.
+        // dirty를 먼저 지워야, write 하는 동안 수정된 page가 다시 dirty로
+        // 남는다.
+        if (frame.pin == 1 && frame.is_dirty.exchange(false))
+        {
+            // commit은 page lsn까지 log를 flush 한 뒤에 page를 write 한다.
+            cleaned = commit(file_id, frame);
+            if (!cleaned)
+            {
+                frame.is_dirty = true;
+            }
+        }
+        frame.mtx.unlock_shared();
+    }
+    unpin(buffer_index);
+
+    if (cleaned)
+    {
+        ++cleaned_count;
+    }
+    return cleaned;
+}
@@ -0,0 +1,214 @@
+#include "page_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+constexpr int MIN_MATCH = 4;
+constexpr int MAX_OFFSET = 0xFFFF;
+// 마지막 이만큼은 그대로 적는다. 읽을 때 4바이트 비교가 page를 넘지 않는다.
+constexpr int LAST_LITERALS = 5;
+constexpr int HASH_BITS = 12;
+
+static uint32_t load32(const uint8_t* src)
+{
+    uint32_t value;
+    std::memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static uint32_t hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// 15 이상인 길이의 나머지를 255 단위로 적는다.
+static int put_length(uint8_t* out, int length)
+{
+    int len = 0;
+    for (length -= 15; length >= 255; length -= 255)
+    {
+        out[len++] = 255;
+    }
+    out[len++] = length;
+    return len;
+}
+
+static int put_sequence(uint8_t* out, const uint8_t* literal, int literals,
+                        int offset, int match)
+{
+    int len = 1;
+    uint8_t token = std::min(literals, 15) << 4;
+    if (literals >= 15)
+    {
+        len += put_length(out + len, literals);
+    }
+    std::memcpy(out + len, literal, literals);
+    len += literals;
+    if (match == 0)
+    {
+        out[0] = token;
+        return len;
+    }
+
+    out[len++] = offset & 0xFF;
+    out[len++] = offset >> 8;
+    token |= std::min(match - MIN_MATCH, 15);
+    if (match - MIN_MATCH >= 15)
+    {
+        len += put_length(out + len, match - MIN_MATCH);
+    }
+    out[0] = token;
+    return len;
+}
+
+int page_compress(const page_t& page, uint8_t* out)
+{
+    const auto* src = reinterpret_cast<const uint8_t*>(&page);
+    // 4바이트 hash로 가장 최근에 나온 위치 + 1 (0이면 없음)
+    std::array<uint16_t, 1 << HASH_BITS> table {};
+    constexpr int match_limit = PAGESIZE - LAST_LITERALS;
+
+    int len = 0;
+    int anchor = 0;
+    int pos = 0;
+    while (pos + MIN_MATCH <= match_limit)
+    {
+        uint32_t sequence = load32(src + pos);
+        auto& slot = table[hash(sequence)];
+        int candidate = slot - 1;
+        slot = pos + 1;
+        if (candidate < 0 || pos - candidate > MAX_OFFSET ||
+            load32(src + candidate) != sequence)
+        {
+            ++pos;
+            continue;
+        }
+
+        int match = MIN_MATCH;
+        while (pos + match < match_limit &&
+               src[candidate + match] == src[pos + match])
+        {
+            ++match;
+        }
+        len += put_sequence(out + len, src + anchor, pos - anchor,
+                            pos - candidate, match);
+        pos += match;
+        anchor = pos;
+    }
+    return len + put_sequence(out + len, src + anchor, PAGESIZE - anchor, 0, 0);
+}
+
+// 15 이상인 길이의 나머지를 읽는다. 입력이 끝나면 false
+static bool get_length(const uint8_t* in, int length, int& i, int& value)
+{
+    for (;;)
+    {
+        if (i == length)
+        {
+            return false;
+        }
+        uint8_t byte = in[i++];
+        value += byte;
+        if (byte != 255)
+        {
+            return true;
+        }
+    }
+}
+
+// 짧은 literal / match가 많아서 8바이트씩 넘치게 복사한다.
+// 넘치는 곳이 있도록 page보다 조금 큰 buffer에 풀고 page로 옮긴다.
+constexpr int COPY_SLACK = 16;
+
+static void wild_copy(uint8_t* dst, const uint8_t* src, int size)
+{
+    for (int k = 0; k < size; k += 8)
+    {
+        std::memcpy(dst + k, src + k, 8);
+    }
+}
+
+bool page_decompress(const uint8_t* in, int length, page_t& page)
+{
+    std::array<uint8_t, PAGESIZE + COPY_SLACK> buffer;
+    uint8_t* dst = buffer.data();
+    int pos = 0;
+    int i = 0;
+    while (i < length)
+    {
+        uint8_t token = in[i++];
+        int literals = token >> 4;
+        if (literals == 15 && !get_length(in, length, i, literals))
+        {
+            return false;
+        }
+        if (literals > length - i || literals > PAGESIZE - pos)
+        {
+            return false;
+        }
+        if (literals <= COPY_SLACK && length - i >= COPY_SLACK)
+        {
+            wild_copy(dst + pos, in + i, literals);
+        }
+        else
+        {
+            std::memcpy(dst + pos, in + i, literals);
+        }
+        i += literals;
+        pos += literals;
+        if (i == length)
+        {
+            break;
+        }
+
+        if (length - i < 2)
+        {
+            return false;
+        }
+        int offset = in[i] | (in[i + 1] << 8);
+        i += 2;
+        int match = token & 0x0F;
+        if (match == 15 && !get_length(in, length, i, match))
+        {
+            return false;
+        }
+        match += MIN_MATCH;
+        if (offset == 0 || offset > pos || match > PAGESIZE - pos)
+        {
+            return false;
+        }
+        if (offset >= 8)
+        {
+            // 8바이트씩 복사하면 읽는 곳은 이미 쓴 곳이다.
+            if (match <= COPY_SLACK)
+            {
+                wild_copy(dst + pos, dst + pos - offset, match);
+            }
+            else
+            {
+                for (int k = 0; k < match; k += 8)
+                {
+                    std::memcpy(dst + pos + k, dst + pos - offset + k,
+                                std::min(8, match - k));
+                }
+            }
+            pos += match;
+            continue;
+        }
+        // 겹치면 offset 바이트씩 앞에서부터 복사한다.
+        for (int end = pos + match; pos < end;)
+        {
+            int count = std::min(offset, end - pos);
+            std::memcpy(dst + pos, dst + pos - offset, count);
+            pos += count;
+            offset += count;
+        }
+    }
+    if (pos != PAGESIZE)
+    {
+        return false;
+    }
+    std::memcpy(&page, dst, PAGESIZE);
+    return true;
+}
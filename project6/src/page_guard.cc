@@ -0,0 +1,164 @@
+#include "page_guard.hpp"
+
+#include <utility>
+
+#include "buffer_manager.hpp"
+#include "logger.hpp"
+
+page_guard::page_guard()
+    : frame_ptr(nullptr),
+      index(INVALID_BUFFER_INDEX),
+      latch_mode(LatchMode::NONE)
+{
+    // Do nothing
+}
+
+page_guard::page_guard(int file_id, pagenum_t pagenum, LatchMode mode)
+    : page_guard()
+{
+    acquire(file_id, pagenum, mode);
+}
+
+page_guard::~page_guard()
+{
+    release();
+}
+
+page_guard::page_guard(page_guard&& rhs) noexcept
+    : frame_ptr(std::exchange(rhs.frame_ptr, nullptr)),
+      index(std::exchange(rhs.index, INVALID_BUFFER_INDEX)),
+      latch_mode(std::exchange(rhs.latch_mode, LatchMode::NONE))
+{
+    // Do nothing
+}
+
+page_guard& page_guard::operator=(page_guard&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        release();
+        frame_ptr = std::exchange(rhs.frame_ptr, nullptr);
+        index = std::exchange(rhs.index, INVALID_BUFFER_INDEX);
+        latch_mode = std::exchange(rhs.latch_mode, LatchMode::NONE);
+    }
+    return *this;
+}
+
+bool page_guard::acquire(int file_id, pagenum_t pagenum, LatchMode mode)
+{
+    auto& bc = BufferController::instance();
+    int new_index = bc.pin(file_id, pagenum);
+    CHECK_WITH_LOG(new_index != INVALID_BUFFER_INDEX, false,
+                   "pin page failure. file: %d / pagenum: %ld", file_id,
+                   pagenum);
+
+    page_guard next;
+    next.frame_ptr = &bc.at(new_index);
+    next.index = new_index;
+    next.lock(mode);
+
+    *this = std::move(next);
+    return true;
+}
+
+void page_guard::release()
+{
+    if (!frame_ptr)
+    {
+        return;
+    }
+    unlock();
+    BufferController::instance().unpin(index);
+    frame_ptr = nullptr;
+    index = INVALID_BUFFER_INDEX;
+}
+
+void page_guard::lock(LatchMode mode)
+{
+    DB_CRASH_COND(frame_ptr, -1, "lock on empty page guard");
+    DB_CRASH_COND(latch_mode == LatchMode::NONE, -1, "page already latched");
+    switch (mode)
+    {
+        case LatchMode::NONE:
+            break;
+        case LatchMode::SHARED:
+            frame_ptr->mtx.lock_shared();
+            break;
+        case LatchMode::EXCLUSIVE:
+            frame_ptr->mtx.lock();
+            break;
+    }
+    latch_mode = mode;
+}
+
+bool page_guard::try_lock(LatchMode mode)
+{
+    DB_CRASH_COND(frame_ptr, -1, "lock on empty page guard");
+    DB_CRASH_COND(latch_mode == LatchMode::NONE, -1, "page already latched");
+    bool locked = true;
+    switch (mode)
+    {
+        case LatchMode::NONE:
+            break;
+        case LatchMode::SHARED:
+            locked = frame_ptr->mtx.try_lock_shared();
+            break;
+        case LatchMode::EXCLUSIVE:
+            locked = frame_ptr->mtx.try_lock();
+            break;
+    }
+    if (locked)
+    {
+        latch_mode = mode;
+    }
+    return locked;
+}
+
+void page_guard::unlock()
+{
+    switch (latch_mode)
+    {
+        case LatchMode::NONE:
+            break;
+        case LatchMode::SHARED:
+            frame_ptr->mtx.unlock_shared();
+            break;
+        case LatchMode::EXCLUSIVE:
+            frame_ptr->mtx.unlock();
+            break;
+    }
+    latch_mode = LatchMode::NONE;
+}
+
+const page_t& page_guard::page() const
+{
+    return *frame_ptr;
+}
+
+page_t& page_guard::mutable_page()
+{
+    DB_CRASH_COND(latch_mode != LatchMode::SHARED, -1,
+                  "write on shared latched page");
+    mark_dirty();
+    return *frame_ptr;
+}
+
+void page_guard::mark_dirty()
+{
+    frame_ptr->is_dirty = true;
+}
+
+frame_t& page_guard::frame() const
+{
+    return *frame_ptr;
+}
+
+int page_guard::frame_index() const
+{
+    return index;
+}
+
+LatchMode page_guard::mode() const
+{
+    return latch_mode;
+}
@@ -0,0 +1,140 @@
+#include "page_table.hpp"
+
+#include "logger.hpp"
+
+// 비어있는 slot의 frame_index
+constexpr auto EMPTY_SLOT = -1;
+// partition의 최소 slot 수
+constexpr std::size_t MIN_PARTITION_CAPACITY = 16;
+
+PageTable::PageTable()
+{
+    reset(0);
+}
+
+void PageTable::reset(std::size_t expected_size)
+{
+    // load factor가 0.5 정도가 되도록 잡는다.
+    std::size_t per_partition = expected_size * 2 / NUM_PARTITIONS;
+    std::size_t capacity = MIN_PARTITION_CAPACITY;
+    while (capacity < per_partition)
+    {
+        capacity <<= 1;
+    }
+
+    for (auto& partition : partitions)
+    {
+        std::unique_lock<std::shared_mutex> latch { partition.mtx };
+        partition.reset(capacity);
+    }
+}
+
+void PageTable::insert(int file_id, pagenum_t pagenum, int frame_index)
+{
+    uint64_t hash = hash_key(file_id, pagenum);
+    auto& partition = partitions[partition_of(hash)];
+    std::unique_lock<std::shared_mutex> latch { partition.mtx };
+
+    int slot = partition.lookup(hash, file_id, pagenum);
+    if (slot != -1)
+    {
+        partition.slots[slot].frame_index = frame_index;
+        return;
+    }
+
+    // load factor가 0.75를 넘으면 늘린다.
+    if ((partition.count + 1) * 4 > partition.slots.size() * 3)
+    {
+        partition.grow();
+    }
+    partition.insert(hash, { file_id, frame_index, pagenum });
+}
+
+uint64_t PageTable::hash_key(int file_id, pagenum_t pagenum)
+{
+    // splitmix64 finalizer
+    uint64_t x = (static_cast<uint64_t>(file_id) << 48) ^ pagenum;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+void PageTable::Partition::reset(std::size_t capacity)
+{
+    slots.assign(capacity, { -1, EMPTY_SLOT, EMPTY_PAGE_NUMBER });
+    mask = capacity - 1;
+    count = 0;
+}
+
+int PageTable::Partition::lookup(uint64_t hash, int file_id,
+                                 pagenum_t pagenum) const
+{
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        auto& slot = slots[i];
+        if (slot.frame_index == EMPTY_SLOT)
+        {
+            return -1;
+        }
+        if (slot.file_id == file_id && slot.pagenum == pagenum)
+        {
+            return i;
+        }
+    }
+}
+
+void PageTable::Partition::insert(uint64_t hash, const Slot& slot)
+{
+    std::size_t i = hash & mask;
+    while (slots[i].frame_index != EMPTY_SLOT)
+    {
+        i = (i + 1) & mask;
+    }
+    slots[i] = slot;
+    ++count;
+}
+
+void PageTable::Partition::erase(int slot)
+{
+    // tombstone을 남기지 않도록, 뒤에 있는 entry들을 당겨서 빈 칸을 메운다.
+    std::size_t hole = slot;
+    std::size_t i = hole;
+    while (true)
+    {
+        i = (i + 1) & mask;
+        auto& now = slots[i];
+        if (now.frame_index == EMPTY_SLOT)
+        {
+            break;
+        }
+
+        std::size_t home = hash_key(now.file_id, now.pagenum) & mask;
+        // home이 (hole, i] 구간 밖에 있으면 hole로 옮길 수 있다.
+        bool movable = (hole <= i) ? (home <= hole || home > i)
+                                   : (home <= hole && home > i);
+        if (movable)
+        {
+            slots[hole] = now;
+            hole = i;
+        }
+    }
+    slots[hole].frame_index = EMPTY_SLOT;
+    --count;
+}
+
+void PageTable::Partition::grow()
+{
+    std::vector<Slot> old;
+    old.swap(slots);
+    reset(old.size() * 2);
+    for (auto& slot : old)
+    {
+        if (slot.frame_index != EMPTY_SLOT)
+        {
+            insert(hash_key(slot.file_id, slot.pagenum), slot);
+        }
+    }
+}
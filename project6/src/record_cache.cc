@@ -0,0 +1,169 @@
+#include "record_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+void RecordCache::reset(std::size_t capacity)
+{
+    // 모든 partition을 잡은 뒤에 크기를 바꿔야, 이전 크기로 들어온 entry가
+    // 남지 않는다.
+    std::vector<std::unique_lock<std::mutex>> latches;
+    for (auto& partition : partitions)
+    {
+        latches.emplace_back(partition.mtx);
+        partition.lru.clear();
+        partition.entries.clear();
+        partition.used = 0;
+    }
+    partition_capacity = capacity / NUM_PARTITIONS;
+}
+
+void RecordCache::clear()
+{
+    for (auto& partition : partitions)
+    {
+        std::unique_lock<std::mutex> latch { partition.mtx };
+        partition.lru.clear();
+        partition.entries.clear();
+        partition.used = 0;
+    }
+}
+
+std::size_t RecordCache::capacity() const
+{
+    return partition_capacity * NUM_PARTITIONS;
+}
+
+std::size_t RecordCache::size() const
+{
+    std::size_t used = 0;
+    for (auto& partition : partitions)
+    {
+        used += partition.used.load(std::memory_order_relaxed);
+    }
+    return used;
+}
+
+bool RecordCache::find(int table_id, keyType key, uint8_t* buffer,
+                       int capacity, int& length)
+{
+    auto& partition = partition_of(table_id, key);
+    std::unique_lock<std::mutex> latch { partition.mtx };
+    auto it = partition.entries.find(RecordId { table_id, key });
+    if (it == partition.entries.end())
+    {
+        partition.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    partition.hits.fetch_add(1, std::memory_order_relaxed);
+    partition.lru.splice(partition.lru.begin(), partition.lru, it->second);
+    auto& value = it->second->value;
+    length = value.size();
+    std::memcpy(buffer, value.data(), std::min(length, capacity));
+    return true;
+}
+
+void RecordCache::insert(int table_id, keyType key, const uint8_t* value,
+                         int length)
+{
+    auto& partition = partition_of(table_id, key);
+    std::unique_lock<std::mutex> latch { partition.mtx };
+    std::size_t limit = partition_capacity;
+    if (charge(length) > limit)
+    {
+        return;
+    }
+
+    RecordId id { table_id, key };
+    auto it = partition.entries.find(id);
+    if (it != partition.entries.end())
+    {
+        partition.erase(it->second);
+    }
+
+    partition.lru.push_front(Entry { id, { value, value + length } });
+    partition.entries.emplace(id, partition.lru.begin());
+    partition.used.fetch_add(charge(length), std::memory_order_relaxed);
+    while (partition.used.load(std::memory_order_relaxed) > limit)
+    {
+        partition.erase(std::prev(partition.lru.end()));
+    }
+}
+
+void RecordCache::erase(int table_id, keyType key)
+{
+    auto& partition = partition_of(table_id, key);
+    std::unique_lock<std::mutex> latch { partition.mtx };
+    auto it = partition.entries.find(RecordId { table_id, key });
+    if (it != partition.entries.end())
+    {
+        partition.erase(it->second);
+    }
+}
+
+void RecordCache::erase_table(int table_id)
+{
+    for (auto& partition : partitions)
+    {
+        std::unique_lock<std::mutex> latch { partition.mtx };
+        for (auto it = partition.lru.begin(); it != partition.lru.end();)
+        {
+            auto now = it++;
+            if (now->id.table_id == table_id)
+            {
+                partition.erase(now);
+            }
+        }
+    }
+}
+
+std::size_t RecordCache::hits() const
+{
+    std::size_t hits = 0;
+    for (auto& partition : partitions)
+    {
+        hits += partition.hits.load(std::memory_order_relaxed);
+    }
+    return hits;
+}
+
+std::size_t RecordCache::misses() const
+{
+    std::size_t misses = 0;
+    for (auto& partition : partitions)
+    {
+        misses += partition.misses.load(std::memory_order_relaxed);
+    }
+    return misses;
+}
+
+void RecordCache::reset_stats()
+{
+    for (auto& partition : partitions)
+    {
+        std::unique_lock<std::mutex> latch { partition.mtx };
+        partition.hits = 0;
+        partition.misses = 0;
+    }
+}
+
+void RecordCache::Partition::erase(std::list<Entry>::iterator it)
+{
+    used.fetch_sub(charge(it->value.size()), std::memory_order_relaxed);
+    entries.erase(it->id);
+    lru.erase(it);
+}
+
+uint64_t RecordCache::hash_key(int table_id, keyType key)
+{
+    // splitmix64 finalizer (PageTable::hash_key와 같다)
+    uint64_t x = (static_cast<uint64_t>(table_id) << 48) ^
+                 static_cast<uint64_t>(key);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
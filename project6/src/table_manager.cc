@@ -1,17 +1,23 @@
 #include "table_manager.hpp"
 
+#include "lock_manager.hpp"
 #include "logger.hpp"
 #include "log_manager.hpp"
+#include "record_cache.hpp"
 
-bool TableManager::init_db(int buf_num, int flag, int log_num, char* log_path, char* logmsg)
+bool TableManager::init_db(int buf_num, int flag, int log_num, char* log_path, char* logmsg,
+                           BufferPolicy policy)
 {
     CHECK_WITH_LOG(!valid_table_manager, false, "shutdown first");
-    CHECK_WITH_LOG(BufferController::instance().init_buffer(buf_num), false,
+    CHECK_WITH_LOG(BufferController::instance().init_buffer(buf_num, policy), false,
                    "init buffer failure");
     valid_table_manager = true;
+    RecordCache::instance().clear();
     std::cout << "init_db" << std::endl;
     LogManager::instance().open(log_path, logmsg);
     LogManager::instance().recovery(RecoveryMode(flag), log_num);
+    LogManager::instance().start_checkpointer();
+    LockManager::instance().start_detector();
     return true;
 }
 
@@ -19,15 +25,37 @@ bool TableManager::shutdown_db()
 {
     CHECK_WITH_LOG(valid_table_manager, false, "init first");
     valid_table_manager = false;
+    close_cursors(INVALID_TABLE_ID);
+    LockManager::instance().stop_detector();
+    LogManager::instance().stop_checkpointer();
     LogManager::instance().flush();
     CHECK_WITH_LOG(BufferController::instance().clear_buffer(), false,
                    "clear buffer failure");
+    // 모든 page를 write 했으므로, 다음 recovery는 이 checkpoint부터 읽으면
+    // 된다.
+    LogManager::instance().checkpoint();
     tables.clear();
     name_id_table.clear();
+    RecordCache::instance().clear();
     std::cout << "shutdown db" << std::endl;
     return true;
 }
 
+bool TableManager::crash_db()
+{
+    CHECK_WITH_LOG(valid_table_manager, false, "init first");
+    valid_table_manager = false;
+    close_cursors(INVALID_TABLE_ID);
+    LockManager::instance().stop_detector();
+    LogManager::instance().stop_checkpointer();
+    CHECK_WITH_LOG(BufferController::instance().clear_buffer(false), false,
+                   "clear buffer failure");
+    tables.clear();
+    name_id_table.clear();
+    RecordCache::instance().clear();
+    return true;
+}
+
 int TableManager::get_table_id(const std::string& name)
 {
     // if (!valid_table_manager)
@@ -72,7 +100,8 @@ int TableManager::get_table_id(const std::string& name)
     return id;
 }
 
-int TableManager::open_table(const std::string& name)
+int TableManager::open_table(const std::string& name, FileFormat format,
+                             LeafFormat leaf_format)
 {
     if (!valid_table_manager)
     {
@@ -87,8 +116,8 @@ int TableManager::open_table(const std::string& name)
     tables[id] = std::make_unique<table_t>();
     tables[id]->table_id = id;
     tables[id]->tree.set_table(id);
-    CHECK_WITH_LOG(tables[id]->tree.open_table(name), INVALID_TABLE_ID,
-                   "open table failure: %s", name.c_str());
+    CHECK_WITH_LOG(tables[id]->tree.open_table(name, format, leaf_format),
+                   INVALID_TABLE_ID, "open table failure: %s", name.c_str());
     return id;
 }
 
@@ -98,27 +127,66 @@ bool TableManager::close_table(int table_id)
     {
         return false;
     }
+    close_cursors(table_id);
     tables.erase(table_id);
+    RecordCache::instance().erase_table(table_id);
     return true;
 }
 
-bool TableManager::insert(int table_id, keyType key, const valType& value)
+void TableManager::set_record_cache(std::size_t capacity)
+{
+    RecordCache::instance().reset(capacity);
+}
+
+static record_t text_record(keyType key, const valType& value)
+{
+    record_t rec;
+    rec.init(key, value, value_length(value));
+    return rec;
+}
+
+bool TableManager::insert(int table_id, const record_t& rec)
 {
     if (!valid_table_manager || tables.find(table_id) == tables.end())
     {
         return false;
     }
-    return tables[table_id]->tree.insert(key, value);
+    return tables[table_id]->tree.insert(rec);
 }
 
-bool TableManager::update(int table_id, keyType key, const valType& value,
-                          int trx_id)
+bool TableManager::update(int table_id, const record_t& rec, int trx_id)
 {
     if (!valid_table_manager || tables.find(table_id) == tables.end())
     {
         return false;
     }
-    return tables[table_id]->tree.update(key, value, trx_id);
+    return tables[table_id]->tree.update(rec, trx_id);
+}
+
+bool TableManager::upsert(int table_id, const record_t& rec, int trx_id)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return false;
+    }
+    return tables[table_id]->tree.upsert(rec, trx_id);
+}
+
+bool TableManager::insert(int table_id, keyType key, const valType& value)
+{
+    return insert(table_id, text_record(key, value));
+}
+
+bool TableManager::update(int table_id, keyType key, const valType& value,
+                          int trx_id)
+{
+    return update(table_id, text_record(key, value), trx_id);
+}
+
+bool TableManager::upsert(int table_id, keyType key, const valType& value,
+                          int trx_id)
+{
+    return upsert(table_id, text_record(key, value), trx_id);
 }
 
 bool TableManager::delete_key(int table_id, keyType key)
@@ -137,4 +205,139 @@ bool TableManager::find(int table_id, keyType key, record_t& ret, int trx_id)
         return false;
     }
     return tables[table_id]->tree.find(key, ret, trx_id);
-}
\ No newline at end of file
+}
+
+bool TableManager::insert(int table_id, keyType key, ValueRef value)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return false;
+    }
+    return tables[table_id]->tree.insert(key, value);
+}
+
+bool TableManager::update(int table_id, keyType key, ValueRef value,
+                          int trx_id)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return false;
+    }
+    return tables[table_id]->tree.update(key, value, trx_id);
+}
+
+bool TableManager::upsert(int table_id, keyType key, ValueRef value,
+                          int trx_id)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return false;
+    }
+    return tables[table_id]->tree.upsert(key, value, trx_id);
+}
+
+bool TableManager::find(int table_id, keyType key, uint8_t* buffer,
+                        int capacity, int& length, int trx_id)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return false;
+    }
+    return tables[table_id]->tree.find(key, buffer, capacity, length, trx_id);
+}
+
+int TableManager::scan_open(int table_id, keyType lo, keyType hi, int trx_id)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return INVALID_CURSOR_ID;
+    }
+
+    auto cursor = std::make_unique<open_cursor>();
+    cursor->table_id = table_id;
+    CHECK_RET(tables[table_id]->tree.scan_open(cursor->cursor, lo, hi, trx_id),
+              INVALID_CURSOR_ID);
+
+    std::unique_lock<std::mutex> crit { cursor_latch };
+    int id = cursor_counter++;
+    cursors.emplace(id, std::move(cursor));
+    return id;
+}
+
+ScanResult TableManager::scan_next(int cursor_id, record_t& ret)
+{
+    open_cursor* cursor;
+    {
+        std::unique_lock<std::mutex> crit { cursor_latch };
+        auto it = cursors.find(cursor_id);
+        if (it == cursors.end())
+        {
+            return ScanResult::END;
+        }
+        cursor = it->second.get();
+    }
+    return tables[cursor->table_id]->tree.scan_next(cursor->cursor, ret);
+}
+
+bool TableManager::scan_close(int cursor_id)
+{
+    std::unique_ptr<open_cursor> cursor;
+    {
+        std::unique_lock<std::mutex> crit { cursor_latch };
+        auto it = cursors.find(cursor_id);
+        if (it == cursors.end())
+        {
+            return false;
+        }
+        cursor = std::move(it->second);
+        cursors.erase(it);
+    }
+    tables[cursor->table_id]->tree.scan_close(cursor->cursor);
+    return true;
+}
+
+bool TableManager::scan(int table_id, keyType lo, keyType hi,
+                        const std::function<bool(const record_t&)>& callback,
+                        int trx_id)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return false;
+    }
+    return tables[table_id]->tree.scan(lo, hi, callback, trx_id);
+}
+
+bool TableManager::bulk_load(int table_id, std::size_t count,
+                             const std::function<bool(record_t&)>& next,
+                             double fill_factor)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return false;
+    }
+    return tables[table_id]->tree.bulk_load(count, next, fill_factor);
+}
+
+int TableManager::set_leaf_format(int table_id, LeafFormat format)
+{
+    if (!valid_table_manager || tables.find(table_id) == tables.end())
+    {
+        return -1;
+    }
+    return tables[table_id]->tree.set_leaf_format(format);
+}
+
+void TableManager::close_cursors(int table_id)
+{
+    std::unique_lock<std::mutex> crit { cursor_latch };
+    for (auto it = cursors.begin(); it != cursors.end();)
+    {
+        if (table_id != INVALID_TABLE_ID && it->second->table_id != table_id)
+        {
+            ++it;
+            continue;
+        }
+        tables[it->second->table_id]->tree.scan_close(it->second->cursor);
+        it = cursors.erase(it);
+    }
+}
@@ -5,31 +5,53 @@
 
 #include "log_manager.hpp"
 #include "logger.hpp"
+#include "record_cache.hpp"
 #include "table_manager.hpp"
 
 int TransactionManager::begin()
 {
-    std::unique_lock<std::mutex> trx_latch { mtx };
     int id = ++counter;
-
-    if (transactions.find(id) != transactions.end())
     {
-        return invliad_transaction_id;
+        std::unique_lock<std::shared_mutex> trx_latch { mtx };
+        if (!transactions.emplace(id, Transaction(id)).second)
+        {
+            return invliad_transaction_id;
+        }
     }
 
-    transactions.emplace(id, Transaction(id));
     LogManager::instance().begin_log(id);
     return id;
 }
 
+Transaction* TransactionManager::find(int transaction_id)
+{
+    std::shared_lock<std::shared_mutex> trx_latch { mtx };
+    auto it = transactions.find(transaction_id);
+    return it == transactions.end() ? nullptr : &it->second;
+}
+
+void TransactionManager::erase(int transaction_id)
+{
+    {
+        std::unique_lock<std::shared_mutex> trx_latch { mtx };
+        transactions.erase(transaction_id);
+    }
+    LockManager::instance().transaction_finished(transaction_id);
+}
+
 Transaction& TransactionManager::get(int transaction_id)
 {
+    if (auto transaction = find(transaction_id))
+    {
+        return *transaction;
+    }
+    std::unique_lock<std::shared_mutex> trx_latch { mtx };
     return transactions[transaction_id];
 }
 
-void TransactionManager::lock_wait(lock_t* lock)
+bool TransactionManager::lock_wait(lock_t* lock)
 {
-    LockManager::instance().lock_wait(lock);
+    return LockManager::instance().lock_wait(lock);
 }
 
 LockAcquireResult TransactionManager::lock_acquire(int table_id, int64_t key,
@@ -37,18 +59,25 @@ LockAcquireResult TransactionManager::lock_acquire(int table_id, int64_t key,
 {
     LockHash hash { table_id, key };
 
-    auto transaction = transactions.find(trx_id);
-    if (transaction == transactions.end())
+    auto transaction = find(trx_id);
+    if (!transaction)
     {
         return { nullptr, LockState::INVALID };
     }
 
-    auto& locks = transaction->second.locks;
-    if (auto count = std::count_if(locks.begin(), locks.end(),
-                                   [&hash](auto& t) {
-                                       return std::get<0>(t) == hash;
-                                   });
-        count > 0)
+    // locks는 주인 thread만 바꾸므로 latch 없이 읽고, 바꿀 때만 잡는다.
+    // LockManager는 latch 없이 부른다. (Transaction::mtx 참고)
+    auto held = [&]() {
+        return std::count_if(
+            transaction->locks.begin(), transaction->locks.end(),
+            [&hash](auto& t) { return std::get<0>(t) == hash; });
+    };
+    auto add = [&](lock_t* lock) {
+        std::unique_lock<std::mutex> crit { transaction->mtx };
+        transaction->locks.emplace_back(hash, lock);
+    };
+
+    if (auto count = held(); count > 0)
     {
         auto aleady_lock_mode =
             count == 1 ? LockMode::SHARED : LockMode::EXCLUSIVE;
@@ -79,11 +108,10 @@ LockAcquireResult TransactionManager::lock_acquire(int table_id, int64_t key,
             return { nullptr, LockState::ABORTED };
         }
 
-        locks.emplace_back(hash, xlock);
+        add(xlock);
 
         if (xlock->state == LockState::WAITING)
         {
-            // Acquire the transaction latch
             return { xlock, LockState::WAITING };
         }
 
@@ -98,11 +126,10 @@ LockAcquireResult TransactionManager::lock_acquire(int table_id, int64_t key,
         return { nullptr, LockState::ABORTED };
     }
 
-    locks.emplace_back(hash, new_lock);
+    add(new_lock);
 
     if (new_lock->state == LockState::WAITING)
     {
-        // Acquire the transaction latch
         return { new_lock, LockState::WAITING };
     }
 
@@ -111,39 +138,42 @@ LockAcquireResult TransactionManager::lock_acquire(int table_id, int64_t key,
 
 int TransactionManager::abort(int transaction_id)
 {
-    auto it = transactions.find(transaction_id);
-    if (it == transactions.end())
+    auto transaction = find(transaction_id);
+    if (!transaction)
     {
         return 0;
     }
 
-    CHECK_RET(it->second.abort(), 0);
-    transactions.erase(it);
+    CHECK_RET(transaction->abort(), 0);
+    erase(transaction_id);
 
     return transaction_id;
 }
 
 int TransactionManager::commit(int id)
 {
-    std::unique_lock<std::mutex> trx_latch { mtx };
-
-    auto it = transactions.find(id);
-    if (it == transactions.end())
+    auto transaction = find(id);
+    if (!transaction)
     {
         return id;
     }
+    int64_t commit_lsn = LogManager::instance().commit_log(id);
 
-    LogManager::instance().commit_log(id);
+    // commit log가 disk에 기록될 때까지 기다린다. (group commit)
+    // 다른 transaction의 commit이 같은 fsync에 함께 묶인다. lock은 아직
+    // 놓지 않았으므로 다른 transaction이 이 transaction의 수정을 먼저 볼
+    // 수는 없다.
+    CHECK_RET(LogManager::instance().flush_until(commit_lsn), 0);
 
-    CHECK_RET(it->second.commit(), 0);
-    transactions.erase(it);
+    CHECK_RET(transaction->commit(), 0);
+    erase(id);
 
     return id;
 }
 
 void TransactionManager::reset()
 {
-    std::unique_lock<std::mutex> trx_latch { mtx };
+    std::unique_lock<std::shared_mutex> trx_latch { mtx };
     counter = 0;
     transactions.clear();
 }
@@ -175,19 +205,22 @@ Transaction::Transaction(const Transaction& rhs)
 
 bool Transaction::commit()
 {
-    // TODO: log commit
-    CHECK(LogManager::instance().flush());
+    // commit log는 TransactionManager::commit에서 flush 한다.
     return lock_release();
 }
 
-bool Transaction::lock_release(bool abort)
+bool Transaction::lock_release()
 {
-    for (auto& it : locks)
+    // 놓는 동안 다른 transaction의 lock을 깨우므로 latch 밖에서 놓는다.
+    std::list<std::tuple<LockHash, lock_t*>> released;
     {
-        CHECK(LockManager::instance().lock_release(std::get<1>(it), abort));
+        std::unique_lock<std::mutex> crit { mtx };
+        released.swap(locks);
+    }
+    for (auto& it : released)
+    {
+        CHECK(LockManager::instance().lock_release(std::get<1>(it)));
     }
-
-    locks.clear();
     return true;
 }
 
@@ -196,5 +229,13 @@ bool Transaction::abort()
     state = TransactionState::ABORTED;
     CHECK(LogManager::instance().rollback(transactionID));
 
-    return lock_release(true);
+    // rollback은 page의 byte를 되돌리므로 어떤 record인지 모른다. lock을
+    // 놓기 전에 lock을 얻은 record를 모두 record cache에서 지운다.
+    for (auto& it : locks)
+    {
+        auto& hash = std::get<0>(it);
+        RecordCache::instance().erase(hash.table_id, hash.key);
+    }
+
+    return lock_release();
 }
\ No newline at end of file
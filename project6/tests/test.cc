@@ -1,10 +1,18 @@
 #include "test.hpp"
 
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <list>
+#include <map>
+#include <memory>
 #include <random>
 #include <sstream>
 #include <string>
@@ -18,6 +26,9 @@
 #include "lock_manager.hpp"
 #include "log_manager.hpp"
 #include "logger.hpp"
+#include "page_codec.hpp"
+#include "page_table.hpp"
+#include "record_cache.hpp"
 #include "table_manager.hpp"
 #include "transaction_manager.hpp"
 #include "dbms_api.hpp"
@@ -33,6 +44,23 @@ void TEST_FILE();
 void TESTS();
 void TEST_TABLE();
 void TEST_RECOVERY();
+void TEST_CHECKPOINT();
+void TEST_SCAN();
+void TEST_BULK_LOAD();
+void TEST_UPSERT();
+void TEST_CONCURRENT_WRITE();
+void TEST_BLINK();
+void TEST_SLOTTED();
+void TEST_OVERFLOW();
+void TEST_INTERNAL();
+void TEST_COLUMNAR();
+void TEST_COMPRESSED();
+void TEST_FIXED();
+void TEST_RECORD_CACHE();
+void TEST_DEADLOCK();
+void TEST_LOG_BUFFER();
+void TEST_PAGE_TABLE();
+void TEST_BUFFER_POLICY();
 // void TEST_MULTITHREADING();
 // void TEST_LOCK();
 void TEST_TRANSACTION();
@@ -50,9 +78,25 @@ int main()
     //     "test_file",           "TESTS"
     // };
 
-    void (*tests[])() = { TEST_RECOVERY };
-
-    std::string testNames[] = { "test recovery" };
+    void (*tests[])() = { TEST_PAGE_TABLE,       TEST_BUFFER_POLICY,
+                          TEST_CHECKPOINT,       TEST_SCAN,
+                          TEST_BULK_LOAD,        TEST_UPSERT,
+                          TEST_CONCURRENT_WRITE, TEST_BLINK,
+                          TEST_SLOTTED,          TEST_OVERFLOW,
+                          TEST_INTERNAL,         TEST_COLUMNAR,
+                          TEST_COMPRESSED,       TEST_FIXED,
+                          TEST_RECORD_CACHE,     TEST_DEADLOCK,
+                          TEST_LOG_BUFFER,       TEST_RECOVERY };
+
+    std::string testNames[] = { "page table",       "buffer policy",
+                                "checkpoint",       "scan",
+                                "bulk load",        "upsert",
+                                "concurrent write", "b-link",
+                                "slotted leaf",     "overflow",
+                                "internal node",    "columnar leaf",
+                                "compressed file",  "fixed value width",
+                                "record cache",     "deadlock policy",
+                                "log buffer",       "test recovery" };
 
     for (int i = 0;
          i < static_cast<int>((sizeof(tests) / sizeof(void (*)(void)))); ++i)
@@ -70,6 +114,164 @@ int main()
     return 0;
 }
 
+void TEST_PAGE_TABLE()
+{
+    TEST("insert / find")
+    {
+        PageTable table;
+        table.reset(100);
+        for (int i = 0; i < 5000; ++i)
+        {
+            table.insert(i % 3, i, i);
+        }
+        for (int i = 0; i < 5000; ++i)
+        {
+            CHECK_VALUE(table.find(i % 3, i), i);
+        }
+        CHECK_VALUE(table.find(1, 0), -1);
+        CHECK_VALUE(table.find(7, 1), -1);
+    }
+    END()
+
+    TEST("erase")
+    {
+        PageTable table;
+        table.reset(1000);
+        for (int i = 0; i < 3000; ++i)
+        {
+            table.insert(1, i, i);
+        }
+        CHECK_FALSE(table.erase_if(1, 10, []() { return false; }));
+        CHECK_VALUE(table.find(1, 10), 10);
+
+        // 지운 뒤에도 같은 probe sequence에 있던 page를 찾을 수 있어야 한다.
+        for (int i = 0; i < 3000; i += 2)
+        {
+            CHECK_TRUE(table.erase(1, i));
+        }
+        CHECK_FALSE(table.erase(1, 0));
+        bool ok = true;
+        for (int i = 0; i < 3000; ++i)
+        {
+            ok = ok && table.find(1, i) == ((i % 2) ? i : -1);
+        }
+        CHECK_TRUE(ok);
+
+        int found = -1;
+        table.find(1, 11, [&found](int index) { found = index; });
+        CHECK_VALUE(found, 11);
+    }
+    END()
+}
+
+void TEST_BUFFER_POLICY()
+{
+    constexpr auto num_pages = 40;
+    auto& bc = BufferController::instance();
+    std::remove("DATA8");
+
+    TEST("create pages")
+    {
+        CHECK_TRUE(bc.clear_buffer());
+        CHECK_TRUE(bc.init_buffer(8));
+        BufferManager bm;
+        CHECK_TRUE(bm.open("DATA8"));
+        bool ok = true;
+        for (int i = 1; i <= num_pages; ++i)
+        {
+            pagenum_t pagenum = bm.create();
+            page_guard guard;
+            ok = ok && pagenum == static_cast<pagenum_t>(i) &&
+                 bm.load(pagenum, guard, LatchMode::EXCLUSIVE);
+            guard.mutable_page().nodePageHeader().numberOfKeys = i;
+        }
+        CHECK_TRUE(ok);
+        CHECK_TRUE(bc.clear_buffer());
+    }
+    END()
+
+    for (auto policy : { BufferPolicy::LRU, BufferPolicy::CLOCK,
+                         BufferPolicy::LRU_K, BufferPolicy::TWO_Q })
+    {
+        TEST("policy " + std::to_string(static_cast<int>(policy)))
+        {
+            CHECK_TRUE(bc.clear_buffer());
+            CHECK_TRUE(bc.init_buffer(8, policy));
+            BufferManager bm;
+            CHECK_TRUE(bm.open("DATA8"));
+
+            // hot page 1 ~ 3을 참조하고, scan에 밀려났다가 다시 참조한
+            // 뒤 전체를 한 번 훑는다.
+            std::vector<int> accesses { 1, 2, 3, 1, 2, 3 };
+            for (int i = 4; i <= 11; ++i)
+            {
+                accesses.push_back(i);
+            }
+            accesses.insert(accesses.end(), { 1, 2, 3 });
+            for (int i = 12; i <= num_pages; ++i)
+            {
+                accesses.push_back(i);
+            }
+
+            bool ok = true;
+            for (int pagenum : accesses)
+            {
+                page_guard guard;
+                ok = ok && bm.load(pagenum, guard) &&
+                     guard.page().nodePageHeader().numberOfKeys ==
+                         static_cast<uint32_t>(pagenum);
+            }
+            CHECK_TRUE(ok);
+            CHECK_TRUE(bc.size() <= bc.capacity());
+
+            // LRU-K와 2Q는 scan이 hot page를 밀어내지 못한다.
+            bc.reset_stats();
+            for (int pagenum : { 1, 2, 3 })
+            {
+                page_guard guard;
+                ok = ok && bm.load(pagenum, guard);
+            }
+            CHECK_TRUE(ok);
+            if (policy == BufferPolicy::LRU_K ||
+                policy == BufferPolicy::TWO_Q)
+            {
+                CHECK_VALUE(bc.hits(), 3);
+            }
+            CHECK_VALUE(bc.hits() + bc.misses(), 3);
+        }
+        END()
+    }
+
+    TEST("page cleaner")
+    {
+        CHECK_TRUE(bc.clear_buffer());
+        PageCleanerConfig config;
+        config.dirty_target_pct = 0;
+        config.interval_ms = 1;
+        bc.set_page_cleaner_config(config);
+        CHECK_TRUE(bc.init_buffer(8));
+        BufferManager bm;
+        CHECK_TRUE(bm.open("DATA8"));
+        for (int pagenum = 1; pagenum <= 8; ++pagenum)
+        {
+            page_guard guard;
+            CHECK_TRUE(bm.load(pagenum, guard, LatchMode::EXCLUSIVE));
+            guard.mutable_page().nodePageHeader().numberOfKeys = pagenum * 2;
+        }
+        for (int i = 0; i < 1000 && bc.dirty_frames() != 0; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK_VALUE(bc.dirty_frames(), 0);
+        CHECK_TRUE(bc.cleaned_pages() >= 8);
+        bc.set_page_cleaner_config(PageCleanerConfig {});
+    }
+    END()
+
+    bc.clear_buffer();
+    std::remove("DATA8");
+}
+
 void TEST_RECOVERY()
 {
     TEST("recovery")
@@ -160,6 +362,2428 @@ void TEST_RECOVERY()
     END()
 }
 
+void TEST_CHECKPOINT()
+{
+    constexpr auto num_records = 100;
+    auto update_all = [](int table_id, int from, int to, const std::string& s,
+                         int trx) {
+        for (int i = from; i < to; ++i)
+        {
+            valType v;
+            TableManager::char_to_valType(v, (s + std::to_string(i)).c_str());
+            db_update(table_id, i, (char*)&v, trx);
+        }
+    };
+
+    TEST("checkpoint")
+    {
+        unlink("checkpoint.log");
+        unlink("DATA12");
+        init_db(1000, 0, 0, (char*)"checkpoint.log", (char*)"checkpoint.txt");
+        int table_id = open_table((char*)"DATA12");
+        for (int i = 0; i < num_records; ++i)
+        {
+            valType v;
+            TableManager::char_to_valType(
+                v, ("insert " + std::to_string(i)).c_str());
+            db_insert(table_id, i, (char*)&v);
+        }
+
+        int winner = trx_begin();
+        update_all(table_id, num_records / 2, num_records, "winner ", winner);
+        CHECK_TRUE(trx_commit(winner) == winner);
+
+        // 진행중인 transaction이 없으므로 BEGIN 앞의 log는 버려진다.
+        CHECK_TRUE(LogManager::instance().checkpoint());
+        CHECK_TRUE(LogReader("checkpoint.log").get_lsn() > LOG_START_LSN);
+        CHECK_TRUE(LogReader("checkpoint.log").get_checkpoint_lsn() !=
+                   INVALID_LSN);
+
+        // checkpoint 전에 시작해서 commit 하지 못한 transaction은 checkpoint
+        // 이후의 log만 읽어도 loser로 undo 되어야 한다.
+        int loser = trx_begin();
+        update_all(table_id, 0, num_records / 2, "loser ", loser);
+        CHECK_TRUE(LogManager::instance().checkpoint());
+
+        int winner2 = trx_begin();
+        update_all(table_id, num_records / 2, num_records, "winner2 ", winner2);
+        CHECK_TRUE(trx_commit(winner2) == winner2);
+
+        shutdown_db();
+        init_db(1000, 0, 0, (char*)"checkpoint.log", (char*)"checkpoint.txt");
+        table_id = open_table((char*)"DATA12");
+
+        bool ok = true;
+        for (int i = 0; i < num_records; ++i)
+        {
+            std::string expected = (i < num_records / 2 ? "insert " : "winner2 ") +
+                                   std::to_string(i);
+            char result[120];
+            ok = ok && db_find(table_id, i, result, 0) == 0 &&
+                 expected == result;
+        }
+        CHECK_TRUE(ok);
+        shutdown_db();
+    }
+    END()
+
+    TEST("crash after checkpoint")
+    {
+        // eviction으로 write 된 page는 checkpoint가 sync 해야 그 redo log를
+        // 버릴 수 있다. page cleaner와 checkpointer는 멈춰 둔다.
+        // page가 커도 leaf 수가 buffer(8)보다 훨씬 많도록 key 수를 늘린다.
+        constexpr auto num_keys = 3000 * (PAGESIZE / 4096);
+        PageCleanerConfig cleaner;
+        cleaner.enabled = false;
+        BufferController::instance().set_page_cleaner_config(cleaner);
+        CheckpointConfig checkpointer;
+        checkpointer.enabled = false;
+        LogManager::instance().set_checkpoint_config(checkpointer);
+
+        unlink("checkpoint.log");
+        unlink("DATA12");
+        init_db(1000, 0, 0, (char*)"checkpoint.log", (char*)"checkpoint.txt");
+        int table_id = open_table((char*)"DATA12");
+        for (int i = 0; i < num_keys; ++i)
+        {
+            valType v;
+            TableManager::char_to_valType(
+                v, ("insert " + std::to_string(i)).c_str());
+            db_insert(table_id, i, (char*)&v);
+        }
+        shutdown_db();
+
+        // buffer가 작아서 update 한 page 대부분이 eviction으로 write 된다.
+        init_db(8, 0, 0, (char*)"checkpoint.log", (char*)"checkpoint.txt");
+        table_id = open_table((char*)"DATA12");
+        int winner = trx_begin();
+        update_all(table_id, 0, num_keys, "winner ", winner);
+        CHECK_TRUE(trx_commit(winner) == winner);
+        CHECK_TRUE(LogManager::instance().unsynced_pages() > 0);
+        CHECK_TRUE(LogManager::instance().checkpoint());
+        CHECK_VALUE(LogManager::instance().unsynced_pages(), 0u);
+
+        int loser = trx_begin();
+        update_all(table_id, 0, num_keys / 2, "loser ", loser);
+        CHECK_TRUE(TableManager::instance().crash_db());
+
+        init_db(1000, 0, 0, (char*)"checkpoint.log", (char*)"checkpoint.txt");
+        table_id = open_table((char*)"DATA12");
+        bool ok = true;
+        for (int i = 0; i < num_keys; ++i)
+        {
+            std::string expected = "winner " + std::to_string(i);
+            char result[120];
+            ok = ok && db_find(table_id, i, result, 0) == 0 &&
+                 expected == result;
+        }
+        CHECK_TRUE(ok);
+        shutdown_db();
+    }
+    END()
+
+    BufferController::instance().set_page_cleaner_config(PageCleanerConfig {});
+    LogManager::instance().set_checkpoint_config(CheckpointConfig {});
+}
+
+void TEST_SCAN()
+{
+    // 짝수 key만 넣어서 여러 leaf에 걸치게 한다.
+    constexpr auto num_records = 1000;
+    auto open = []() {
+        init_db(1000, 0, 0, (char*)"scan.log", (char*)"scan.txt");
+        return open_table((char*)"DATA14");
+    };
+
+    unlink("scan.log");
+    unlink("DATA14");
+    int table_id = open();
+    for (int i = 0; i < num_records; ++i)
+    {
+        valType v;
+        TableManager::char_to_valType(v, std::to_string(i * 2).c_str());
+        db_insert(table_id, i * 2, (char*)&v);
+    }
+
+    TEST("cursor")
+    {
+        bool ok = true;
+        int64_t expected = 101 / 2 * 2 + 2;
+        int cursor = db_scan_open(table_id, 101, 1500, 0);
+        CHECK_TRUE(cursor != INVALID_CURSOR_ID);
+        int64_t key;
+        char value[120];
+        int ret;
+        while ((ret = db_scan_next(cursor, &key, value)) == 0)
+        {
+            ok = ok && key == expected && std::to_string(key) == value;
+            expected += 2;
+        }
+        CHECK_TRUE(ok);
+        CHECK_VALUE(ret, 1);
+        CHECK_VALUE(expected, 1502);
+        CHECK_VALUE(db_scan_close(cursor), 0);
+    }
+    END()
+
+    TEST("empty range")
+    {
+        int64_t key;
+        char value[120];
+        int cursor = db_scan_open(table_id, 2 * num_records, 3 * num_records, 0);
+        CHECK_VALUE(db_scan_next(cursor, &key, value), 1);
+        CHECK_VALUE(db_scan_close(cursor), 0);
+        cursor = db_scan_open(table_id, 11, 11, 0);
+        CHECK_VALUE(db_scan_next(cursor, &key, value), 1);
+        CHECK_VALUE(db_scan_close(cursor), 0);
+    }
+    END()
+
+    TEST("callback")
+    {
+        std::vector<int64_t> keys;
+        auto collect = [](int64_t key, char*, void* arg) {
+            auto& keys = *static_cast<std::vector<int64_t>*>(arg);
+            keys.push_back(key);
+            return keys.size() == 10 ? 1 : 0;
+        };
+        CHECK_VALUE(db_scan(table_id, -100, 2 * num_records, 0, collect, &keys),
+                    0);
+        CHECK_VALUE(keys.size(), 10u);
+        CHECK_VALUE(keys.back(), 18);
+    }
+    END()
+
+    TEST("transaction")
+    {
+        // scan 한 record에 S lock이 남아 있으므로 update로 upgrade 할 수 있다.
+        int trx = trx_begin();
+        int count = 0;
+        int cursor = db_scan_open(table_id, 0, 99, trx);
+        int64_t key;
+        char value[120];
+        while (db_scan_next(cursor, &key, value) == 0)
+        {
+            ++count;
+        }
+        CHECK_VALUE(db_scan_close(cursor), 0);
+        CHECK_VALUE(count, 50);
+        CHECK_VALUE(db_update(table_id, 10, (char*)"scanned", trx), 0);
+        CHECK_VALUE(trx_commit(trx), trx);
+
+        char result[120];
+        CHECK_VALUE(db_find(table_id, 10, result, 0), 0);
+        CHECK_TRUE(std::string("scanned") == result);
+    }
+    END()
+
+    shutdown_db();
+}
+
+void TEST_BULK_LOAD()
+{
+    // 짝수 key를 bulk load 한 뒤, 그 사이에 홀수 key를 insert 한다.
+    constexpr auto num_records = 20000;
+    auto open = []() {
+        init_db(1000, 0, 0, (char*)"bulk_load.log", (char*)"bulk_load.txt");
+        return open_table((char*)"DATA16");
+    };
+    // arg는 다음에 넣을 record 번호. key를 step 만큼 늘려 간다.
+    auto even = [](int64_t* key, char* value, void* arg) {
+        auto& i = *static_cast<int64_t*>(arg);
+        *key = i * 2;
+        std::sprintf(value, "%ld", *key);
+        ++i;
+        return 0;
+    };
+    auto check_range = [](int table_id, int64_t lo, int64_t hi, int64_t step) {
+        bool ok = true;
+        int64_t expected = lo;
+        int64_t key;
+        char value[120];
+        int cursor = db_scan_open(table_id, lo, hi, 0);
+        while (db_scan_next(cursor, &key, value) == 0)
+        {
+            ok = ok && key == expected && std::to_string(key) == value;
+            expected += step;
+        }
+        db_scan_close(cursor);
+        return ok && expected == hi + step;
+    };
+
+    unlink("bulk_load.log");
+    unlink("DATA16");
+    unlink("DATA17");
+    int table_id = open();
+
+    TEST("bulk load")
+    {
+        int64_t i = 0;
+        CHECK_VALUE(db_bulk_load(table_id, num_records, even, &i, 90), 0);
+        CHECK_VALUE(i, num_records);
+        CHECK_TRUE(check_range(table_id, 0, 2 * (num_records - 1), 2));
+
+        bool ok = true;
+        char value[120];
+        for (int64_t key = -1; key <= 2 * num_records; ++key)
+        {
+            int ret = db_find(table_id, key, value, 0);
+            ok = ok && (ret == 0) == (key >= 0 && key % 2 == 0 &&
+                                      key < 2 * num_records);
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    TEST("insert after bulk load")
+    {
+        // leaf가 90%만 차 있으므로 split이 일어나는 곳과 아닌 곳이 섞인다.
+        bool ok = true;
+        for (int64_t key = 1001; key < 3000; key += 2)
+        {
+            ok = ok && db_insert(table_id, key,
+                                 (char*)std::to_string(key).c_str()) == 0;
+        }
+        for (int64_t key = 4000; key < 6000; key += 2)
+        {
+            ok = ok && db_delete(table_id, key) == 0;
+        }
+        CHECK_TRUE(ok);
+        CHECK_TRUE(check_range(table_id, 1000, 2998, 1));
+        CHECK_TRUE(check_range(table_id, 6000, 2 * (num_records - 1), 2));
+        char value[120];
+        CHECK_VALUE(db_find(table_id, 4000, value, 0), -1);
+        CHECK_VALUE(db_find(table_id, 1001, value, 0), 0);
+    }
+    END()
+
+    TEST("reopen")
+    {
+        shutdown_db();
+        table_id = open();
+        CHECK_TRUE(check_range(table_id, 1000, 2998, 1));
+        CHECK_TRUE(check_range(table_id, 6000, 2 * (num_records - 1), 2));
+    }
+    END()
+
+    TEST("non-empty table")
+    {
+        // 이미 record가 있으면 insert로 넣는다.
+        int64_t i = num_records;
+        CHECK_VALUE(db_bulk_load(table_id, 100, even, &i, 90), 0);
+        CHECK_TRUE(check_range(table_id, 6000, 2 * (num_records + 99), 2));
+    }
+    END()
+
+    TEST("unsorted input")
+    {
+        int other = open_table((char*)"DATA17");
+        auto unsorted = [](int64_t* key, char* value, void* arg) {
+            auto& i = *static_cast<int64_t*>(arg);
+            *key = i == 500 ? 0 : i;
+            std::sprintf(value, "%ld", *key);
+            ++i;
+            return 0;
+        };
+        int64_t i = 0;
+        char value[120];
+        CHECK_VALUE(db_bulk_load(other, 1000, unsorted, &i, 100), -1);
+        CHECK_VALUE(db_find(other, 0, value, 0), -1);
+
+        // 실패한 bulk load가 잡았던 page는 다시 쓰인다.
+        i = 0;
+        CHECK_VALUE(db_bulk_load(other, 1000, even, &i, 100), 0);
+        CHECK_TRUE(check_range(other, 0, 1998, 2));
+    }
+    END()
+
+    shutdown_db();
+}
+
+void TEST_UPSERT()
+{
+    constexpr auto num_records = 1000;
+    unlink("upsert.log");
+    unlink("DATA18");
+    init_db(1000, 0, 0, (char*)"upsert.log", (char*)"upsert.txt");
+    int table_id = open_table((char*)"DATA18");
+
+    TEST("insert")
+    {
+        // 빈 tree에서 시작해서 split이 일어날 만큼 넣는다.
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && db_upsert(table_id, key,
+                                 (char*)std::to_string(key).c_str(), 0) == 0;
+        }
+        CHECK_TRUE(ok);
+        char value[120];
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && db_find(table_id, key, value, 0) == 0 &&
+                 std::to_string(key) == value;
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    TEST("update")
+    {
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; key += 3)
+        {
+            ok = ok && db_upsert(table_id, key, (char*)"updated", 0) == 0;
+        }
+        CHECK_TRUE(ok);
+        char value[120];
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && db_find(table_id, key, value, 0) == 0 &&
+                 (key % 3 == 0 ? std::string("updated")
+                               : std::to_string(key)) == value;
+        }
+        CHECK_TRUE(ok);
+        CHECK_VALUE(db_insert(table_id, 3, (char*)"duplicated"), -1);
+    }
+    END()
+
+    TEST("transaction")
+    {
+        // 있는 key의 upsert는 update와 같이 X lock을 얻고 log를 남긴다.
+        int trx = trx_begin();
+        CHECK_VALUE(db_upsert(table_id, 1, (char*)"aborted", trx), 0);
+        char value[120];
+        CHECK_VALUE(db_find(table_id, 1, value, trx), 0);
+        CHECK_TRUE(std::string("aborted") == value);
+        CHECK_VALUE(trx_abort(trx), trx);
+        CHECK_VALUE(db_find(table_id, 1, value, 0), 0);
+        CHECK_TRUE(std::string("1") == value);
+    }
+    END()
+
+    shutdown_db();
+}
+
+void TEST_CONCURRENT_WRITE()
+{
+    // [0, region): 짝수 key를 넣어 두고 홀수 key를 여러 thread가 넣는다.
+    // [region, 2 * region): 모든 key를 넣어 두고 여러 thread가 모두 지운다.
+    // 그 사이 reader와 scanner는 지워지지 않는 key(4k + 2)를 확인한다.
+    constexpr int64_t region = 40000;
+    constexpr int num_writers = 4;
+    unlink("concurrent_write.log");
+    unlink("DATA19");
+    init_db(1000, 0, 0, (char*)"concurrent_write.log",
+            (char*)"concurrent_write.txt");
+    int table_id = open_table((char*)"DATA19");
+    for (int64_t key = 0; key < 2 * region; ++key)
+    {
+        if (key >= region || key % 2 == 0)
+        {
+            db_insert(table_id, key, (char*)std::to_string(key).c_str());
+        }
+    }
+
+    std::atomic<bool> writing { true };
+    std::atomic<int> errors { 0 };
+    std::vector<std::thread> writers;
+    for (int t = 0; t < num_writers; ++t)
+    {
+        writers.emplace_back([&, t]() {
+            for (int64_t key = 2 * t + 1; key < region; key += 2 * num_writers)
+            {
+                if (db_insert(table_id, key,
+                              (char*)std::to_string(key).c_str()) != 0)
+                {
+                    ++errors;
+                }
+            }
+        });
+        writers.emplace_back([&, t]() {
+            for (int64_t key = region + t; key < 2 * region; key += num_writers)
+            {
+                if (db_delete(table_id, key) != 0)
+                {
+                    ++errors;
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> readers;
+    readers.emplace_back([&]() {
+        std::mt19937 gen(2038);
+        char value[120];
+        while (writing)
+        {
+            int64_t key = gen() % (region / 4) * 4 + 2;
+            if (db_find(table_id, key, value, 0) != 0 ||
+                std::to_string(key) != value)
+            {
+                ++errors;
+            }
+        }
+    });
+    readers.emplace_back([&]() {
+        auto collect = [](int64_t key, char*, void* arg) {
+            static_cast<std::vector<int64_t>*>(arg)->push_back(key);
+            return 0;
+        };
+        std::vector<int64_t> keys;
+        while (writing)
+        {
+            keys.clear();
+            db_scan(table_id, 0, region - 1, 0, collect, &keys);
+            // key 순서대로 읽고, 지워지지 않는 key는 모두 읽어야 한다.
+            int64_t expected = 2;
+            for (std::size_t i = 0; i < keys.size(); ++i)
+            {
+                if (i > 0 && keys[i] <= keys[i - 1])
+                {
+                    ++errors;
+                }
+                if (keys[i] == expected)
+                {
+                    expected += 4;
+                }
+            }
+            if (expected != region + 2)
+            {
+                ++errors;
+            }
+        }
+    });
+
+    for (auto& thread : writers)
+    {
+        thread.join();
+    }
+    writing = false;
+    for (auto& thread : readers)
+    {
+        thread.join();
+    }
+
+    TEST("concurrent insert / delete")
+    {
+        CHECK_VALUE(errors.load(), 0);
+
+        int64_t count = 0;
+        bool ok = true;
+        auto collect = [](int64_t key, char* value, void* arg) {
+            auto& count = *static_cast<int64_t*>(arg);
+            if (key != count || std::to_string(key) != value)
+            {
+                return 1;
+            }
+            ++count;
+            return 0;
+        };
+        CHECK_VALUE(db_scan(table_id, 0, 2 * region, 0, collect, &count), 0);
+        CHECK_VALUE(count, region);
+        char value[120];
+        for (int64_t key = region; key < 2 * region; key += 97)
+        {
+            ok = ok && db_find(table_id, key, value, 0) != 0;
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    shutdown_db();
+}
+
+void TEST_BLINK()
+{
+    // 여러 thread가 임의의 순서로 insert 해서 leaf와 internal node가 동시에
+    // split 되는 동안, reader는 미리 넣어 둔 key(anchor)를 계속 찾는다.
+    // 그 다음 anchor가 아닌 key를 모두 지워 merge가 일어나게 한다.
+    constexpr int64_t num_keys = 200000;
+    constexpr int64_t anchor_gap = 1000;
+    constexpr int num_writers = 4;
+    unlink("blink.log");
+    unlink("DATA21");
+    init_db(1000, 0, 0, (char*)"blink.log", (char*)"blink.txt");
+    int table_id = open_table((char*)"DATA21");
+    for (int64_t key = 0; key < num_keys; key += anchor_gap)
+    {
+        db_insert(table_id, key, (char*)std::to_string(key).c_str());
+    }
+
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < num_keys; ++key)
+    {
+        if (key % anchor_gap != 0)
+        {
+            keys.push_back(key);
+        }
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(2038));
+
+    std::atomic<int> errors { 0 };
+    auto run_writers = [&](bool inserting) {
+        std::atomic<bool> writing { true };
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 2; ++t)
+        {
+            readers.emplace_back([&, t]() {
+                std::mt19937 gen(t);
+                char value[120];
+                while (writing)
+                {
+                    int64_t key = gen() % (num_keys / anchor_gap) * anchor_gap;
+                    if (db_find(table_id, key, value, 0) != 0 ||
+                        std::to_string(key) != value)
+                    {
+                        ++errors;
+                    }
+                }
+            });
+        }
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < num_writers; ++t)
+        {
+            writers.emplace_back([&, t]() {
+                for (std::size_t i = t; i < keys.size(); i += num_writers)
+                {
+                    int64_t key = keys[i];
+                    int result =
+                        inserting ? db_insert(table_id, key,
+                                              (char*)std::to_string(key).c_str())
+                                  : db_delete(table_id, key);
+                    if (result != 0)
+                    {
+                        ++errors;
+                    }
+                }
+            });
+        }
+        for (auto& thread : writers)
+        {
+            thread.join();
+        }
+        writing = false;
+        for (auto& thread : readers)
+        {
+            thread.join();
+        }
+    };
+
+    auto count_keys = [&](int64_t step) {
+        int64_t count = 0;
+        std::pair<int64_t*, int64_t> arg { &count, step };
+        auto collect = [](int64_t key, char* value, void* arg) {
+            auto& [count, step] = *static_cast<std::pair<int64_t*, int64_t>*>(arg);
+            if (key != *count * step || std::to_string(key) != value)
+            {
+                return 1;
+            }
+            ++*count;
+            return 0;
+        };
+        return db_scan(table_id, 0, num_keys, 0, collect, &arg) == 0 ? count
+                                                                     : -1;
+    };
+
+    TEST("concurrent split")
+    {
+        run_writers(true);
+        CHECK_VALUE(errors.load(), 0);
+        CHECK_VALUE(count_keys(1), num_keys);
+    }
+    END()
+
+    TEST("concurrent merge")
+    {
+        run_writers(false);
+        CHECK_VALUE(errors.load(), 0);
+        CHECK_VALUE(count_keys(anchor_gap), num_keys / anchor_gap);
+    }
+    END()
+
+    shutdown_db();
+}
+
+// leaf 하나를 100바이트 value로 채우고 앞의 key를 지워서 cell 사이에 빈
+// 자리를 만든 뒤, commit 하지 않은 update가 있는 채로 record를 넣고 abort
+// 한다. record를 넣으면 slot / CellRef 배열이 움직이고, 자리가 모자라면
+// compact 해야 한다. 바뀐 cell이 옮겨지면 abort가 엉뚱한 곳에 쓰인다.
+// entry_size는 cell을 뺀 record 하나의 크기이다. (SLOTTED는 Slot, COLUMNAR는
+// LeafKey + CellRef)
+static bool abort_after_insert(const char* path, int format, int entry_size)
+{
+    unlink(path);
+    int leaf_table = open_table(const_cast<char*>(path));
+    if (db_set_leaf_format(leaf_table, format) != 0)
+    {
+        return false;
+    }
+    // 100바이트 value의 cell은 104바이트이다.
+    constexpr int length = 100;
+    constexpr int deleted = 30;
+    const int fits = page_layout::entry_bytes / (entry_size + 104);
+    auto value_of = [](int64_t key) {
+        return std::string(length, 'a' + key % 26);
+    };
+    auto leaf_matches = [&](int64_t key, const std::string& expected) {
+        char value[120];
+        int found = -1;
+        return db_find_n(leaf_table, key, value, &found, 0) == 0 &&
+               found == static_cast<int>(expected.size()) &&
+               std::memcmp(value, expected.data(), found) == 0;
+    };
+
+    bool ok = fits > deleted + 2;
+    for (int64_t key = 0; key < fits; ++key)
+    {
+        ok = ok &&
+             db_insert_n(leaf_table, key, value_of(key).data(), length) == 0;
+    }
+    for (int64_t key = 0; key < deleted; ++key)
+    {
+        ok = ok && db_delete(leaf_table, key) == 0;
+    }
+
+    // 같은 길이와 cell보다 긴 value로 바꾼다.
+    int trx = trx_begin();
+    std::string same(length, 'Z');
+    std::string longer(length + 10, 'Y');
+    ok = ok &&
+         db_update_n(leaf_table, deleted, same.data(), same.size(), trx) == 0;
+    ok = ok && db_update_n(leaf_table, deleted + 1, longer.data(),
+                           longer.size(), trx) == 0;
+    ok = ok && leaf_matches(deleted + 1, longer);
+    for (int64_t key = fits + 100; key < fits + 104; ++key)
+    {
+        ok = ok &&
+             db_insert_n(leaf_table, key, value_of(key).data(), length) == 0;
+    }
+    ok = trx_abort(trx) == trx && ok;
+
+    for (int64_t key = deleted; key < fits; ++key)
+    {
+        ok = ok && leaf_matches(key, value_of(key));
+    }
+    for (int64_t key = fits + 100; key < fits + 104; ++key)
+    {
+        ok = ok && leaf_matches(key, value_of(key));
+    }
+    close_table(leaf_table);
+    return ok;
+}
+
+void TEST_SLOTTED()
+{
+    constexpr int64_t num_records = 5000;
+    unlink("slotted.log");
+    unlink("DATA24");
+    unlink("DATA25");
+    init_db(1000, 0, 0, (char*)"slotted.log", (char*)"slotted.txt");
+    int table_id = open_table((char*)"DATA24");
+
+    // key마다 길이가 다르고 0이 섞인 value
+    auto make_value = [](int64_t key, int length) {
+        std::string value(length, '\0');
+        for (int i = 0; i < length; ++i)
+        {
+            value[i] = static_cast<char>((key + i) % 5);
+        }
+        return value;
+    };
+    auto matches = [&](int64_t key, const std::string& expected) {
+        char value[120];
+        int length = -1;
+        return db_find_n(table_id, key, value, &length, 0) == 0 &&
+               length == static_cast<int>(expected.size()) &&
+               std::memcmp(value, expected.data(), length) == 0;
+    };
+
+    // update grows에서 바꾸는 value. 앞의 절반은 모두 길어진다.
+    auto grown = [&](int64_t key) {
+        return make_value(key + 1, key < num_records / 2
+                                       ? 100 + key % 20
+                                       : (key * 37 + 60) % 120);
+    };
+
+    TEST("leaf page")
+    {
+        // 세 형식에 같은 연산을 하고 남은 record를 비교한다.
+        int fits[3] = { 0, 0, 0 };
+        for (auto format : { LeafFormat::RECORDS, LeafFormat::SLOTTED,
+                             LeafFormat::COLUMNAR })
+        {
+            node_t page {};
+            page.leaf_init(format);
+            std::map<keyType, std::string> expected;
+            KeyValue rec;
+            auto set = [&](keyType key, const std::string& value) {
+                valType text {};
+                std::memcpy(text.data(), value.data(), value.size());
+                rec.init(key, text, value.size());
+            };
+
+            for (keyType key = 0;; key += 2)
+            {
+                set(key, std::to_string(key));
+                if (!page.leaf_fits(rec))
+                {
+                    break;
+                }
+                page.leaf_insert(page.leaf_lower_bound(key), rec);
+                expected[key] = std::to_string(key);
+            }
+            fits[static_cast<int>(format)] = page.number_of_keys();
+
+            for (keyType key = 0; key < 2 * fits[0]; key += 6)
+            {
+                page.leaf_erase(page.leaf_index(key));
+                expected.erase(key);
+            }
+
+            // 짧아지는 update는 cell 안에서, 길어지는 update는 빈 곳으로
+            // 옮겨 가거나 자리가 없으면 -1이다.
+            bool ok = true;
+            page_changes changes;
+            for (auto& [key, value] : expected)
+            {
+                std::string next(key % 4 == 0 ? 1 : 40, 'a' + key % 26);
+                set(key, next);
+                int count = page.leaf_update(page.leaf_index(key), rec, changes);
+                if (count != -1)
+                {
+                    value = next;
+                }
+                ok = ok && (count == 1 || count == 3 ||
+                            (count == -1 && leaf_has_cells(format)));
+            }
+            CHECK_TRUE(ok);
+
+            // 지운 자리는 compact 해서 다시 쓴다.
+            for (keyType key = 1; key < 40; key += 2)
+            {
+                set(key, "inserted");
+                if (page.leaf_fits(rec))
+                {
+                    page.leaf_insert(page.leaf_lower_bound(key), rec);
+                    expected[key] = "inserted";
+                }
+            }
+
+            CHECK_VALUE(page.number_of_keys(),
+                        static_cast<int>(expected.size()));
+            int i = 0;
+            for (auto& [key, value] : expected)
+            {
+                page.leaf_read(i++, rec);
+                ok = ok && rec.key == key && rec.overflow == EMPTY_PAGE_NUMBER &&
+                     std::string(reinterpret_cast<char*>(rec.value.data()),
+                                 rec.length) == value;
+            }
+            CHECK_TRUE(ok);
+
+            if (leaf_has_cells(format))
+            {
+                // overflow page를 가리키는 cell은 가장 작은 cell에도 들어간다.
+                rec.key = page.leaf_key(0);
+                rec.length = 0;
+                rec.overflow = 12345;
+                CHECK_VALUE(page.leaf_update(0, rec, changes), 1);
+                CHECK_VALUE(page.leaf_overflow(0), 12345);
+            }
+        }
+        // 짧은 value는 slotted leaf에 훨씬 많이 들어가고, columnar leaf는
+        // slot의 빈 4바이트가 없어서 조금 더 들어간다.
+        CHECK_TRUE(fits[1] > 4 * fits[0]);
+        CHECK_TRUE(fits[2] > fits[1]);
+    }
+    END()
+
+    TEST("variable length")
+    {
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            auto value = make_value(key, key % 120);
+            ok = ok && db_insert_n(table_id, key, value.data(), value.size()) ==
+                           0;
+        }
+        CHECK_TRUE(ok);
+        std::string too_long(max_overflow_length + 1, 'x');
+        CHECK_VALUE(db_insert_n(table_id, num_records, too_long.data(),
+                                too_long.size()),
+                    -1);
+        CHECK_VALUE(db_insert_n(table_id, num_records, too_long.data(), -1),
+                    -1);
+
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && matches(key, make_value(key, key % 120));
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    TEST("update grows")
+    {
+        // 앞의 절반은 transaction 없이 바꿔서 leaf를 compact 하거나 나눈다.
+        // 뒤의 절반은 한 transaction으로 바꾸므로, cell에 들어가지 않는
+        // value는 overflow page로 빠진다.
+        bool ok = true;
+        int trx = 0;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            if (key == num_records / 2)
+            {
+                trx = trx_begin();
+            }
+            auto value = grown(key);
+            ok = ok && db_update_n(table_id, key, value.data(), value.size(),
+                                   trx) == 0;
+        }
+        CHECK_VALUE(trx_commit(trx), trx);
+        CHECK_TRUE(ok);
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && matches(key, grown(key));
+        }
+        CHECK_TRUE(ok);
+
+        // overflow page를 가리키는 record도 지우고 merge 할 수 있다.
+        for (int64_t key = 0; key < num_records; key += 2)
+        {
+            ok = ok && db_delete(table_id, key) == 0;
+        }
+        CHECK_TRUE(ok);
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && (key % 2 == 0
+                            ? !matches(key, "")
+                            : matches(key, grown(key)));
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    TEST("rollback")
+    {
+        // 길어져서 overflow page로 뺀 update도 abort 하면 예전 value로
+        // 돌아온다.
+        int trx = trx_begin();
+        bool ok = true;
+        std::string longest(max_value_length, 'z');
+        for (int64_t key = 1; key < num_records; key += 4)
+        {
+            ok = ok && db_update_n(table_id, key, longest.data(),
+                                   longest.size(), trx) == 0;
+        }
+        CHECK_TRUE(ok);
+        char value[120];
+        int length = 0;
+        CHECK_VALUE(db_find_n(table_id, 1, value, &length, trx), 0);
+        CHECK_VALUE(length, max_value_length);
+        CHECK_VALUE(trx_abort(trx), trx);
+
+        for (int64_t key = 1; key < num_records; key += 2)
+        {
+            ok = ok && matches(key, grown(key));
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    TEST("abort after insert")
+    {
+        CHECK_TRUE(abort_after_insert("DATA40", 1, sizeof(Slot)));
+    }
+    END()
+
+    TEST("reopen")
+    {
+        shutdown_db();
+        init_db(1000, 0, 0, (char*)"slotted.log", (char*)"slotted.txt");
+        table_id = open_table((char*)"DATA24");
+        bool ok = true;
+        for (int64_t key = 1; key < num_records; key += 2)
+        {
+            ok = ok && matches(key, grown(key));
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    TEST("fanout")
+    {
+        // 짧은 value만 넣으면 Records leaf가 꽉 찼을 때보다도 page가 적다.
+        constexpr int64_t num_short = 20000;
+        int short_table = open_table((char*)"DATA25");
+        for (int64_t key = 0; key < num_short; ++key)
+        {
+            db_insert(short_table, key, (char*)std::to_string(key).c_str());
+        }
+        shutdown_db();
+
+        std::ifstream file("DATA25", std::ios::binary | std::ios::ate);
+        auto pages = static_cast<int64_t>(file.tellg()) / PAGESIZE;
+        CHECK_TRUE(pages < num_short / (LEAF_ORDER - 1));
+    }
+    END()
+}
+
+void TEST_OVERFLOW()
+{
+    constexpr int64_t num_records = 300;
+    unlink("overflow.log");
+    unlink("DATA27");
+    init_db(1000, 0, 0, (char*)"overflow.log", (char*)"overflow.txt");
+    int table_id = open_table((char*)"DATA27");
+
+    // 여러 overflow page에 걸치는 value
+    auto make_value = [](int64_t key, int length) {
+        std::string value(length, '\0');
+        for (int i = 0; i < length; ++i)
+        {
+            value[i] = static_cast<char>((key * 7 + i) % 251);
+        }
+        return value;
+    };
+    std::map<int64_t, std::string> expected;
+    auto matches = [&](int64_t key, const std::string& value) {
+        std::string buffer(value.size() + 10, '\0');
+        int length = -1;
+        return db_find_value(table_id, key, buffer.data(), buffer.size(),
+                             &length, 0) == 0 &&
+               length == static_cast<int>(value.size()) &&
+               std::memcmp(buffer.data(), value.data(), length) == 0;
+    };
+    auto all_match = [&]() {
+        bool ok = true;
+        for (auto& [key, value] : expected)
+        {
+            ok = ok && matches(key, value);
+        }
+        return ok;
+    };
+
+    TEST("insert / find")
+    {
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            auto value = make_value(key, key % 3 == 0 ? key % 119
+                                                      : 120 + key * 97 % 20000);
+            ok = ok && db_insert_n(table_id, key, value.data(), value.size()) ==
+                           0;
+            expected[key] = value;
+        }
+        CHECK_TRUE(ok);
+        CHECK_TRUE(all_match());
+        CHECK_VALUE(db_insert_n(table_id, 1, expected[1].data(),
+                                expected[1].size()),
+                    -1);
+
+        // 앞부분만 읽기
+        char prefix[16];
+        int length = 0;
+        CHECK_VALUE(db_find_value(table_id, 2, prefix, sizeof(prefix), &length,
+                                  0),
+                    0);
+        CHECK_VALUE(length, static_cast<int>(expected[2].size()));
+        CHECK_TRUE(std::memcmp(prefix, expected[2].data(), sizeof(prefix)) ==
+                   0);
+
+        // db_find_n / scan은 앞 119바이트만 돌려준다.
+        char value[120];
+        CHECK_VALUE(db_find_n(table_id, 2, value, &length, 0), 0);
+        CHECK_VALUE(length, static_cast<int>(expected[2].size()));
+        CHECK_TRUE(std::memcmp(value, expected[2].data(), max_value_length) ==
+                   0);
+        int64_t key;
+        int cursor = db_scan_open(table_id, 2, 2, 0);
+        CHECK_VALUE(db_scan_next(cursor, &key, value), 0);
+        CHECK_TRUE(std::memcmp(value, expected[2].data(), max_value_length) ==
+                   0);
+        db_scan_close(cursor);
+
+        // NUL로 끝나는 문자열도 잘리지 않는다.
+        std::string text(500, 'a');
+        CHECK_VALUE(db_insert(table_id, num_records, text.data()), 0);
+        expected[num_records] = text;
+        CHECK_TRUE(matches(num_records, text));
+    }
+    END()
+
+    TEST("update")
+    {
+        // 짧아지거나 길어지는 update, inline value가 chain으로 가는 update
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            auto value = make_value(key + 1, key % 2 == 0
+                                                 ? 200 + key * 53 % 30000
+                                                 : key % 150);
+            ok = ok && db_update_n(table_id, key, value.data(), value.size(),
+                                   0) == 0;
+            expected[key] = value;
+        }
+        CHECK_TRUE(ok);
+        CHECK_TRUE(all_match());
+    }
+    END()
+
+    TEST("log changed pages")
+    {
+        // 여러 page에 걸친 value의 1바이트를 바꾸면, 그 바이트가 있는
+        // overflow page와 leaf cell의 log만 남는다.
+        // page 크기와 상관없이 overflow page 여러 개가 필요한 길이로 넣는다.
+        int64_t key = num_records + 1;
+        auto value = make_value(key, 4 * page_layout::entry_bytes);
+        CHECK_VALUE(db_insert_n(table_id, key, value.data(), value.size()), 0);
+        expected[key] = value;
+        value[value.size() / 2] ^= 0x5a;
+        int trx = trx_begin();
+        CHECK_VALUE(db_update_n(table_id, key, value.data(), value.size(), trx),
+                    0);
+        CHECK_VALUE(trx_commit(trx), trx);
+        expected[key] = value;
+        CHECK_TRUE(matches(key, value));
+
+        LogReader reader("overflow.log");
+        int updates = 0;
+        while (true)
+        {
+            auto [type, rec] = reader.next();
+            if (type == LogType::INVALID)
+            {
+                break;
+            }
+            if (type == LogType::UPDATE &&
+                std::get<UpdateLogRecord>(rec).transaction_id == trx)
+            {
+                ++updates;
+            }
+        }
+        CHECK_VALUE(updates, 2);
+    }
+    END()
+
+    TEST("rollback")
+    {
+        int trx = trx_begin();
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; key += 5)
+        {
+            auto value = make_value(key + 2, 100 + key * 31 % 25000);
+            ok = ok && db_update_n(table_id, key, value.data(), value.size(),
+                                   trx) == 0;
+        }
+        CHECK_TRUE(ok);
+        CHECK_VALUE(trx_abort(trx), trx);
+        CHECK_TRUE(all_match());
+    }
+    END()
+
+    TEST("delete")
+    {
+        // 지운 chain의 page는 다시 쓴다.
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; key += 2)
+        {
+            ok = ok && db_delete(table_id, key) == 0;
+            expected.erase(key);
+        }
+        CHECK_TRUE(ok);
+        CHECK_TRUE(all_match());
+        for (int64_t key = 0; key < num_records; key += 4)
+        {
+            auto value = make_value(key + 3, 1000 + key * 13 % 9000);
+            ok = ok && db_insert_n(table_id, key, value.data(), value.size()) ==
+                           0;
+            expected[key] = value;
+        }
+        CHECK_TRUE(ok);
+        CHECK_TRUE(all_match());
+    }
+    END()
+
+    TEST("reopen")
+    {
+        shutdown_db();
+        init_db(1000, 0, 0, (char*)"overflow.log", (char*)"overflow.txt");
+        table_id = open_table((char*)"DATA27");
+        CHECK_TRUE(all_match());
+        shutdown_db();
+    }
+    END()
+}
+
+void TEST_INTERNAL()
+{
+    // upper_bound를 entry 배열에서 직접 센 것과 비교한다.
+    auto same_as = [](const node_t& page, const std::vector<Internal>& entries,
+                      const std::vector<keyType>& probes) {
+        bool ok = page.number_of_keys() == static_cast<int>(entries.size());
+        for (int i = 0; ok && i < static_cast<int>(entries.size()); ++i)
+        {
+            ok = page.internal_key(i) == entries[i].key &&
+                 page.internal_child(i) == entries[i].node_id;
+        }
+        for (auto key : probes)
+        {
+            int expected = std::upper_bound(entries.begin(), entries.end(), key,
+                                            [](keyType k, const Internal& e) {
+                                                return k < e.key;
+                                            }) -
+                           entries.begin();
+            ok = ok && page.internal_upper_bound(key) == expected;
+        }
+        return ok;
+    };
+
+    TEST("packed page")
+    {
+        // 아래 bit가 0인 separator는 key가 1바이트로 줄어든다.
+        std::vector<Internal> entries;
+        for (int i = 0; i < 200; ++i)
+        {
+            entries.push_back({ (int64_t { 1 } << 40) + i * 4096, 10u + i });
+        }
+        node_t page {};
+        CHECK_TRUE(page.internal_assign(entries));
+        CHECK_TRUE(page.internal_format() == InternalFormat::PACKED);
+        CHECK_VALUE(page.nodePageHeader().keyWidth, 1);
+        CHECK_VALUE(page.nodePageHeader().childWidth, 4);
+
+        std::mt19937_64 gen(2038);
+        std::vector<keyType> probes { MIN_KEY, std::numeric_limits<keyType>::max(),
+                                      entries[0].key, entries[0].key - 1,
+                                      entries.back().key,
+                                      entries.back().key + 1 };
+        for (int i = 0; i < 1000; ++i)
+        {
+            probes.push_back(entries[0].key - 100 +
+                             static_cast<keyType>(gen() % (201 * 4096 + 200)));
+        }
+        CHECK_TRUE(same_as(page, entries, probes));
+        CHECK_VALUE(page.internal_index(entries[7].key), 7);
+        CHECK_VALUE(page.internal_index(entries[7].key + 1), -1);
+
+        // 너비가 늘어나는 key와 child도 넣을 수 있다.
+        CHECK_TRUE(page.internal_insert(3, entries[2].key + 1, 1ull << 40));
+        entries.insert(entries.begin() + 3,
+                       { entries[2].key + 1, pagenum_t { 1 } << 40 });
+        CHECK_TRUE(page.internal_insert(0, -5, 3));
+        entries.insert(entries.begin(), { -5, 3 });
+        CHECK_TRUE(page.nodePageHeader().keyWidth > 1);
+        CHECK_VALUE(page.nodePageHeader().childWidth, 8);
+        CHECK_TRUE(same_as(page, entries, probes));
+
+        page.internal_erase(0);
+        entries.erase(entries.begin());
+        CHECK_TRUE(same_as(page, entries, probes));
+    }
+    END()
+
+    TEST("fanout")
+    {
+        // 좁은 key는 Internals보다 훨씬 많이 들어가고, 넘치면 바꾸지 않는다.
+        std::vector<Internal> entries;
+        node_t page {};
+        while (page.internal_insert(entries.size(), entries.size() * 2,
+                                    entries.size() + 1))
+        {
+            entries.push_back({ static_cast<keyType>(entries.size() * 2),
+                                entries.size() + 1 });
+        }
+        CHECK_TRUE(static_cast<int>(entries.size()) >
+                   2 * page_layout::internals);
+        CHECK_TRUE(same_as(page, entries, { -1, 0, 1, 2, 999, 1000, 1 << 20 }));
+
+        // 아무리 넓어도 Internals 만큼은 들어간다.
+        entries.clear();
+        for (int i = 0; i < page_layout::internals; ++i)
+        {
+            entries.push_back({ i == 0 ? MIN_KEY : (int64_t { 1 } << 62) + i * 3,
+                                ~pagenum_t { 0 } - i });
+        }
+        CHECK_TRUE(page.internal_assign(entries));
+        entries.push_back({ std::numeric_limits<keyType>::max(), 1 });
+        CHECK_FALSE(page.internal_assign(entries));
+        entries.pop_back();
+        CHECK_TRUE(same_as(page, entries, { MIN_KEY, 0 }));
+    }
+    END()
+
+    TEST("wide page")
+    {
+        // 형식을 적기 전에 만든 internal node도 읽고, 바꾸면 PACKED가 된다.
+        node_t page {};
+        std::vector<Internal> entries;
+        for (int i = 0; i < 100; ++i)
+        {
+            page.emplace_back<internal_t>(i * 7, i + 1);
+            entries.push_back({ i * 7, static_cast<pagenum_t>(i + 1) });
+        }
+        page.set_leftmost(1000);
+        CHECK_TRUE(page.internal_format() == InternalFormat::WIDE);
+        CHECK_TRUE(same_as(page, entries, { -1, 0, 6, 7, 700, 693 }));
+        CHECK_VALUE(page.internal_child_for(-1), 1000);
+        CHECK_VALUE(page.internal_child_for(8), 2);
+
+        CHECK_TRUE(page.internal_insert(100, 800, 101));
+        entries.push_back({ 800, 101 });
+        CHECK_TRUE(page.internal_format() == InternalFormat::PACKED);
+        CHECK_TRUE(same_as(page, entries, { -1, 0, 6, 7, 700, 800, 801 }));
+        CHECK_VALUE(page.leftmost(), 1000);
+    }
+    END()
+
+    constexpr int64_t num_records = 100000;
+    unlink("internal.log");
+    unlink("DATA29");
+    init_db(1000, 0, 0, (char*)"internal.log", (char*)"internal.txt");
+    int table_id = open_table((char*)"DATA29");
+    std::mt19937_64 gen(2038);
+    std::vector<int64_t> keys;
+
+    TEST("random keys")
+    {
+        // 64bit 전체에 흩어진 key와, 그 사이에 끼워 넣은 가까운 key
+        for (int64_t i = 0; i < num_records; ++i)
+        {
+            int64_t key = static_cast<int64_t>(gen());
+            keys.push_back(key);
+            keys.push_back(key ^ (1 + gen() % 64));
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::shuffle(keys.begin(), keys.end(), gen);
+
+        bool ok = true;
+        for (auto key : keys)
+        {
+            ok = ok && db_insert(table_id, key,
+                                 (char*)std::to_string(key).c_str()) == 0;
+        }
+        CHECK_TRUE(ok);
+        char value[120];
+        for (auto key : keys)
+        {
+            ok = ok && db_find(table_id, key, value, 0) == 0 &&
+                 std::to_string(key) == value;
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    TEST("delete")
+    {
+        // merge / redistribute가 separator를 다시 고른다.
+        bool ok = true;
+        std::size_t half = keys.size() / 2;
+        for (std::size_t i = 0; i < half; ++i)
+        {
+            ok = ok && db_delete(table_id, keys[i]) == 0;
+        }
+        CHECK_TRUE(ok);
+        char value[120];
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            ok = ok && (db_find(table_id, keys[i], value, 0) == 0) == (i >= half);
+        }
+        CHECK_TRUE(ok);
+
+        int64_t key;
+        long long count = 0;
+        int cursor = db_scan_open(table_id, MIN_KEY,
+                                  std::numeric_limits<int64_t>::max(), 0);
+        while (db_scan_next(cursor, &key, value) == 0)
+        {
+            ++count;
+        }
+        db_scan_close(cursor);
+        CHECK_VALUE(count, static_cast<long long>(keys.size() - half));
+        shutdown_db();
+    }
+    END()
+}
+
+void TEST_COLUMNAR()
+{
+    TEST("leaf page")
+    {
+        // 임의로 넣고 지운 뒤 std::map과 비교한다. 절반쯤 남으므로 key
+        // 범위는 Records leaf 크기의 4배로 잡는다.
+        const keyType num_keys = 4 * page_layout::records;
+        node_t page {};
+        page.leaf_init(LeafFormat::COLUMNAR);
+        std::map<keyType, std::string> expected;
+        std::mt19937 gen(2038);
+        KeyValue rec;
+        auto set = [&](keyType key, const std::string& value) {
+            valType text {};
+            std::memcpy(text.data(), value.data(), value.size());
+            rec.init(key, text, value.size());
+        };
+        for (int i = 0; i < 2000; ++i)
+        {
+            keyType key = gen() % num_keys;
+            int index = page.leaf_index(key);
+            if (index != -1)
+            {
+                page.leaf_erase(index);
+                expected.erase(key);
+                continue;
+            }
+            set(key, std::string(gen() % 30, 'a' + key % 26));
+            if (page.leaf_fits(rec))
+            {
+                page.leaf_insert(page.leaf_lower_bound(key), rec);
+                expected[key] = std::string(reinterpret_cast<char*>(
+                                                rec.value.data()),
+                                            rec.length);
+            }
+        }
+
+        auto same = [&](const node_t& page) {
+            bool ok = page.number_of_keys() ==
+                      static_cast<int>(expected.size());
+            int i = 0;
+            for (auto& [key, value] : expected)
+            {
+                KeyValue now;
+                page.leaf_read(i, now);
+                ok = ok && page.leaf_key(i) == key && now.key == key &&
+                     page.leaf_index(key) == i &&
+                     std::string(reinterpret_cast<char*>(now.value.data()),
+                                 now.length) == value;
+                ++i;
+            }
+            return ok;
+        };
+        CHECK_TRUE(expected.size() > 20);
+        CHECK_TRUE(same(page));
+        CHECK_VALUE(page.leaf_upper_bound(-1), 0);
+        CHECK_VALUE(page.leaf_upper_bound(num_keys),
+                    static_cast<int>(expected.size()));
+
+        // 다른 형식으로 바꿔도 record는 같다. value가 짧아서 slotted leaf에도
+        // 들어가지만, Records leaf에는 다 들어가지 않는다.
+        for (auto format : { LeafFormat::SLOTTED, LeafFormat::COLUMNAR })
+        {
+            CHECK_TRUE(page.leaf_convert(format));
+            CHECK_TRUE(page.leaf_format() == format);
+            CHECK_TRUE(same(page));
+        }
+        CHECK_TRUE(expected.size() > page_layout::records);
+        CHECK_FALSE(page.leaf_convert(LeafFormat::RECORDS));
+        CHECK_TRUE(page.leaf_format() == LeafFormat::COLUMNAR);
+        CHECK_TRUE(same(page));
+
+        // 짧은 value로 가득 찬 columnar leaf는 slotted leaf에 들어가지 않는다.
+        node_t full {};
+        full.leaf_init(LeafFormat::COLUMNAR);
+        for (keyType key = 0;; ++key)
+        {
+            set(key, "x");
+            if (!full.leaf_fits(rec))
+            {
+                break;
+            }
+            full.leaf_insert(full.number_of_keys(), rec);
+        }
+        CHECK_FALSE(full.leaf_convert(LeafFormat::SLOTTED));
+        CHECK_TRUE(full.leaf_format() == LeafFormat::COLUMNAR);
+    }
+    END()
+
+    constexpr int64_t num_records = 20000;
+    unlink("columnar.log");
+    unlink("DATA31");
+    init_db(1000, 0, 0, (char*)"columnar.log", (char*)"columnar.txt");
+    int table_id = open_table((char*)"DATA31");
+    close_table(table_id);
+    shutdown_db();
+
+    // leaf 형식을 적기 전에 만든 파일처럼 header의 형식을 RECORDS로 바꾼다.
+    {
+        std::fstream file("DATA31",
+                          std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t format = static_cast<uint32_t>(LeafFormat::RECORDS);
+        file.seekp(offsetof(HeaderPageHeader, leafFormat));
+        file.write(reinterpret_cast<char*>(&format), sizeof(format));
+    }
+    init_db(1000, 0, 0, (char*)"columnar.log", (char*)"columnar.txt");
+    table_id = open_table((char*)"DATA31");
+
+    auto text = [](int64_t key) { return "v" + std::to_string(key * 7); };
+    auto all_found = [&]() {
+        bool ok = true;
+        char value[120];
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && db_find(table_id, key, value, 0) == 0 &&
+                 text(key) == value;
+        }
+        int64_t count = 0;
+        db_scan(
+            table_id, 0, num_records, 0,
+            [](int64_t, char*, void* arg) {
+                ++*static_cast<int64_t*>(arg);
+                return 0;
+            },
+            &count);
+        return ok && count == num_records;
+    };
+    std::string long_value(1000, 'L');
+
+    TEST("migrate records")
+    {
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            db_insert(table_id, key, (char*)text(key).c_str());
+        }
+        // Records leaf에는 overflow page chain이 없다.
+        CHECK_VALUE(db_insert_n(table_id, num_records, long_value.data(),
+                                long_value.size()),
+                    -1);
+
+        CHECK_VALUE(db_set_leaf_format(table_id, 2), 0);
+        CHECK_TRUE(all_found());
+        CHECK_VALUE(db_insert_n(table_id, num_records, long_value.data(),
+                                long_value.size()),
+                    0);
+        CHECK_VALUE(db_delete(table_id, num_records), 0);
+        CHECK_VALUE(db_set_leaf_format(table_id, 0), -1);
+    }
+    END()
+
+    TEST("migrate cells")
+    {
+        // columnar에서 slotted로 가면 leaf가 커져서 나뉜다.
+        CHECK_VALUE(db_set_leaf_format(table_id, 1), 0);
+        CHECK_TRUE(all_found());
+        CHECK_VALUE(db_set_leaf_format(table_id, 2), 0);
+        CHECK_TRUE(all_found());
+
+        // table의 형식은 파일에 남는다.
+        close_table(table_id);
+        shutdown_db();
+        init_db(1000, 0, 0, (char*)"columnar.log", (char*)"columnar.txt");
+        table_id = open_table((char*)"DATA31");
+        CHECK_TRUE(all_found());
+        CHECK_VALUE(db_insert_n(table_id, num_records, long_value.data(),
+                                long_value.size()),
+                    0);
+        char value[120];
+        int length = 0;
+        CHECK_VALUE(db_find_n(table_id, num_records, value, &length, 0), 0);
+        CHECK_VALUE(length, 1000);
+        CHECK_VALUE(db_delete(table_id, num_records), 0);
+    }
+    END()
+
+    TEST("pending update")
+    {
+        // commit 하지 않은 update가 있는 leaf는 건너뛰었다가 다시 바꾼다.
+        int trx_id = trx_begin();
+        CHECK_VALUE(db_update(table_id, 100, (char*)"pending", trx_id), 0);
+        CHECK_VALUE(db_set_leaf_format(table_id, 1), 1);
+        CHECK_VALUE(trx_abort(trx_id), trx_id);
+        CHECK_VALUE(db_set_leaf_format(table_id, 1), 0);
+        CHECK_TRUE(all_found());
+    }
+    END()
+
+    TEST("abort after insert")
+    {
+        CHECK_TRUE(abort_after_insert("DATA41", 2,
+                                      sizeof(LeafKey) + sizeof(CellRef)));
+    }
+    END()
+
+    close_table(table_id);
+    shutdown_db();
+}
+
+void TEST_COMPRESSED()
+{
+    TEST("codec")
+    {
+        auto round_trip = [](const page_t& page) {
+            std::array<uint8_t, page_codec_bound> buffer;
+            int length = page_compress(page, buffer.data());
+            page_t out;
+            std::memset(&out, 0xAB, sizeof(out));
+            return std::make_pair(
+                length, page_decompress(buffer.data(), length, out) &&
+                            std::memcmp(&out, &page, PAGESIZE) == 0);
+        };
+
+        page_t zero {};
+        auto [zero_length, zero_ok] = round_trip(zero);
+        CHECK_TRUE(zero_ok);
+        // 0만 있는 page는 match 길이를 적는 byte만 남는다. (255바이트마다 1)
+        CHECK_TRUE(zero_length < 16 + PAGESIZE / 255);
+
+        node_t leaf {};
+        leaf.leaf_init(LeafFormat::SLOTTED);
+        KeyValue rec;
+        for (keyType key = 0; key < 20; ++key)
+        {
+            valType value {};
+            std::sprintf(reinterpret_cast<char*>(value.data()), "%ld", key);
+            rec.init(key, value, 5);
+            leaf.leaf_insert(leaf.number_of_keys(), rec);
+        }
+        auto [leaf_length, leaf_ok] = round_trip(leaf);
+        CHECK_TRUE(leaf_ok);
+        CHECK_TRUE(leaf_length < PAGESIZE / 4);
+
+        // 압축되지 않는 page도 bound 안에서 되돌릴 수 있다.
+        page_t noise;
+        std::mt19937 gen(2038);
+        for (auto& byte : reinterpret_cast<uint8_t(&)[PAGESIZE]>(noise))
+        {
+            byte = gen();
+        }
+        auto [noise_length, noise_ok] = round_trip(noise);
+        CHECK_TRUE(noise_ok);
+        CHECK_TRUE(noise_length <= page_codec_bound);
+
+        // 잘린 입력은 실패한다.
+        std::array<uint8_t, page_codec_bound> buffer;
+        int length = page_compress(leaf, buffer.data());
+        page_t out;
+        CHECK_FALSE(page_decompress(buffer.data(), length - 1, out));
+    }
+    END()
+
+    constexpr int64_t num_records = 20000;
+    auto text = [](int64_t key) { return "value " + std::to_string(key); };
+    auto allocated = []() {
+        struct stat st;
+        stat("DATA33", &st);
+        return static_cast<long long>(st.st_blocks) * 512;
+    };
+    auto reopen = [](int table_id) {
+        close_table(table_id);
+        shutdown_db();
+        init_db(100, 0, 0, (char*)"compressed.log", (char*)"compressed.txt");
+        return open_table((char*)"DATA33");
+    };
+
+    unlink("compressed.log");
+    unlink("DATA33");
+    init_db(100, 0, 0, (char*)"compressed.log", (char*)"compressed.txt");
+    int table_id = open_compressed_table((char*)"DATA33");
+
+    TEST("table")
+    {
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            db_insert(table_id, key, (char*)text(key).c_str());
+        }
+
+        // 다시 열 때는 header에 적힌 형식을 따른다.
+        table_id = reopen(table_id);
+        char value[120];
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && db_find(table_id, key, value, 0) == 0 &&
+                 text(key) == value;
+        }
+        CHECK_TRUE(ok);
+
+        auto& fm = BufferController::instance().getFileManager(table_id);
+        CHECK_TRUE(fm.file_format() == FileFormat::COMPRESSED);
+
+        // 압축하지 않았다면 numberOfPages * PAGESIZE 만큼 쓴다.
+        // 빈 곳이 적은 slotted leaf라도 1/3 넘게 줄어든다.
+        HeaderPageHeader header;
+        std::ifstream("DATA33", std::ios::binary)
+            .read(reinterpret_cast<char*>(&header), sizeof(header));
+        CHECK_TRUE(header.fileFormat ==
+                   static_cast<uint32_t>(FileFormat::COMPRESSED));
+        CHECK_TRUE(allocated() * 3 <
+                   static_cast<long long>(header.numberOfPages) * PAGESIZE * 2);
+    }
+    END()
+
+    TEST("rewrite")
+    {
+        // 절반은 지우고 나머지는 긴 value로 바꾼다.
+        for (int64_t key = 0; key < num_records; key += 2)
+        {
+            CHECK_VALUE(db_delete(table_id, key), 0);
+        }
+        std::string big(100, 'b');
+        int trx_id = trx_begin();
+        for (int64_t key = 1; key < num_records; key += 2)
+        {
+            db_update(table_id, key, (char*)(big + text(key)).c_str(), trx_id);
+        }
+        CHECK_VALUE(trx_commit(trx_id), trx_id);
+
+        table_id = reopen(table_id);
+        char value[120];
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            int ret = db_find(table_id, key, value, 0);
+            ok = ok && (key % 2 == 0
+                            ? ret == -1
+                            : ret == 0 && (big + text(key)).substr(0, 119) ==
+                                              value);
+        }
+        CHECK_TRUE(ok);
+    }
+    END()
+
+    close_table(table_id);
+    shutdown_db();
+}
+
+void TEST_FIXED()
+{
+    TEST("leaf page")
+    {
+        // 너비마다 leaf에 들어가는 record 수가 FixedRecords와 같다.
+        auto fill = [](LeafFormat format, int width) {
+            node_t page {};
+            page.leaf_init(format);
+            KeyValue rec;
+            valType value {};
+            int count = 0;
+            for (keyType key = 0;; ++key)
+            {
+                std::memset(value.data(), 'a' + key % 26, width);
+                rec.init(key * 2, value, width);
+                if (!page.leaf_fits(rec))
+                {
+                    break;
+                }
+                page.leaf_insert(page.number_of_keys(), rec);
+                ++count;
+            }
+
+            bool ok = count == page.number_of_keys();
+            for (keyType key = 0; key < count; ++key)
+            {
+                KeyValue now;
+                page.leaf_read(page.leaf_index(key * 2), now);
+                ok = ok && now.key == key * 2 && now.length == width &&
+                     now.value[width - 1] == 'a' + key % 26 &&
+                     page.leaf_index(key * 2 + 1) == -1;
+            }
+
+            // update는 value 자리만 바꾼다.
+            page_changes changes;
+            std::memset(value.data(), 0, width);
+            value[0] = 'z';
+            rec.init(10, value, 1);
+            ok = ok && page.leaf_update(5, rec, changes) == 1 &&
+                 changes[0].length == width;
+            KeyValue now;
+            page.leaf_read(5, now);
+            ok = ok && now.length == width && now.value[0] == 'z' &&
+                 now.value[1] == 0;
+            rec.init(10, value, width + 1);
+            ok = ok && page.leaf_update(5, rec, changes) == -1;
+
+            page.leaf_erase(0);
+            ok = ok && page.number_of_keys() == count - 1 &&
+                 page.leaf_key(0) == 2;
+            return std::make_pair(ok, count);
+        };
+
+        auto [ok8, count8] = fill(LeafFormat::FIXED_8, 8);
+        CHECK_TRUE(ok8);
+        CHECK_VALUE(count8, page_layout::fixed_records<8>);
+        auto [ok16, count16] = fill(LeafFormat::FIXED_16, 16);
+        CHECK_TRUE(ok16);
+        CHECK_VALUE(count16, page_layout::fixed_records<16>);
+        auto [ok32, count32] = fill(LeafFormat::FIXED_32, 32);
+        CHECK_TRUE(ok32);
+        CHECK_VALUE(count32, page_layout::fixed_records<32>);
+        auto [ok64, count64] = fill(LeafFormat::FIXED_64, 64);
+        CHECK_TRUE(ok64);
+        CHECK_VALUE(count64, page_layout::fixed_records<64>);
+        CHECK_TRUE(count8 > 7 * page_layout::records);
+    }
+    END()
+
+    // page가 커져도 leaf 수는 같도록 한다.
+    constexpr int64_t num_records = 20000 * (PAGESIZE / 4096);
+    auto counter = [](int64_t key) {
+        // 가운데에 0이 있는 8바이트 값
+        int64_t value = key << 32 | 7;
+        return value;
+    };
+    auto all_found = [&](int table_id) {
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            char value[120];
+            int length = 0;
+            int64_t now = 0;
+            ok = ok && db_find_n(table_id, key, value, &length, 0) == 0 &&
+                 length == 8;
+            std::memcpy(&now, value, sizeof(now));
+            ok = ok && now == counter(key);
+        }
+        return ok;
+    };
+
+    unlink("fixed.log");
+    unlink("DATA35");
+    unlink("DATA36");
+    init_db(100, 0, 0, (char*)"fixed.log", (char*)"fixed.txt");
+    int table_id = open_fixed_table((char*)"DATA35", 8);
+
+    TEST("table")
+    {
+        CHECK_VALUE(open_fixed_table((char*)"DATA36", 12), -1);
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            int64_t value = counter(key);
+            db_insert_n(table_id, key, reinterpret_cast<char*>(&value),
+                        sizeof(value));
+        }
+        CHECK_VALUE(db_insert_n(table_id, num_records, "123456789", 9), -1);
+        CHECK_VALUE(db_insert(table_id, num_records, (char*)"short"), 0);
+        char value[120];
+        CHECK_VALUE(db_find(table_id, num_records, value, 0), 0);
+        CHECK_TRUE(std::string(value) == "short");
+        CHECK_VALUE(db_delete(table_id, num_records), 0);
+        CHECK_TRUE(all_found(table_id));
+
+        // 다시 열어도 너비는 파일에 남아 있다.
+        close_table(table_id);
+        shutdown_db();
+        init_db(100, 0, 0, (char*)"fixed.log", (char*)"fixed.txt");
+        table_id = open_table((char*)"DATA35");
+        CHECK_TRUE(all_found(table_id));
+        CHECK_VALUE(db_insert_n(table_id, num_records, "123456789", 9), -1);
+
+        // 같은 record를 120바이트 Records leaf에 넣으면 page가 8배 가까이
+        // 더 필요하다.
+        int wide_table = open_fixed_table((char*)"DATA36", 120);
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            int64_t value = counter(key);
+            db_insert_n(wide_table, key, reinterpret_cast<char*>(&value),
+                        sizeof(value));
+        }
+        close_table(wide_table);
+
+        auto header_of = [](const char* name) {
+            HeaderPageHeader header;
+            std::ifstream(name, std::ios::binary)
+                .read(reinterpret_cast<char*>(&header), sizeof(header));
+            return header;
+        };
+        auto fixed = header_of("DATA35");
+        auto wide = header_of("DATA36");
+        CHECK_TRUE(fixed.leafFormat ==
+                   static_cast<uint32_t>(LeafFormat::FIXED_8));
+        CHECK_TRUE(wide.leafFormat ==
+                   static_cast<uint32_t>(LeafFormat::RECORDS));
+        CHECK_TRUE(fixed.numberOfPages * 6 < wide.numberOfPages);
+    }
+    END()
+
+    TEST("update / abort")
+    {
+        int trx_id = trx_begin();
+        int64_t value = -1;
+        CHECK_VALUE(db_update_n(table_id, 10, reinterpret_cast<char*>(&value),
+                                sizeof(value), trx_id),
+                    0);
+        CHECK_VALUE(db_update_n(table_id, 11, "123456789", 9, trx_id), 1);
+        CHECK_VALUE(trx_abort(trx_id), trx_id);
+        CHECK_TRUE(all_found(table_id));
+
+        trx_id = trx_begin();
+        CHECK_VALUE(db_update_n(table_id, 10, reinterpret_cast<char*>(&value),
+                                sizeof(value), trx_id),
+                    0);
+        CHECK_VALUE(trx_commit(trx_id), trx_id);
+        char found[120];
+        int length = 0;
+        CHECK_VALUE(db_find_n(table_id, 10, found, &length, 0), 0);
+        CHECK_VALUE(length, 8);
+        CHECK_TRUE(std::memcmp(found, &value, sizeof(value)) == 0);
+    }
+    END()
+
+    close_table(table_id);
+    shutdown_db();
+}
+
+void TEST_RECORD_CACHE()
+{
+    auto& cache = RecordCache::instance();
+
+    TEST("cache")
+    {
+        uint8_t value[120];
+        uint8_t found[120];
+        int length = 0;
+        constexpr std::size_t entry_bytes = 100 + RecordCache::ENTRY_OVERHEAD;
+        cache.reset(RecordCache::NUM_PARTITIONS * entry_bytes * 4);
+        CHECK_TRUE(cache.enabled());
+
+        std::memset(value, 'a', sizeof(value));
+        cache.insert(1, 10, value, 100);
+        CHECK_TRUE(cache.find(1, 10, found, 120, length));
+        CHECK_VALUE(length, 100);
+        CHECK_TRUE(std::memcmp(found, value, 100) == 0);
+        // 다른 table의 같은 key는 다른 record다.
+        CHECK_FALSE(cache.find(2, 10, found, 120, length));
+        // capacity보다 긴 value는 앞부분만 쓴다.
+        found[10] = 0;
+        CHECK_TRUE(cache.find(1, 10, found, 10, length));
+        CHECK_VALUE(length, 100);
+        CHECK_VALUE(found[10], 0);
+
+        value[0] = 'b';
+        cache.insert(1, 10, value, 50);
+        CHECK_TRUE(cache.find(1, 10, found, 120, length));
+        CHECK_VALUE(length, 50);
+        CHECK_VALUE(found[0], 'b');
+        CHECK_VALUE(cache.size(), 50 + RecordCache::ENTRY_OVERHEAD);
+        cache.erase(1, 10);
+        CHECK_FALSE(cache.find(1, 10, found, 120, length));
+        CHECK_VALUE(cache.size(), 0);
+
+        // 크기를 넘으면 오래 읽지 않은 record부터 빠진다.
+        for (keyType key = 0; key < 10000; ++key)
+        {
+            cache.insert(1, key, value, 100);
+            CHECK_TRUE(cache.find(1, 0, found, 120, length));
+        }
+        CHECK_TRUE(cache.size() <= cache.capacity());
+        CHECK_TRUE(cache.size() > cache.capacity() / 2);
+        CHECK_TRUE(cache.find(1, 0, found, 120, length));
+        CHECK_TRUE(cache.find(1, 9999, found, 120, length));
+        CHECK_FALSE(cache.find(1, 5000, found, 120, length));
+
+        cache.erase_table(1);
+        CHECK_VALUE(cache.size(), 0);
+        cache.reset(0);
+        CHECK_FALSE(cache.enabled());
+        cache.insert(1, 10, value, 100);
+        CHECK_FALSE(cache.find(1, 10, found, 120, length));
+    }
+    END()
+
+    constexpr int64_t num_records = 5000;
+    auto value_of = [](int64_t key, int version) {
+        return std::to_string(key) + "-" + std::to_string(version);
+    };
+    auto found = [](int table_id, int64_t key, int trx_id = 0) {
+        char value[120];
+        if (db_find(table_id, key, value, trx_id) != 0)
+        {
+            return std::string("-");
+        }
+        return std::string(value);
+    };
+
+    unlink("cache.log");
+    unlink("DATA38");
+    db_set_record_cache(1 << 20);
+    init_db(100, 0, 0, (char*)"cache.log", (char*)"cache.txt");
+    int table_id = open_table((char*)"DATA38");
+    for (int64_t key = 0; key < num_records; ++key)
+    {
+        db_insert(table_id, key, const_cast<char*>(value_of(key, 0).c_str()));
+    }
+
+    TEST("find / update / delete")
+    {
+        CHECK_VALUE(db_set_record_cache(-1), -1);
+        CHECK_TRUE(cache.enabled());
+        cache.reset_stats();
+        bool ok = true;
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && found(table_id, key) == value_of(key, 0);
+        }
+        CHECK_TRUE(ok);
+        CHECK_VALUE(cache.misses(), static_cast<std::size_t>(num_records));
+        for (int64_t key = 0; key < num_records; ++key)
+        {
+            ok = ok && found(table_id, key) == value_of(key, 0);
+        }
+        CHECK_TRUE(ok);
+        CHECK_VALUE(cache.hits(), static_cast<std::size_t>(num_records));
+
+        CHECK_VALUE(db_update(table_id, 10,
+                              const_cast<char*>(value_of(10, 1).c_str()), 0),
+                    0);
+        CHECK_TRUE(found(table_id, 10) == value_of(10, 1));
+        CHECK_VALUE(db_upsert(table_id, 11,
+                              const_cast<char*>(value_of(11, 1).c_str()), 0),
+                    0);
+        CHECK_TRUE(found(table_id, 11) == value_of(11, 1));
+        CHECK_VALUE(db_delete(table_id, 12), 0);
+        CHECK_TRUE(found(table_id, 12) == "-");
+        CHECK_VALUE(db_insert(table_id, 12,
+                              const_cast<char*>(value_of(12, 1).c_str())),
+                    0);
+        CHECK_TRUE(found(table_id, 12) == value_of(12, 1));
+
+        // overflow page chain에 있는 value는 넣지 않는다.
+        std::string large(1000, 'x');
+        CHECK_VALUE(db_update_n(table_id, 13, large.c_str(), large.size(), 0),
+                    0);
+        char value[120];
+        int length = 0;
+        CHECK_VALUE(db_find_n(table_id, 13, value, &length, 0), 0);
+        CHECK_VALUE(length, 1000);
+        CHECK_VALUE(db_find_n(table_id, 13, value, &length, 0), 0);
+        CHECK_VALUE(length, 1000);
+        CHECK_TRUE(cache.size() <= cache.capacity());
+    }
+    END()
+
+    TEST("transaction")
+    {
+        // abort는 record를 cache에서 지운다.
+        int trx_id = trx_begin();
+        CHECK_VALUE(db_update(table_id, 20,
+                              const_cast<char*>(value_of(20, 1).c_str()),
+                              trx_id),
+                    0);
+        CHECK_TRUE(found(table_id, 20, trx_id) == value_of(20, 1));
+        CHECK_VALUE(trx_abort(trx_id), trx_id);
+        CHECK_TRUE(found(table_id, 20) == value_of(20, 0));
+
+        // commit 하지 않은 update를 transaction 밖의 find가 cache에 넣어도,
+        // 다른 transaction은 S lock을 얻을 때까지 기다린다.
+        int writer = trx_begin();
+        CHECK_VALUE(db_update(table_id, 21,
+                              const_cast<char*>(value_of(21, 1).c_str()),
+                              writer),
+                    0);
+        CHECK_TRUE(found(table_id, 21) == value_of(21, 1));
+        auto reader = std::async(std::launch::async, [&]() {
+            int trx_id = trx_begin();
+            auto value = found(table_id, 21, trx_id);
+            trx_commit(trx_id);
+            return value;
+        });
+        CHECK_TRUE(reader.wait_for(std::chrono::milliseconds(200)) ==
+                   std::future_status::timeout);
+        CHECK_VALUE(trx_abort(writer), writer);
+        CHECK_TRUE(reader.get() == value_of(21, 0));
+    }
+    END()
+
+    TEST("close table")
+    {
+        CHECK_TRUE(cache.size() > 0);
+        close_table(table_id);
+        CHECK_VALUE(cache.size(), 0);
+        table_id = open_table((char*)"DATA38");
+        CHECK_TRUE(found(table_id, 10) == value_of(10, 1));
+        CHECK_TRUE(found(table_id, 20) == value_of(20, 0));
+    }
+    END()
+
+    close_table(table_id);
+    shutdown_db();
+    db_set_record_cache(0);
+}
+
+void TEST_DEADLOCK()
+{
+    auto original = LockManager::instance().get_deadlock_config();
+    // policy를 바꾸고 key 1, 2만 있는 table을 새로 연다.
+    auto open_with = [](DeadlockPolicy policy) {
+        DeadlockConfig config;
+        config.policy = policy;
+        config.detect_interval_ms = 1;
+        LockManager::instance().set_deadlock_config(config);
+        unlink("deadlock.log");
+        unlink("DATA42");
+        init_db(100, 0, 0, (char*)"deadlock.log", (char*)"deadlock.txt");
+        int table_id = open_table((char*)"DATA42");
+        db_insert(table_id, 1, (char*)"1");
+        db_insert(table_id, 2, (char*)"2");
+        return table_id;
+    };
+    // 다른 thread에서 update 한다.
+    auto update_async = [](int table_id, int64_t key, const char* value,
+                           int trx_id) {
+        return std::async(std::launch::async, [=]() {
+            return db_update(table_id, key, const_cast<char*>(value), trx_id);
+        });
+    };
+    auto blocked = [](std::future<int>& result) {
+        return result.wait_for(std::chrono::milliseconds(50)) ==
+               std::future_status::timeout;
+    };
+    auto value_of = [](int table_id, int64_t key) {
+        char value[120] = "";
+        db_find(table_id, key, value, 0);
+        return std::string(value);
+    };
+
+    // policy마다 t1이 key 1, t2가 key 2를 가진 뒤 서로의 key를 요청한다.
+    // t1이 먼저 시작했으므로 t2가 abort 되고 두 key 모두 t1의 값이 남는다.
+    TEST("detect incremental")
+    {
+        int table_id = open_with(DeadlockPolicy::DETECT_INCREMENTAL);
+        int t1 = trx_begin();
+        int t2 = trx_begin();
+        CHECK_VALUE(db_update(table_id, 1, (char*)"t1", t1), 0);
+        CHECK_VALUE(db_update(table_id, 2, (char*)"t2", t2), 0);
+        auto first = update_async(table_id, 2, "t1", t1);
+        CHECK_TRUE(blocked(first));
+        // cycle을 만든 요청이 abort 된다.
+        CHECK_TRUE(db_update(table_id, 1, (char*)"t2", t2) != 0);
+        CHECK_VALUE(first.get(), 0);
+        CHECK_VALUE(trx_commit(t1), t1);
+        CHECK_VALUE(value_of(table_id, 1), "t1");
+        CHECK_VALUE(value_of(table_id, 2), "t1");
+    }
+    END()
+    shutdown_db();
+
+    TEST("detect background")
+    {
+        int table_id = open_with(DeadlockPolicy::DETECT_BACKGROUND);
+        int t1 = trx_begin();
+        int t2 = trx_begin();
+        CHECK_VALUE(db_update(table_id, 1, (char*)"t1", t1), 0);
+        CHECK_VALUE(db_update(table_id, 2, (char*)"t2", t2), 0);
+        auto first = update_async(table_id, 2, "t1", t1);
+        CHECK_TRUE(blocked(first));
+        auto second = update_async(table_id, 1, "t2", t2);
+        // detector가 cycle에서 가장 늦게 시작한 t2를 abort 시킨다.
+        CHECK_TRUE(second.get() != 0);
+        CHECK_VALUE(first.get(), 0);
+        CHECK_VALUE(trx_commit(t1), t1);
+        CHECK_VALUE(value_of(table_id, 1), "t1");
+        CHECK_VALUE(value_of(table_id, 2), "t1");
+    }
+    END()
+    shutdown_db();
+
+    TEST("wait-die")
+    {
+        int table_id = open_with(DeadlockPolicy::WAIT_DIE);
+        int t1 = trx_begin();
+        int t2 = trx_begin();
+        CHECK_VALUE(db_update(table_id, 1, (char*)"t1", t1), 0);
+        CHECK_VALUE(db_update(table_id, 2, (char*)"t2", t2), 0);
+        // 먼저 시작한 t1은 t2를 기다린다.
+        auto first = update_async(table_id, 2, "t1", t1);
+        CHECK_TRUE(blocked(first));
+        // 늦게 시작한 t2는 t1을 기다리지 않고 abort 한다.
+        CHECK_TRUE(db_update(table_id, 1, (char*)"t2", t2) != 0);
+        CHECK_VALUE(first.get(), 0);
+        CHECK_VALUE(trx_commit(t1), t1);
+        CHECK_VALUE(value_of(table_id, 1), "t1");
+        CHECK_VALUE(value_of(table_id, 2), "t1");
+    }
+    END()
+    shutdown_db();
+
+    TEST("wound-wait")
+    {
+        int table_id = open_with(DeadlockPolicy::WOUND_WAIT);
+        int t1 = trx_begin();
+        int t2 = trx_begin();
+        CHECK_VALUE(db_update(table_id, 1, (char*)"t1", t1), 0);
+        CHECK_VALUE(db_update(table_id, 2, (char*)"t2", t2), 0);
+        // 늦게 시작한 t2는 t1을 기다린다.
+        auto second = update_async(table_id, 1, "t2", t2);
+        CHECK_TRUE(blocked(second));
+        // t1이 t2를 wound 하면, 기다리던 t2는 lock_wait에서 깨어나 abort
+        // 하고 t1이 lock을 얻는다.
+        CHECK_VALUE(db_update(table_id, 2, (char*)"t1", t1), 0);
+        CHECK_TRUE(second.get() != 0);
+        CHECK_VALUE(trx_commit(t1), t1);
+        CHECK_VALUE(value_of(table_id, 1), "t1");
+        CHECK_VALUE(value_of(table_id, 2), "t1");
+    }
+    END()
+    shutdown_db();
+
+    TEST("wounded waiter stays aborted")
+    {
+        // wound 된 뒤 lock_wait이 state를 읽기 전에 앞의 lock이 풀려도,
+        // wound 된 lock을 주면 안 된다. lock_wait을 늦게 불러서 그 사이를
+        // 만든다.
+        int table_id = open_with(DeadlockPolicy::WOUND_WAIT);
+        auto& manager = TransactionManager::instance();
+        int t1 = trx_begin();
+        int t2 = trx_begin();
+        CHECK_TRUE(manager.lock_acquire(table_id, 1, t1, LockMode::EXCLUSIVE)
+                       .state == LockState::ACQUIRED);
+        CHECK_TRUE(manager.lock_acquire(table_id, 2, t2, LockMode::EXCLUSIVE)
+                       .state == LockState::ACQUIRED);
+        auto [waiting, state] =
+            manager.lock_acquire(table_id, 1, t2, LockMode::EXCLUSIVE);
+        CHECK_TRUE(state == LockState::WAITING);
+        // t1이 t2를 wound 하고, commit 하면서 key 1의 lock을 놓는다.
+        CHECK_TRUE(manager.lock_acquire(table_id, 2, t1, LockMode::EXCLUSIVE)
+                       .state == LockState::WAITING);
+        CHECK_VALUE(trx_commit(t1), t1);
+        CHECK_FALSE(manager.lock_wait(waiting));
+        CHECK_VALUE(trx_abort(t2), t2);
+    }
+    END()
+    shutdown_db();
+
+    TEST("detect incremental granted waiter")
+    {
+        // lock을 얻은 waiter의 edge가 lock_wait이 돌아올 때까지 남아 있으면,
+        // 그 사이의 요청이 없는 cycle을 본다. lock_wait을 부르지 않고
+        // TransactionManager::lock_acquire만으로 그 사이를 만든다.
+        int table_id = open_with(DeadlockPolicy::DETECT_INCREMENTAL);
+        auto& manager = TransactionManager::instance();
+        int t1 = trx_begin();
+        int t2 = trx_begin();
+        int t3 = trx_begin();
+        CHECK_TRUE(manager.lock_acquire(table_id, 2, t2, LockMode::EXCLUSIVE)
+                       .state == LockState::ACQUIRED);
+        CHECK_TRUE(manager.lock_acquire(table_id, 1, t1, LockMode::SHARED)
+                       .state == LockState::ACQUIRED);
+        CHECK_TRUE(manager.lock_acquire(table_id, 1, t3, LockMode::EXCLUSIVE)
+                       .state == LockState::WAITING);
+        // t2는 t3의 EXCLUSIVE 뒤에서 t1, t3을 기다린다.
+        CHECK_TRUE(manager.lock_acquire(table_id, 1, t2, LockMode::SHARED)
+                       .state == LockState::WAITING);
+        // t3이 빠지면 t2는 t1과 함께 SHARED lock을 얻는다.
+        CHECK_VALUE(trx_abort(t3), t3);
+        // t2의 edge가 남아 있으면 t1 -> t2 -> t1을 cycle로 본다.
+        CHECK_TRUE(manager.lock_acquire(table_id, 2, t1, LockMode::EXCLUSIVE)
+                       .state == LockState::WAITING);
+        CHECK_VALUE(trx_commit(t2), t2);
+        CHECK_VALUE(trx_commit(t1), t1);
+    }
+    END()
+    shutdown_db();
+
+    LockManager::instance().set_deadlock_config(original);
+}
+
+void TEST_LOG_BUFFER()
+{
+    constexpr auto path = "log_buffer_test.log";
+
+    TEST("concurrent append")
+    {
+        // ring을 여러 번 돌 만큼 쓴다. 앞선 log가 flush 되기 전에 ring이
+        // 차면 append가 직접 flush 해야 한다.
+        constexpr int NUM_THREADS = 8;
+        constexpr int NUM_RECORDS = 4000;
+        unlink(path);
+        auto buffer = std::make_unique<LogBuffer>();
+        buffer->open(path);
+
+        // 크기가 다른 record를 섞어서 ring 끝에서 record가 잘리게 한다.
+        auto image_of = [](int thread, int seq) {
+            valType image;
+            image.fill((thread * 31 + seq) & 0xff);
+            return image;
+        };
+        std::vector<std::vector<int64_t>> lsns(NUM_THREADS);
+        std::atomic<bool> done { false };
+        std::thread flusher([&] {
+            while (!done)
+            {
+                buffer->flush();
+            }
+        });
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t)
+        {
+            threads.emplace_back([&, t] {
+                int64_t prev_lsn = INVALID_LSN;
+                for (int seq = 0; seq < NUM_RECORDS; ++seq)
+                {
+                    if (seq % 3 == 0)
+                    {
+                        CommonLogRecord rec;
+                        rec.prev_lsn = prev_lsn;
+                        rec.transaction_id = t + 1;
+                        rec.type = LogType::BEGIN;
+                        rec.log_size = sizeof(rec);
+                        prev_lsn = buffer->append(rec);
+                    }
+                    else
+                    {
+                        UpdateLogRecord rec;
+                        rec.prev_lsn = prev_lsn;
+                        rec.transaction_id = t + 1;
+                        rec.type = LogType::UPDATE;
+                        rec.table_id = 1;
+                        rec.page_number = seq;
+                        rec.offset = t;
+                        rec.data_length = sizeof(valType);
+                        rec.old_image = image_of(t, seq);
+                        rec.new_image = image_of(t, seq + 1);
+                        rec.log_size = sizeof(rec);
+                        prev_lsn = buffer->append(rec);
+                    }
+                    lsns[t].push_back(prev_lsn);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        done = true;
+        flusher.join();
+        buffer->flush();
+        CHECK_TRUE(buffer->get_last_lsn() >
+                   LOG_START_LSN + 4 * static_cast<int64_t>(LOG_BUFFER_SIZE));
+
+        // lsn 순서로 빈틈없이 이어지고, thread 별로는 append 한 순서대로
+        // 같은 내용이 나와야 한다.
+        LogReader reader(path, LOG_START_LSN);
+        std::vector<int> next(NUM_THREADS, 0);
+        bool ok = true;
+        int total = 0;
+        while (ok)
+        {
+            int64_t lsn = reader.get_lsn();
+            auto [type, record] = reader.next();
+            if (type == LogType::INVALID)
+            {
+                break;
+            }
+            int t = std::visit(
+                [](auto& rec) { return static_cast<int>(rec.transaction_id); },
+                record) - 1;
+            ok = get_log_record_lsn(record) == lsn && t >= 0 &&
+                 t < NUM_THREADS && next[t] < NUM_RECORDS &&
+                 lsns[t][next[t]] == lsn;
+            if (!ok)
+            {
+                break;
+            }
+            int seq = next[t]++;
+            int64_t prev_lsn = seq == 0 ? INVALID_LSN : lsns[t][seq - 1];
+            if (seq % 3 == 0)
+            {
+                auto& rec = std::get<CommonLogRecord>(record);
+                ok = type == LogType::BEGIN && rec.prev_lsn == prev_lsn;
+            }
+            else
+            {
+                auto& rec = std::get<UpdateLogRecord>(record);
+                valType old_image = rec.old_image;
+                valType new_image = rec.new_image;
+                ok = type == LogType::UPDATE && rec.prev_lsn == prev_lsn &&
+                     rec.page_number == seq && rec.offset == t &&
+                     old_image == image_of(t, seq) &&
+                     new_image == image_of(t, seq + 1);
+            }
+            ++total;
+        }
+        CHECK_TRUE(ok);
+        CHECK_VALUE(total, NUM_THREADS * NUM_RECORDS);
+        CHECK_VALUE(reader.get_lsn(), buffer->get_last_lsn());
+    }
+    END()
+
+    unlink(path);
+
+    TEST("group commit")
+    {
+        // 여러 thread가 동시에 commit 할 때, commit이 돌아온 시점에는
+        // 그 transaction의 COMMIT log 전체가 disk에 있어야 한다.
+        // log를 끝까지 읽어야 하므로 checkpointer는 멈춰 둔다.
+        constexpr int NUM_THREADS = 8;
+        constexpr int NUM_COMMITS = 50;
+        CheckpointConfig checkpointer;
+        checkpointer.enabled = false;
+        LogManager::instance().set_checkpoint_config(checkpointer);
+
+        unlink("group_commit.log");
+        unlink("DATA43");
+        init_db(100, 0, 0, (char*)"group_commit.log",
+                (char*)"group_commit.txt");
+        int table_id = open_table((char*)"DATA43");
+        for (int t = 0; t < NUM_THREADS; ++t)
+        {
+            db_insert(table_id, t, (char*)"0");
+        }
+
+        // (transaction id, commit이 돌아온 직후의 flushed_lsn)
+        std::vector<std::vector<std::pair<int, int64_t>>> commits(NUM_THREADS);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t)
+        {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < NUM_COMMITS; ++i)
+                {
+                    int trx_id = trx_begin();
+                    auto value = std::to_string(i);
+                    db_update(table_id, t, value.data(), trx_id);
+                    if (trx_commit(trx_id) != trx_id)
+                    {
+                        return;
+                    }
+                    commits[t].emplace_back(
+                        trx_id, LogManager::instance().get_flushed_lsn());
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::map<int, int64_t> commit_lsn;
+        LogReader reader { "group_commit.log" };
+        while (true)
+        {
+            auto [type, record] = reader.next();
+            if (type == LogType::INVALID)
+            {
+                break;
+            }
+            if (type == LogType::COMMIT)
+            {
+                auto& rec = std::get<CommonLogRecord>(record);
+                commit_lsn[rec.transaction_id] = rec.lsn;
+            }
+        }
+
+        bool ok = true;
+        int total = 0;
+        for (auto& thread_commits : commits)
+        {
+            for (auto [trx_id, flushed_lsn] : thread_commits)
+            {
+                auto it = commit_lsn.find(trx_id);
+                ok = ok && it != commit_lsn.end() &&
+                     flushed_lsn >= it->second +
+                                        static_cast<int64_t>(
+                                            sizeof(CommonLogRecord));
+                ++total;
+            }
+        }
+        CHECK_TRUE(ok);
+        CHECK_VALUE(total, NUM_THREADS * NUM_COMMITS);
+    }
+    END()
+    shutdown_db();
+
+    LogManager::instance().set_checkpoint_config(CheckpointConfig {});
+}
+
 void TEST_LOG()
 {
     TEST("log record size")